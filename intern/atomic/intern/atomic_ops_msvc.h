@@ -99,4 +99,22 @@ ATOMIC_INLINE uint8_t atomic_fetch_and_or_uint8(uint8_t *p, uint8_t b)
 #endif
 }
 
+/******************************************************************************/
+/* Loads with acquire ordering, aligned loads are atomic and never reordered with later
+ * memory accesses on x86, only the compiler must not move them. */
+#pragma intrinsic(_ReadWriteBarrier)
+ATOMIC_INLINE size_t atomic_load_z(const size_t *v)
+{
+	const size_t ret = *(volatile const size_t *)v;
+	_ReadWriteBarrier();
+	return ret;
+}
+
+ATOMIC_INLINE void *atomic_load_ptr(void *const *v)
+{
+	void *ret = *(void *volatile const *)v;
+	_ReadWriteBarrier();
+	return ret;
+}
+
 #endif /* __ATOMIC_OPS_MSVC_H__ */
@@ -177,4 +177,32 @@ ATOMIC_INLINE uint8_t atomic_fetch_and_or_uint8(uint8_t *p, uint8_t b)
 #  error "Missing implementation for 8-bit atomic operations"
 #endif
 
+/******************************************************************************/
+/* Loads with acquire ordering. */
+#if defined(__ATOMIC_ACQUIRE)
+ATOMIC_INLINE size_t atomic_load_z(const size_t *v)
+{
+	return __atomic_load_n(v, __ATOMIC_ACQUIRE);
+}
+
+ATOMIC_INLINE void *atomic_load_ptr(void *const *v)
+{
+	return __atomic_load_n(v, __ATOMIC_ACQUIRE);
+}
+#else
+ATOMIC_INLINE size_t atomic_load_z(const size_t *v)
+{
+	const size_t ret = *(volatile const size_t *)v;
+	__sync_synchronize();
+	return ret;
+}
+
+ATOMIC_INLINE void *atomic_load_ptr(void *const *v)
+{
+	void *ret = *(void *volatile const *)v;
+	__sync_synchronize();
+	return ret;
+}
+#endif
+
 #endif /* __ATOMIC_OPS_UNIX_H__ */
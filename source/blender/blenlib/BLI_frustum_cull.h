@@ -0,0 +1,62 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_FRUSTUM_CULL_H__
+#define __BLI_FRUSTUM_CULL_H__
+
+/** \file BLI_frustum_cull.h
+ *  \ingroup bli
+ *  \brief Batched culling of bounding volumes against a set of planes.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRUSTUM_CULL_BLOCK_SIZE 4
+
+/**
+ * Bounds of #FRUSTUM_CULL_BLOCK_SIZE objects, stored component by component so that
+ * a whole block is tested at once.
+ *
+ * Each object is an oriented box given by its center and its three half extent axes,
+ * \a radius is the radius of the sphere around \a center enclosing the box.
+ * Unused slots of the last block should have a zero radius and axes.
+ */
+typedef struct FrustumCullBlock {
+	float center[3][FRUSTUM_CULL_BLOCK_SIZE];
+	float radius[FRUSTUM_CULL_BLOCK_SIZE];
+	float axis[3][3][FRUSTUM_CULL_BLOCK_SIZE];
+} FrustumCullBlock;
+
+void BLI_frustum_cull_block_set(
+        FrustumCullBlock *block, const int index,
+        const float center[3], const float axis[3][3]);
+
+void BLI_frustum_cull_blocks(
+        const float (*planes)[4], const int totplane,
+        const FrustumCullBlock *blocks, const int totblock,
+        unsigned char *r_visible, const bool use_threading);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __BLI_FRUSTUM_CULL_H__ */
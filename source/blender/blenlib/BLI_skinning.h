@@ -0,0 +1,61 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_SKINNING_H__
+#define __BLI_SKINNING_H__
+
+/** \file BLI_skinning.h
+ *  \ingroup bli
+ *  \brief Linear blend skinning of vertices with a fixed amount of influences.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SKIN_MAX_INFLUENCES 4
+
+/**
+ * Bone influences of each vertex, #SKIN_MAX_INFLUENCES per vertex sorted by decreasing weight.
+ * The weights of a vertex add up to one, or are all zero when the vertex is not deformed.
+ */
+typedef struct SkinWeights {
+	int totvert;
+	int (*bone)[SKIN_MAX_INFLUENCES];
+	float (*weight)[SKIN_MAX_INFLUENCES];
+} SkinWeights;
+
+void BLI_skin_weights_init(SkinWeights *weights, const int totvert);
+void BLI_skin_weights_free(SkinWeights *weights);
+void BLI_skin_weights_set(
+        SkinWeights *weights, const int index,
+        const int *bone, const float *weight, const int totweight);
+
+void BLI_skin_deform(
+        const SkinWeights *weights,
+        const float (*palette)[4][4], const float (*nor_palette)[4][4],
+        float (*co)[3], float (*no)[3],
+        float r_min[3], float r_max[3], const bool use_threading);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __BLI_SKINNING_H__ */
@@ -28,6 +28,12 @@
  *  \ingroup bli
  */
 
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * \note keep \a sort_value first,
  * so cmp functions can be reused.
@@ -58,4 +64,13 @@ int BLI_sortutil_cmp_float_reverse(const void *a_, const void *b_);
 int BLI_sortutil_cmp_int(const void *a_, const void *b_);
 int BLI_sortutil_cmp_int_reverse(const void *a_, const void *b_);
 
+unsigned int BLI_sortutil_float_as_key(const float value);
+void BLI_sortutil_radix_u64(
+        uint64_t *keys, unsigned int *values,
+        uint64_t *keys_tmp, unsigned int *values_tmp, const unsigned int len);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif  /* __BLI_SORT_UTILS_H__ */
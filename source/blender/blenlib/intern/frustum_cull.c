@@ -0,0 +1,231 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/frustum_cull.c
+ *  \ingroup bli
+ *
+ * Tests many oriented boxes against a set of planes (typically a view frustum) at once.
+ *
+ * Each object is first tested using its bounding sphere: a sphere fully behind any plane is culled,
+ * a sphere fully in front of all planes is visible. Only when some sphere of a block intersects
+ * a plane, the boxes of that block are tested as well, which gives the same result as testing
+ * the eight box corners against each plane.
+ */
+
+#include <math.h>
+
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+
+#include "BLI_frustum_cull.h"  /* own include */
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/* Below this amount of blocks, threading overhead is higher than the culling itself. */
+#define FRUSTUM_CULL_THREADED_MIN_BLOCKS 256
+
+/**
+ * Fill the slot \a index of \a block.
+ *
+ * \param axis: The three half extent axes of the box, in world space.
+ */
+void BLI_frustum_cull_block_set(
+        FrustumCullBlock *block, const int index,
+        const float center[3], const float axis[3][3])
+{
+	float len_sq = 0.0f;
+	int i, j;
+
+	BLI_assert(index >= 0 && index < FRUSTUM_CULL_BLOCK_SIZE);
+
+	for (i = 0; i < 3; i++) {
+		block->center[i][index] = center[i];
+		for (j = 0; j < 3; j++) {
+			block->axis[i][j][index] = axis[i][j];
+			len_sq += axis[i][j] * axis[i][j];
+		}
+	}
+
+	/* axes are orthogonal, this is the half diagonal of the box */
+	block->radius[index] = sqrtf(len_sq);
+}
+
+#ifdef __SSE2__
+
+BLI_INLINE __m128 frustum_cull_dot_v3(const float plane[4], const __m128 x, const __m128 y, const __m128 z)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), x),
+	                             _mm_mul_ps(_mm_set1_ps(plane[1]), y)),
+	                  _mm_mul_ps(_mm_set1_ps(plane[2]), z));
+}
+
+static void frustum_cull_block(
+        const float (*planes)[4], const int totplane,
+        const FrustumCullBlock *block, unsigned char r_visible[FRUSTUM_CULL_BLOCK_SIZE])
+{
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 cx = _mm_loadu_ps(block->center[0]);
+	const __m128 cy = _mm_loadu_ps(block->center[1]);
+	const __m128 cz = _mm_loadu_ps(block->center[2]);
+	const __m128 radius = _mm_loadu_ps(block->radius);
+	const __m128 radius_neg = _mm_sub_ps(_mm_setzero_ps(), radius);
+	__m128 outside = _mm_setzero_ps();
+	__m128 intersect = _mm_setzero_ps();
+	int mask_outside, i, p;
+
+	for (p = 0; p < totplane; p++) {
+		const __m128 dist = _mm_add_ps(frustum_cull_dot_v3(planes[p], cx, cy, cz), _mm_set1_ps(planes[p][3]));
+
+		outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, radius_neg));
+		intersect = _mm_or_ps(intersect, _mm_cmplt_ps(dist, radius));
+	}
+
+	mask_outside = _mm_movemask_ps(outside);
+
+	if (_mm_movemask_ps(intersect) & ~mask_outside) {
+		const __m128 a0x = _mm_loadu_ps(block->axis[0][0]);
+		const __m128 a0y = _mm_loadu_ps(block->axis[0][1]);
+		const __m128 a0z = _mm_loadu_ps(block->axis[0][2]);
+		const __m128 a1x = _mm_loadu_ps(block->axis[1][0]);
+		const __m128 a1y = _mm_loadu_ps(block->axis[1][1]);
+		const __m128 a1z = _mm_loadu_ps(block->axis[1][2]);
+		const __m128 a2x = _mm_loadu_ps(block->axis[2][0]);
+		const __m128 a2y = _mm_loadu_ps(block->axis[2][1]);
+		const __m128 a2z = _mm_loadu_ps(block->axis[2][2]);
+
+		for (p = 0; p < totplane; p++) {
+			const __m128 dist = _mm_add_ps(frustum_cull_dot_v3(planes[p], cx, cy, cz), _mm_set1_ps(planes[p][3]));
+			/* distance from the box center to its farthest corner, along the plane normal */
+			const __m128 extent = _mm_add_ps(
+			        _mm_add_ps(_mm_and_ps(frustum_cull_dot_v3(planes[p], a0x, a0y, a0z), abs_mask),
+			                   _mm_and_ps(frustum_cull_dot_v3(planes[p], a1x, a1y, a1z), abs_mask)),
+			        _mm_and_ps(frustum_cull_dot_v3(planes[p], a2x, a2y, a2z), abs_mask));
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, extent), _mm_setzero_ps()));
+		}
+
+		mask_outside = _mm_movemask_ps(outside);
+	}
+
+	for (i = 0; i < FRUSTUM_CULL_BLOCK_SIZE; i++) {
+		r_visible[i] = (mask_outside & (1 << i)) == 0;
+	}
+}
+
+#else  /* __SSE2__ */
+
+static void frustum_cull_block(
+        const float (*planes)[4], const int totplane,
+        const FrustumCullBlock *block, unsigned char r_visible[FRUSTUM_CULL_BLOCK_SIZE])
+{
+	int i, p;
+
+	for (i = 0; i < FRUSTUM_CULL_BLOCK_SIZE; i++) {
+		const float center[3] = {block->center[0][i], block->center[1][i], block->center[2][i]};
+		const float radius = block->radius[i];
+		bool outside = false;
+		bool intersect = false;
+
+		for (p = 0; p < totplane; p++) {
+			const float dist = planes[p][0] * center[0] + planes[p][1] * center[1] + planes[p][2] * center[2] +
+			                   planes[p][3];
+
+			if (dist < -radius) {
+				outside = true;
+				break;
+			}
+			else if (dist < radius) {
+				intersect = true;
+			}
+		}
+
+		if (!outside && intersect) {
+			for (p = 0; p < totplane; p++) {
+				const float dist = planes[p][0] * center[0] + planes[p][1] * center[1] + planes[p][2] * center[2] +
+				                   planes[p][3];
+				float extent = 0.0f;
+				int j;
+
+				for (j = 0; j < 3; j++) {
+					extent += fabsf(planes[p][0] * block->axis[j][0][i] +
+					                planes[p][1] * block->axis[j][1][i] +
+					                planes[p][2] * block->axis[j][2][i]);
+				}
+
+				if (dist + extent < 0.0f) {
+					outside = true;
+					break;
+				}
+			}
+		}
+
+		r_visible[i] = !outside;
+	}
+}
+
+#endif  /* __SSE2__ */
+
+typedef struct FrustumCullData {
+	const float (*planes)[4];
+	int totplane;
+	const FrustumCullBlock *blocks;
+	unsigned char *r_visible;
+} FrustumCullData;
+
+static void frustum_cull_block_cb(void *userdata, const int iter)
+{
+	FrustumCullData *data = userdata;
+
+	frustum_cull_block(data->planes, data->totplane, &data->blocks[iter],
+	                   &data->r_visible[iter * FRUSTUM_CULL_BLOCK_SIZE]);
+}
+
+/**
+ * Test \a totblock blocks of boxes against \a planes, the planes normals must be normalized
+ * and point towards the visible side.
+ *
+ * \param r_visible: Receives one value per object (`totblock * FRUSTUM_CULL_BLOCK_SIZE`),
+ * non-zero when the object is at least partially in front of all planes.
+ * \param use_threading: Split the work over the task scheduler for large amounts of blocks.
+ */
+void BLI_frustum_cull_blocks(
+        const float (*planes)[4], const int totplane,
+        const FrustumCullBlock *blocks, const int totblock,
+        unsigned char *r_visible, const bool use_threading)
+{
+	FrustumCullData data;
+	int i;
+
+	if (use_threading && totblock >= FRUSTUM_CULL_THREADED_MIN_BLOCKS) {
+		data.planes = planes;
+		data.totplane = totplane;
+		data.blocks = blocks;
+		data.r_visible = r_visible;
+
+		BLI_task_parallel_range(0, totblock, &data, frustum_cull_block_cb, true);
+	}
+	else {
+		for (i = 0; i < totblock; i++) {
+			frustum_cull_block(planes, totplane, &blocks[i], &r_visible[i * FRUSTUM_CULL_BLOCK_SIZE]);
+		}
+	}
+}
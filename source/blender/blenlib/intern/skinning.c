@@ -0,0 +1,255 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/skinning.c
+ *  \ingroup bli
+ *
+ * Linear blend skinning: each vertex is transformed by the weighted sum of the matrices
+ * of its bones. The bone matrices are given as a palette, computed once per update by the caller,
+ * and the weights are stored with a fixed amount of influences per vertex so that
+ * the matrices of a vertex are blended without any branch on the amount of weights.
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_task.h"
+
+#include "BLI_skinning.h"  /* own include */
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/* Vertices deformed by a single task. */
+#define SKIN_CHUNK_SIZE 1024
+/* Below this amount of vertices, threading overhead is higher than the skinning itself. */
+#define SKIN_THREADED_MIN_VERTS (SKIN_CHUNK_SIZE * 4)
+
+void BLI_skin_weights_init(SkinWeights *weights, const int totvert)
+{
+	weights->totvert = totvert;
+	weights->bone = MEM_callocN(sizeof(*weights->bone) * totvert, __func__);
+	weights->weight = MEM_callocN(sizeof(*weights->weight) * totvert, __func__);
+}
+
+void BLI_skin_weights_free(SkinWeights *weights)
+{
+	MEM_SAFE_FREE(weights->bone);
+	MEM_SAFE_FREE(weights->weight);
+	weights->totvert = 0;
+}
+
+/**
+ * Set the influences of the vertex \a index, only the #SKIN_MAX_INFLUENCES largest weights
+ * are kept and normalized. Zero weights are ignored.
+ */
+void BLI_skin_weights_set(
+        SkinWeights *weights, const int index,
+        const int *bone, const float *weight, const int totweight)
+{
+	int *r_bone = weights->bone[index];
+	float *r_weight = weights->weight[index];
+	float contrib = 0.0f;
+	int i, j, tot = 0;
+
+	memset(r_bone, 0, sizeof(weights->bone[index]));
+	memset(r_weight, 0, sizeof(weights->weight[index]));
+
+	for (i = 0; i < totweight; i++) {
+		if (weight[i] <= 0.0f || (tot == SKIN_MAX_INFLUENCES && r_weight[tot - 1] >= weight[i])) {
+			continue;
+		}
+
+		/* insertion in the influences sorted by decreasing weight, when they are all used
+		 * the smallest one is replaced */
+		for (j = min_ii(tot, SKIN_MAX_INFLUENCES - 1); j > 0 && r_weight[j - 1] < weight[i]; j--) {
+			r_bone[j] = r_bone[j - 1];
+			r_weight[j] = r_weight[j - 1];
+		}
+		r_bone[j] = bone[i];
+		r_weight[j] = weight[i];
+
+		if (tot < SKIN_MAX_INFLUENCES) {
+			tot++;
+		}
+	}
+
+	for (i = 0; i < tot; i++) {
+		contrib += r_weight[i];
+	}
+	if (contrib > 0.0f) {
+		for (i = 0; i < tot; i++) {
+			r_weight[i] /= contrib;
+		}
+	}
+}
+
+typedef struct SkinDeformData {
+	const SkinWeights *weights;
+	const float (*palette)[4][4];
+	const float (*nor_palette)[4][4];
+	float (*co)[3];
+	float (*no)[3];
+	int totchunk;
+	/* bounds of each chunk */
+	float (*chunk_min)[3];
+	float (*chunk_max)[3];
+} SkinDeformData;
+
+#ifdef __SSE2__
+
+BLI_INLINE void skin_deform_co(const float (*palette)[4][4], const int bone[4], const float weight[4], float co[3])
+{
+	__m128 w = _mm_set1_ps(weight[0]);
+	__m128 c0 = _mm_mul_ps(_mm_loadu_ps(palette[bone[0]][0]), w);
+	__m128 c1 = _mm_mul_ps(_mm_loadu_ps(palette[bone[0]][1]), w);
+	__m128 c2 = _mm_mul_ps(_mm_loadu_ps(palette[bone[0]][2]), w);
+	__m128 c3 = _mm_mul_ps(_mm_loadu_ps(palette[bone[0]][3]), w);
+	float r[4];
+	int i;
+
+	/* blend the columns of the bone matrices */
+	for (i = 1; i < SKIN_MAX_INFLUENCES && weight[i] != 0.0f; i++) {
+		const float (*mat)[4] = palette[bone[i]];
+
+		w = _mm_set1_ps(weight[i]);
+		c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(mat[0]), w));
+		c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(mat[1]), w));
+		c2 = _mm_add_ps(c2, _mm_mul_ps(_mm_loadu_ps(mat[2]), w));
+		c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(mat[3]), w));
+	}
+
+	c3 = _mm_add_ps(_mm_add_ps(c3, _mm_mul_ps(c0, _mm_set1_ps(co[0]))),
+	                _mm_add_ps(_mm_mul_ps(c1, _mm_set1_ps(co[1])), _mm_mul_ps(c2, _mm_set1_ps(co[2]))));
+
+	_mm_storeu_ps(r, c3);
+	copy_v3_v3(co, r);
+}
+
+#else  /* __SSE2__ */
+
+BLI_INLINE void skin_deform_co(const float (*palette)[4][4], const int bone[4], const float weight[4], float co[3])
+{
+	float mat[4][4];
+	int i, j;
+
+	for (j = 0; j < 16; j++) {
+		((float *)mat)[j] = ((const float *)palette[bone[0]])[j] * weight[0];
+	}
+
+	for (i = 1; i < SKIN_MAX_INFLUENCES && weight[i] != 0.0f; i++) {
+		for (j = 0; j < 16; j++) {
+			((float *)mat)[j] += ((const float *)palette[bone[i]])[j] * weight[i];
+		}
+	}
+
+	mul_m4_v3(mat, co);
+}
+
+#endif  /* __SSE2__ */
+
+static void skin_deform_chunk(const SkinDeformData *data, const int chunk, float r_min[3], float r_max[3])
+{
+	const int start = chunk * SKIN_CHUNK_SIZE;
+	const int end = min_ii(start + SKIN_CHUNK_SIZE, data->weights->totvert);
+	const int (*bone)[SKIN_MAX_INFLUENCES] = (const int (*)[SKIN_MAX_INFLUENCES])data->weights->bone;
+	const float (*weight)[SKIN_MAX_INFLUENCES] = (const float (*)[SKIN_MAX_INFLUENCES])data->weights->weight;
+	int i;
+
+	INIT_MINMAX(r_min, r_max);
+
+	for (i = start; i < end; i++) {
+		/* the first weight is the largest one, it is zero for vertices which are not deformed */
+		if (weight[i][0] != 0.0f) {
+			skin_deform_co(data->palette, bone[i], weight[i], data->co[i]);
+
+			/* the normal only follows the most influential bone */
+			if (data->no) {
+				mul_mat3_m4_v3((float (*)[4])data->nor_palette[bone[i][0]], data->no[i]);
+			}
+		}
+
+		minmax_v3v3_v3(r_min, r_max, data->co[i]);
+	}
+}
+
+static void skin_deform_chunk_cb(void *userdata, const int iter)
+{
+	SkinDeformData *data = userdata;
+
+	skin_deform_chunk(data, iter, data->chunk_min[iter], data->chunk_max[iter]);
+}
+
+/**
+ * Deform \a co and \a no in place.
+ *
+ * \param palette: The matrix of each bone referenced by \a weights, column major.
+ * \param nor_palette: The matrices used to rotate the normals, only the 3x3 part is used.
+ * \param no: The normals, may be NULL, they are only rotated by the matrix of the largest influence.
+ * \param r_min, r_max: Receive the bounds of all the vertices.
+ * \param use_threading: Split the vertices in chunks over the task scheduler for large meshes.
+ */
+void BLI_skin_deform(
+        const SkinWeights *weights,
+        const float (*palette)[4][4], const float (*nor_palette)[4][4],
+        float (*co)[3], float (*no)[3],
+        float r_min[3], float r_max[3], const bool use_threading)
+{
+	SkinDeformData data;
+	float min[3], max[3];
+	int i;
+
+	BLI_assert(no == NULL || nor_palette != NULL);
+
+	data.weights = weights;
+	data.palette = palette;
+	data.nor_palette = nor_palette;
+	data.co = co;
+	data.no = no;
+	data.totchunk = (weights->totvert + SKIN_CHUNK_SIZE - 1) / SKIN_CHUNK_SIZE;
+
+	INIT_MINMAX(r_min, r_max);
+
+	if (use_threading && weights->totvert >= SKIN_THREADED_MIN_VERTS) {
+		data.chunk_min = MEM_mallocN(sizeof(*data.chunk_min) * data.totchunk, __func__);
+		data.chunk_max = MEM_mallocN(sizeof(*data.chunk_max) * data.totchunk, __func__);
+
+		BLI_task_parallel_range(0, data.totchunk, &data, skin_deform_chunk_cb, true);
+
+		for (i = 0; i < data.totchunk; i++) {
+			minmax_v3v3_v3(r_min, r_max, data.chunk_min[i]);
+			minmax_v3v3_v3(r_min, r_max, data.chunk_max[i]);
+		}
+
+		MEM_freeN(data.chunk_min);
+		MEM_freeN(data.chunk_max);
+	}
+	else {
+		for (i = 0; i < data.totchunk; i++) {
+			skin_deform_chunk(&data, i, min, max);
+			minmax_v3v3_v3(r_min, r_max, min);
+			minmax_v3v3_v3(r_min, r_max, max);
+		}
+	}
+}
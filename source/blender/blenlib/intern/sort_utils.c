@@ -27,6 +27,10 @@
  * Utility functions for sorting common types.
  */
 
+#include <string.h>
+
+#include "BLI_utildefines.h"
+
 #include "BLI_sort_utils.h"  /* own include */
 
 struct SortAnyByFloat {
@@ -72,3 +76,75 @@ int BLI_sortutil_cmp_int_reverse(const void *a_, const void *b_)
 	else if (a->sort_value > b->sort_value) return -1;
 	else                                    return  0;
 }
+
+/**
+ * Convert a float to an unsigned integer with the same order, to be used as a sort key.
+ */
+unsigned int BLI_sortutil_float_as_key(const float value)
+{
+	union { float f; unsigned int i; } u;
+	u.f = value;
+	/* negative values are reversed, positive ones are moved after them */
+	return (u.i & 0x80000000u) ? ~u.i : (u.i | 0x80000000u);
+}
+
+/**
+ * Stable LSD radix sort of 64 bit keys by increasing value, \a values are moved along with their keys.
+ * Bytes shared by all the keys are skipped, so keys using only a few bits are sorted in a few passes.
+ *
+ * \param keys_tmp, values_tmp: Buffers of \a len elements used during the sort,
+ * so that callers sorting every frame can keep them allocated.
+ */
+void BLI_sortutil_radix_u64(
+        uint64_t *keys, unsigned int *values,
+        uint64_t *keys_tmp, unsigned int *values_tmp, const unsigned int len)
+{
+	unsigned int count[8][256];
+	uint64_t *src_keys = keys, *dst_keys = keys_tmp;
+	unsigned int *src_values = values, *dst_values = values_tmp;
+	unsigned int i, pass;
+
+	if (len < 2) {
+		return;
+	}
+
+	/* histograms of all the passes in a single read of the keys */
+	memset(count, 0, sizeof(count));
+	for (i = 0; i < len; i++) {
+		const uint64_t key = keys[i];
+		for (pass = 0; pass < 8; pass++) {
+			count[pass][(key >> (pass * 8)) & 0xff]++;
+		}
+	}
+
+	for (pass = 0; pass < 8; pass++) {
+		unsigned int *offset = count[pass];
+		const unsigned int shift = pass * 8;
+		unsigned int j, total = 0;
+
+		/* all the keys share this byte, the pass would not change the order */
+		if (offset[(src_keys[0] >> shift) & 0xff] == len) {
+			continue;
+		}
+
+		for (j = 0; j < 256; j++) {
+			const unsigned int tot = offset[j];
+			offset[j] = total;
+			total += tot;
+		}
+
+		for (i = 0; i < len; i++) {
+			const unsigned int dst = offset[(src_keys[i] >> shift) & 0xff]++;
+			dst_keys[dst] = src_keys[i];
+			dst_values[dst] = src_values[i];
+		}
+
+		SWAP(uint64_t *, src_keys, dst_keys);
+		SWAP(unsigned int *, src_values, dst_values);
+	}
+
+	if (src_keys != keys) {
+		memcpy(keys, src_keys, sizeof(*keys) * len);
+		memcpy(values, src_values, sizeof(*values) * len);
+	}
+}
@@ -37,6 +37,10 @@
 
 /* Types */
 
+/* Number of finished Task structures a worker thread keeps around for reuse, so that
+ * tasks pushed from inside other tasks do not have to go through the allocator. */
+#define TASK_THREAD_CACHE_SIZE 64
+
 typedef struct Task {
 	struct Task *next, *prev;
 
@@ -50,13 +54,18 @@ typedef struct Task {
 struct TaskPool {
 	TaskScheduler *scheduler;
 
-	volatile size_t num;
-	volatile size_t done;
+	size_t num;
+	size_t done;
 	size_t num_threads;
 	size_t currently_running_tasks;
 	ThreadMutex num_mutex;
 	ThreadCondition num_cond;
 
+	/* Incremented on every push, and number of threads sleeping in BLI_task_pool_work_and_wait(),
+	 * together they allow pushes to skip num_mutex when nobody is waiting on this pool. */
+	size_t push_epoch;
+	size_t num_waiters;
+
 	void *userdata;
 	ThreadMutex user_mutex;
 
@@ -73,16 +82,33 @@ struct TaskScheduler {
 	int num_threads;
 	bool background_thread_only;
 
+	/* Tasks pushed from threads which do not belong to this scheduler (usually the main thread). */
 	ListBase queue;
 	ThreadMutex queue_mutex;
 	ThreadCondition queue_cond;
 
+	/* Incremented on every push, and number of worker threads sleeping on queue_cond. */
+	size_t push_epoch;
+	size_t num_sleeping;
+
+	/* Gives the TaskThread of the calling thread, NULL for threads not owned by this scheduler. */
+	pthread_key_t thread_key;
+
 	volatile bool do_exit;
 };
 
 typedef struct TaskThread {
 	TaskScheduler *scheduler;
 	int id;
+
+	/* Tasks pushed from this thread. The owner takes tasks from the head like for the
+	 * scheduler queue, other threads steal from the tail so they rarely contend with it. */
+	ListBase queue;
+	SpinLock queue_lock;
+
+	/* Only ever accessed by the owner thread. */
+	Task *task_cache[TASK_THREAD_CACHE_SIZE];
+	int num_task_cache;
 } TaskThread;
 
 /* Helper */
@@ -98,87 +124,200 @@ static void task_data_free(Task *task, const int thread_id)
 	}
 }
 
+static Task *task_alloc(TaskThread *thread)
+{
+	if (thread && thread->num_task_cache) {
+		return thread->task_cache[--thread->num_task_cache];
+	}
+	return MEM_mallocN(sizeof(Task), "Task");
+}
+
+static void task_free(TaskThread *thread, Task *task, const int thread_id)
+{
+	task_data_free(task, thread_id);
+
+	if (thread && thread->num_task_cache < TASK_THREAD_CACHE_SIZE) {
+		thread->task_cache[thread->num_task_cache++] = task;
+	}
+	else {
+		MEM_freeN(task);
+	}
+}
+
 /* Task Scheduler */
 
-static void task_pool_num_decrease(TaskPool *pool, size_t done)
+static TaskThread *task_scheduler_current_thread(TaskScheduler *scheduler)
 {
-	BLI_mutex_lock(&pool->num_mutex);
+	return pthread_getspecific(scheduler->thread_key);
+}
 
-	BLI_assert(pool->num >= done);
+/* Release count references on the pool, the pool may be freed as soon as this returned. */
+static void task_pool_num_release(TaskPool *pool, size_t count)
+{
+	size_t num;
 
-	pool->num -= done;
-	atomic_sub_z(&pool->currently_running_tasks, done);
-	pool->done += done;
+	/* Only the decrement bringing the counter down to zero has to happen under num_mutex: this way
+	 * BLI_task_pool_work_and_wait() can not return, and the pool be freed, before we notified it. */
+	do {
+		num = atomic_load_z(&pool->num);
 
-	if (pool->num == 0)
-		BLI_condition_notify_all(&pool->num_cond);
+		BLI_assert(num >= count);
 
-	BLI_mutex_unlock(&pool->num_mutex);
+		if (num == count) {
+			BLI_mutex_lock(&pool->num_mutex);
+			atomic_sub_z(&pool->num, count);
+			BLI_condition_notify_all(&pool->num_cond);
+			BLI_mutex_unlock(&pool->num_mutex);
+			return;
+		}
+	} while (atomic_cas_z(&pool->num, num, num - count) != num);
 }
 
-static void task_pool_num_increase(TaskPool *pool)
+static void task_pool_num_decrease(TaskPool *pool, size_t done)
 {
-	BLI_mutex_lock(&pool->num_mutex);
+	atomic_add_z(&pool->done, done);
+	task_pool_num_release(pool, done);
+}
 
-	pool->num++;
-	BLI_condition_notify_all(&pool->num_cond);
+static void task_pool_num_increase(TaskPool *pool, size_t num)
+{
+	atomic_add_z(&pool->num, num);
+}
 
-	BLI_mutex_unlock(&pool->num_mutex);
+/* Wake up threads waiting on a pool after one of its tasks was queued. */
+static void task_pool_notify_push(TaskPool *pool)
+{
+	atomic_add_z(&pool->push_epoch, 1);
+
+	if (atomic_load_z(&pool->num_waiters)) {
+		BLI_mutex_lock(&pool->num_mutex);
+		BLI_condition_notify_all(&pool->num_cond);
+		BLI_mutex_unlock(&pool->num_mutex);
+	}
 }
 
-static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task)
+/* Reserve a thread slot in the pool for the task, respecting BLI_pool_set_num_threads() limit. */
+static bool task_pool_start_task(TaskPool *pool)
 {
-	bool found_task = false;
-	BLI_mutex_lock(&scheduler->queue_mutex);
+	size_t running;
 
-	while (!scheduler->queue.first && !scheduler->do_exit)
-		BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+	if (pool->num_threads == 0) {
+		atomic_add_z(&pool->currently_running_tasks, 1);
+		return true;
+	}
 
 	do {
-		Task *current_task;
-
-		/* Assuming we can only have a void queue in 'exit' case here seems logical (we should only be here after
-		 * our worker thread has been woken up from a condition_wait(), which only happens after a new task was
-		 * added to the queue), but it is wrong.
-		 * Waiting on condition may wake up the thread even if condition is not signaled (spurious wake-ups), and some
-		 * race condition may also empty the queue **after** condition has been signaled, but **before** awoken thread
-		 * reaches this point...
-		 * See http://stackoverflow.com/questions/8594591
-		 *
-		 * So we only abort here if do_exit is set.
-		 */
-		if (scheduler->do_exit) {
-			BLI_mutex_unlock(&scheduler->queue_mutex);
+		running = atomic_load_z(&pool->currently_running_tasks);
+		if (running >= pool->num_threads) {
 			return false;
 		}
+	} while (atomic_cas_z(&pool->currently_running_tasks, running, running + 1) != running);
+
+	return true;
+}
 
-		for (current_task = scheduler->queue.first;
-		     current_task != NULL;
-		     current_task = current_task->next)
-		{
-			TaskPool *pool = current_task->pool;
+/* Find and remove a task which can run now from given queue, caller must hold the queue lock.
+ * If pool is given, only tasks from that pool are considered. */
+static Task *task_queue_pop(TaskScheduler *scheduler, ListBase *queue, TaskPool *pool, const bool from_tail)
+{
+	Task *task;
+
+	for (task = from_tail ? queue->last : queue->first;
+	     task != NULL;
+	     task = from_tail ? task->prev : task->next)
+	{
+		TaskPool *task_pool = task->pool;
 
-			if (scheduler->background_thread_only && !pool->run_in_background) {
+		if (pool) {
+			/* if we get a task from another pool, we can get into deadlock */
+			if (task_pool != pool) {
 				continue;
 			}
+		}
+		else if (scheduler->background_thread_only && !task_pool->run_in_background) {
+			continue;
+		}
 
-			if (pool->num_threads == 0 ||
-			    pool->currently_running_tasks < pool->num_threads)
-			{
-				*task = current_task;
-				found_task = true;
-				atomic_add_z(&pool->currently_running_tasks, 1);
-				BLI_remlink(&scheduler->queue, *task);
-				break;
-			}
+		if (task_pool_start_task(task_pool)) {
+			BLI_remlink(queue, task);
+			return task;
+		}
+	}
+
+	return NULL;
+}
+
+/* Look for work in the calling thread's own queue first, then in the scheduler queue, and finally
+ * steal from the other worker threads. */
+static Task *task_scheduler_pop(TaskScheduler *scheduler, TaskThread *thread, TaskPool *pool)
+{
+	Task *task = NULL;
+	int i;
+
+	if (thread) {
+		BLI_spin_lock(&thread->queue_lock);
+		task = task_queue_pop(scheduler, &thread->queue, pool, false);
+		BLI_spin_unlock(&thread->queue_lock);
+
+		if (task) {
+			return task;
+		}
+	}
+
+	if (atomic_load_ptr(&scheduler->queue.first)) {
+		BLI_mutex_lock(&scheduler->queue_mutex);
+		task = task_queue_pop(scheduler, &scheduler->queue, pool, false);
+		BLI_mutex_unlock(&scheduler->queue_mutex);
+
+		if (task) {
+			return task;
+		}
+	}
+
+	for (i = 0; i < scheduler->num_threads; i++) {
+		/* start with the next thread, so that thieves spread over victims */
+		TaskThread *victim = &scheduler->task_threads[((thread ? thread->id : 0) + i) % scheduler->num_threads];
+
+		if (victim == thread || atomic_load_ptr(&victim->queue.last) == NULL) {
+			continue;
+		}
+
+		BLI_spin_lock(&victim->queue_lock);
+		task = task_queue_pop(scheduler, &victim->queue, pool, true);
+		BLI_spin_unlock(&victim->queue_lock);
+
+		if (task) {
+			return task;
+		}
+	}
+
+	return NULL;
+}
+
+static Task *task_scheduler_thread_wait_pop(TaskScheduler *scheduler, TaskThread *thread)
+{
+	while (!scheduler->do_exit) {
+		const size_t push_epoch = atomic_load_z(&scheduler->push_epoch);
+		Task *task = task_scheduler_pop(scheduler, thread, NULL);
+
+		if (task) {
+			return task;
 		}
-		if (!found_task)
+
+		/* Nothing we can run, sleep until something gets pushed. Checking the epoch after registering
+		 * as sleeper ensures we do not miss a push happening while we were scanning the queues. */
+		BLI_mutex_lock(&scheduler->queue_mutex);
+		atomic_add_z(&scheduler->num_sleeping, 1);
+
+		if (!scheduler->do_exit && atomic_load_z(&scheduler->push_epoch) == push_epoch) {
 			BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
-	} while (!found_task);
+		}
 
-	BLI_mutex_unlock(&scheduler->queue_mutex);
+		atomic_sub_z(&scheduler->num_sleeping, 1);
+		BLI_mutex_unlock(&scheduler->queue_mutex);
+	}
 
-	return true;
+	return NULL;
 }
 
 static void *task_scheduler_thread_run(void *thread_p)
@@ -188,18 +327,20 @@ static void *task_scheduler_thread_run(void *thread_p)
 	int thread_id = thread->id;
 	Task *task;
 
+	pthread_setspecific(scheduler->thread_key, thread);
+
 	/* keep popping off tasks */
-	while (task_scheduler_thread_wait_pop(scheduler, &task)) {
+	while ((task = task_scheduler_thread_wait_pop(scheduler, thread))) {
 		TaskPool *pool = task->pool;
 
 		/* run task */
 		task->run(pool, task->taskdata, thread_id);
 
 		/* delete task */
-		task_data_free(task, thread_id);
-		MEM_freeN(task);
+		task_free(thread, task, thread_id);
 
 		/* notify pool task was done */
+		atomic_sub_z(&pool->currently_running_tasks, 1);
 		task_pool_num_decrease(pool, 1);
 	}
 
@@ -218,6 +359,8 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 	BLI_mutex_init(&scheduler->queue_mutex);
 	BLI_condition_init(&scheduler->queue_cond);
 
+	pthread_key_create(&scheduler->thread_key, NULL);
+
 	if (num_threads == 0) {
 		/* automatic number of threads will be main thread + num cores */
 		num_threads = BLI_system_thread_count();
@@ -244,8 +387,11 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 			TaskThread *thread = &scheduler->task_threads[i];
 			thread->scheduler = scheduler;
 			thread->id = i + 1;
+			BLI_spin_init(&thread->queue_lock);
+		}
 
-			if (pthread_create(&scheduler->threads[i], NULL, task_scheduler_thread_run, thread) != 0) {
+		for (i = 0; i < num_threads; i++) {
+			if (pthread_create(&scheduler->threads[i], NULL, task_scheduler_thread_run, &scheduler->task_threads[i]) != 0) {
 				fprintf(stderr, "TaskScheduler failed to launch thread %d/%d\n", i, num_threads);
 			}
 		}
@@ -278,6 +424,23 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
 
 	/* Delete task thread data */
 	if (scheduler->task_threads) {
+		int i;
+
+		for (i = 0; i < scheduler->num_threads; i++) {
+			TaskThread *thread = &scheduler->task_threads[i];
+
+			for (task = thread->queue.first; task; task = task->next) {
+				task_data_free(task, 0);
+			}
+			BLI_freelistN(&thread->queue);
+
+			while (thread->num_task_cache) {
+				MEM_freeN(thread->task_cache[--thread->num_task_cache]);
+			}
+
+			BLI_spin_end(&thread->queue_lock);
+		}
+
 		MEM_freeN(scheduler->task_threads);
 	}
 
@@ -291,6 +454,8 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
 	BLI_mutex_end(&scheduler->queue_mutex);
 	BLI_condition_end(&scheduler->queue_cond);
 
+	pthread_key_delete(scheduler->thread_key);
+
 	MEM_freeN(scheduler);
 }
 
@@ -299,43 +464,85 @@ int BLI_task_scheduler_num_threads(TaskScheduler *scheduler)
 	return scheduler->num_threads + 1;
 }
 
-static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
+static void task_scheduler_push(TaskScheduler *scheduler, TaskThread *thread, Task *task, TaskPriority priority)
 {
-	task_pool_num_increase(task->pool);
+	/* Once queued the task can be run and freed by another thread at any time. Besides the reference
+	 * of the task, keep one on the pool until its waiters are notified, so that it can't be freed. */
+	TaskPool *pool = task->pool;
+	task_pool_num_increase(pool, 2);
 
-	/* add task to queue */
-	BLI_mutex_lock(&scheduler->queue_mutex);
+	/* add task to queue, worker threads use their own queue and never touch the scheduler lock */
+	if (thread) {
+		BLI_spin_lock(&thread->queue_lock);
 
-	if (priority == TASK_PRIORITY_HIGH)
-		BLI_addhead(&scheduler->queue, task);
-	else
-		BLI_addtail(&scheduler->queue, task);
+		if (priority == TASK_PRIORITY_HIGH)
+			BLI_addhead(&thread->queue, task);
+		else
+			BLI_addtail(&thread->queue, task);
 
-	BLI_condition_notify_one(&scheduler->queue_cond);
-	BLI_mutex_unlock(&scheduler->queue_mutex);
+		BLI_spin_unlock(&thread->queue_lock);
+	}
+	else {
+		BLI_mutex_lock(&scheduler->queue_mutex);
+
+		if (priority == TASK_PRIORITY_HIGH)
+			BLI_addhead(&scheduler->queue, task);
+		else
+			BLI_addtail(&scheduler->queue, task);
+
+		BLI_mutex_unlock(&scheduler->queue_mutex);
+	}
+
+	/* wake up a sleeping worker thread, if any */
+	atomic_add_z(&scheduler->push_epoch, 1);
+
+	if (atomic_load_z(&scheduler->num_sleeping)) {
+		BLI_mutex_lock(&scheduler->queue_mutex);
+		BLI_condition_notify_one(&scheduler->queue_cond);
+		BLI_mutex_unlock(&scheduler->queue_mutex);
+	}
+
+	task_pool_notify_push(pool);
+	task_pool_num_release(pool, 1);
 }
 
-static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
+static size_t task_queue_clear(ListBase *queue, TaskPool *pool)
 {
 	Task *task, *nexttask;
 	size_t done = 0;
 
-	BLI_mutex_lock(&scheduler->queue_mutex);
-
-	/* free all tasks from this pool from the queue */
-	for (task = scheduler->queue.first; task; task = nexttask) {
+	for (task = queue->first; task; task = nexttask) {
 		nexttask = task->next;
 
 		if (task->pool == pool) {
 			task_data_free(task, 0);
-			BLI_freelinkN(&scheduler->queue, task);
+			BLI_freelinkN(queue, task);
 
 			done++;
 		}
 	}
 
+	return done;
+}
+
+static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
+{
+	size_t done = 0;
+	int i;
+
+	/* free all tasks from this pool from the queues */
+	BLI_mutex_lock(&scheduler->queue_mutex);
+	done += task_queue_clear(&scheduler->queue, pool);
 	BLI_mutex_unlock(&scheduler->queue_mutex);
 
+	for (i = 0; i < scheduler->num_threads; i++) {
+		TaskThread *thread = &scheduler->task_threads[i];
+
+		BLI_spin_lock(&thread->queue_lock);
+		done += task_queue_clear(&thread->queue, pool);
+		BLI_spin_unlock(&thread->queue_lock);
+	}
+
 	/* notify done */
 	task_pool_num_decrease(pool, done);
 }
@@ -363,6 +570,8 @@ static TaskPool *task_pool_create_ex(TaskScheduler *scheduler, void *userdata, c
 	pool->done = 0;
 	pool->num_threads = 0;
 	pool->currently_running_tasks = 0;
+	pool->push_epoch = 0;
+	pool->num_waiters = 0;
 	pool->do_cancel = false;
 	pool->run_in_background = is_background;
 
@@ -422,11 +631,16 @@ void BLI_task_pool_free(TaskPool *pool)
 	BLI_end_threaded_malloc();
 }
 
+/**
+ * \note Pushing from a task running in one of the scheduler's threads goes to a queue owned by that
+ * thread, which is lock-free for the pushing thread as long as no other thread is stealing from it.
+ */
 void BLI_task_pool_push_ex(
         TaskPool *pool, TaskRunFunction run, void *taskdata,
         bool free_taskdata, TaskFreeFunction freedata, TaskPriority priority)
 {
-	Task *task = MEM_mallocN(sizeof(Task), "Task");
+	TaskThread *thread = task_scheduler_current_thread(pool->scheduler);
+	Task *task = task_alloc(thread);
 
 	task->run = run;
 	task->taskdata = taskdata;
@@ -434,7 +648,7 @@ void BLI_task_pool_push_ex(
 	task->freedata = freedata;
 	task->pool = pool;
 
-	task_scheduler_push(pool->scheduler, task, priority);
+	task_scheduler_push(pool->scheduler, thread, task, priority);
 }
 
 void BLI_task_pool_push(
@@ -446,58 +660,46 @@ void BLI_task_pool_push(
 void BLI_task_pool_work_and_wait(TaskPool *pool)
 {
 	TaskScheduler *scheduler = pool->scheduler;
+	TaskThread *thread = task_scheduler_current_thread(scheduler);
+	const int thread_id = thread ? thread->id : 0;
 
-	BLI_mutex_lock(&pool->num_mutex);
+	while (true) {
+		const size_t push_epoch = atomic_load_z(&pool->push_epoch);
 
-	while (pool->num != 0) {
-		Task *task, *work_task = NULL;
-		bool found_task = false;
-
-		BLI_mutex_unlock(&pool->num_mutex);
-
-		BLI_mutex_lock(&scheduler->queue_mutex);
-
-		/* find task from this pool. if we get a task from another pool,
-		 * we can get into deadlock */
-
-		if (pool->num_threads == 0 ||
-		    pool->currently_running_tasks < pool->num_threads)
-		{
-			for (task = scheduler->queue.first; task; task = task->next) {
-				if (task->pool == pool) {
-					work_task = task;
-					found_task = true;
-					BLI_remlink(&scheduler->queue, task);
-					break;
-				}
-			}
-		}
-
-		BLI_mutex_unlock(&scheduler->queue_mutex);
+		/* find task from this pool, in any queue */
+		Task *task = task_scheduler_pop(scheduler, thread, pool);
 
 		/* if found task, do it, otherwise wait until other tasks are done */
-		if (found_task) {
+		if (task) {
 			/* run task */
-			atomic_add_z(&pool->currently_running_tasks, 1);
-			work_task->run(pool, work_task->taskdata, 0);
+			task->run(pool, task->taskdata, thread_id);
 
 			/* delete task */
-			task_data_free(task, 0);
-			MEM_freeN(work_task);
+			task_free(thread, task, thread_id);
 
 			/* notify pool task was done */
+			atomic_sub_z(&pool->currently_running_tasks, 1);
 			task_pool_num_decrease(pool, 1);
+			continue;
 		}
 
 		BLI_mutex_lock(&pool->num_mutex);
-		if (pool->num == 0)
+
+		if (atomic_load_z(&pool->num) == 0) {
+			BLI_mutex_unlock(&pool->num_mutex);
 			break;
+		}
+
+		atomic_add_z(&pool->num_waiters, 1);
 
-		if (!found_task)
+		if (atomic_load_z(&pool->push_epoch) == push_epoch) {
 			BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
-	}
+		}
 
-	BLI_mutex_unlock(&pool->num_mutex);
+		atomic_sub_z(&pool->num_waiters, 1);
+
+		BLI_mutex_unlock(&pool->num_mutex);
+	}
 }
 
 int BLI_pool_get_num_threads(TaskPool *pool)
@@ -524,7 +726,7 @@ void BLI_task_pool_cancel(TaskPool *pool)
 
 	/* wait until all entries are cleared */
 	BLI_mutex_lock(&pool->num_mutex);
-	while (pool->num)
+	while (atomic_load_z(&pool->num))
 		BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
 	BLI_mutex_unlock(&pool->num_mutex);
 
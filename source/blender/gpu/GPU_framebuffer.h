@@ -65,6 +65,7 @@ void GPU_framebuffer_restore(void);
 void GPU_framebuffer_blur(
         GPUFrameBuffer *fb, struct GPUTexture *tex,
         GPUFrameBuffer *blurfb, struct GPUTexture *blurtex);
+void GPU_framebuffer_blit_depth(GPUFrameBuffer *fb_read, GPUFrameBuffer *fb_write, int width, int height);
 
 /* GPU OffScreen
  * - wrapper around framebuffer and texture for simple offscreen drawing
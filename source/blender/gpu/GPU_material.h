@@ -339,8 +339,12 @@ void GPU_lamp_free(struct Object *ob);
 
 bool GPU_lamp_has_shadow_buffer(GPULamp *lamp);
 void GPU_lamp_update_buffer_mats(GPULamp *lamp);
+void GPU_lamp_shadow_buffer_mats(GPULamp *lamp, float viewmat[4][4], float winmat[4][4]);
 void GPU_lamp_shadow_buffer_bind(GPULamp *lamp, float viewmat[4][4], int *winsize, float winmat[4][4]);
 void GPU_lamp_shadow_buffer_unbind(GPULamp *lamp);
+bool GPU_lamp_shadow_cache_create(GPULamp *lamp);
+void GPU_lamp_shadow_cache_store(GPULamp *lamp);
+void GPU_lamp_shadow_cache_restore(GPULamp *lamp);
 int GPU_lamp_shadow_buffer_type(GPULamp *lamp);
 int GPU_lamp_shadow_bind_code(GPULamp *lamp);
 float *GPU_lamp_dynpersmat(GPULamp *lamp);
@@ -372,6 +372,17 @@ void GPU_framebuffer_restore(void)
 	}
 }
 
+/* copy the depth of fb_read into fb_write, the current framebuffer stays bound */
+void GPU_framebuffer_blit_depth(GPUFrameBuffer *fb_read, GPUFrameBuffer *fb_write, int width, int height)
+{
+	glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, fb_read->object);
+	glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, fb_write->object);
+
+	glBlitFramebufferEXT(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, GG.currentfb);
+}
+
 void GPU_framebuffer_blur(
         GPUFrameBuffer *fb, GPUTexture *tex,
         GPUFrameBuffer *blurfb, GPUTexture *blurtex)
@@ -176,6 +176,10 @@ struct GPULamp {
 	GPUTexture *depthtex;
 	GPUTexture *blurtex;
 
+	/* copy of the shadow buffer depth, see GPU_lamp_shadow_cache_store */
+	GPUFrameBuffer *cachefb;
+	GPUTexture *cachetex;
+
 	ListBase materials;
 };
 
@@ -2494,8 +2498,22 @@ static void gpu_lamp_from_blender(Scene *scene, Object *ob, Object *par, Lamp *l
 	lamp->bias *= 0.25f;
 }
 
+static void gpu_lamp_shadow_cache_free(GPULamp *lamp)
+{
+	if (lamp->cachetex) {
+		GPU_texture_free(lamp->cachetex);
+		lamp->cachetex = NULL;
+	}
+	if (lamp->cachefb) {
+		GPU_framebuffer_free(lamp->cachefb);
+		lamp->cachefb = NULL;
+	}
+}
+
 static void gpu_lamp_shadow_free(GPULamp *lamp)
 {
+	gpu_lamp_shadow_cache_free(lamp);
+
 	if (lamp->tex) {
 		GPU_texture_free(lamp->tex);
 		lamp->tex = NULL;
@@ -2702,6 +2720,14 @@ void GPU_lamp_update_buffer_mats(GPULamp *lamp)
 	mul_m4_m4m4(lamp->persmat, rangemat, persmat);
 }
 
+void GPU_lamp_shadow_buffer_mats(GPULamp *lamp, float viewmat[4][4], float winmat[4][4])
+{
+	GPU_lamp_update_buffer_mats(lamp);
+
+	copy_m4_m4(viewmat, lamp->viewmat);
+	copy_m4_m4(winmat, lamp->winmat);
+}
+
 void GPU_lamp_shadow_buffer_bind(GPULamp *lamp, float viewmat[4][4], int *winsize, float winmat[4][4])
 {
 	GPU_lamp_update_buffer_mats(lamp);
@@ -2728,6 +2754,46 @@ void GPU_lamp_shadow_buffer_unbind(GPULamp *lamp)
 	glEnable(GL_SCISSOR_TEST);
 }
 
+bool GPU_lamp_shadow_cache_create(GPULamp *lamp)
+{
+	if (lamp->cachefb)
+		return true;
+
+	/* variance shadow maps are blurred after drawing, the depth alone can't be restored */
+	if (!lamp->tex || !lamp->fb || lamp->la->shadowmap_type == LA_SHADMAP_VARIANCE)
+		return false;
+
+	lamp->cachetex = GPU_texture_create_depth(lamp->size, lamp->size, NULL);
+	if (!lamp->cachetex)
+		return false;
+
+	lamp->cachefb = GPU_framebuffer_create();
+	if (!lamp->cachefb) {
+		gpu_lamp_shadow_cache_free(lamp);
+		return false;
+	}
+
+	if (!GPU_framebuffer_texture_attach(lamp->cachefb, lamp->cachetex, 0, NULL) ||
+	    !GPU_framebuffer_check_valid(lamp->cachefb, NULL))
+	{
+		gpu_lamp_shadow_cache_free(lamp);
+		return false;
+	}
+
+	GPU_framebuffer_restore();
+	return true;
+}
+
+void GPU_lamp_shadow_cache_store(GPULamp *lamp)
+{
+	GPU_framebuffer_blit_depth(lamp->fb, lamp->cachefb, lamp->size, lamp->size);
+}
+
+void GPU_lamp_shadow_cache_restore(GPULamp *lamp)
+{
+	GPU_framebuffer_blit_depth(lamp->cachefb, lamp->fb, lamp->size, lamp->size);
+}
+
 int GPU_lamp_shadow_buffer_type(GPULamp *lamp)
 {
 	return lamp->la->shadowmap_type;
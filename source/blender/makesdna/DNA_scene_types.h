@@ -902,6 +902,8 @@ typedef struct GameData {
 #define GAME_SHOW_OBSTACLE_SIMULATION		(1 << 16)
 #define GAME_SHOW_BOUNDING_BOX				(1 << 18)
 #define GAME_SHOW_ARMATURES					(1 << 19)
+#define GAME_USE_PARALLEL_SCENES			(1 << 20)
+#define GAME_USE_PARALLEL_PHYSICS			(1 << 21)
 /* Note: GameData.flag is now an int (max 32 flags). A short could only take 16 flags */
 
 /* GameData.playerflag */
@@ -4269,6 +4269,12 @@ static void rna_def_scene_game_data(BlenderRNA *brna)
 	                         "Use optimized Bullet DBVT tree for view frustum and occlusion culling (more efficient, "
 	                         "but it can waste unnecessary CPU if the scene doesn't have occluder objects)");
 	
+	prop = RNA_def_property(srna, "use_parallel_physics", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_USE_PARALLEL_PHYSICS);
+	RNA_def_property_ui_text(prop, "Multithreaded Physics",
+	                         "Compute the collisions and solve the independent groups of objects on several threads "
+	                         "(results don't depend on the amount of threads)");
+
 	/* not used  *//* deprecated !!!!!!!!!!!!! */
 	prop = RNA_def_property(srna, "use_activity_culling", PROP_BOOLEAN, PROP_NONE);
 	RNA_def_property_boolean_sdna(prop, NULL, "mode", WO_ACTIVITY_CULLING);
@@ -4328,6 +4334,12 @@ static void rna_def_scene_game_data(BlenderRNA *brna)
 	                         "Restrict the number of animation updates to the animation FPS (this is "
 	                         "better for performance, but can cause issues with smooth playback)");
 
+	prop = RNA_def_property(srna, "use_parallel_scenes", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_USE_PARALLEL_SCENES);
+	RNA_def_property_ui_text(prop, "Parallel Scenes",
+	                         "Update the logic and physics of the scenes without Python logic concurrently "
+	                         "(scenes using Python are still updated one after another)");
+
 	prop = RNA_def_property(srna, "show_bounding_box", PROP_BOOLEAN, PROP_NONE);
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_SHOW_BOUNDING_BOX);
 	RNA_def_property_ui_text(prop, "Show Bounding Box", "Show a visualization of bounding volume box");
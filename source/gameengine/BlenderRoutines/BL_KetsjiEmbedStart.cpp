@@ -53,6 +53,10 @@
 #include "KX_PythonMain.h"
 #include "KX_Globals.h"
 
+#ifdef WITH_BULLET
+#include "CcdBvhCache.h"
+#endif
+
 #include "RAS_OpenGLRasterizer.h"
 
 #include "BL_System.h"
@@ -268,8 +272,13 @@ extern "C" void StartKetsjiShell(struct bContext *C, struct ARegion *ar, rcti *c
 		bool nodepwarnings = (SYS_GetCommandLineInt(syshandle, "ignore_deprecation_warnings", 0) != 0);
 #endif
 		// bool novertexarrays = (SYS_GetCommandLineInt(syshandle, "novertexarrays", 0) != 0);
+#ifdef WITH_BULLET
+		// The triangle mesh trees are loaded from and saved in this directory when set.
+		CcdBvhCache::SetDirectory(SYS_GetCommandLineString(syshandle, "conversion_cache", ""));
+#endif
 		bool mouse_state = (startscene->gm.flag & GAME_SHOW_MOUSE) != 0;
 		bool restrictAnimFPS = (startscene->gm.flag & GAME_RESTRICT_ANIM_UPDATES) != 0;
+		bool parallelScenes = (startscene->gm.flag & GAME_USE_PARALLEL_SCENES) != 0;
 
 		RAS_IRasterizer::DrawType drawmode = RAS_IRasterizer::RAS_TEXTURED;
 		switch(v3d->drawtype) {
@@ -349,6 +358,7 @@ extern "C" void StartKetsjiShell(struct bContext *C, struct ARegion *ar, rcti *c
 		ketsjiengine->SetUseFixedTime(usefixed);
 		ketsjiengine->SetTimingDisplay(frameRate, profile, properties);
 		ketsjiengine->SetRestrictAnimationFPS(restrictAnimFPS);
+		ketsjiengine->SetUseParallelScenes(parallelScenes);
 		ketsjiengine->SetShowBoundingBox(showBoundingBox);
 		ketsjiengine->SetShowArmatures(showArmatures);
 		KX_KetsjiEngine::SetExitKey(ConvertKeyCode(startscene->gm.exitkey));
@@ -0,0 +1,292 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Converter/BL_ActionCurves.cpp
+ *  \ingroup bgeconv
+ */
+
+#include "BL_ActionCurves.h"
+
+#include <cstring>
+#include <stddef.h>
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_listbase.h"
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+#include "DNA_key_types.h"
+#include "BKE_action.h"
+#include "BKE_fcurve.h"
+}
+
+static const struct {
+	const char *name;
+	BL_ActionCurveList::Property property;
+	int length;
+} pose_channel_properties[] = {
+	{"location", BL_ActionCurveList::PROP_LOCATION, 3},
+	{"scale", BL_ActionCurveList::PROP_SCALE, 3},
+	{"rotation_euler", BL_ActionCurveList::PROP_ROTATION_EULER, 3},
+	{"rotation_quaternion", BL_ActionCurveList::PROP_ROTATION_QUATERNION, 4},
+	{"rotation_axis_angle", BL_ActionCurveList::PROP_ROTATION_AXIS_ANGLE, 4},
+	{NULL, BL_ActionCurveList::PROP_NONE, 0}
+};
+
+/** Read the name of path["name"].property after prefix, return the property
+ * or NULL if the path doesn't match. Escaped names aren't supported.
+ */
+static const char *parse_collection_path(const char *path, const char *prefix, STR_String& name)
+{
+	const size_t prefixlen = strlen(prefix);
+	if (strncmp(path, prefix, prefixlen) != 0) {
+		return NULL;
+	}
+
+	const char *start = path + prefixlen;
+	const char *end = strchr(start, '"');
+	if (!end || memchr(start, '\\', end - start) || strncmp(end, "\"].", 3) != 0) {
+		return NULL;
+	}
+
+	name = STR_String(start, end - start);
+	return end + 3;
+}
+
+static bool is_identifier(const char *path)
+{
+	if (!path[0]) {
+		return false;
+	}
+	for (const char *c = path; *c; ++c) {
+		if (!((*c >= 'a' && *c <= 'z') || (*c >= '0' && *c <= '9') || *c == '_')) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void parse_curve_target(FCurve *fcu, BL_ActionCurveList::Curve& curve)
+{
+	curve.m_type = BL_ActionCurveList::TARGET_UNSUPPORTED;
+	curve.m_property = BL_ActionCurveList::PROP_NONE;
+
+	const char *property;
+	if ((property = parse_collection_path(fcu->rna_path, "pose.bones[\"", curve.m_name))) {
+		for (unsigned int i = 0; pose_channel_properties[i].name; ++i) {
+			if (STREQ(property, pose_channel_properties[i].name)) {
+				// An invalid array index is ignored by RNA as well.
+				if (curve.m_arrayIndex >= 0 && curve.m_arrayIndex < pose_channel_properties[i].length) {
+					curve.m_type = BL_ActionCurveList::TARGET_POSE_CHANNEL;
+					curve.m_property = pose_channel_properties[i].property;
+				}
+				break;
+			}
+		}
+	}
+	else if ((property = parse_collection_path(fcu->rna_path, "key_blocks[\"", curve.m_name))) {
+		if (STREQ(property, "value")) {
+			curve.m_type = BL_ActionCurveList::TARGET_KEY_BLOCK;
+			curve.m_property = BL_ActionCurveList::PROP_VALUE;
+		}
+	}
+	else if (is_identifier(fcu->rna_path)) {
+		curve.m_type = BL_ActionCurveList::TARGET_ID;
+	}
+}
+
+BL_ActionCurveList::BL_ActionCurveList(bAction *action)
+	:m_hasDriver(false)
+{
+	unsigned int index = 0;
+	for (FCurve *fcu = (FCurve *)action->curves.first; fcu; fcu = fcu->next, ++index) {
+		// Same curves as animsys_evaluate_fcurves.
+		if ((fcu->grp && (fcu->grp->flag & AGRP_MUTED)) || (fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) ||
+			!fcu->rna_path)
+		{
+			continue;
+		}
+
+		if (fcu->driver) {
+			m_hasDriver = true;
+		}
+
+		Curve curve;
+		curve.m_index = index;
+		curve.m_arrayIndex = fcu->array_index;
+		// Same condition as calculate_fcurve.
+		curve.m_evaluate = (fcu->totvert || list_has_suitable_fmodifier(&fcu->modifiers, 0, FMI_TYPE_GENERATE_CURVE));
+		parse_curve_target(fcu, curve);
+
+		m_curves.push_back(curve);
+	}
+}
+
+BL_ActionCurveList::~BL_ActionCurveList()
+{
+}
+
+const std::vector<BL_ActionCurveList::Curve>& BL_ActionCurveList::GetCurves() const
+{
+	return m_curves;
+}
+
+bool BL_ActionCurveList::HasDriver() const
+{
+	return m_hasDriver;
+}
+
+BL_ActionCurveBinding::BL_ActionCurveBinding()
+	:m_target(NULL),
+	m_valid(false)
+{
+}
+
+BL_ActionCurveBinding::~BL_ActionCurveBinding()
+{
+}
+
+void BL_ActionCurveBinding::Clear()
+{
+	m_slots.clear();
+	m_target = NULL;
+	m_valid = false;
+}
+
+static float *pose_channel_target(bPoseChannel *pchan, BL_ActionCurveList::Property property, int index)
+{
+	switch (property) {
+		case BL_ActionCurveList::PROP_LOCATION:
+			return &pchan->loc[index];
+		case BL_ActionCurveList::PROP_SCALE:
+			return &pchan->size[index];
+		case BL_ActionCurveList::PROP_ROTATION_EULER:
+			return &pchan->eul[index];
+		case BL_ActionCurveList::PROP_ROTATION_QUATERNION:
+			return &pchan->quat[index];
+		case BL_ActionCurveList::PROP_ROTATION_AXIS_ANGLE:
+			// Same layout as rna_PoseChannel_rotation_axis_angle_set.
+			return (index == 0) ? &pchan->rotAngle : &pchan->rotAxis[index - 1];
+		default:
+			return NULL;
+	}
+}
+
+bool BL_ActionCurveBinding::Bind(const BL_ActionCurveList *curves, bAction *action, void *target,
+                                 BL_ActionCurveList::TargetType type)
+{
+	Clear();
+	m_target = target;
+
+	if (curves->HasDriver()) {
+		return false;
+	}
+
+	const std::vector<BL_ActionCurveList::Curve>& curvelist = curves->GetCurves();
+	FCurve *fcu = (FCurve *)action->curves.first;
+	unsigned int index = 0;
+
+	for (std::vector<BL_ActionCurveList::Curve>::const_iterator it = curvelist.begin(), end = curvelist.end();
+		 it != end; ++it)
+	{
+		const BL_ActionCurveList::Curve& curve = *it;
+		for (; fcu && index < curve.m_index; fcu = fcu->next, ++index) {
+		}
+		// The action isn't a copy of the action of the curves.
+		if (!fcu) {
+			return false;
+		}
+
+		if (curve.m_type == BL_ActionCurveList::TARGET_UNSUPPORTED) {
+			return false;
+		}
+
+		Slot slot = {fcu, NULL, NULL, curve.m_evaluate};
+
+		if (type == BL_ActionCurveList::TARGET_POSE_CHANNEL) {
+			// The object properties of the armature copy aren't used, they are applied by the IPO controllers.
+			if (curve.m_type != BL_ActionCurveList::TARGET_POSE_CHANNEL) {
+				continue;
+			}
+			bPoseChannel *pchan = BKE_pose_channel_find_name((bPose *)target, curve.m_name.ReadPtr());
+			// Not found by RNA either, nothing is written.
+			if (!pchan) {
+				continue;
+			}
+			slot.m_target = pose_channel_target(pchan, curve.m_property, curve.m_arrayIndex);
+		}
+		else {
+			// The paths to the pose channels don't exist in a key.
+			if (curve.m_type == BL_ActionCurveList::TARGET_POSE_CHANNEL) {
+				continue;
+			}
+			// A property of the key, e.g. its evaluation time.
+			if (curve.m_type != BL_ActionCurveList::TARGET_KEY_BLOCK) {
+				return false;
+			}
+			KeyBlock *kb = (KeyBlock *)BLI_findstring(&((Key *)target)->block, curve.m_name.ReadPtr(),
+			                                          offsetof(KeyBlock, name));
+			if (!kb) {
+				continue;
+			}
+			slot.m_target = &kb->curval;
+			slot.m_keyBlock = kb;
+		}
+
+		m_slots.push_back(slot);
+	}
+
+	m_valid = true;
+	return true;
+}
+
+bool BL_ActionCurveBinding::BindPose(const BL_ActionCurveList *curves, bAction *action, bPose *pose)
+{
+	return Bind(curves, action, pose, BL_ActionCurveList::TARGET_POSE_CHANNEL);
+}
+
+bool BL_ActionCurveBinding::BindKey(const BL_ActionCurveList *curves, bAction *action, Key *key)
+{
+	return Bind(curves, action, key, BL_ActionCurveList::TARGET_KEY_BLOCK);
+}
+
+void *BL_ActionCurveBinding::GetTarget() const
+{
+	return m_target;
+}
+
+bool BL_ActionCurveBinding::IsValid() const
+{
+	return m_valid;
+}
+
+void BL_ActionCurveBinding::Evaluate(float frame) const
+{
+	for (std::vector<Slot>::const_iterator it = m_slots.begin(), end = m_slots.end(); it != end; ++it) {
+		const Slot& slot = *it;
+		// The F-curves aren't written, unlike calculate_fcurve, their value is constant if not evaluated.
+		float value = slot.m_evaluate ? evaluate_fcurve(slot.m_fcurve, frame) : slot.m_fcurve->curval;
+		if (slot.m_keyBlock) {
+			// Same as rna_ShapeKey_value_set.
+			CLAMP(value, slot.m_keyBlock->slidermin, slot.m_keyBlock->slidermax);
+		}
+		*slot.m_target = value;
+	}
+}
@@ -0,0 +1,150 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_ActionCurves.h
+ *  \ingroup bgeconv
+ */
+
+#ifndef __BL_ACTIONCURVES_H__
+#define __BL_ACTIONCURVES_H__
+
+#include "STR_String.h"
+
+#include <vector>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+struct bAction;
+struct bPose;
+struct Key;
+struct KeyBlock;
+struct FCurve;
+
+/** Targets of the F-curves of an action, parsed once from their RNA paths and shared
+ * by all the objects playing the action. Only the pose channels transforms and the key
+ * blocks values are supported, see BL_ActionCurveBinding.
+ */
+class BL_ActionCurveList
+{
+public:
+	enum TargetType {
+		/// A pose channel transform, pose.bones["name"].property.
+		TARGET_POSE_CHANNEL,
+		/// A key block value, key_blocks["name"].value.
+		TARGET_KEY_BLOCK,
+		/// A property of the ID itself, e.g. the object location applied by the IPO controllers.
+		TARGET_ID,
+		/// Any other path, only evaluated through RNA.
+		TARGET_UNSUPPORTED
+	};
+
+	enum Property {
+		PROP_LOCATION,
+		PROP_SCALE,
+		PROP_ROTATION_EULER,
+		PROP_ROTATION_QUATERNION,
+		PROP_ROTATION_AXIS_ANGLE,
+		PROP_VALUE,
+		PROP_NONE
+	};
+
+	struct Curve
+	{
+		/// Index of the F-curve in the curves of the action.
+		unsigned int m_index;
+		TargetType m_type;
+		Property m_property;
+		int m_arrayIndex;
+		/// Name of the pose channel or the key block.
+		STR_String m_name;
+		/// False when the F-curve has no key and no generator, its value is constant.
+		bool m_evaluate;
+	};
+
+private:
+	/// The enabled F-curves, in the order of the action.
+	std::vector<Curve> m_curves;
+	/// True when a F-curve is driven, it must be evaluated through RNA.
+	bool m_hasDriver;
+
+public:
+	BL_ActionCurveList(bAction *action);
+	~BL_ActionCurveList();
+
+	const std::vector<Curve>& GetCurves() const;
+	bool HasDriver() const;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:BL_ActionCurveList")
+#endif
+};
+
+/** F-curves of an action copy bound to the pose channels or key blocks of one object.
+ * The evaluation writes the same values as animsys_evaluate_action without any RNA
+ * path resolution and without writing in the F-curves.
+ */
+class BL_ActionCurveBinding
+{
+private:
+	struct Slot
+	{
+		FCurve *m_fcurve;
+		float *m_target;
+		/// Key block clamping the value to its slider range, NULL for the pose channels.
+		KeyBlock *m_keyBlock;
+		bool m_evaluate;
+	};
+
+	std::vector<Slot> m_slots;
+	/// Pose or key the F-curves are bound to.
+	void *m_target;
+	bool m_valid;
+
+	bool Bind(const BL_ActionCurveList *curves, bAction *action, void *target, BL_ActionCurveList::TargetType type);
+
+public:
+	BL_ActionCurveBinding();
+	~BL_ActionCurveBinding();
+
+	/// Unbind the F-curves, called when the action changes.
+	void Clear();
+
+	/** Bind the F-curves of action, a copy of the action of curves, to the channels
+	 * of pose or to the key blocks of key. Return false if an F-curve can't be bound,
+	 * the action must be evaluated through RNA.
+	 */
+	bool BindPose(const BL_ActionCurveList *curves, bAction *action, bPose *pose);
+	bool BindKey(const BL_ActionCurveList *curves, bAction *action, Key *key);
+
+	/// Return the pose or key the F-curves are bound to.
+	void *GetTarget() const;
+	bool IsValid() const;
+
+	/// Write the values of the F-curves at frame in their targets.
+	void Evaluate(float frame) const;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:BL_ActionCurveBinding")
+#endif
+};
+
+#endif  /* __BL_ACTIONCURVES_H__ */
@@ -65,6 +65,10 @@ extern "C" {
 
 #include "MT_Matrix4x4.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /** 
  * Move here pose function for game engine so that we can mix with GE objects
  * Principle is as follow:
@@ -154,7 +158,6 @@ static void game_blend_poses(bPose *dst, bPose *src, float srcweight, short mode
 	const bPoseChannel *schan;
 	bConstraint *dcon, *scon;
 	float dstweight;
-	int i;
 
 	if (mode == BL_Action::ACT_BLEND_BLEND)
 	{
@@ -189,7 +192,36 @@ static void game_blend_poses(bPose *dst, bPose *src, float srcweight, short mode
 			normalize_qt(dchan->quat);
 		}
 
-		for (i=0; i<3; i++) {
+#ifdef __SSE2__
+		/* loc, size and eul are contiguous in bPoseChannel, blend them as 9 floats:
+		 * offset + (dst - offset) * dstweight + (src - offset) * srcweight,
+		 * with an offset of 1 for the scale, same results as the scalar code. */
+		const __m128 dw = _mm_set1_ps(dstweight);
+		const __m128 sw = _mm_set1_ps(srcweight);
+		const __m128 offset0 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f); // loc[0..2], size[0]
+		const __m128 offset1 = _mm_set_ps(0.0f, 0.0f, 1.0f, 1.0f); // size[1..2], eul[0..1]
+		float *dblock = dchan->loc;
+		const float *sblock = schan->loc;
+
+		__m128 d = _mm_loadu_ps(dblock);
+		__m128 r = _mm_add_ps(_mm_add_ps(offset0, _mm_mul_ps(_mm_sub_ps(d, offset0), dw)),
+		                      _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(sblock), offset0), sw));
+		_mm_storeu_ps(dblock, r);
+
+		d = _mm_loadu_ps(dblock + 4);
+		r = _mm_add_ps(_mm_add_ps(offset1, _mm_mul_ps(_mm_sub_ps(d, offset1), dw)),
+		               _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(sblock + 4), offset1), sw));
+		if (!schan->rotmode) {
+			// Keep the euler rotation.
+			const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1));
+			r = _mm_or_ps(_mm_and_ps(mask, r), _mm_andnot_ps(mask, d));
+		}
+		_mm_storeu_ps(dblock + 4, r);
+
+		if (schan->rotmode)
+			dchan->eul[2] = (dchan->eul[2]*dstweight) + (schan->eul[2]*srcweight);
+#else
+		for (int i=0; i<3; i++) {
 			/* blending for loc and scale are pretty self-explanatory... */
 			dchan->loc[i] = (dchan->loc[i]*dstweight) + (schan->loc[i]*srcweight);
 			dchan->size[i] = 1.0f + ((dchan->size[i]-1.0f)*dstweight) + ((schan->size[i]-1.0f)*srcweight);
@@ -199,6 +231,7 @@ static void game_blend_poses(bPose *dst, bPose *src, float srcweight, short mode
 			if (schan->rotmode)
 				dchan->eul[i] = (dchan->eul[i]*dstweight) + (schan->eul[i]*srcweight);
 		}
+#endif
 		for (dcon= (bConstraint *)dchan->constraints.first, scon= (bConstraint *)schan->constraints.first;
 		     dcon && scon;
 		     dcon = dcon->next, scon = scon->next)
@@ -222,6 +255,7 @@ BL_ArmatureObject::BL_ArmatureObject(
 :	KX_GameObject(sgReplicationInfo,callbacks),
 	m_controlledConstraints(),
 	m_poseChannels(),
+	m_armpose(NULL),
 	m_scene(scene), // maybe remove later. needed for BKE_pose_where_is
 	m_lastframe(0.0),
 	m_timestep(0.040),
@@ -229,8 +263,11 @@ BL_ArmatureObject::BL_ArmatureObject(
 	m_constraintNumber(0),
 	m_channelNumber(0),
 	m_drawDebug(false),
-	m_lastapplyframe(0.0)
+	m_lastapplyframe(0.0),
+	m_poseApplyCount(0)
 {
+	BLI_mutex_init(&m_poseMutex);
+
 	m_origObjArma = armature; // Keep a copy of the original armature so we can fix drivers later
 	m_objArma = BKE_object_copy(armature);
 	m_objArma->data = BKE_armature_copy((bArmature *)armature->data);
@@ -263,6 +300,8 @@ BL_ArmatureObject::~BL_ArmatureObject()
 		m_objArma->data = NULL;
 		BKE_libblock_free(G.main, m_objArma);
 	}
+
+	BLI_mutex_end(&m_poseMutex);
 }
 
 
@@ -438,6 +477,9 @@ void BL_ArmatureObject::ProcessReplica()
 	m_objArma = BKE_object_copy(m_objArma);
 	m_objArma->data = BKE_armature_copy(tmp);
 	m_pose = m_objArma->pose;
+	m_armpose = NULL;
+	m_poseApplyCount = 0;
+	BLI_mutex_init(&m_poseMutex);
 }
 
 void BL_ArmatureObject::ReParentLogic()
@@ -471,8 +513,12 @@ bool BL_ArmatureObject::UnlinkObject(SCA_IObject* clientobj)
 
 void BL_ArmatureObject::ApplyPose()
 {
-	m_armpose = m_objArma->pose;
-	m_objArma->pose = m_pose;
+	BLI_mutex_lock(&m_poseMutex);
+	// Only the first call swaps the poses, nested and concurrent calls use the applied pose.
+	if (m_poseApplyCount++ == 0) {
+		m_armpose = m_objArma->pose;
+		m_objArma->pose = m_pose;
+	}
 	// in the GE, we use ctime to store the timestep
 	m_pose->ctime = (float)m_timestep;
 	//m_scene->r.cfra++;
@@ -493,12 +539,17 @@ void BL_ArmatureObject::ApplyPose()
 		}
 		m_lastapplyframe = m_lastframe;
 	}
+	BLI_mutex_unlock(&m_poseMutex);
 }
 
 void BL_ArmatureObject::RestorePose()
 {
-	m_objArma->pose = m_armpose;
-	m_armpose = NULL;
+	BLI_mutex_lock(&m_poseMutex);
+	if (--m_poseApplyCount == 0) {
+		m_objArma->pose = m_armpose;
+		m_armpose = NULL;
+	}
+	BLI_mutex_unlock(&m_poseMutex);
 }
 
 void BL_ArmatureObject::SetPose(bPose *pose)
@@ -37,6 +37,7 @@
 #include "BL_ArmatureChannel.h"
 
 #include "SG_IObject.h"
+#include "BLI_threads.h"
 #include <vector>
 #include <algorithm>
 
@@ -74,6 +75,9 @@ public:
 	void SetPose (struct bPose *pose);
 	struct bPose *GetOrigPose() {return m_pose;} // never edit this, only for accessing names
 
+	/** Apply the pose to the armature object and evaluate it once per frame, until RestorePose.
+	 * The calls are counted and locked, the deformers of the children can apply the pose concurrently.
+	 */
 	void ApplyPose();
 	void SetPoseByAction(struct bAction* action, float localtime);
 	void BlendInPose(struct bPose *blend_pose, float weight, short mode);
@@ -144,6 +148,9 @@ protected:
 	bool m_drawDebug;
 
 	double			m_lastapplyframe;
+	/// Number of ApplyPose calls not yet restored.
+	int				m_poseApplyCount;
+	ThreadMutex		m_poseMutex;
 };
 
 #endif  /* __BL_ARMATUREOBJECT_H__ */
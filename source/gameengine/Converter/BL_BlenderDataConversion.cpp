@@ -49,6 +49,7 @@
 
 #include <math.h>
 #include <vector>
+#include <map>
 #include <algorithm>
 
 #include "BL_BlenderDataConversion.h"
@@ -80,6 +81,7 @@
 #include "RAS_ICanvas.h"
 #include "RAS_Polygon.h"
 #include "RAS_TexVert.h"
+#include "RAS_VertexWelder.h"
 #include "RAS_BucketManager.h"
 #include "RAS_IPolygonMaterial.h"
 #include "KX_BlenderMaterial.h"
@@ -139,6 +141,7 @@
 #include "BKE_mesh.h"
 
 #include "BLI_math.h"
+#include "BLI_string.h"
 
 extern "C" {
 #include "BKE_scene.h"
@@ -179,6 +182,7 @@ extern Material defmaterial;	/* material.c */
 #include "KX_Lod.h"
 
 #include "BLI_threads.h"
+#include "BLI_task.h"
 
 static bool default_light_mode = 0;
 
@@ -493,16 +497,10 @@ static KX_BlenderMaterial *ConvertMaterial(
 	return kx_blmat;
 }
 
-static RAS_MaterialBucket *material_from_mesh(Material *ma, MFace *mface, MTFace *tface, MCol *mcol, MTF_localLayer *layers, int lightlayer, unsigned int *rgb, MT_Vector2 uvs[4][RAS_TexVert::MAX_UNIT], const char *tfaceName, KX_Scene* scene, KX_BlenderSceneConverter *converter)
+static RAS_MaterialBucket *material_from_mesh(Material *ma, MTFace *tface, MTF_localLayer *layers, int lightlayer, KX_Scene* scene, KX_BlenderSceneConverter *converter)
 {
 	RAS_IPolyMaterial* polymat = converter->FindCachedPolyMaterial(scene, ma);
 
-	if (mface) {
-		GetRGB(mface, mcol, rgb);
-
-		GetUVs(layers, mface, tface, uvs);
-	}
-
 	if (!polymat) {
 		polymat = ConvertMaterial(ma, tface, layers, lightlayer, scene);
 		converter->CachePolyMaterial(scene, ma, polymat);
@@ -521,21 +519,112 @@ static RAS_MaterialBucket *material_from_mesh(Material *ma, MFace *mface, MTFace
 	return bucket;
 }
 
-/* blenderobj can be NULL, make sure its checked for */
-RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene, KX_BlenderSceneConverter *converter, bool libloading)
+/** Data of a mesh converted without any access to the scene, see mesh_gather. The materials
+ * and the buckets are created after in mesh_register, in the same order as the objects.
+ */
+struct BL_MeshData
 {
-	RAS_MeshObject *meshobj;
-	int lightlayer = blenderobj ? blenderobj->lay:(1<<20)-1; // all layers if no object.
+	/// A material of the mesh, its vertices are welded in the array of the same index.
+	struct MaterialData
+	{
+		Material *m_material;
+		/// Index of the material in the mesh, like in blender.
+		unsigned short m_index;
+		/// True if m_face is the texture face of the first face using the material, it converts the material.
+		bool m_hasFace;
+		MTFace m_face;
+	};
+
+	/// A face of the derived mesh.
+	struct FaceData
+	{
+		unsigned int m_material;
+		unsigned short m_numVerts;
+		/// Number of lines of the face in m_lines, only for the visible faces of a wire material.
+		unsigned short m_numLines;
+		/// Offsets of the vertices in the array of the material.
+		unsigned int m_indices[4];
+	};
+
+	Mesh *m_mesh;
+	/// Object giving the materials and the light layer, can be NULL.
+	Object *m_object;
+	/// Names of the UV layers, the derived mesh is released at the end of mesh_gather.
+	char m_layerNames[MAX_MTFACE][MAX_CUSTOMDATA_LAYER_NAME];
+	RAS_VertexWelder *m_welder;
+	std::vector<MaterialData> m_materials;
+	std::vector<FaceData> m_faces;
+	/// Pairs of vertex offsets of the lines of the faces, in the face order.
+	std::vector<unsigned int> m_lines;
+
+	BL_MeshData(Mesh *mesh, Object *object)
+		:m_mesh(mesh),
+		m_object(object),
+		m_welder(NULL)
+	{
+	}
 
-	// Without checking names, we get some reuse we don't want that can cause
-	// problems with material LoDs.
-	if (blenderobj && ((meshobj = converter->FindGameMesh(mesh/*, ob->lay*/)) != NULL)) {
-		const char *bge_name = meshobj->GetName().ReadPtr();
-		const char *blender_name = ((ID *)blenderobj->data)->name + 2;
-		if (STREQ(bge_name, blender_name)) {
-			return meshobj;
+	~BL_MeshData()
+	{
+		delete m_welder;
+	}
+};
+
+typedef std::map<Mesh *, BL_MeshData *> BL_MeshDataMap;
+
+/// Return the index of the material of the face in data, the material is added if it's new.
+static unsigned int mesh_gather_material(BL_MeshData *data, MFace *mface, MTFace *tface, std::vector<int>& materialByIndex)
+{
+	if ((unsigned int)mface->mat_nr < materialByIndex.size() && materialByIndex[mface->mat_nr] != -1) {
+		return materialByIndex[mface->mat_nr];
+	}
+
+	Material *ma;
+	if (data->m_object)
+		ma = give_current_material(data->m_object, mface->mat_nr+1);
+	else
+		ma = data->m_mesh->mat ? data->m_mesh->mat[mface->mat_nr]:NULL;
+
+	// Check for blender material
+	if (ma == NULL) {
+		ma= &defmaterial;
+	}
+
+	// Several indices can use the same material, like they use the same bucket.
+	unsigned int index;
+	for (index = 0; index < data->m_materials.size(); ++index) {
+		if (data->m_materials[index].m_material == ma) {
+			break;
+		}
+	}
+
+	if (index == data->m_materials.size()) {
+		BL_MeshData::MaterialData matdata;
+		matdata.m_material = ma;
+		matdata.m_index = mface->mat_nr;
+		matdata.m_hasFace = (tface != NULL);
+		if (tface) {
+			matdata.m_face = *tface;
 		}
+		data->m_materials.push_back(matdata);
+		data->m_welder->AddArray();
+	}
+
+	if ((unsigned int)mface->mat_nr >= materialByIndex.size()) {
+		materialByIndex.resize(mface->mat_nr + 1, -1);
 	}
+	materialByIndex[mface->mat_nr] = index;
+
+	return index;
+}
+
+/** Build the derived mesh and weld the vertices of the faces by material. The scene and
+ * the converter aren't used, the meshes of a scene are gathered in parallel. Only the data
+ * needed by mesh_register is kept, the derived mesh is released.
+ */
+static void mesh_gather(BL_MeshData *data)
+{
+	Mesh *mesh = data->m_mesh;
 
 	// Get DerivedMesh data
 	DerivedMesh *dm = CDDM_from_mesh(mesh);
@@ -547,13 +636,14 @@ RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene,
 	MFace *mface = dm->getTessFaceArray(dm);
 	MTFace *tface = static_cast<MTFace*>(dm->getTessFaceDataArray(dm, CD_MTFACE));
 	MCol *mcol = static_cast<MCol*>(dm->getTessFaceDataArray(dm, CD_MCOL));
+	float (*tangent)[4] = NULL;
+	int totface = dm->getNumTessFaces(dm);
+
+	// Used for the lines of the wire materials.
 	MPoly *mpolyarray = (MPoly *)dm->getPolyArray(dm);
 	MLoop *mlooparray = (MLoop *)dm->getLoopArray(dm);
 	MEdge *medgearray = (MEdge *)dm->getEdgeArray(dm);
 	int *mfaceTompoly = (int *)dm->getTessFaceDataArray(dm, CD_ORIGINDEX);
-	float (*tangent)[4] = NULL;
-	int totface = dm->getNumTessFaces(dm);
-	const char *tfaceName = "";
 
 	/* needs to be rewritten for loopdata */
 	if (tface) {
@@ -568,13 +658,12 @@ RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene,
 		tangent = (float(*)[4])dm->getTessFaceDataArray(dm, CD_TANGENT);
 	}
 
-	meshobj = new RAS_MeshObject(mesh);
-
 	// Extract avaiable layers
-	MTF_localLayer *layers =  new MTF_localLayer[MAX_MTFACE];
+	MTF_localLayer layers[MAX_MTFACE];
 	for (int lay=0; lay<MAX_MTFACE; lay++) {
 		layers[lay].face = 0;
 		layers[lay].name = "";
+		data->m_layerNames[lay][0] = '\0';
 	}
 
 	int validLayers = 0;
@@ -589,16 +678,17 @@ RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene,
 
 			layers[validLayers].face = (MTFace*)(dm->faceData.layers[i].data);
 			layers[validLayers].name = dm->faceData.layers[i].name;
-			if (tface == layers[validLayers].face)
-				tfaceName = layers[validLayers].name;
+			BLI_strncpy(data->m_layerNames[validLayers], dm->faceData.layers[i].name, MAX_CUSTOMDATA_LAYER_NAME);
 			validLayers++;
 		}
 	}
 
-	meshobj->SetName(mesh->id.name + 2);
-	meshobj->m_sharedvertex_map.resize(totvert);
+	// The layers of the current face.
+	MTF_localLayer *facelayers = layers;
+
+	data->m_welder = new RAS_VertexWelder(totvert);
+	data->m_faces.resize(totface);
 
-	Material* ma = 0;
 	MT_Vector2 uvs[4][RAS_TexVert::MAX_UNIT];
 	unsigned int rgb[4] = {0};
 
@@ -622,16 +712,23 @@ RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene,
 	}
 
 	if (totface == 0) {
-		ma = mesh->mat ? mesh->mat[0] : NULL;
+		Material *ma = mesh->mat ? mesh->mat[0] : NULL;
 		// Check for blender material
 		if (!ma) {
 			ma = &defmaterial;
 		}
 
-		RAS_MaterialBucket *bucket = material_from_mesh(ma, mface, tface, mcol, layers, lightlayer, rgb, uvs, tfaceName, scene, converter);
-		meshobj->AddMaterial(bucket, 0);
+		BL_MeshData::MaterialData matdata;
+		matdata.m_material = ma;
+		matdata.m_index = 0;
+		matdata.m_hasFace = false;
+		data->m_materials.push_back(matdata);
+		data->m_welder->AddArray();
 	}
 
+	// Material index of the face material indices, -1 until the first face using it.
+	std::vector<int> materialByIndex;
+
 	for (int f=0;f<totface;f++,mface++)
 	{
 		/* get coordinates, normals and tangents */
@@ -674,78 +771,125 @@ RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene,
 			if (mface->v4)
 				tan[3] = MT_Vector4(tangent[f*4 + 3]);
 		}
-		if (blenderobj)
-			ma = give_current_material(blenderobj, mface->mat_nr+1);
-		else
-			ma = mesh->mat ? mesh->mat[mface->mat_nr]:NULL;
 
-		// Check for blender material
-		if (ma == NULL) {
-			ma= &defmaterial;
-		}
-
-		{
-
-			RAS_MaterialBucket* bucket = material_from_mesh(ma, mface, tface, mcol, layers, lightlayer, rgb, uvs, tfaceName, scene, converter);
-			meshobj->AddMaterial(bucket, mface->mat_nr);
+		GetRGB(mface, mcol, rgb);
+		GetUVs(facelayers, mface, tface, uvs);
 
-			// set render flags
-			bool visible = ((ma->game.flag & GEMAT_INVISIBLE)==0);
-			bool twoside = ((ma->game.flag  & GEMAT_BACKCULL)==0);
-			bool collider = ((ma->game.flag & GEMAT_NOPHYSICS)==0);
+		BL_MeshData::FaceData& face = data->m_faces[f];
+		face.m_material = mesh_gather_material(data, mface, tface, materialByIndex);
 
-			/* mark face as flat, so vertices are split */
-			bool flat = (mface->flag & ME_SMOOTH) == 0;
-				
-			int nverts = (mface->v4)? 4: 3;
+		/* mark face as flat, so vertices are split */
+		bool flat = (mface->flag & ME_SMOOTH) == 0;
 
-			unsigned int indices[4]; // all indices of the poly, can be a tri or quad.
-			indices[0] = meshobj->AddVertex(bucket, 0, pt[0], uvs[0], tan[0], rgb[0], no[0], flat, mface->v1);
-			indices[1] = meshobj->AddVertex(bucket, 1, pt[1], uvs[1], tan[1], rgb[1], no[1], flat, mface->v2);
-			indices[2] = meshobj->AddVertex(bucket, 2, pt[2], uvs[2], tan[2], rgb[2], no[2], flat, mface->v3);
+		face.m_numVerts = (mface->v4)? 4: 3;
 
-			if (nverts == 4) {
-				indices[3] = meshobj->AddVertex(bucket, 3, pt[3], uvs[3], tan[3], rgb[3], no[3], flat, mface->v4);
-			}
+		const unsigned int origindices[4] = {mface->v1, mface->v2, mface->v3, mface->v4};
+		for (unsigned short i = 0; i < face.m_numVerts; ++i) {
+			const RAS_TexVert texvert(pt[i], uvs[i], tan[i], rgb[i], no[i], flat, origindices[i]);
+			face.m_indices[i] = data->m_welder->AddVertex(face.m_material, texvert);
+		}
 
-			if (bucket->IsWire() && visible) {
-				// The fourth value can be uninitialized.
-				unsigned int mfaceindices[4] = {mface->v1, mface->v2, mface->v3, mface->v4};
-				MPoly *mpoly = mpolyarray + mfaceTompoly[f];
-				unsigned int lpstart = mpoly->loopstart;
-				unsigned int totlp = mpoly->totloop;
-				// Iterate on all edges (=loops) of the MPoly which contains the current MFace.
-				for (unsigned int i = lpstart; i < lpstart + totlp; ++i) {
-					MLoop *mloop = mlooparray + i;
-					// Get the edge.
-					MEdge *medge = medgearray + mloop->e;
-					// Iterate on all MFace vertices index.
-					for (unsigned short j = (nverts - 1), k = 0; k < nverts; j = k++) {
-						// If 2 vertices are the same as an edge, we add a line in the mesh.
-						if (ELEM(medge->v1, mfaceindices[j], mfaceindices[k]) &&
-							ELEM(medge->v2, mfaceindices[j], mfaceindices[k])) {
-							meshobj->AddLine(bucket, indices[j], indices[k]);
-							break;
-						}
+		// The lines of a wire material are the edges of the polygon joining two vertices of the face.
+		face.m_numLines = 0;
+		Material *ma = data->m_materials[face.m_material].m_material;
+		if (ma->material_type == MA_TYPE_WIRE && (ma->game.flag & GEMAT_INVISIBLE) == 0) {
+			MPoly *mpoly = mpolyarray + mfaceTompoly[f];
+			unsigned int lpstart = mpoly->loopstart;
+			unsigned int totlp = mpoly->totloop;
+			// Iterate on all edges (=loops) of the MPoly which contains the current MFace.
+			for (unsigned int i = lpstart; i < lpstart + totlp; ++i) {
+				MLoop *mloop = mlooparray + i;
+				// Get the edge.
+				MEdge *medge = medgearray + mloop->e;
+				// Iterate on all MFace vertices index.
+				for (unsigned short j = (face.m_numVerts - 1), k = 0; k < face.m_numVerts; j = k++) {
+					// If 2 vertices are the same as an edge, we add a line in the mesh.
+					if (ELEM(medge->v1, origindices[j], origindices[k]) &&
+						ELEM(medge->v2, origindices[j], origindices[k])) {
+						data->m_lines.push_back(face.m_indices[j]);
+						data->m_lines.push_back(face.m_indices[k]);
+						face.m_numLines++;
+						break;
 					}
 				}
 			}
-			meshobj->AddPolygon(bucket, nverts, indices, visible, collider, twoside);
 		}
 
-		if (tface) 
+		if (tface)
 			tface++;
 		if (mcol)
 			mcol+=4;
 
 		for (int lay=0; lay<MAX_MTFACE; lay++)
 		{
-			MTF_localLayer &layer = layers[lay];
+			MTF_localLayer &layer = facelayers[lay];
 			if (layer.face == 0) break;
 
 			layer.face++;
 		}
 	}
+
+	dm->release(dm);
+}
+
+/** Create the mesh object from the gathered data, its materials are converted and its
+ * vertices and polygons added in the buckets of the scene. data is freed.
+ */
+static RAS_MeshObject *mesh_register(BL_MeshData *data, KX_Scene *scene, KX_BlenderSceneConverter *converter, bool libloading)
+{
+	Mesh *mesh = data->m_mesh;
+	int lightlayer = data->m_object ? data->m_object->lay:(1<<20)-1; // all layers if no object.
+
+	// Only the names of the layers are used by the materials.
+	MTF_localLayer layers[MAX_MTFACE];
+	for (int lay = 0; lay < MAX_MTFACE; lay++) {
+		layers[lay].face = NULL;
+		layers[lay].name = data->m_layerNames[lay];
+	}
+
+	RAS_MeshObject *meshobj = new RAS_MeshObject(mesh);
+	meshobj->SetName(mesh->id.name + 2);
+
+	// The materials are converted in the order of their first face, like the faces would.
+	const unsigned int nummaterials = data->m_materials.size();
+	std::vector<RAS_MeshMaterial *> meshmaterials(nummaterials);
+	for (unsigned int i = 0; i < nummaterials; ++i) {
+		const BL_MeshData::MaterialData& matdata = data->m_materials[i];
+		// The const_cast is safe, the texture face is only copied.
+		MTFace *matface = matdata.m_hasFace ? const_cast<MTFace *>(&matdata.m_face) : NULL;
+		RAS_MaterialBucket *bucket = material_from_mesh(matdata.m_material, matface, layers, lightlayer, scene, converter);
+		meshmaterials[i] = meshobj->AddMaterial(bucket, matdata.m_index);
+	}
+
+	meshobj->SetWeldedVertices(*data->m_welder, meshmaterials);
+
+	const unsigned int *lines = data->m_lines.empty() ? NULL : &data->m_lines[0];
+	for (unsigned int f = 0, size = data->m_faces.size(); f < size; ++f) {
+		const BL_MeshData::FaceData& face = data->m_faces[f];
+		RAS_MaterialBucket *bucket = meshmaterials[face.m_material]->m_bucket;
+		Material *ma = data->m_materials[face.m_material].m_material;
+
+		// set render flags
+		bool visible = ((ma->game.flag & GEMAT_INVISIBLE)==0);
+		bool twoside = ((ma->game.flag  & GEMAT_BACKCULL)==0);
+		bool collider = ((ma->game.flag & GEMAT_NOPHYSICS)==0);
+
+		int nverts = face.m_numVerts;
+
+		unsigned int indices[4]; // all indices of the poly, can be a tri or quad.
+		for (int i = 0; i < nverts; ++i) {
+			indices[i] = face.m_indices[i];
+		}
+
+		// The lines were found in mesh_gather.
+		for (unsigned short i = 0; i < face.m_numLines; ++i, lines += 2) {
+			if (bucket->IsWire() && visible) {
+				meshobj->AddLine(bucket, lines[0], lines[1]);
+			}
+		}
+		meshobj->AddPolygon(bucket, nverts, indices, visible, collider, twoside);
+	}
+
 	// keep meshobj->m_sharedvertex_map for reinstance phys mesh.
 	// 2.49a and before it did: meshobj->m_sharedvertex_map.clear();
 	// but this didnt save much ram. - Campbell
@@ -760,15 +904,84 @@ RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene,
 		}
 	}
 
-	if (layers)
-		delete []layers;
-	
-	dm->release(dm);
+	delete data;
 
 	converter->RegisterGameMesh(meshobj, mesh);
 	return meshobj;
 }
 
+/* blenderobj can be NULL, make sure its checked for, data is the gathered mesh or NULL */
+static RAS_MeshObject *convert_mesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene, KX_BlenderSceneConverter *converter, bool libloading, BL_MeshData *data)
+{
+	RAS_MeshObject *meshobj;
+
+	// Without checking names, we get some reuse we don't want that can cause
+	// problems with material LoDs.
+	if (blenderobj && ((meshobj = converter->FindGameMesh(mesh/*, ob->lay*/)) != NULL)) {
+		const char *bge_name = meshobj->GetName().ReadPtr();
+		const char *blender_name = ((ID *)blenderobj->data)->name + 2;
+		if (STREQ(bge_name, blender_name)) {
+			// The mesh was converted before its gathering was used, e.g. as a LoD level.
+			delete data;
+			return meshobj;
+		}
+	}
+
+	if (!data) {
+		data = new BL_MeshData(mesh, blenderobj);
+		mesh_gather(data);
+	}
+
+	return mesh_register(data, scene, converter, libloading);
+}
+
+/* blenderobj can be NULL, make sure its checked for */
+RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene, KX_BlenderSceneConverter *converter, bool libloading)
+{
+	return convert_mesh(mesh, blenderobj, scene, converter, libloading, NULL);
+}
+
+static void mesh_gather_task(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	mesh_gather((BL_MeshData *)taskdata);
+}
+
+/** Gather in parallel the meshes of the objects of the scene not already converted, they are
+ * registered in the scene when their first object is converted, see gameobject_from_blenderobject.
+ */
+static void gather_meshes(Scene *blenderscene, KX_BlenderSceneConverter *converter, TaskScheduler *scheduler,
+                          BL_MeshDataMap& meshdatas)
+{
+	Scene *sce_iter;
+	Base *base;
+
+	for (SETLOOPER(blenderscene, sce_iter, base)) {
+		Object *blenderobject = base->object;
+		if (blenderobject->type != OB_MESH) {
+			continue;
+		}
+
+		// The first object using the mesh gives its materials, like for the conversion.
+		Mesh *mesh = (Mesh *)blenderobject->data;
+		if (converter->FindGameMesh(mesh) || meshdatas.find(mesh) != meshdatas.end()) {
+			continue;
+		}
+
+		meshdatas[mesh] = new BL_MeshData(mesh, blenderobject);
+	}
+
+	if (meshdatas.empty()) {
+		return;
+	}
+
+	TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+	for (BL_MeshDataMap::iterator it = meshdatas.begin(), end = meshdatas.end(); it != end; ++it) {
+		BLI_task_pool_push(pool, mesh_gather_task, it->second, false, TASK_PRIORITY_LOW);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+}
+
 	
 	
 static PHY_MaterialProps *CreateMaterialFromBlenderObject(struct Object* blenderobject)
@@ -998,6 +1211,7 @@ static KX_LightObject *gamelight_from_blamp(Object *ob, Lamp *la, unsigned int l
 	lightobj->m_staticShadow = la->mode & LA_STATIC_SHADOW;
 	// Set to true to make at least one shadow render in static mode.
 	lightobj->m_requestShadowUpdate = true;
+	lightobj->m_cachedShadow = false;
 
 	lightobj->m_nodiffuse = (la->mode & LA_NO_DIFF) != 0;
 	lightobj->m_nospecular = (la->mode & LA_NO_SPEC) != 0;
@@ -1037,6 +1251,7 @@ static KX_GameObject *gameobject_from_blenderobject(
 								KX_Scene *kxscene, 
 								RAS_IRasterizer *rendertools,
 								KX_BlenderSceneConverter *converter,
+								BL_MeshDataMap& meshdatas,
 								bool libloading) 
 {
 	KX_GameObject *gameobj = NULL;
@@ -1072,7 +1287,14 @@ static KX_GameObject *gameobject_from_blenderobject(
 	case OB_MESH:
 	{
 		Mesh* mesh = static_cast<Mesh*>(ob->data);
-		RAS_MeshObject* meshobj = BL_ConvertMesh(mesh,ob,kxscene,converter, libloading);
+		// Use the mesh gathered in parallel if this object is the first one using it.
+		BL_MeshData *meshdata = NULL;
+		BL_MeshDataMap::iterator meshit = meshdatas.find(mesh);
+		if (meshit != meshdatas.end() && meshit->second->m_object == ob) {
+			meshdata = meshit->second;
+			meshdatas.erase(meshit);
+		}
+		RAS_MeshObject* meshobj = convert_mesh(mesh,ob,kxscene,converter, libloading, meshdata);
 		
 		// needed for python scripting
 		kxscene->GetLogicManager()->RegisterMeshName(meshobj->GetName(),meshobj);
@@ -1498,6 +1720,11 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 
 	blenderSceneSetBackground(blenderscene);
 
+	/* The meshes are built and their vertices welded in parallel, their materials
+	 * and buckets are then registered in the scene in the order of the objects. */
+	BL_MeshDataMap meshdatas;
+	gather_meshes(blenderscene, converter, ketsjiEngine->GetTaskScheduler(), meshdatas);
+
 	// Let's support scene set.
 	// Beware of name conflict in linked data, it will not crash but will create confusion
 	// in Python scripting and in certain actuators (replace mesh). Linked scene *should* have
@@ -1512,6 +1739,7 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 										kxscene, 
 										rendertools, 
 										converter,
+										meshdatas,
 										libloading);
 
 		bool isInActiveLayer = (blenderobject->lay & activeLayerBitInfo) !=0;
@@ -1536,6 +1764,12 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 		}
 	}
 
+	// Normally all used by their first object.
+	for (BL_MeshDataMap::iterator it = meshdatas.begin(), end = meshdatas.end(); it != end; ++it) {
+		delete it->second;
+	}
+	meshdatas.clear();
+
 	if (!grouplist.empty())
 	{
 		// now convert the group referenced by dupli group object
@@ -1564,6 +1798,7 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 														kxscene, 
 														rendertools, 
 														converter,
+														meshdatas,
 														libloading);
 
 						bool isInActiveLayer = false;
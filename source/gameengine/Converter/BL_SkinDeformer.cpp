@@ -33,9 +33,7 @@
 #  pragma warning (disable:4786)
 #endif
 
-// Eigen3 stuff used for BGEDeformVerts
-#include <Eigen/Core>
-#include <Eigen/LU>
+#include <vector>
 
 #include "BL_SkinDeformer.h"
 #include "STR_HashedString.h"
@@ -93,8 +91,11 @@ BL_SkinDeformer::BL_SkinDeformer(BL_DeformableGameObject *gameobj,
 	m_poseApplied(false),
 	m_recalcNormal(true),
 	m_copyNormals(false),
-	m_dfnrToPC(NULL)
+	m_dfnrToPC(NULL),
+	m_skinPalette(NULL),
+	m_skinNorPalette(NULL)
 {
+	memset(&m_skinWeights, 0, sizeof(m_skinWeights));
 	copy_m4_m4(m_obmat, bmeshobj->obmat);
 	m_deformflags = get_deformflags(bmeshobj);
 }
@@ -113,8 +114,11 @@ BL_SkinDeformer::BL_SkinDeformer(
 	m_releaseobject(release_object),
 	m_recalcNormal(recalc_normal),
 	m_copyNormals(false),
-	m_dfnrToPC(NULL)
+	m_dfnrToPC(NULL),
+	m_skinPalette(NULL),
+	m_skinNorPalette(NULL)
 {
+	memset(&m_skinWeights, 0, sizeof(m_skinWeights));
 	// this is needed to ensure correct deformation of mesh:
 	// the deformation is done with Blender's armature_deform_verts() function
 	// that takes an object as parameter and not a mesh. The object matrice is used
@@ -130,6 +134,11 @@ BL_SkinDeformer::~BL_SkinDeformer()
 		m_armobj->Release();
 	if (m_dfnrToPC)
 		delete [] m_dfnrToPC;
+	if (m_skinPalette)
+		delete [] m_skinPalette;
+	if (m_skinNorPalette)
+		delete [] m_skinNorPalette;
+	BLI_skin_weights_free(&m_skinWeights);
 }
 
 void BL_SkinDeformer::Relink(std::map<void *, void *>& map)
@@ -192,6 +201,9 @@ void BL_SkinDeformer::ProcessReplica()
 	m_lastArmaUpdate = -1.0;
 	m_releaseobject = false;
 	m_dfnrToPC = NULL;
+	m_skinPalette = NULL;
+	m_skinNorPalette = NULL;
+	memset(&m_skinWeights, 0, sizeof(m_skinWeights));
 }
 
 void BL_SkinDeformer::BlenderDeformVerts()
@@ -221,7 +233,8 @@ void BL_SkinDeformer::BGEDeformVerts()
 	MDeformVert *dverts = m_bmesh->dvert;
 	bDeformGroup *dg;
 	int defbase_tot;
-	Eigen::Matrix4f pre_mat, post_mat, chan_mat, norm_chan_mat;
+	float obimat[4][4], pre_mat[4][4], post_mat[4][4];
+	float aabbMin[3], aabbMax[3];
 
 	if (!dverts)
 		return;
@@ -240,71 +253,64 @@ void BL_SkinDeformer::BGEDeformVerts()
 			if (m_dfnrToPC[i] && m_dfnrToPC[i]->bone->flag & BONE_NO_DEFORM)
 				m_dfnrToPC[i] = NULL;
 		}
-	}
-
-	post_mat = Eigen::Matrix4f::Map((float *)m_obmat).inverse() * Eigen::Matrix4f::Map((float *)m_armobj->GetArmatureObject()->obmat);
-	pre_mat = post_mat.inverse();
-
-	MDeformVert *dv = dverts;
-	MDeformWeight *dw;
-
-	for (int i = 0; i < m_bmesh->totvert; ++i, dv++) {
-		float contrib = 0.0f, weight, max_weight = -1.0f;
-		bPoseChannel *pchan = NULL;
-		Eigen::Map<Eigen::Vector3f> norm = Eigen::Vector3f::Map(m_transnors[i]);
-		Eigen::Vector4f vec(0.0f, 0.0f, 0.0f, 1.0f);
-		Eigen::Vector4f co(m_transverts[i][0],
-		                   m_transverts[i][1],
-		                   m_transverts[i][2],
-		                   1.0f);
-
-		if (!dv->totweight)
-			continue;
-
-		co = pre_mat * co;
-
-		dw = dv->dw;
 
-		for (unsigned int j = dv->totweight; j != 0; j--, dw++) {
-			const int index = dw->def_nr;
+		m_skinPalette = new float[max_ii(defbase_tot, 1)][4][4];
+		m_skinNorPalette = new float[max_ii(defbase_tot, 1)][4][4];
 
-			if (index < defbase_tot && (pchan = m_dfnrToPC[index])) {
-				weight = dw->weight;
+		// keep only the weights of deforming bones, at most SKIN_MAX_INFLUENCES per vertex
+		std::vector<int> bones;
+		std::vector<float> weights;
+		MDeformVert *dv = dverts;
 
-				if (weight) {
-					chan_mat = Eigen::Matrix4f::Map((float *)pchan->chan_mat);
+		BLI_skin_weights_init(&m_skinWeights, m_bmesh->totvert);
+		for (i = 0; i < m_bmesh->totvert; ++i, dv++) {
+			bones.clear();
+			weights.clear();
 
-					// Update Vertex Position
-					vec.noalias() += (chan_mat * co - co) * weight;
-
-					// Save the most influential channel so we can use it to update the vertex normal
-					if (weight > max_weight)
-					{
-						max_weight = weight;
-						norm_chan_mat = chan_mat;
-					}
-
-					contrib += weight;
+			MDeformWeight *dw = dv->dw;
+			for (unsigned int j = dv->totweight; j != 0; j--, dw++) {
+				if (dw->def_nr < defbase_tot && m_dfnrToPC[dw->def_nr]) {
+					bones.push_back(dw->def_nr);
+					weights.push_back(dw->weight);
 				}
 			}
+
+			if (!bones.empty()) {
+				BLI_skin_weights_set(&m_skinWeights, i, &bones[0], &weights[0], bones.size());
+			}
 		}
+	}
+
+	invert_m4_m4(obimat, m_obmat);
+	mul_m4_m4m4(post_mat, obimat, par_arma->obmat);
+	invert_m4_m4(pre_mat, post_mat);
 
-		// Update Vertex Normal
-		norm = norm_chan_mat.topLeftCorner<3, 3>() * norm;
+	// the pre and post matrices are the same for all the bones, merge them in the palette
+	for (int i = 0; i < defbase_tot; ++i) {
+		bPoseChannel *pchan = m_dfnrToPC[i];
 
-		co.noalias() += vec / contrib;
-		co[3] = 1.0f; // Make sure we have a 1 for the w component!
+		if (pchan) {
+			mul_m4_series(m_skinPalette[i], post_mat, pchan->chan_mat, pre_mat);
+			copy_m4_m4(m_skinNorPalette[i], pchan->chan_mat);
+		}
+		else {
+			unit_m4(m_skinPalette[i]);
+			unit_m4(m_skinNorPalette[i]);
+		}
+	}
 
-		co = post_mat * co;
+	BLI_skin_deform(&m_skinWeights, m_skinPalette, m_skinNorPalette, m_transverts, m_transnors,
+	                aabbMin, aabbMax, true);
 
-		m_transverts[i][0] = co[0];
-		m_transverts[i][1] = co[1];
-		m_transverts[i][2] = co[2];
+	if (m_bmesh->totvert > 0) {
+		m_aabbMin = MT_Vector3(aabbMin);
+		m_aabbMax = MT_Vector3(aabbMax);
 	}
+
 	m_copyNormals = true;
 }
 
-void BL_SkinDeformer::UpdateTransverts()
+void BL_SkinDeformer::UpdateTransverts(bool updateBounds)
 {
 	// if we don't use a vertex array we does nothing.
 	if (!UseVertexArray()) {
@@ -314,7 +320,6 @@ void BL_SkinDeformer::UpdateTransverts()
 	RAS_MeshMaterial *mmat;
 	RAS_MeshSlot *slot;
 	size_t i, nmat, imat;
-	bool first = true;
 	if (m_transverts) {
 		// the vertex cache is unique to this deformer, no need to update it
 		// if it wasn't updated! We must update all the materials at once
@@ -336,31 +341,21 @@ void BL_SkinDeformer::UpdateTransverts()
 				v.SetXYZ(m_transverts[v.getOrigIndex()]);
 				if (m_copyNormals)
 					v.SetNormal(MT_Vector3(m_transnors[v.getOrigIndex()]));
-
-				MT_Vector3 vertpos = v.xyz();
-
-				if (!m_gameobj->GetAutoUpdateBounds()) {
-					continue;
-				}
-
-				// For the first vertex of the mesh, only initialize AABB.
-				if (first) {
-					m_aabbMin = m_aabbMax = vertpos;
-					first = false;
-				}
-				else {
-					m_aabbMin.x() = std::min(m_aabbMin.x(), vertpos.x());
-					m_aabbMin.y() = std::min(m_aabbMin.y(), vertpos.y());
-					m_aabbMin.z() = std::min(m_aabbMin.z(), vertpos.z());
-					m_aabbMax.x() = std::max(m_aabbMax.x(), vertpos.x());
-					m_aabbMax.y() = std::max(m_aabbMax.y(), vertpos.y());
-					m_aabbMax.z() = std::max(m_aabbMax.z(), vertpos.z());
-				}
 			}
 		}
 
 		if (m_copyNormals)
 			m_copyNormals = false;
+
+		// the bounds are computed on the mesh vertices, the display arrays share them between materials
+		if (updateBounds && m_gameobj->GetAutoUpdateBounds() && m_tvtot > 0) {
+			float aabbMin[3], aabbMax[3];
+
+			INIT_MINMAX(aabbMin, aabbMax);
+			minmax_v3v3_v3_array(aabbMin, aabbMax, m_transverts, m_tvtot);
+			m_aabbMin = MT_Vector3(aabbMin);
+			m_aabbMax = MT_Vector3(aabbMax);
+		}
 	}
 }
 
@@ -393,7 +388,8 @@ bool BL_SkinDeformer::UpdateInternal(bool shape_applied)
 		/* dynamic vertex, cannot use display list */
 		m_bDynamic = true;
 
-		UpdateTransverts();
+		// BGEDeformVerts() computes the bounds while skinning
+		UpdateTransverts(m_armobj->GetVertDeformType() != ARM_VDEF_BGE_CPU || !m_bmesh->dvert);
 
 		m_poseApplied = false;
 
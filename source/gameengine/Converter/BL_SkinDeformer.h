@@ -43,6 +43,7 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 #include "BKE_armature.h"
+#include "BLI_skinning.h"
 
 #include "RAS_Deformer.h"
 
@@ -112,10 +113,16 @@ protected:
 	bPoseChannel **m_dfnrToPC;
 	short m_deformflags;
 
+	/// Influences of each vertex, built with m_dfnrToPC, bones are deform group indices.
+	SkinWeights m_skinWeights;
+	/// Matrices of each deform group, used by BGEDeformVerts().
+	float (*m_skinPalette)[4][4];
+	float (*m_skinNorPalette)[4][4];
+
 	void BlenderDeformVerts();
 	void BGEDeformVerts();
 
-	void UpdateTransverts();
+	void UpdateTransverts(bool updateBounds = true);
 
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("GE:BL_SkinDeformer")
@@ -55,6 +55,7 @@
 
 #include "KX_LibLoadStatus.h"
 #include "KX_BlenderScalarInterpolator.h"
+#include "BL_ActionCurves.h"
 #include "BL_BlenderDataConversion.h"
 #include "KX_WorldInfo.h"
 #include "EXP_StringValue.h"
@@ -94,6 +95,7 @@ extern "C"
 
 /* Only for dynamic loading and merging */
 #include "RAS_BucketManager.h" // XXX cant stay
+#include "RAS_MeshUser.h"
 #include "KX_BlenderSceneConverter.h"
 #include "KX_MeshProxy.h"
 extern "C" {
@@ -110,12 +112,58 @@ extern "C" {
 #include "BLI_task.h"
 #include "EXP_Thread.h"
 
+#include <algorithm>
+#include <climits>
+
 // This is used to avoid including BLI_task.h in KX_BlenderSceneConverter.h
 typedef struct ThreadInfo {
 	TaskPool *m_pool;
 	CThreadMutex m_mutex;
+	// Asynchronous loads waiting to be read and converted, taken by priority.
+	vector<KX_LibLoadStatus *> m_readqueue;
+	vector<KX_LibLoadStatus *> m_convertqueue;
+	// True while the conversion task runs, the scenes are converted one at a time.
+	bool m_converting;
 } ThreadInfo;
 
+// Data of an asynchronous load, stored in its status until the load is finished.
+struct AsyncLibLoad {
+	Main *m_main;
+	int m_idcode;
+	short m_options;
+	// Copy of the library data given from memory or the read file data, freed once linked.
+	void *m_data;
+	int m_length;
+	// Scenes to convert, then the converted scenes to merge.
+	vector<Scene *> m_scenes;
+	vector<KX_Scene *> m_mergeScenes;
+	unsigned int m_numScenes;
+};
+
+// Share of the progress of an asynchronous load for each stage.
+#define LIB_LOAD_READ_PROGRESS 0.3f
+#define LIB_LOAD_CONVERT_PROGRESS 0.6f
+#define LIB_LOAD_MERGE_PROGRESS 0.1f
+
+// The library files are read by chunks to update the progress.
+#define LIB_LOAD_READ_CHUNK_SIZE (1 << 20)
+
+// Time in seconds spent merging the converted libraries per frame, at least one scene is merged.
+#define LIB_LOAD_MERGE_TIME_BUDGET 0.002
+
+// Time in seconds spent removing the objects of the libraries freed deferred per frame.
+#define LIB_FREE_TIME_BUDGET 0.002
+
+/** Converted data owned by a library, freed with it without looking at the data of the
+ * other libraries and of the main file.
+ */
+struct LibraryData {
+	// Links of the game objects converted from the library objects, replicas included.
+	SG_DList m_objects;
+	vector<pair<KX_Scene *, RAS_MeshObject *> > m_meshobjects;
+	vector<pair<KX_Scene *, RAS_IPolyMaterial *> > m_polymaterials;
+};
+
 KX_BlenderSceneConverter::KX_BlenderSceneConverter(
 							Main *maggie,
 							KX_KetsjiEngine *engine)
@@ -127,6 +175,7 @@ KX_BlenderSceneConverter::KX_BlenderSceneConverter(
 	m_newfilename = "";
 	m_threadinfo = new ThreadInfo();
 	m_threadinfo->m_pool = BLI_task_pool_create(engine->GetTaskScheduler(), NULL);
+	m_threadinfo->m_converting = false;
 }
 
 KX_BlenderSceneConverter::~KX_BlenderSceneConverter()
@@ -140,6 +189,12 @@ KX_BlenderSceneConverter::~KX_BlenderSceneConverter()
 		delete it->second;
 	}
 
+	for (std::map<bAction *, BL_ActionCurveList *>::iterator it = m_map_blender_to_actionCurveList.begin(),
+		 end = m_map_blender_to_actionCurveList.end(); it != end; ++it)
+	{
+		delete it->second;
+	}
+
 	vector<pair<KX_Scene *, KX_WorldInfo *> >::iterator itw = m_worldinfos.begin();
 	while (itw != m_worldinfos.end()) {
 		delete itw->second;
@@ -161,13 +216,42 @@ KX_BlenderSceneConverter::~KX_BlenderSceneConverter()
 	}
 	m_meshobjects.clear();
 
+	/* The converted data of the libraries is freed here, all the scenes are already freed. */
+	for (map<Main *, LibraryData *>::iterator it = m_libraryData.begin(), end = m_libraryData.end(); it != end; ++it) {
+		LibraryData *data = it->second;
+		for (itp = data->m_polymaterials.begin(); itp != data->m_polymaterials.end(); ++itp) {
+			delete itp->second;
+		}
+		data->m_polymaterials.clear();
+		for (itm = data->m_meshobjects.begin(); itm != data->m_meshobjects.end(); ++itm) {
+			delete itm->second;
+		}
+		data->m_meshobjects.clear();
+	}
+
 	/* free any data that was dynamically loaded */
 	while (m_DynamicMaggie.size() != 0) {
 		FreeBlendFile(m_DynamicMaggie[0]);
 	}
 
+	// The objects of the deferred frees are already freed with their scenes.
+	for (vector<Main *>::iterator it = m_freequeue.begin(), end = m_freequeue.end(); it != end; ++it) {
+		EndFreeLibrary(*it);
+	}
+	m_freequeue.clear();
+
+	for (map<Main *, LibraryData *>::iterator it = m_libraryData.begin(), end = m_libraryData.end(); it != end; ++it) {
+		delete it->second;
+	}
+	m_libraryData.clear();
+
 	m_DynamicMaggie.clear();
 
+	for (vector<KX_LibLoadStatus *>::iterator it = m_failedStatuses.begin(), end = m_failedStatuses.end(); it != end; ++it) {
+		delete *it;
+	}
+	m_failedStatuses.clear();
+
 	if (m_threadinfo) {
 		/* Thread infos like mutex must be freed after FreeBlendFile function.
 		Because it needs to lock the mutex, even if there's no active task when it's
@@ -201,6 +285,10 @@ Scene *KX_BlenderSceneConverter::GetBlenderSceneForName(const STR_String &name)
 
 	for (vector<Main *>::iterator it=m_DynamicMaggie.begin(); !(it == m_DynamicMaggie.end()); it++) {
 		Main *main = *it;
+		// The scenes of a loading library are still linked by the read task.
+		if (IsMainLoading(main)) {
+			continue;
+		}
 
 		if ((sce= (Scene *)BLI_findstring(&main->scene, name.ReadPtr(), offsetof(ID, name) + 2)))
 			return sce;
@@ -286,7 +374,9 @@ void KX_BlenderSceneConverter::ConvertScene(KX_Scene *destinationscene, RAS_IRas
 	//between scenes, even if they are shared in the blend file.
 	//This cache mecanism is buggy so I leave it disable and the memory leak
 	//that would result from this is fixed in RemoveScene()
+	m_threadinfo->m_mutex.Lock();
 	m_map_mesh_to_gamemesh.clear();
+	m_threadinfo->m_mutex.Unlock();
 }
 
 // This function removes all entities stored in the converter for that scene
@@ -295,59 +385,46 @@ void KX_BlenderSceneConverter::ConvertScene(KX_Scene *destinationscene, RAS_IRas
 // scenes but that is now disabled so all scene will have their own copy
 // and we can delete them here. If the sharing is reactivated, change this code too..
 // (see KX_BlenderSceneConverter::ConvertScene)
-void KX_BlenderSceneConverter::RemoveScene(KX_Scene *scene)
+/// Delete the entities of a removed scene.
+template <class T>
+static void remove_scene_entities(vector<pair<KX_Scene *, T *> >& entities, KX_Scene *scene)
 {
-	int i, size;
-	// delete the scene first as it will stop the use of entities
-	scene->Release();
-	// delete the entities of this scene
-	vector<pair<KX_Scene *, KX_WorldInfo *> >::iterator worldit;
-	size = m_worldinfos.size();
-	for (i = 0, worldit = m_worldinfos.begin(); i < size; ) {
-		if (worldit->first == scene) {
-			delete worldit->second;
-			*worldit = m_worldinfos.back();
-			m_worldinfos.pop_back();
+	typename vector<pair<KX_Scene *, T *> >::iterator it;
+	int i, size = entities.size();
+	for (i = 0, it = entities.begin(); i < size; ) {
+		if (it->first == scene) {
+			delete it->second;
+			*it = entities.back();
+			entities.pop_back();
 			size--;
 		} 
 		else {
 			i++;
-			worldit++;
+			it++;
 		}
 	}
+}
 
-	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator polymit;
-	size = m_polymaterials.size();
-	for (i = 0, polymit = m_polymaterials.begin(); i < size; ) {
-		if (polymit->first == scene) {
-			m_polymat_cache[scene].erase(polymit->second->GetBlenderMaterial());
-			delete polymit->second;
-			*polymit = m_polymaterials.back();
-			m_polymaterials.pop_back();
-			size--;
-		} 
-		else {
-			i++;
-			polymit++;
-		}
+void KX_BlenderSceneConverter::RemoveScene(KX_Scene *scene)
+{
+	// delete the scene first as it will stop the use of entities
+	scene->Release();
+
+	m_threadinfo->m_mutex.Lock();
+
+	// delete the entities of this scene
+	remove_scene_entities(m_worldinfos, scene);
+	remove_scene_entities(m_polymaterials, scene);
+	remove_scene_entities(m_meshobjects, scene);
+
+	for (map<Main *, LibraryData *>::iterator it = m_libraryData.begin(), end = m_libraryData.end(); it != end; ++it) {
+		remove_scene_entities(it->second->m_polymaterials, scene);
+		remove_scene_entities(it->second->m_meshobjects, scene);
 	}
 
 	m_polymat_cache.erase(scene);
 
-	vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit;
-	size = m_meshobjects.size();
-	for (i = 0, meshit = m_meshobjects.begin(); i < size; ) {
-		if (meshit->first == scene) {
-			delete meshit->second;
-			*meshit = m_meshobjects.back();
-			m_meshobjects.pop_back();
-			size--;
-		} 
-		else {
-			i++;
-			meshit++;
-		}
-	}
+	m_threadinfo->m_mutex.Unlock();
 }
 
 void KX_BlenderSceneConverter::SetAlwaysUseExpandFraming(bool to_what)
@@ -359,6 +436,13 @@ void KX_BlenderSceneConverter::RegisterGameObject(KX_GameObject *gameobject, Obj
 {
 	/* only maintained while converting, freed during game runtime */
 	m_map_blender_to_gameobject[for_blenderobject] = gameobject;
+
+	m_threadinfo->m_mutex.Lock();
+	LibraryData *data = FindLibraryData(&for_blenderobject->id);
+	if (data) {
+		data->m_objects.AddBack(gameobject->GetLibraryLink());
+	}
+	m_threadinfo->m_mutex.Unlock();
 }
 
 /* only need to run this during conversion since
@@ -383,36 +467,60 @@ KX_GameObject *KX_BlenderSceneConverter::FindGameObject(Object *for_blenderobjec
 
 void KX_BlenderSceneConverter::RegisterGameMesh(RAS_MeshObject *gamemesh, Mesh *for_blendermesh)
 {
+	m_threadinfo->m_mutex.Lock();
 	if (for_blendermesh) { /* dynamically loaded meshes we don't want to keep lookups for */
 		m_map_mesh_to_gamemesh[for_blendermesh] = gamemesh;
 	}
-	m_meshobjects.push_back(pair<KX_Scene *, RAS_MeshObject *> (m_currentScene,gamemesh));
+	LibraryData *data = FindLibraryData(&gamemesh->GetMesh()->id);
+	vector<pair<KX_Scene *, RAS_MeshObject *> >& meshobjects = (data) ? data->m_meshobjects : m_meshobjects;
+	meshobjects.push_back(pair<KX_Scene *, RAS_MeshObject *> (m_currentScene,gamemesh));
+	m_threadinfo->m_mutex.Unlock();
 }
 
 RAS_MeshObject *KX_BlenderSceneConverter::FindGameMesh(Mesh *for_blendermesh)
 {
-	return m_map_mesh_to_gamemesh[for_blendermesh];
+	// The meshes are registered by the conversion task too.
+	m_threadinfo->m_mutex.Lock();
+	map<Mesh *, RAS_MeshObject *>::iterator it = m_map_mesh_to_gamemesh.find(for_blendermesh);
+	RAS_MeshObject *meshobj = (it != m_map_mesh_to_gamemesh.end()) ? it->second : NULL;
+	m_threadinfo->m_mutex.Unlock();
+	return meshobj;
 }
 
 void KX_BlenderSceneConverter::RegisterPolyMaterial(RAS_IPolyMaterial *polymat)
 {
+	m_threadinfo->m_mutex.Lock();
+	Material *mat = polymat->GetBlenderMaterial();
+	LibraryData *data = (mat) ? FindLibraryData(&mat->id) : NULL;
+	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >& polymaterials = (data) ? data->m_polymaterials : m_polymaterials;
+
 	// First make sure we don't register the material twice
 	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator it;
-	for (it = m_polymaterials.begin(); it != m_polymaterials.end(); ++it)
-		if (it->second == polymat)
+	for (it = polymaterials.begin(); it != polymaterials.end(); ++it) {
+		if (it->second == polymat) {
+			m_threadinfo->m_mutex.Unlock();
 			return;
-	m_polymaterials.push_back(pair<KX_Scene *, RAS_IPolyMaterial *> (m_currentScene, polymat));
+		}
+	}
+	polymaterials.push_back(pair<KX_Scene *, RAS_IPolyMaterial *> (m_currentScene, polymat));
+	m_threadinfo->m_mutex.Unlock();
 }
 
 void KX_BlenderSceneConverter::CachePolyMaterial(KX_Scene *scene, Material *mat, RAS_IPolyMaterial *polymat)
 {
-	if (mat)
+	if (mat) {
+		m_threadinfo->m_mutex.Lock();
 		m_polymat_cache[scene][mat] = polymat;
+		m_threadinfo->m_mutex.Unlock();
+	}
 }
 
 RAS_IPolyMaterial *KX_BlenderSceneConverter::FindCachedPolyMaterial(KX_Scene *scene, Material *mat)
 {
-	return m_polymat_cache[scene][mat];
+	m_threadinfo->m_mutex.Lock();
+	RAS_IPolyMaterial *polymat = m_polymat_cache[scene][mat];
+	m_threadinfo->m_mutex.Unlock();
+	return polymat;
 }
 
 void KX_BlenderSceneConverter::RegisterInterpolatorList(BL_InterpolatorList *actList, bAction *for_act)
@@ -425,6 +533,15 @@ BL_InterpolatorList *KX_BlenderSceneConverter::FindInterpolatorList(bAction *for
 	return m_map_blender_to_gameAdtList[for_act];
 }
 
+BL_ActionCurveList *KX_BlenderSceneConverter::GetActionCurveList(bAction *for_act)
+{
+	BL_ActionCurveList *&curves = m_map_blender_to_actionCurveList[for_act];
+	if (!curves) {
+		curves = new BL_ActionCurveList(for_act);
+	}
+	return curves;
+}
+
 void KX_BlenderSceneConverter::RegisterGameActuator(SCA_IActuator *act, bActuator *for_actuator)
 {
 	m_map_blender_to_gameactuator[for_actuator] = act;
@@ -447,7 +564,9 @@ SCA_IController *KX_BlenderSceneConverter::FindGameController(bController *for_c
 
 void KX_BlenderSceneConverter::RegisterWorldInfo(KX_WorldInfo *worldinfo)
 {
+	m_threadinfo->m_mutex.Lock();
 	m_worldinfos.push_back(pair<KX_Scene *, KX_WorldInfo *> (m_currentScene, worldinfo));
+	m_threadinfo->m_mutex.Unlock();
 }
 
 #ifdef WITH_PYTHON
@@ -471,87 +590,182 @@ Main *KX_BlenderSceneConverter::GetMainDynamicPath(const char *path)
 	return NULL;
 }
 
-void KX_BlenderSceneConverter::MergeAsyncLoads()
+/// Return the first status of highest priority in queue, the end of queue if empty.
+static vector<KX_LibLoadStatus *>::iterator find_highest_priority(vector<KX_LibLoadStatus *>& queue)
 {
-	vector<KX_Scene *> *merge_scenes;
-
-	vector<KX_LibLoadStatus *>::iterator mit;
-	vector<KX_Scene *>::iterator sit;
+	vector<KX_LibLoadStatus *>::iterator best = queue.end();
+	for (vector<KX_LibLoadStatus *>::iterator it = queue.begin(), end = queue.end(); it != end; ++it) {
+		if (best == queue.end() || (*it)->GetPriority() > (*best)->GetPriority()) {
+			best = it;
+		}
+	}
+	return best;
+}
 
+bool KX_BlenderSceneConverter::IsMainLoading(Main *maggie)
+{
 	m_threadinfo->m_mutex.Lock();
+	map<char *, KX_LibLoadStatus *>::iterator it = m_status_map.find(maggie->name);
+	const bool loading = (it != m_status_map.end() && !it->second->IsFinished());
+	m_threadinfo->m_mutex.Unlock();
 
-	for (mit = m_mergequeue.begin(); mit != m_mergequeue.end(); ++mit) {
-		merge_scenes = (vector<KX_Scene *> *)(*mit)->GetData();
+	return loading;
+}
 
-		for (sit=merge_scenes->begin(); sit!=merge_scenes->end(); ++sit) {
-			(*mit)->GetMergeScene()->MergeScene(*sit);
-			delete (*sit);
-		}
+LibraryData *KX_BlenderSceneConverter::GetLibraryData(Main *maggie)
+{
+	map<Main *, LibraryData *>::iterator it = m_libraryData.find(maggie);
+	if (it != m_libraryData.end()) {
+		return it->second;
+	}
 
-		delete merge_scenes;
-		(*mit)->SetData(NULL);
+	LibraryData *data = new LibraryData();
+	m_libraryData[maggie] = data;
+	return data;
+}
 
-		(*mit)->Finish();
+LibraryData *KX_BlenderSceneConverter::FindLibraryData(ID *id)
+{
+	map<ID *, Main *>::iterator ownerit = m_idOwners.find(id);
+	if (ownerit != m_idOwners.end()) {
+		return GetLibraryData(ownerit->second);
 	}
 
-	m_mergequeue.clear();
+	if (!id->lib) {
+		return NULL;
+	}
 
-	m_threadinfo->m_mutex.Unlock();
+	map<Library *, Main *>::iterator libit = m_libraryMains.find(id->lib);
+	if (libit == m_libraryMains.end()) {
+		return NULL;
+	}
+
+	return GetLibraryData(libit->second);
 }
 
-void KX_BlenderSceneConverter::FinalizeAsyncLoads()
+void KX_BlenderSceneConverter::RegisterLibraryMains(Main *maggie)
 {
-	// Finish all loading libraries.
-	if (m_threadinfo) {
-		BLI_task_pool_work_and_wait(m_threadinfo->m_pool);
+	m_threadinfo->m_mutex.Lock();
+	for (Library *lib = (Library *)maggie->library.first; lib; lib = (Library *)lib->id.next) {
+		m_libraryMains[lib] = maggie;
 	}
-	// Merge all libraries data in the current scene, to avoid memory leak of unmerged scenes.
-	MergeAsyncLoads();
+	m_threadinfo->m_mutex.Unlock();
 }
 
-void KX_BlenderSceneConverter::AddScenesToMergeQueue(KX_LibLoadStatus *status)
+void KX_BlenderSceneConverter::MergeAsyncLoads()
 {
-	m_threadinfo->m_mutex.Lock();
-	m_mergequeue.push_back(status);
-	m_threadinfo->m_mutex.Unlock();
+	MergeLibLoads(LIB_LOAD_MERGE_TIME_BUDGET);
 }
 
-static void async_convert(TaskPool *pool, void *ptr, int UNUSED(threadid))
+void KX_BlenderSceneConverter::MergeLibLoads(double timeBudget)
 {
-	KX_Scene *new_scene = NULL;
-	KX_LibLoadStatus *status = (KX_LibLoadStatus *)ptr;
-	vector<Scene *> *scenes = (vector<Scene *> *)status->GetData();
-	vector<KX_Scene *> *merge_scenes = new vector<KX_Scene *>(); // Deleted in MergeAsyncLoads
+	const double starttime = PIL_check_seconds_timer();
+
+	do {
+		m_threadinfo->m_mutex.Lock();
+
+		/* The meshes of a library are converted with the converter state used by the
+		 * scenes conversion, they wait for the end of the conversion task. */
+		vector<KX_LibLoadStatus *>::iterator best = m_mergequeue.end();
+		for (vector<KX_LibLoadStatus *>::iterator it = m_mergequeue.begin(), end = m_mergequeue.end(); it != end; ++it) {
+			AsyncLibLoad *load = (AsyncLibLoad *)(*it)->GetData();
+			if (load->m_idcode == ID_ME && m_threadinfo->m_converting) {
+				continue;
+			}
+			if (best == m_mergequeue.end() || (*it)->GetPriority() > (*best)->GetPriority()) {
+				best = it;
+			}
+		}
+
+		if (best == m_mergequeue.end()) {
+			m_threadinfo->m_mutex.Unlock();
+			break;
+		}
+
+		KX_LibLoadStatus *status = *best;
+		AsyncLibLoad *load = (AsyncLibLoad *)status->GetData();
+		// One scene is merged by step, the library is finished with its last scene.
+		const bool last = (load->m_mergeScenes.size() <= 1);
+		if (last) {
+			m_mergequeue.erase(best);
+		}
+
+		// The merge and the finish callback are done unlocked, the callback could load another library.
+		m_threadinfo->m_mutex.Unlock();
+
+		if (!load->m_mergeScenes.empty()) {
+			KX_Scene *scene = load->m_mergeScenes.front();
+			load->m_mergeScenes.erase(load->m_mergeScenes.begin());
+
+			status->GetMergeScene()->MergeScene(scene);
+			delete scene;
+
+			status->AddProgress(LIB_LOAD_MERGE_PROGRESS / load->m_numScenes);
+		}
+
+		if (last) {
+			if (status->HasFailed()) {
+				DiscardAsyncLoad(status);
+			}
+			else {
+				RegisterLibraryData(load->m_main, load->m_idcode, status->GetMergeScene(), load->m_options);
+			}
+
+			delete load;
+			status->SetData(NULL);
 
-	for (unsigned int i = 0; i < scenes->size(); ++i) {
-		new_scene = status->GetEngine()->CreateScene((*scenes)[i], true);
+			status->Finish();
+		}
+	} while (timeBudget < 0.0 || (PIL_check_seconds_timer() - starttime) < timeBudget);
+}
 
-		if (new_scene)
-			merge_scenes->push_back(new_scene);
+void KX_BlenderSceneConverter::DiscardAsyncLoad(KX_LibLoadStatus *status)
+{
+	AsyncLibLoad *load = (AsyncLibLoad *)status->GetData();
 
-		status->AddProgress((1.0f / scenes->size()) * 0.9f); // We'll call conversion 90% and merging 10% for now
+	vector<Main *>::iterator maggieit = std::find(m_DynamicMaggie.begin(), m_DynamicMaggie.end(), load->m_main);
+	if (maggieit != m_DynamicMaggie.end()) {
+		m_DynamicMaggie.erase(maggieit);
 	}
 
-	delete scenes;
-	status->SetData(merge_scenes);
+	m_threadinfo->m_mutex.Lock();
+	m_status_map.erase(load->m_main->name);
+	m_threadinfo->m_mutex.Unlock();
+
+	// The status is still used by the scripts, only the empty library is freed.
+	m_failedStatuses.push_back(status);
 
-	status->GetConverter()->AddScenesToMergeQueue(status);
+	BKE_main_free(load->m_main);
+	load->m_main = NULL;
 }
 
-KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFileMemory(void *data, int length, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options)
+void KX_BlenderSceneConverter::FinalizeAsyncLoads()
 {
-	BlendHandle *bpy_openlib = BLO_blendhandle_from_memory(data, length);
+	// Finish all loading libraries.
+	if (m_threadinfo) {
+		BLI_task_pool_work_and_wait(m_threadinfo->m_pool);
+	}
+	// Merge all libraries data in the current scene, to avoid memory leak of unmerged scenes.
+	MergeLibLoads(-1.0);
+	// Finish the deferred frees.
+	FreeLibraries(-1.0);
+}
 
-	// Error checking is done in LinkBlendFile
-	return LinkBlendFile(bpy_openlib, path, group, scene_merge, err_str, options);
+void KX_BlenderSceneConverter::AddScenesToMergeQueue(KX_LibLoadStatus *status)
+{
+	m_threadinfo->m_mutex.Lock();
+	m_mergequeue.push_back(status);
+	m_threadinfo->m_mutex.Unlock();
 }
 
-KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFilePath(const char *filepath, char *group, KX_Scene *scene_merge, char **err_str, short options)
+static void async_read(TaskPool *pool, void *ptr, int UNUSED(threadid))
 {
-	BlendHandle *bpy_openlib = BLO_blendhandle_from_file(filepath, NULL);
+	((KX_BlenderSceneConverter *)ptr)->ReadAsyncLoad();
+}
 
-	// Error checking is done in LinkBlendFile
-	return LinkBlendFile(bpy_openlib, filepath, group, scene_merge, err_str, options);
+static void async_convert(TaskPool *pool, void *ptr, int UNUSED(threadid))
+{
+	((KX_BlenderSceneConverter *)ptr)->ConvertAsyncLoads();
 }
 
 static void load_datablocks(Main *main_tmp, BlendHandle *bpy_openlib, const char *path, int idcode)
@@ -571,39 +785,10 @@ static void load_datablocks(Main *main_tmp, BlendHandle *bpy_openlib, const char
 	BLI_linklist_free(names, free);	/* free linklist *and* each node's data */
 }
 
-KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFile(BlendHandle *bpy_openlib, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options)
+/// Link all the data blocks of type idcode of the library into main_newlib and close bpy_openlib.
+static void link_library(Main *main_newlib, BlendHandle *bpy_openlib, const char *path, int idcode, short options)
 {
-	Main *main_newlib; /* stored as a dynamic 'main' until we free it */
-	const int idcode = BKE_idcode_from_name(group);
 	ReportList reports;
-	static char err_local[255];
-
-//	TIMEIT_START(bge_link_blend_file);
-
-	KX_LibLoadStatus *status;
-
-	/* only scene and mesh supported right now */
-	if (idcode != ID_SCE && idcode != ID_ME && idcode != ID_AC) {
-		snprintf(err_local, sizeof(err_local), "invalid ID type given \"%s\"\n", group);
-		*err_str = err_local;
-		BLO_blendhandle_close(bpy_openlib);
-		return NULL;
-	}
-	
-	if (GetMainDynamicPath(path)) {
-		snprintf(err_local, sizeof(err_local), "blend file already open \"%s\"\n", path);
-		*err_str = err_local;
-		BLO_blendhandle_close(bpy_openlib);
-		return NULL;
-	}
-
-	if (bpy_openlib == NULL) {
-		snprintf(err_local, sizeof(err_local), "could not open blendfile \"%s\"\n", path);
-		*err_str = err_local;
-		return NULL;
-	}
-
-	main_newlib = BKE_main_new();
 	BKE_reports_init(&reports, RPT_STORE);
 
 	short flag = 0; /* don't need any special options */
@@ -612,12 +797,12 @@ KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFile(BlendHandle *bpy_openl
 
 	load_datablocks(main_tmp, bpy_openlib, path, idcode);
 
-	if (idcode == ID_SCE && options & LIB_LOAD_LOAD_SCRIPTS) {
+	if (idcode == ID_SCE && options & KX_BlenderSceneConverter::LIB_LOAD_LOAD_SCRIPTS) {
 		load_datablocks(main_tmp, bpy_openlib, path, ID_TXT);
 	}
 
 	/* now do another round of linking for Scenes so all actions are properly loaded */
-	if (idcode == ID_SCE && options & LIB_LOAD_LOAD_ACTIONS) {
+	if (idcode == ID_SCE && options & KX_BlenderSceneConverter::LIB_LOAD_LOAD_ACTIONS) {
 		load_datablocks(main_tmp, bpy_openlib, path, ID_AC);
 	}
 
@@ -627,132 +812,418 @@ KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFile(BlendHandle *bpy_openl
 
 	BKE_reports_clear(&reports);
 	/* done linking */
-	
-	/* needed for lookups*/
-	GetMainDynamic().push_back(main_newlib);
-	BLI_strncpy(main_newlib->name, path, sizeof(main_newlib->name));
-	
-	
-	status = new KX_LibLoadStatus(this, m_ketsjiEngine, scene_merge, path);
+}
 
-	if (idcode == ID_ME) {
-		/* Convert all new meshes into BGE meshes */
-		ID *mesh;
-	
-		for (mesh = (ID *)main_newlib->mesh.first; mesh; mesh = (ID *)mesh->next ) {
-			if (options & LIB_LOAD_VERBOSE)
-				printf("MeshName: %s\n", mesh->name + 2);
-			RAS_MeshObject *meshobj = BL_ConvertMesh((Mesh *)mesh, NULL, scene_merge, this, false); // For now only use the libloading option for scenes, which need to handle materials/shaders
-			scene_merge->GetLogicManager()->RegisterMeshName(meshobj->GetName(), meshobj);
-		}
+/// Read the library file by chunks, counting the read bytes in the status.
+static void *read_library_file(const char *path, KX_LibLoadStatus *status, int *r_length)
+{
+	const int length = status->GetTotalBytes();
+	if (length <= 0) {
+		return NULL;
 	}
-	else if (idcode == ID_AC) {
-		/* Convert all actions */
-		ID *action;
 
-		for (action= (ID *)main_newlib->action.first; action; action = (ID *)action->next) {
-			if (options & LIB_LOAD_VERBOSE)
-				printf("ActionName: %s\n", action->name + 2);
-			scene_merge->GetLogicManager()->RegisterActionName(action->name + 2, action);
-		}
+	FILE *file = BLI_fopen(path, "rb");
+	if (!file) {
+		return NULL;
 	}
-	else if (idcode == ID_SCE) {
-		/* Merge all new linked in scene into the existing one */
-		ID *scene;
-		// scenes gets deleted by the thread when it's done using it (look in async_convert())
-		vector<Scene *> *scenes = (options & LIB_LOAD_ASYNC) ? new vector<Scene *>() : NULL;
-
-		for (scene = (ID *)main_newlib->scene.first; scene; scene = (ID *)scene->next ) {
-			if (options & LIB_LOAD_VERBOSE)
-				printf("SceneName: %s\n", scene->name + 2);
-			
-			if (options & LIB_LOAD_ASYNC) {
-				scenes->push_back((Scene *)scene);
-			} 
-			else {
-				/* merge into the base  scene */
-				KX_Scene* other = m_ketsjiEngine->CreateScene((Scene *)scene, true);
-				scene_merge->MergeScene(other);
-			
-				// RemoveScene(other); // Don't run this, it frees the entire scene converter data, just delete the scene
-				delete other;
-			}
-		}
 
-		if (options & LIB_LOAD_ASYNC) {
-			status->SetData(scenes);
-			BLI_task_pool_push(m_threadinfo->m_pool, async_convert, (void *)status, false, TASK_PRIORITY_LOW);
+	char *data = (char *)MEM_mallocN(length, "KX_BlenderSceneConverter library");
+	int offset = 0;
+	while (offset < length) {
+		const int chunk = min_ii(LIB_LOAD_READ_CHUNK_SIZE, length - offset);
+		if (fread(data + offset, 1, chunk, file) != (size_t)chunk) {
+			break;
 		}
+		offset += chunk;
 
-#ifdef WITH_PYTHON
-		/* Handle any text datablocks */
-		if (options & LIB_LOAD_LOAD_SCRIPTS)
-			addImportMain(main_newlib);
-#endif
-
-		/* Now handle all the actions */
-		if (options & LIB_LOAD_LOAD_ACTIONS) {
-			ID *action;
-
-			for (action = (ID *)main_newlib->action.first; action; action = (ID *)action->next) {
-				if (options & LIB_LOAD_VERBOSE)
-					printf("ActionName: %s\n", action->name + 2);
-				scene_merge->GetLogicManager()->RegisterActionName(action->name + 2, action);
-			}
-		}
+		status->AddLoadedBytes(chunk);
+		status->AddProgress(LIB_LOAD_READ_PROGRESS * chunk / length);
 	}
 
-	if (!(options & LIB_LOAD_ASYNC))
-		status->Finish();
+	fclose(file);
 
-//	TIMEIT_END(bge_link_blend_file);
+	if (offset != length) {
+		MEM_freeN(data);
+		return NULL;
+	}
 
-	m_status_map[main_newlib->name] = status;
-	return status;
+	*r_length = length;
+	return data;
 }
 
-/* Note m_map_*** are all ok and don't need to be freed
- * most are temp and NewRemoveObject frees m_map_gameobject_to_blender */
-bool KX_BlenderSceneConverter::FreeBlendFile(Main *maggie)
+void KX_BlenderSceneConverter::ReadAsyncLoad()
 {
-	int maggie_index = -1;
-	int i = 0;
-
-	if (maggie == NULL)
-		return false;
+	// A read task is pushed for each library added to the read queue.
+	m_threadinfo->m_mutex.Lock();
+	vector<KX_LibLoadStatus *>::iterator it = find_highest_priority(m_threadinfo->m_readqueue);
+	KX_LibLoadStatus *status = *it;
+	m_threadinfo->m_readqueue.erase(it);
+	m_threadinfo->m_mutex.Unlock();
 
-	// If the given library is currently in loading, we do nothing.
-	if (m_status_map.count(maggie->name)) {
-		m_threadinfo->m_mutex.Lock();
-		const bool finished = m_status_map[maggie->name]->IsFinished();
-		m_threadinfo->m_mutex.Unlock();
+	AsyncLibLoad *load = (AsyncLibLoad *)status->GetData();
+	const char *path = load->m_main->name;
 
-		if (!finished) {
-			printf("Library (%s) is currently being loaded asynchronously, and cannot be freed until this process is done\n", maggie->name);
-			return false;
-		}
+	if (!load->m_data) {
+		load->m_data = read_library_file(path, status, &load->m_length);
 	}
 
-	/* tag all false except the one we remove */
-	for (vector<Main *>::iterator it = m_DynamicMaggie.begin(); !(it == m_DynamicMaggie.end()); it++) {
-		Main *main = *it;
-		if (main != maggie) {
-			BKE_main_id_tag_all(main, LIB_TAG_DOIT, false);
-		}
-		else {
-			maggie_index = i;
-		}
-		i++;
+	BlendHandle *bpy_openlib = (load->m_data) ? BLO_blendhandle_from_memory(load->m_data, load->m_length) : NULL;
+	if (!bpy_openlib) {
+		MEM_SAFE_FREE(load->m_data);
+
+		// The failed load is finished by the merge, which frees its main on the main thread.
+		char err_local[255];
+		snprintf(err_local, sizeof(err_local), "could not open blendfile \"%s\"", path);
+		printf("Library (%s) could not be read\n", path);
+		status->SetError(err_local);
+		AddScenesToMergeQueue(status);
+		return;
 	}
 
-	/* should never happen but just to be safe */
-	if (maggie_index == -1)
+	link_library(load->m_main, bpy_openlib, path, load->m_idcode, load->m_options);
+	// Same as the tagging in the converter constructor, the main is free of any DOIT tags.
+	BKE_main_id_tag_all(load->m_main, LIB_TAG_DOIT, false);
+	RegisterLibraryMains(load->m_main);
+
+	MEM_SAFE_FREE(load->m_data);
+
+	if (load->m_idcode != ID_SCE) {
+		// The meshes and actions are only registered by the merge.
+		AddScenesToMergeQueue(status);
+		return;
+	}
+
+	for (ID *scene = (ID *)load->m_main->scene.first; scene; scene = (ID *)scene->next) {
+		if (load->m_options & LIB_LOAD_VERBOSE)
+			printf("SceneName: %s\n", scene->name + 2);
+		load->m_scenes.push_back((Scene *)scene);
+	}
+
+	m_threadinfo->m_mutex.Lock();
+	m_threadinfo->m_convertqueue.push_back(status);
+	const bool convert = !m_threadinfo->m_converting;
+	m_threadinfo->m_converting = true;
+	m_threadinfo->m_mutex.Unlock();
+
+	if (convert) {
+		BLI_task_pool_push(m_threadinfo->m_pool, async_convert, (void *)this, false, TASK_PRIORITY_LOW);
+	}
+}
+
+void KX_BlenderSceneConverter::ConvertAsyncLoads()
+{
+	while (true) {
+		m_threadinfo->m_mutex.Lock();
+		vector<KX_LibLoadStatus *>::iterator it = find_highest_priority(m_threadinfo->m_convertqueue);
+		if (it == m_threadinfo->m_convertqueue.end()) {
+			m_threadinfo->m_converting = false;
+			m_threadinfo->m_mutex.Unlock();
+			return;
+		}
+		KX_LibLoadStatus *status = *it;
+		m_threadinfo->m_convertqueue.erase(it);
+		m_threadinfo->m_mutex.Unlock();
+
+		AsyncLibLoad *load = (AsyncLibLoad *)status->GetData();
+		const unsigned int numscenes = load->m_scenes.size();
+
+		for (unsigned int i = 0; i < numscenes; ++i) {
+			KX_Scene *new_scene = m_ketsjiEngine->CreateScene(load->m_scenes[i], true);
+
+			if (new_scene)
+				load->m_mergeScenes.push_back(new_scene);
+
+			status->AddProgress(LIB_LOAD_CONVERT_PROGRESS / numscenes);
+		}
+
+		load->m_scenes.clear();
+		load->m_numScenes = load->m_mergeScenes.size();
+
+		AddScenesToMergeQueue(status);
+	}
+}
+
+KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFileMemory(void *data, int length, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options, int priority)
+{
+	if (options & LIB_LOAD_ASYNC) {
+		return LinkBlendFileAsync(data, length, path, group, scene_merge, err_str, options, priority);
+	}
+
+	BlendHandle *bpy_openlib = BLO_blendhandle_from_memory(data, length);
+
+	// Error checking is done in LinkBlendFile
+	KX_LibLoadStatus *status = LinkBlendFile(bpy_openlib, path, group, scene_merge, err_str, options);
+	if (status) {
+		status->SetTotalBytes(length);
+		status->AddLoadedBytes(length);
+	}
+	return status;
+}
+
+KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFilePath(const char *filepath, char *group, KX_Scene *scene_merge, char **err_str, short options, int priority)
+{
+	if (options & LIB_LOAD_ASYNC) {
+		return LinkBlendFileAsync(NULL, 0, filepath, group, scene_merge, err_str, options, priority);
+	}
+
+	BlendHandle *bpy_openlib = BLO_blendhandle_from_file(filepath, NULL);
+
+	// Error checking is done in LinkBlendFile
+	KX_LibLoadStatus *status = LinkBlendFile(bpy_openlib, filepath, group, scene_merge, err_str, options);
+	if (status) {
+		const int length = (int)BLI_file_size(filepath);
+		status->SetTotalBytes(length);
+		status->AddLoadedBytes(length);
+	}
+	return status;
+}
+
+void KX_BlenderSceneConverter::RegisterLibraryData(Main *main_newlib, int idcode, KX_Scene *scene_merge, short options)
+{
+	if (idcode == ID_ME) {
+		/* Convert all new meshes into BGE meshes */
+		ID *mesh;
+	
+		for (mesh = (ID *)main_newlib->mesh.first; mesh; mesh = (ID *)mesh->next ) {
+			if (options & LIB_LOAD_VERBOSE)
+				printf("MeshName: %s\n", mesh->name + 2);
+			RAS_MeshObject *meshobj = BL_ConvertMesh((Mesh *)mesh, NULL, scene_merge, this, false); // For now only use the libloading option for scenes, which need to handle materials/shaders
+			scene_merge->GetLogicManager()->RegisterMeshName(meshobj->GetName(), meshobj);
+		}
+	}
+	/* Convert all actions, also the actions of the scenes if asked */
+	else if (idcode == ID_AC || (idcode == ID_SCE && options & LIB_LOAD_LOAD_ACTIONS)) {
+		ID *action;
+
+		for (action= (ID *)main_newlib->action.first; action; action = (ID *)action->next) {
+			if (options & LIB_LOAD_VERBOSE)
+				printf("ActionName: %s\n", action->name + 2);
+			scene_merge->GetLogicManager()->RegisterActionName(action->name + 2, action);
+		}
+	}
+
+#ifdef WITH_PYTHON
+	/* Handle any text datablocks */
+	if (idcode == ID_SCE && options & LIB_LOAD_LOAD_SCRIPTS)
+		addImportMain(main_newlib);
+#endif
+}
+
+bool KX_BlenderSceneConverter::CheckLinkBlendFile(const char *path, char *group, int idcode, char **err_str)
+{
+	static char err_local[255];
+
+	/* only scene and mesh supported right now */
+	if (idcode != ID_SCE && idcode != ID_ME && idcode != ID_AC) {
+		snprintf(err_local, sizeof(err_local), "invalid ID type given \"%s\"\n", group);
+		*err_str = err_local;
 		return false;
+	}
+	
+	if (GetMainDynamicPath(path)) {
+		snprintf(err_local, sizeof(err_local), "blend file already open \"%s\"\n", path);
+		*err_str = err_local;
+		return false;
+	}
+
+	return true;
+}
+
+KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFileAsync(void *data, int length, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options, int priority)
+{
+	const int idcode = BKE_idcode_from_name(group);
+	static char err_local[255];
+
+	if (!CheckLinkBlendFile(path, group, idcode, err_str)) {
+		return NULL;
+	}
+
+	// The file is read by the task, only its size is checked now.
+	if (!data) {
+		const size_t size = BLI_file_size(path);
+		if (size == (size_t)-1 || size > INT_MAX) {
+			snprintf(err_local, sizeof(err_local), "could not open blendfile \"%s\"\n", path);
+			*err_str = err_local;
+			return NULL;
+		}
+		length = (int)size;
+	}
+
+	/* The main is added now for the lookups, it is filled by the read task and
+	 * left alone by the converter until the load is finished, see IsMainLoading(). */
+	Main *main_newlib = BKE_main_new();
+	GetMainDynamic().push_back(main_newlib);
+	BLI_strncpy(main_newlib->name, path, sizeof(main_newlib->name));
+
+	KX_LibLoadStatus *status = new KX_LibLoadStatus(this, m_ketsjiEngine, scene_merge, path);
+	status->SetTotalBytes(length);
+	status->SetPriority(priority);
+
+	AsyncLibLoad *load = new AsyncLibLoad(); // Deleted in MergeLibLoads
+	load->m_main = main_newlib;
+	load->m_idcode = idcode;
+	load->m_options = options;
+	load->m_data = NULL;
+	load->m_length = length;
+	load->m_numScenes = 0;
+
+	if (data) {
+		// The data given by Python is released when LibLoad returns.
+		load->m_data = MEM_mallocN(length, "KX_BlenderSceneConverter library");
+		memcpy(load->m_data, data, length);
+		status->AddLoadedBytes(length);
+		status->AddProgress(LIB_LOAD_READ_PROGRESS);
+	}
+
+	status->SetData(load);
+
+	m_threadinfo->m_mutex.Lock();
+	m_status_map[main_newlib->name] = status;
+	m_threadinfo->m_readqueue.push_back(status);
+	m_threadinfo->m_mutex.Unlock();
+
+	BLI_task_pool_push(m_threadinfo->m_pool, async_read, (void *)this, false, TASK_PRIORITY_LOW);
+
+	return status;
+}
+
+KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFile(BlendHandle *bpy_openlib, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options)
+{
+	Main *main_newlib; /* stored as a dynamic 'main' until we free it */
+	const int idcode = BKE_idcode_from_name(group);
+	static char err_local[255];
+
+//	TIMEIT_START(bge_link_blend_file);
+
+	KX_LibLoadStatus *status;
+
+	if (!CheckLinkBlendFile(path, group, idcode, err_str)) {
+		BLO_blendhandle_close(bpy_openlib);
+		return NULL;
+	}
+
+	if (bpy_openlib == NULL) {
+		snprintf(err_local, sizeof(err_local), "could not open blendfile \"%s\"\n", path);
+		*err_str = err_local;
+		return NULL;
+	}
+
+	main_newlib = BKE_main_new();
+
+	link_library(main_newlib, bpy_openlib, path, idcode, options);
+	// Same as the tagging in the converter constructor, the main is free of any DOIT tags.
+	BKE_main_id_tag_all(main_newlib, LIB_TAG_DOIT, false);
+	RegisterLibraryMains(main_newlib);
+
+	/* needed for lookups*/
+	GetMainDynamic().push_back(main_newlib);
+	BLI_strncpy(main_newlib->name, path, sizeof(main_newlib->name));
+	
+	
+	status = new KX_LibLoadStatus(this, m_ketsjiEngine, scene_merge, path);
+
+	if (idcode == ID_SCE) {
+		/* Merge all new linked in scene into the existing one */
+		ID *scene;
+
+		for (scene = (ID *)main_newlib->scene.first; scene; scene = (ID *)scene->next ) {
+			if (options & LIB_LOAD_VERBOSE)
+				printf("SceneName: %s\n", scene->name + 2);
+			
+			/* merge into the base  scene */
+			KX_Scene* other = m_ketsjiEngine->CreateScene((Scene *)scene, true);
+			scene_merge->MergeScene(other);
+		
+			// RemoveScene(other); // Don't run this, it frees the entire scene converter data, just delete the scene
+			delete other;
+		}
+	}
+
+	RegisterLibraryData(main_newlib, idcode, scene_merge, options);
+
+	status->Finish();
+
+//	TIMEIT_END(bge_link_blend_file);
+
+	m_threadinfo->m_mutex.Lock();
+	m_status_map[main_newlib->name] = status;
+	m_threadinfo->m_mutex.Unlock();
+	return status;
+}
+
+/* Note m_map_*** are all ok and don't need to be freed
+ * most are temp and NewRemoveObject frees m_map_gameobject_to_blender */
+bool KX_BlenderSceneConverter::FreeBlendFile(Main *maggie, bool deferred)
+{
+	if (maggie == NULL)
+		return false;
+
+	// If the given library is currently in loading, we do nothing.
+	if (IsMainLoading(maggie)) {
+		printf("Library (%s) is currently being loaded asynchronously, and cannot be freed until this process is done\n", maggie->name);
+		return false;
+	}
+
+	vector<Main *>::iterator maggieit = std::find(m_DynamicMaggie.begin(), m_DynamicMaggie.end(), maggie);
+
+	/* should never happen but just to be safe */
+	if (maggieit == m_DynamicMaggie.end())
+		return false;
+
+	m_DynamicMaggie.erase(maggieit);
+
+	BeginFreeLibrary(maggie);
+
+	if (deferred) {
+		m_freequeue.push_back(maggie);
+	}
+	else {
+		FreeLibraryObjects(maggie, -1.0);
+		EndFreeLibrary(maggie);
+	}
+
+	return true;
+}
 
-	m_DynamicMaggie.erase(m_DynamicMaggie.begin() + maggie_index);
+bool KX_BlenderSceneConverter::FreeBlendFile(const char *path, bool deferred)
+{
+	return FreeBlendFile(GetMainDynamicPath(path), deferred);
+}
+
+void KX_BlenderSceneConverter::FreeDeferredLibraries()
+{
+	FreeLibraries(LIB_FREE_TIME_BUDGET);
+}
+
+void KX_BlenderSceneConverter::FreeLibraries(double timeBudget)
+{
+	const double endtime = (timeBudget < 0.0) ? -1.0 : PIL_check_seconds_timer() + timeBudget;
+
+	while (!m_freequeue.empty()) {
+		Main *maggie = m_freequeue.front();
+		if (!FreeLibraryObjects(maggie, endtime)) {
+			break;
+		}
+
+		m_freequeue.erase(m_freequeue.begin());
+		EndFreeLibrary(maggie);
+
+		if (endtime >= 0.0 && PIL_check_seconds_timer() > endtime) {
+			break;
+		}
+	}
+}
+
+void KX_BlenderSceneConverter::BeginFreeLibrary(Main *maggie)
+{
+	/* Only the data of the library is tagged, the other libraries are free of tags:
+	 * they are cleared once linked and after their use by the converter. */
 	BKE_main_id_tag_all(maggie, LIB_TAG_DOIT, true);
 
-	/* free all tagged objects */
+	m_threadinfo->m_mutex.Lock();
+	LibraryData *data = GetLibraryData(maggie);
+	m_threadinfo->m_mutex.Unlock();
+
 	CListValue *scenes = m_ketsjiEngine->CurrentScenes();
 	int numScenes = scenes->GetCount();
 
@@ -760,126 +1231,236 @@ bool KX_BlenderSceneConverter::FreeBlendFile(Main *maggie)
 		KX_Scene *scene = (KX_Scene *)scenes->GetValue(sce_idx);
 		if (IS_TAGGED(scene->GetBlenderScene())) {
 			m_ketsjiEngine->RemoveScene(scene->GetName());
+			m_threadinfo->m_mutex.Lock();
 			m_polymat_cache.erase(scene);
+			m_threadinfo->m_mutex.Unlock();
 			sce_idx--;
 			numScenes--;
 		}
 		else {
 			/* in case the mesh might be refered to later */
+			std::map<STR_HashedString, void *> &mapStringToMeshes = scene->GetLogicManager()->GetMeshMap();
+
+			for (vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit = data->m_meshobjects.begin(),
+				 meshend = data->m_meshobjects.end(); meshit != meshend; ++meshit)
 			{
-				std::map<STR_HashedString, void *> &mapStringToMeshes = scene->GetLogicManager()->GetMeshMap();
-				
-				for (std::map<STR_HashedString, void *>::iterator it = mapStringToMeshes.begin(),
-					 end = mapStringToMeshes.end(); it != end;)
-				{
-					RAS_MeshObject *meshobj = (RAS_MeshObject *)it->second;
-					if (meshobj && IS_TAGGED(meshobj->GetMesh())) {
-						m_map_mesh_to_gamemesh.erase(meshobj->GetMesh());
-						mapStringToMeshes.erase(it++);
-					}
-					else {
-						++it;
-					}
+				std::map<STR_HashedString, void *>::iterator it = mapStringToMeshes.find(meshit->second->GetName());
+				if (it != mapStringToMeshes.end() && it->second == meshit->second) {
+					mapStringToMeshes.erase(it);
 				}
 			}
 
 			/* Now unregister actions */
-			{
-				std::map<STR_HashedString, void *> &mapStringToActions = scene->GetLogicManager()->GetActionMap();
+			std::map<STR_HashedString, void *> &mapStringToActions = scene->GetLogicManager()->GetActionMap();
 
-				for (std::map<STR_HashedString, void *>::iterator it = mapStringToActions.begin(),
-					 end = mapStringToActions.end(); it != end;)
-				{
-					ID *action = (ID *)it->second;
+			for (ID *action = (ID *)maggie->action.first; action; action = (ID *)action->next) {
+				std::map<STR_HashedString, void *>::iterator it = mapStringToActions.find(STR_String(action->name + 2));
+				if (it != mapStringToActions.end() && it->second == action) {
+					mapStringToActions.erase(it);
+				}
+			}
+		}
+	}
 
-					if (IS_TAGGED(action)) {
-						m_map_blender_to_gameAdtList.erase((bAction *)action);
-						mapStringToActions.erase(it++);
-					}
-					else {
-						++it;
-					}
+#ifdef WITH_PYTHON
+	/* make sure this maggie is removed from the import list if it's there
+	 * (this operation is safe if it isn't in the list) */
+	removeImportMain(maggie);
+#endif
+}
+
+bool KX_BlenderSceneConverter::FreeLibraryObjects(Main *maggie, double endtime)
+{
+	m_threadinfo->m_mutex.Lock();
+	LibraryData *data = GetLibraryData(maggie);
+	m_threadinfo->m_mutex.Unlock();
+
+	while (!data->m_objects.Empty()) {
+		KX_GameObject *gameobj = static_cast<KX_LibraryObjectLink *>(data->m_objects.Remove())->m_gameobject;
+
+		/* The objects removed from their scene but still referenced have no node,
+		 * the objects of the removed scenes of the library are freed with them. */
+		if (gameobj->GetSGNode()) {
+			KX_Scene *scene = gameobj->GetScene();
+			if (!IS_TAGGED(scene->GetBlenderScene())) {
+				/* Eventually calls RemoveNodeDestructObject, the children
+				 * are removed too and unlinked from the list once deleted. */
+				scene->RemoveObject(gameobj);
+			}
+		}
+
+		if (endtime >= 0.0 && PIL_check_seconds_timer() > endtime) {
+			return data->m_objects.Empty();
+		}
+	}
+
+	return true;
+}
+
+void KX_BlenderSceneConverter::EndFreeLibrary(Main *maggie)
+{
+	// Some tags could have been cleared since the start of a deferred free.
+	BKE_main_id_tag_all(maggie, LIB_TAG_DOIT, true);
+
+	m_threadinfo->m_mutex.Lock();
+	LibraryData *data = GetLibraryData(maggie);
+	m_libraryData.erase(maggie);
+	m_threadinfo->m_mutex.Unlock();
+
+	CListValue *scenes = m_ketsjiEngine->CurrentScenes();
+
+	/* The objects of the main file and of the other libraries using the
+	 * meshes and the materials of the library, found through their mesh slots. */
+	std::set<KX_GameObject *> users;
+
+	for (vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit = data->m_meshobjects.begin(),
+		 meshend = data->m_meshobjects.end(); meshit != meshend; ++meshit)
+	{
+		RAS_MeshObject *meshobj = meshit->second;
+		for (int i = 0, nummat = meshobj->NumMaterials(); i < nummat; ++i) {
+			RAS_MeshMaterial *meshmat = meshobj->GetMeshMaterial(i);
+			for (std::map<void *, RAS_MeshSlot *>::iterator it = meshmat->m_slots.begin(), end = meshmat->m_slots.end();
+				 it != end; ++it)
+			{
+				users.insert(KX_GameObject::GetClientObject((KX_ClientObjectInfo *)it->first));
+			}
+		}
+	}
+
+	for (vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator polymit = data->m_polymaterials.begin(),
+		 polymend = data->m_polymaterials.end(); polymit != polymend; ++polymit)
+	{
+		RAS_BucketManager::BucketList& buckets = polymit->first->GetBucketManager()->GetBuckets();
+		for (RAS_BucketManager::BucketList::iterator bit = buckets.begin(), bend = buckets.end(); bit != bend; ++bit) {
+			RAS_MaterialBucket *bucket = *bit;
+			if (bucket->GetPolyMaterial() != polymit->second) {
+				continue;
+			}
+			for (RAS_MeshSlotList::iterator msit = bucket->msBegin(), msend = bucket->msEnd(); msit != msend; ++msit) {
+				RAS_MeshUser *meshUser = (*msit)->m_meshUser;
+				if (meshUser) {
+					users.insert(KX_GameObject::GetClientObject((KX_ClientObjectInfo *)meshUser->GetClientObject()));
 				}
 			}
-			
-			//scene->FreeTagged(); /* removed tagged objects and meshes*/
+		}
+	}
+
+	// The client info of a mesh slot without an object is NULL.
+	users.erase(NULL);
+
+	for (std::set<KX_GameObject *>::iterator it = users.begin(), end = users.end(); it != end; ++it) {
+		(*it)->RemoveMeshes(); /* XXX - slack, should only remove meshes that are library items but mostly objects only have 1 mesh */
+	}
+
+	/* The users of the actions aren't known, the objects are only visited
+	 * for a library with actions. */
+	if (maggie->action.first) {
+		for (CListValue::iterator sceit = scenes->GetBegin(), sceend = scenes->GetEnd(); sceit != sceend; ++sceit) {
+			KX_Scene *scene = (KX_Scene *)*sceit;
 			CListValue *obj_lists[] = {scene->GetObjectList(), scene->GetInactiveList(), NULL};
 
 			for (int ob_ls_idx = 0; obj_lists[ob_ls_idx]; ob_ls_idx++) {
 				CListValue *obs = obj_lists[ob_ls_idx];
-				RAS_MeshObject *mesh;
 
 				for (int ob_idx = 0; ob_idx < obs->GetCount(); ob_idx++) {
-					KX_GameObject *gameobj = (KX_GameObject*)obs->GetValue(ob_idx);
-					if (IS_TAGGED(gameobj->GetBlenderObject())) {
-						int size_before = obs->GetCount();
-
-						/* Eventually calls RemoveNodeDestructObject
-						 * frees m_map_gameobject_to_blender from UnregisterGameObject */
-						scene->RemoveObject(gameobj);
-
-						if (size_before != obs->GetCount())
-							ob_idx--;
-						else {
-							printf("ERROR COULD NOT REMOVE \"%s\"\n", gameobj->GetName().ReadPtr());
+					KX_GameObject *gameobj = (KX_GameObject *)obs->GetValue(ob_idx);
+					gameobj->RemoveTaggedActions();
+
+					/* make sure action actuators are not referencing tagged actions */
+					for (unsigned int act_idx = 0; act_idx < gameobj->GetActuators().size(); act_idx++) {
+						if (gameobj->GetActuators()[act_idx]->IsType(SCA_IActuator::KX_ACT_ACTION)) {
+							BL_ActionActuator *act = (BL_ActionActuator *)gameobj->GetActuators()[act_idx];
+							if (IS_TAGGED(act->GetAction()))
+								act->SetAction(NULL);
 						}
 					}
-					else {
-						gameobj->RemoveTaggedActions();
-						/* free the mesh, we could be referecing a linked one! */
-						int mesh_index = gameobj->GetMeshCount();
-						while (mesh_index--) {
-							mesh = gameobj->GetMesh(mesh_index);
-							if (IS_TAGGED(mesh->GetMesh())) {
-								gameobj->RemoveMeshes(); /* XXX - slack, should only remove meshes that are library items but mostly objects only have 1 mesh */
-								break;
-							}
-							else {
-								/* also free the mesh if it's using a tagged material */
-								int mat_index = mesh->NumMaterials();
-								while (mat_index--) {
-									if (IS_TAGGED(mesh->GetMeshMaterial(mat_index)->m_bucket->GetPolyMaterial()->GetBlenderMaterial())) {
-										gameobj->RemoveMeshes(); /* XXX - slack, same as above */
-										break;
-									}
-								}
-							}
-						}
+				}
+			}
+		}
 
-						/* make sure action actuators are not referencing tagged actions */
-						for (unsigned int act_idx = 0; act_idx < gameobj->GetActuators().size(); act_idx++) {
-							if (gameobj->GetActuators()[act_idx]->IsType(SCA_IActuator::KX_ACT_ACTION)) {
-								BL_ActionActuator *act = (BL_ActionActuator *)gameobj->GetActuators()[act_idx];
-								if (IS_TAGGED(act->GetAction()))
-									act->SetAction(NULL);
-							}
-						}
-					}
+		for (ID *action = (ID *)maggie->action.first; action; action = (ID *)action->next) {
+			m_map_blender_to_gameAdtList.erase((bAction *)action);
+
+			std::map<bAction *, BL_ActionCurveList *>::iterator curveit =
+				m_map_blender_to_actionCurveList.find((bAction *)action);
+			if (curveit != m_map_blender_to_actionCurveList.end()) {
+				delete curveit->second;
+				m_map_blender_to_actionCurveList.erase(curveit);
+			}
+		}
+	}
+
+	/* Before deleting the mesh objects, make sure the rasterizer is no longer referencing them.
+	 * The buckets of the materials of the library are removed with their mesh slots. */
+	std::set<RAS_IPolyMaterial *> polymats;
+	for (vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator polymit = data->m_polymaterials.begin(),
+		 polymend = data->m_polymaterials.end(); polymit != polymend; ++polymit)
+	{
+		polymats.insert(polymit->second);
+	}
+
+	for (vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit = data->m_meshobjects.begin(),
+		 meshend = data->m_meshobjects.end(); meshit != meshend; ++meshit)
+	{
+		RAS_MeshObject *meshobj = meshit->second;
+		for (int i = 0, nummat = meshobj->NumMaterials(); i < nummat; ++i) {
+			RAS_MaterialBucket *bucket = meshobj->GetMeshMaterial(i)->m_bucket;
+			if (polymats.count(bucket->GetPolyMaterial())) {
+				continue;
+			}
+
+			RAS_MeshSlotList slots;
+			for (RAS_MeshSlotList::iterator msit = bucket->msBegin(), msend = bucket->msEnd(); msit != msend; ++msit) {
+				if ((*msit)->m_mesh == meshobj) {
+					slots.push_back(*msit);
 				}
 			}
+			for (RAS_MeshSlotList::iterator msit = slots.begin(), msend = slots.end(); msit != msend; ++msit) {
+				bucket->RemoveMesh(*msit);
+			}
 		}
 	}
 
-	int size;
+	for (vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator polymit = data->m_polymaterials.begin(),
+		 polymend = data->m_polymaterials.end(); polymit != polymend; ++polymit)
+	{
+		/* only remove from bucket */
+		polymit->first->GetBucketManager()->RemoveMaterial(polymit->second);
+	}
 
-	// delete the entities of this scene
-	/* TODO - */
-#if 0
-	vector<pair<KX_Scene*,KX_WorldInfo*> >::iterator worldit;
-	size = m_worldinfos.size();
-	for (i=0, worldit=m_worldinfos.begin(); i<size; ) {
-		if ((*worldit).second) {
-			delete (*worldit).second;
-			*worldit = m_worldinfos.back();
-			m_worldinfos.pop_back();
-			size--;
-		} else {
-			i++;
-			worldit++;
+	m_threadinfo->m_mutex.Lock();
+
+	for (vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator polymit = data->m_polymaterials.begin(),
+		 polymend = data->m_polymaterials.end(); polymit != polymend; ++polymit)
+	{
+		// Remove the poly material coresponding to this Blender Material.
+		m_polymat_cache[polymit->first].erase(polymit->second->GetBlenderMaterial());
+		delete polymit->second;
+	}
+
+	for (vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit = data->m_meshobjects.begin(),
+		 meshend = data->m_meshobjects.end(); meshit != meshend; ++meshit)
+	{
+		m_map_mesh_to_gamemesh.erase(meshit->second->GetMesh());
+		delete meshit->second;
+	}
+
+	for (Library *lib = (Library *)maggie->library.first; lib; lib = (Library *)lib->id.next) {
+		m_libraryMains.erase(lib);
+	}
+
+	for (map<ID *, Main *>::iterator it = m_idOwners.begin(), end = m_idOwners.end(); it != end; ) {
+		if (it->second == maggie) {
+			m_idOwners.erase(it++);
+		}
+		else {
+			++it;
 		}
 	}
-#endif
 
+	m_threadinfo->m_mutex.Unlock();
+
+	delete data;
 
 	/* Worlds don't reference original blender data so we need to make a set from them */
 	typedef std::set<KX_WorldInfo *> KX_WorldInfoSet;
@@ -891,7 +1472,7 @@ bool KX_BlenderSceneConverter::FreeBlendFile(Main *maggie)
 	}
 
 	vector<pair<KX_Scene *, KX_WorldInfo *> >::iterator worldit;
-	size = m_worldinfos.size();
+	int i, size = m_worldinfos.size();
 	for (i = 0, worldit = m_worldinfos.begin(); i < size;) {
 		if (worldit->second && (worldset.count(worldit->second)) == 0) {
 			delete worldit->second;
@@ -907,129 +1488,57 @@ bool KX_BlenderSceneConverter::FreeBlendFile(Main *maggie)
 	worldset.clear();
 	/* done freeing the worlds */
 
-	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator polymit;
-	size = m_polymaterials.size();
-
-	for (i = 0, polymit = m_polymaterials.begin(); i < size; ) {
-		RAS_IPolyMaterial *mat = polymit->second;
-		Material *bmat = NULL;
-
-		bmat = mat->GetBlenderMaterial();
-
-		if (IS_TAGGED(bmat)) {
-			/* only remove from bucket */
-			polymit->first->GetBucketManager()->RemoveMaterial(mat);
-		}
-
-		i++;
-		polymit++;
-	}
-
-	for (i = 0, polymit = m_polymaterials.begin(); i < size; ) {
-		RAS_IPolyMaterial *mat = polymit->second;
-		Material *bmat = NULL;
-
-		bmat = mat->GetBlenderMaterial();
-
-		if (IS_TAGGED(bmat)) {
-			// Remove the poly material coresponding to this Blender Material.
-			m_polymat_cache[polymit->first].erase(bmat);
-			delete polymit->second;
-			*polymit = m_polymaterials.back();
-			m_polymaterials.pop_back();
-			size--;
-		} else {
-			i++;
-			polymit++;
-		}
-	}
-
-	vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit;
-	RAS_BucketManager::BucketList::iterator bit;
-	RAS_MeshSlotList::iterator msit;
-	RAS_BucketManager::BucketList buckets;
-
-	size = m_meshobjects.size();
-	for (i = 0, meshit = m_meshobjects.begin(); i < size;) {
-		RAS_MeshObject *me = meshit->second;
-		if (IS_TAGGED(me->GetMesh())) {
-			// Before deleting the mesh object, make sure the rasterizer is
-			// no longer referencing it.
-			buckets = meshit->first->GetBucketManager()->GetBuckets();
-			for (bit = buckets.begin(); bit != buckets.end(); bit++) {
-				msit = (*bit)->msBegin();
-
-				while (msit != (*bit)->msEnd()) {
-					if ((*msit)->m_mesh == meshit->second)
-						(*bit)->RemoveMesh(*msit++);
-					else
-						msit++;
-				}
-			}
-
-			// Now it should be safe to delete
-			delete meshit->second;
-			*meshit = m_meshobjects.back();
-			m_meshobjects.pop_back();
-			size--;
-		} 
-		else {
-			i++;
-			meshit++;
-		}
+	m_threadinfo->m_mutex.Lock();
+	map<char *, KX_LibLoadStatus *>::iterator statusit = m_status_map.find(maggie->name);
+	KX_LibLoadStatus *status = (statusit != m_status_map.end()) ? statusit->second : NULL;
+	if (statusit != m_status_map.end()) {
+		m_status_map.erase(statusit);
 	}
-
-#ifdef WITH_PYTHON
-	/* make sure this maggie is removed from the import list if it's there
-	 * (this operation is safe if it isn't in the list) */
-	removeImportMain(maggie);
-#endif
-
-	delete m_status_map[maggie->name];
-	m_status_map.erase(maggie->name);
+	m_threadinfo->m_mutex.Unlock();
+	delete status;
 
 	BKE_main_free(maggie);
-
-	return true;
 }
 
-bool KX_BlenderSceneConverter::FreeBlendFile(const char *path)
+/// Give the entities of the merged scene from to the scene to.
+template <class T>
+static void merge_scene_entities(vector<pair<KX_Scene *, T *> >& entities, KX_Scene *to, KX_Scene *from)
 {
-	return FreeBlendFile(GetMainDynamicPath(path));
+	typename vector<pair<KX_Scene *, T *> >::iterator itp = entities.begin();
+	while (itp != entities.end()) {
+		if (itp->first == from)
+			itp->first = to;
+		itp++;
+	}
 }
 
-bool KX_BlenderSceneConverter::MergeScene(KX_Scene *to, KX_Scene *from)
+static void merge_scene_polymaterials(vector<pair<KX_Scene *, RAS_IPolyMaterial *> >& polymaterials, KX_Scene *to, KX_Scene *from)
 {
-	{
-		vector<pair<KX_Scene *, KX_WorldInfo *> >::iterator itp = m_worldinfos.begin();
-		while (itp != m_worldinfos.end()) {
-			if (itp->first == from)
-				itp->first = to;
-			itp++;
+	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator itp = polymaterials.begin();
+	while (itp != polymaterials.end()) {
+		if (itp->first == from) {
+			itp->first = to;
+
+			/* also switch internal data */
+			RAS_IPolyMaterial *mat = itp->second;
+			mat->Replace_IScene(to);
 		}
+		itp++;
 	}
+}
 
-	{
-		vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator itp = m_polymaterials.begin();
-		while (itp != m_polymaterials.end()) {
-			if (itp->first == from) {
-				itp->first = to;
-
-				/* also switch internal data */
-				RAS_IPolyMaterial *mat = itp->second;
-				mat->Replace_IScene(to);
-			}
-			itp++;
-		}
-	}
+bool KX_BlenderSceneConverter::MergeScene(KX_Scene *to, KX_Scene *from)
+{
+	// The asynchronous loads register their converted data meanwhile.
+	m_threadinfo->m_mutex.Lock();
 
-	{
-		vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator itp = m_meshobjects.begin();
-		while (itp != m_meshobjects.end()) {
-			if (itp->first == from)
-				itp->first = to;
-			itp++;
-		}
+	merge_scene_entities(m_worldinfos, to, from);
+	merge_scene_polymaterials(m_polymaterials, to, from);
+	merge_scene_entities(m_meshobjects, to, from);
+
+	for (map<Main *, LibraryData *>::iterator it = m_libraryData.begin(), end = m_libraryData.end(); it != end; ++it) {
+		merge_scene_polymaterials(it->second->m_polymaterials, to, from);
+		merge_scene_entities(it->second->m_meshobjects, to, from);
 	}
 
 	PolyMaterialCache::iterator polymatcacheit = m_polymat_cache.find(from);
@@ -1039,6 +1548,8 @@ bool KX_BlenderSceneConverter::MergeScene(KX_Scene *to, KX_Scene *from)
 		m_polymat_cache.erase(polymatcacheit);
 	}
 
+	m_threadinfo->m_mutex.Unlock();
+
 	return true;
 }
 
@@ -1055,6 +1566,10 @@ RAS_MeshObject *KX_BlenderSceneConverter::ConvertMeshSpecial(KX_Scene *kx_scene,
 		vector<Main *>::iterator it;
 
 		for (it = GetMainDynamic().begin(); it != GetMainDynamic().end(); it++) {
+			// The meshes of a loading library are still linked.
+			if (IsMainLoading(*it)) {
+				continue;
+			}
 			me = static_cast<ID *>(BLI_findstring(&(*it)->mesh, name, offsetof(ID, name) + 2));
 			from_maggie = *it;
 
@@ -1117,9 +1632,34 @@ RAS_MeshObject *KX_BlenderSceneConverter::ConvertMeshSpecial(KX_Scene *kx_scene,
 		}
 	}
 
+	/* The mesh and its copied materials are owned by maggie, their converted data is freed with it. */
+	{
+		Mesh *mesh = (Mesh *)me;
+
+		m_threadinfo->m_mutex.Lock();
+		m_idOwners[me] = maggie;
+		for (int i = 0; i < mesh->totcol; i++) {
+			if (mesh->mat[i] && (mesh->mat[i]->id.tag & LIB_TAG_DOIT)) {
+				m_idOwners[&mesh->mat[i]->id] = maggie;
+			}
+		}
+		m_threadinfo->m_mutex.Unlock();
+	}
+
 	m_currentScene = kx_scene; // This needs to be set in case we LibLoaded earlier
 	RAS_MeshObject *meshobj = BL_ConvertMesh((Mesh *)me, NULL, kx_scene, this, false);
+
+	/* Only the data of a library being freed is tagged. */
+	me->tag &= ~LIB_TAG_DOIT;
+	for (int i = 0; i < ((Mesh *)me)->totcol; i++) {
+		if (((Mesh *)me)->mat[i]) {
+			((Mesh *)me)->mat[i]->id.tag &= ~LIB_TAG_DOIT;
+		}
+	}
+
 	kx_scene->GetLogicManager()->RegisterMeshName(meshobj->GetName(),meshobj);
+	m_threadinfo->m_mutex.Lock();
 	m_map_mesh_to_gamemesh.clear(); /* This is at runtime so no need to keep this, BL_ConvertMesh adds */
+	m_threadinfo->m_mutex.Unlock();
 	return meshobj;
 }
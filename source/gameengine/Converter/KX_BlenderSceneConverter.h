@@ -48,11 +48,15 @@ class SCA_IController;
 class RAS_MeshObject;
 class RAS_IPolyMaterial;
 class BL_InterpolatorList;
+class BL_ActionCurveList;
 class BL_Material;
 struct Main;
 struct Mesh;
 struct Scene;
 struct ThreadInfo;
+struct LibraryData;
+struct Library;
+struct ID;
 struct Material;
 struct bAction;
 struct bActuator;
@@ -75,6 +79,17 @@ class KX_BlenderSceneConverter : public KX_ISceneConverter
 
 	// Saved KX_LibLoadStatus objects
 	map<char *, class KX_LibLoadStatus*> m_status_map;
+	// Statuses of the failed asynchronous loads, kept for the scripts until the converter is freed.
+	vector<class KX_LibLoadStatus*> m_failedStatuses;
+
+	// Converted data of each library, see LibraryData.
+	map<Main *, LibraryData *> m_libraryData;
+	// Libraries linked in each loaded library, the owners of the linked data.
+	map<Library *, Main *> m_libraryMains;
+	// Owners of the data moved in a library by ConvertMeshSpecial.
+	map<ID *, Main *> m_idOwners;
+	// Libraries freed over several frames, see FreeDeferredLibraries.
+	vector<Main *> m_freequeue;
 
 	// Should also have a list of collision shapes. 
 	// For the time being this is held in KX_Scene::m_shapes
@@ -85,6 +100,7 @@ class KX_BlenderSceneConverter : public KX_ISceneConverter
 	std::map<bController *, SCA_IController *> m_map_blender_to_gamecontroller;	/* cleared after conversion */
 	
 	std::map<bAction *, BL_InterpolatorList *> m_map_blender_to_gameAdtList;
+	std::map<bAction *, BL_ActionCurveList *> m_map_blender_to_actionCurveList;
 	
 	Main*					m_maggie;
 	vector<struct Main*>	m_DynamicMaggie;
@@ -94,6 +110,39 @@ class KX_BlenderSceneConverter : public KX_ISceneConverter
 	class KX_Scene*			m_currentScene;	// Scene being converted
 	bool					m_alwaysUseExpandFraming;
 
+	/// Return true if the library is loaded asynchronously and not finished, its data must be left alone.
+	bool IsMainLoading(struct Main *maggie);
+	/// Return false and set err_str if the ID type isn't supported or the library is already loaded.
+	bool CheckLinkBlendFile(const char *path, char *group, int idcode, char **err_str);
+	/** Load a library from data, or from the file at path if data is NULL, in the task pool.
+	 * The file is read and linked by a task, its scenes are converted by a single conversion
+	 * task and merged by MergeAsyncLoads, the loads of highest priority first.
+	 */
+	class KX_LibLoadStatus *LinkBlendFileAsync(void *data, int length, const char *path, char *group, KX_Scene *scene_merge,
+	                                           char **err_str, short options, int priority);
+	/// Remove the library of a failed asynchronous load from the lookups and free it.
+	void DiscardAsyncLoad(class KX_LibLoadStatus *status);
+	/// Register the meshes, actions and scripts of a linked library in scene_merge.
+	void RegisterLibraryData(struct Main *main_newlib, int idcode, KX_Scene *scene_merge, short options);
+	/// Merge the converted libraries for timeBudget seconds at most, or all if negative.
+	void MergeLibLoads(double timeBudget);
+
+	/// Return the converted data of a library, created on the first call.
+	LibraryData *GetLibraryData(struct Main *maggie);
+	/// Return the converted data of the library owning id, NULL for the data of the main file. Called locked.
+	LibraryData *FindLibraryData(struct ID *id);
+	/// Add the libraries linked in maggie to the owners of the linked data.
+	void RegisterLibraryMains(struct Main *maggie);
+
+	/// Remove a library from the scenes lookups, its scenes and its names, before freeing its objects.
+	void BeginFreeLibrary(struct Main *maggie);
+	/// Remove the objects of a library until endtime, or all if negative. Return true when all are removed.
+	bool FreeLibraryObjects(struct Main *maggie, double endtime);
+	/// Free the converted data of a library with no objects left and the library.
+	void EndFreeLibrary(struct Main *maggie);
+	/// Continue the deferred frees for timeBudget seconds at most, or all if negative.
+	void FreeLibraries(double timeBudget);
+
 public:
 	KX_BlenderSceneConverter(
 		Main* maggie,
@@ -133,6 +182,9 @@ public:
 	void RegisterInterpolatorList(BL_InterpolatorList *actList, struct bAction *for_act);
 	BL_InterpolatorList *FindInterpolatorList(struct bAction *for_act);
 
+	/// Return the F-curve targets of an action shared by the objects playing it, parsed on the first call.
+	BL_ActionCurveList *GetActionCurveList(struct bAction *for_act);
+
 	void RegisterGameActuator(SCA_IActuator *act, struct bActuator *for_actuator);
 	SCA_IActuator *FindGameActuator(struct bActuator *for_actuator);
 
@@ -148,17 +200,27 @@ public:
 	struct Main*		  GetMainDynamicPath(const char *path);
 	vector<struct Main*> &GetMainDynamic();
 	
-	class KX_LibLoadStatus *LinkBlendFileMemory(void *data, int length, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options);
-	class KX_LibLoadStatus *LinkBlendFilePath(const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options);
+	class KX_LibLoadStatus *LinkBlendFileMemory(void *data, int length, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options, int priority = 0);
+	class KX_LibLoadStatus *LinkBlendFilePath(const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options, int priority = 0);
 	class KX_LibLoadStatus *LinkBlendFile(struct BlendHandle *bpy_openlib, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options);
 	bool MergeScene(KX_Scene *to, KX_Scene *from);
 	RAS_MeshObject *ConvertMeshSpecial(KX_Scene* kx_scene, Main *maggie, const char *name);
-	bool FreeBlendFile(struct Main *maggie);
-	bool FreeBlendFile(const char *path);
+	/** Free a library and all the data converted from it. A deferred free removes the library
+	 * from the lookups now and its objects over the next frames, see FreeDeferredLibraries.
+	 */
+	bool FreeBlendFile(struct Main *maggie, bool deferred = false);
+	bool FreeBlendFile(const char *path, bool deferred = false);
+	/// Continue the deferred frees during a small time per frame.
+	virtual void FreeDeferredLibraries();
 
+	/// Merge the converted libraries during a small time per frame, at least one scene.
 	virtual void MergeAsyncLoads();
 	virtual void FinalizeAsyncLoads();
 	void AddScenesToMergeQueue(class KX_LibLoadStatus *status);
+	/// Read and link the asynchronous load of highest priority, run by a task.
+	void ReadAsyncLoad();
+	/// Convert the scenes of the read asynchronous loads until none is left, run by a task.
+	void ConvertAsyncLoads();
  
 	void PrintStats() {
 		printf("BGE STATS!\n");
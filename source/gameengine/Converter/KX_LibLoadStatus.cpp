@@ -27,6 +27,8 @@
 #include "KX_LibLoadStatus.h"
 #include "PIL_time.h"
 
+#include <climits>
+
 KX_LibLoadStatus::KX_LibLoadStatus(class KX_BlenderSceneConverter* kx_converter,
 				class KX_KetsjiEngine* kx_engine,
 				class KX_Scene* merge_scene,
@@ -37,6 +39,9 @@ KX_LibLoadStatus::KX_LibLoadStatus(class KX_BlenderSceneConverter* kx_converter,
 			m_data(NULL),
 			m_libname(path),
 			m_progress(0.0f),
+			m_totalBytes(0),
+			m_loadedBytes(0),
+			m_priority(0),
 			m_finished(false)
 #ifdef WITH_PYTHON
 			,
@@ -129,6 +134,16 @@ void *KX_LibLoadStatus::GetData()
 	return m_data;
 }
 
+void KX_LibLoadStatus::SetError(const char *error)
+{
+	m_error = error;
+}
+
+const char *KX_LibLoadStatus::GetError()
+{
+	return m_error;
+}
+
 void KX_LibLoadStatus::SetProgress(float progress)
 {
 	m_progress = progress;
@@ -146,6 +161,36 @@ void KX_LibLoadStatus::AddProgress(float progress)
 	RunProgressCallback();
 }
 
+void KX_LibLoadStatus::SetTotalBytes(int bytes)
+{
+	m_totalBytes = bytes;
+}
+
+int KX_LibLoadStatus::GetTotalBytes() const
+{
+	return m_totalBytes;
+}
+
+void KX_LibLoadStatus::AddLoadedBytes(int bytes)
+{
+	m_loadedBytes += bytes;
+}
+
+int KX_LibLoadStatus::GetLoadedBytes() const
+{
+	return m_loadedBytes;
+}
+
+void KX_LibLoadStatus::SetPriority(int priority)
+{
+	m_priority = priority;
+}
+
+int KX_LibLoadStatus::GetPriority() const
+{
+	return m_priority;
+}
+
 #ifdef WITH_PYTHON
 
 PyMethodDef KX_LibLoadStatus::Methods[] = 
@@ -160,6 +205,10 @@ PyAttributeDef KX_LibLoadStatus::Attributes[] = {
 	KX_PYATTRIBUTE_STRING_RO("libraryName", KX_LibLoadStatus, m_libname),
 	KX_PYATTRIBUTE_RO_FUNCTION("timeTaken", KX_LibLoadStatus, pyattr_get_timetaken),
 	KX_PYATTRIBUTE_BOOL_RO("finished", KX_LibLoadStatus, m_finished),
+	KX_PYATTRIBUTE_STRING_RO("error", KX_LibLoadStatus, m_error),
+	KX_PYATTRIBUTE_INT_RO("totalBytes", KX_LibLoadStatus, m_totalBytes),
+	KX_PYATTRIBUTE_INT_RO("loadedBytes", KX_LibLoadStatus, m_loadedBytes),
+	KX_PYATTRIBUTE_INT_RW("priority", INT_MIN, INT_MAX, false, KX_LibLoadStatus, m_priority),
 	{ NULL }	//Sentinel
 };
 
@@ -38,8 +38,15 @@ private:
 	class KX_Scene*					m_mergescene;
 	void*							m_data;
 	STR_String						m_libname;
+	/// Reason of the failure of the load, empty if the load succeeded.
+	STR_String						m_error;
 
 	float	m_progress;
+	/// Size of the library and number of bytes read, the reading is a part of the progress.
+	int		m_totalBytes;
+	int		m_loadedBytes;
+	/// The asynchronous loads of highest priority are read, converted and merged first.
+	int		m_priority;
 	double	m_starttime;
 	double	m_endtime;
 
@@ -71,6 +78,13 @@ public:
 	void SetData(void *data);
 	void *GetData();
 
+	void SetError(const char *error);
+	const char *GetError();
+	inline bool HasFailed() const
+	{
+		return !m_error.IsEmpty();
+	}
+
 	inline bool IsFinished() const
 	{
 		return m_finished;
@@ -80,6 +94,14 @@ public:
 	float GetProgress();
 	void AddProgress(float progress);
 
+	void SetTotalBytes(int bytes);
+	int GetTotalBytes() const;
+	void AddLoadedBytes(int bytes);
+	int GetLoadedBytes() const;
+
+	void SetPriority(int priority);
+	int GetPriority() const;
+
 #ifdef WITH_PYTHON
 	static PyObject*	pyattr_get_onfinish(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef);
 	static int			pyattr_set_onfinish(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef, PyObject *value);
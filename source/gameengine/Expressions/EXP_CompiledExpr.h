@@ -0,0 +1,163 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file EXP_CompiledExpr.h
+ *  \ingroup expressions
+ */
+
+#ifndef __EXP_COMPILEDEXPR_H__
+#define __EXP_COMPILEDEXPR_H__
+
+#include "EXP_Value.h"
+#include "EXP_IntValue.h"
+
+#include <vector>
+
+class CExpression;
+
+/// Maximum depth of the evaluation stack, deeper expressions aren't compiled.
+#define EXP_COMPILEDEXPR_MAX_STACK 32
+
+/// Value of the evaluation stack of a compiled expression, never allocated.
+struct CCompiledValue
+{
+	enum Type {
+		BOOL,
+		INT,
+		FLOAT,
+		STRING
+	};
+
+	Type m_type;
+	union {
+		bool m_bool;
+		cInt m_int;
+		float m_float;
+		/// Text owned by a property or by the expression.
+		const STR_String *m_string;
+	};
+
+	/// Same as CValue::GetNumber.
+	double GetNumber() const;
+
+	/// Read a value, return false if its type isn't supported.
+	bool SetValue(CValue *value);
+};
+
+/// Resolves the identifiers of a compiled expression during its evaluation.
+class CCompiledExprContext
+{
+public:
+	virtual ~CCompiledExprContext()
+	{
+	}
+
+	/** Read the identifier into value, id is CPropertyNames::InternIdentifier(name).
+	 * Return false if the identifier doesn't exist or can't be read without allocation.
+	 */
+	virtual bool GetIdentifierValue(const STR_String& name, unsigned int id, CCompiledValue& value) = 0;
+};
+
+/** Expression tree flattened in instructions of a stack machine, evaluated without allocation
+ * and without the virtual dispatch of the operators.
+ * Only the operations on booleans, integers, floats and the comparisons of strings are compiled,
+ * they give the same result as the tree. When the evaluation meets another operation or an error
+ * (e.g strings concatenation, division by zero, missing property) it stops and the tree must be
+ * calculated instead, to create the same values and errors.
+ */
+class CCompiledExpr
+{
+public:
+	enum BranchType {
+		BRANCH_ALWAYS,
+		/// Pop a boolean and branch if it's false.
+		BRANCH_IF_FALSE
+	};
+
+private:
+	enum OpCode {
+		OP_CONSTANT,
+		OP_IDENTIFIER,
+		OP_UNARY,
+		OP_BINARY,
+		OP_BRANCH,
+		OP_BRANCH_IF_FALSE,
+		/// A value not supported by the compiled evaluation.
+		OP_UNSUPPORTED
+	};
+
+	struct Instruction
+	{
+		OpCode m_opcode;
+		VALUE_OPERATOR m_operator;
+		/// Index of the constant or identifier, or target instruction of a branch.
+		unsigned int m_index;
+	};
+
+	struct Identifier
+	{
+		STR_String m_name;
+		unsigned int m_id;
+	};
+
+	std::vector<Instruction> m_instructions;
+	std::vector<CCompiledValue> m_constants;
+	/// Values owning the text of the string constants.
+	std::vector<CValue *> m_constantValues;
+	std::vector<Identifier> m_identifiers;
+
+	/// Depth of the stack at the end of the instructions, while compiling.
+	unsigned int m_depth;
+	bool m_overflow;
+
+	void AddInstruction(OpCode opcode, VALUE_OPERATOR op, unsigned int index, int depth);
+
+	CCompiledExpr();
+
+public:
+	~CCompiledExpr();
+
+	/// Compile an expression tree, return NULL if it contains an expression not supported.
+	static CCompiledExpr *Compile(CExpression *expr);
+
+	/** Evaluate the expression, return false if the tree must be calculated instead,
+	 * see the class description.
+	 */
+	bool Evaluate(CCompiledExprContext *context, CCompiledValue& result) const;
+
+	/// Functions used by CExpression::Compile.
+	void AddConstant(CValue *value);
+	void AddIdentifier(const STR_String& name, unsigned int id);
+	void AddUnaryOperator(VALUE_OPERATOR op);
+	void AddBinaryOperator(VALUE_OPERATOR op);
+	/** Add a branch and return its index for SetBranchTarget. The stack depth is decreased by one after
+	 * a BRANCH_ALWAYS, the value pushed before it is pushed again by the instructions of the target.
+	 */
+	unsigned int AddBranch(BranchType type);
+	/// Set the target of the branch to the next added instruction.
+	void SetBranchTarget(unsigned int branch);
+
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:CCompiledExpr")
+#endif
+};
+
+#endif  /* __EXP_COMPILEDEXPR_H__ */
@@ -37,6 +37,7 @@ public:
 	void ClearModified();
 	virtual double GetNumber();
 	virtual CValue* Calculate();
+	virtual bool Compile(CCompiledExpr& compiled);
 	CConstExpr(CValue* constval);
 	CConstExpr();
 	virtual ~CConstExpr();
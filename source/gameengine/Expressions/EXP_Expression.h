@@ -47,6 +47,7 @@ public:                                                                        \
 
 
 class CExpression;
+class CCompiledExpr;
 
 
 // for undo/redo system the deletion in the expressiontree can be restored by replacing broken links 'inplace'
@@ -113,6 +114,8 @@ public:
 	virtual void				ClearModified() = 0; // another pure one
 	//virtual CExpression * Copy() =0;
 	virtual void		BroadcastOperators(VALUE_OPERATOR op) =0;
+	/// Add the instructions evaluating this expression, return false if it can't be compiled.
+	virtual bool		Compile(CCompiledExpr& compiled);
 
 	virtual CExpression * AddRef() { // please leave multiline, for debugger !!!
 
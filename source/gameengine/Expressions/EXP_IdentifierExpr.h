@@ -38,6 +38,8 @@ class CIdentifierExpr : public CExpression
 {
 	CValue*		m_idContext;
 	STR_String	m_identifier;
+	/// Identifier resolved once, see CValue::FindIdentifier.
+	unsigned int	m_identifierId;
 public:
 	CIdentifierExpr(const STR_String& identifier,CValue* id_context);
 	virtual ~CIdentifierExpr();
@@ -49,6 +51,7 @@ public:
 	virtual CExpression*	CheckLink(std::vector<CBrokenLinkInfo*>& brokenlinks);
 	virtual void			ClearModified();
 	virtual void			BroadcastOperators(VALUE_OPERATOR op);
+	virtual bool			Compile(CCompiledExpr& compiled);
 
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -44,6 +44,7 @@ public:
 	virtual CExpression*	CheckLink(std::vector<CBrokenLinkInfo*>& brokenlinks);
 	virtual void			ClearModified();
 	virtual void			BroadcastOperators(VALUE_OPERATOR op);
+	virtual bool			Compile(CCompiledExpr& compiled);
 
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -43,6 +43,7 @@ public:
 			m_rhs->ClearModified();
 	}
 	virtual CValue* Calculate();
+	virtual bool Compile(CCompiledExpr& compiled);
 	COperator2Expr(VALUE_OPERATOR op, CExpression *lhs, CExpression *rhs);
 	COperator2Expr();
 	virtual ~COperator2Expr();
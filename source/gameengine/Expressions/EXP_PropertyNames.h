@@ -0,0 +1,55 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file EXP_PropertyNames.h
+ *  \ingroup expressions
+ */
+
+#ifndef __EXP_PROPERTYNAMES_H__
+#define __EXP_PROPERTYNAMES_H__
+
+#include "STR_String.h"
+
+/// Identifier of a name never interned, no property uses it.
+#define EXP_PROPERTY_ID_NONE ((unsigned int)-1)
+
+/** Table of all the property names, each name is interned once to an identifier
+ * stable until exit. The properties of a CValue are stored by identifier, the sensors and
+ * expressions resolve their identifier once and then only compare integers.
+ * The table can be used from several threads at once, it is locked to intern a name when
+ * a property is set, the lookups by name only read the names stored in the CValue.
+ */
+class CPropertyNames
+{
+public:
+	/// Return the identifier of name, interning the name if needed.
+	static unsigned int Intern(const char *name);
+	static unsigned int Intern(const STR_String& name);
+
+	/** Return the identifier of a name used to look up an identifier with CValue::FindIdentifier,
+	 * EXP_PROPERTY_ID_NONE if the name contains a dot and must be looked up in a sub context.
+	 */
+	static unsigned int InternIdentifier(const STR_String& name);
+
+	/// Return the name of an identifier returned by Intern.
+	static const STR_String& GetName(unsigned int id);
+};
+
+#endif  /* __EXP_PROPERTYNAMES_H__ */
@@ -592,6 +592,8 @@ public:
 	virtual PyObject*		py_repr(void);
 	/* subclass may overwrite this function to implement more sophisticated method of validating a proxy */
 	virtual bool			py_is_valid(void) { return true; }
+	/* subclass may overwrite this function to be notified when the proxy attached to it is created */
+	virtual void			py_proxy_created(void) {}
 
 	static PyObject*		py_get_attrdef(PyObject *self_py, const PyAttributeDef *attrdef);
 	static int				py_set_attrdef(PyObject *self_py, PyObject *value, const PyAttributeDef *attrdef);
@@ -23,8 +23,10 @@
 #  pragma warning (disable:4786)
 #endif
 
-#include <map>		// array functionality for the propertylist
+#include <map>
+#include <vector>		// array functionality for the propertylist
 #include "STR_String.h"	// STR_String class
+#include "EXP_PropertyNames.h"
 
 using namespace std;
 
@@ -164,6 +166,53 @@ public:
 #include "object.h"
 #endif
 
+class CValue;
+
+/**
+ * Listener of the modifications of a value, see CValue::AddListener.
+ * The listener is notified only once, at the next modification of the value,
+ * and must be added again to be notified of the following modifications.
+ */
+class CValueListener
+{
+public:
+	CValueListener()
+		:m_listenedValue(NULL),
+		m_nextListener(NULL)
+	{
+	}
+	/// A copied listener doesn't listen to the values of the original.
+	CValueListener(const CValueListener& other)
+		:m_listenedValue(NULL),
+		m_nextListener(NULL)
+	{
+	}
+	virtual ~CValueListener()
+	{
+		StopListening();
+	}
+
+	/// Called when the listened value is modified, replaced by another property or removed.
+	virtual void ValueModified(CValue *value) = 0;
+
+	/// Stop listening the value without notification.
+	void StopListening();
+
+	bool IsListening() const
+	{
+		return (m_listenedValue != NULL);
+	}
+
+private:
+	friend class CValue;
+
+	CValueListener& operator=(const CValueListener& other);
+
+	CValue *m_listenedValue;
+	/// Next listener of the same value.
+	CValueListener *m_nextListener;
+};
+
 /**
  * Baseclass CValue
  *
@@ -301,7 +350,23 @@ public:
 	virtual CValue*		GetProperty(int inIndex);								// Get property number <inIndex>
 	virtual int			GetPropertyCount();										// Get the amount of properties assiocated with this value
 
+	/// Property management from an identifier of CPropertyNames, to avoid hashing the name each time.
+	void				SetPropertyFromId(unsigned int id, CValue *ioProperty);
+	CValue*				GetPropertyFromId(unsigned int id);
+
+	/** Notify listener once at the next modification of this value: SetModified(true), the value replaced
+	 * or removed from the properties of its owner, or its destruction. A listener listens to one value at once.
+	 */
+	void				AddListener(CValueListener *listener);
+	/// Notify and remove all the listeners, called by the modifications listed in AddListener.
+	void				NotifyListeners();
+
 	virtual CValue*		FindIdentifier(const STR_String& identifiername);
+	/** Same as FindIdentifier(identifiername) with the identifier returned by
+	 * CPropertyNames::InternIdentifier(identifiername), resolved once by the caller,
+	 * or EXP_PROPERTY_ID_NONE to look the property up by name.
+	 */
+	virtual CValue*		FindIdentifier(const STR_String& identifiername, unsigned int id);
 	/** Set the wireframe color of this value depending on the CSG
 	 * operator type <op>
 	 * \attention: not implemented */
@@ -326,7 +391,13 @@ public:
 		
 	// setting / getting flags
 	inline void			SetSelected(bool bSelected)								{ m_ValFlags.Selected = bSelected; }
-	virtual void		SetModified(bool bModified)								{ m_ValFlags.Modified = bModified; }
+	virtual void		SetModified(bool bModified)
+	{
+		m_ValFlags.Modified = bModified;
+		if (bModified && m_listeners) {
+			NotifyListeners();
+		}
+	}
 	virtual void		SetAffected(bool bAffected=true)						{ m_ValFlags.Affected = bAffected; }
 	inline void			SetReleaseRequested(bool bReleaseRequested)				{ m_ValFlags.ReleaseRequested=bReleaseRequested; }
 	inline void			SetError(bool err)										{ m_ValFlags.Error=err; }
@@ -349,8 +420,25 @@ protected:
 	//virtual void		AddDataToReplica(CValue* replica);
 	virtual				~CValue();
 private:
+	friend class CValueListener;
+
 	// Member variables
-	std::map<STR_String,CValue*>*		m_pNamedPropertyArray;									// Properties for user/game etc
+	struct NamedProperty
+	{
+		unsigned int m_id;
+		/// Interned name of m_id, read without locking the names table.
+		const STR_String *m_name;
+		CValue *m_value;
+	};
+	/** Properties for user/game etc, sorted by name as the previous map of strings.
+	 * Values have few properties, a linear search of the identifier is faster than a tree of strings.
+	 */
+	std::vector<NamedProperty>*		m_pNamedPropertyArray;
+
+	/// Return the first property whose name isn't before name.
+	std::vector<NamedProperty>::iterator	LowerBoundProperty(const char *name);
+	/// First listener of the modifications of this value, the others are linked by CValueListener::m_nextListener.
+	CValueListener*		m_listeners;
 	ValueFlags			m_ValFlags;												// Frequently used flags in a bitfield (low memoryusage)
 	int					m_refcount;												// Reference Counter
 	static	double m_sZeroVec[3];
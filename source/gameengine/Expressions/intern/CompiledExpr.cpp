@@ -0,0 +1,485 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Expressions/CompiledExpr.cpp
+ *  \ingroup expressions
+ */
+
+#include "EXP_CompiledExpr.h"
+#include "EXP_Expression.h"
+#include "EXP_BoolValue.h"
+#include "EXP_FloatValue.h"
+#include "EXP_StringValue.h"
+
+#include <math.h>
+
+#include "BLI_utildefines.h"
+
+double CCompiledValue::GetNumber() const
+{
+	switch (m_type) {
+		case BOOL:
+			return (double)m_bool;
+		case INT:
+			return (double)m_int;
+		case FLOAT:
+			return m_float;
+		default:
+			return -1;
+	}
+}
+
+bool CCompiledValue::SetValue(CValue *value)
+{
+	// No class derives from the basic value types, the casts are safe.
+	switch (value->GetValueType()) {
+		case VALUE_BOOL_TYPE:
+			m_type = BOOL;
+			m_bool = ((CBoolValue *)value)->GetBool();
+			return true;
+		case VALUE_INT_TYPE:
+			m_type = INT;
+			m_int = ((CIntValue *)value)->GetInt();
+			return true;
+		case VALUE_FLOAT_TYPE:
+			m_type = FLOAT;
+			m_float = ((CFloatValue *)value)->GetFloat();
+			return true;
+		case VALUE_STRING_TYPE:
+			m_type = STRING;
+			m_string = &value->GetText();
+			return true;
+		default:
+			return false;
+	}
+}
+
+static inline void compiled_set_bool(CCompiledValue& result, bool value)
+{
+	result.m_type = CCompiledValue::BOOL;
+	result.m_bool = value;
+}
+
+static inline void compiled_set_float(CCompiledValue& result, float value)
+{
+	result.m_type = CCompiledValue::FLOAT;
+	result.m_float = value;
+}
+
+/// Same as CEmptyValue::Calc(op, value), return false when the tree gives an error.
+static bool compiled_unary(VALUE_OPERATOR op, const CCompiledValue& value, CCompiledValue& result)
+{
+	switch (value.m_type) {
+		case CCompiledValue::INT:
+		{
+			switch (op) {
+				case VALUE_NEG_OPERATOR:
+					result.m_type = CCompiledValue::INT;
+					result.m_int = -value.m_int;
+					return true;
+				case VALUE_POS_OPERATOR:
+					result = value;
+					return true;
+				case VALUE_NOT_OPERATOR:
+					compiled_set_bool(result, value.m_int == 0);
+					return true;
+				default:
+					return false;
+			}
+		}
+		case CCompiledValue::FLOAT:
+		{
+			switch (op) {
+				case VALUE_NEG_OPERATOR:
+					compiled_set_float(result, -value.m_float);
+					return true;
+				case VALUE_POS_OPERATOR:
+					result = value;
+					return true;
+				case VALUE_NOT_OPERATOR:
+					compiled_set_bool(result, value.m_float == 0.0f);
+					return true;
+				default:
+					return false;
+			}
+		}
+		case CCompiledValue::BOOL:
+		{
+			if (op == VALUE_NOT_OPERATOR) {
+				compiled_set_bool(result, !value.m_bool);
+				return true;
+			}
+			return false;
+		}
+		default:
+			return false;
+	}
+}
+
+/// Operators of two floats or of a float and an integer, the integer is converted to float.
+static bool compiled_binary_float(VALUE_OPERATOR op, float left, float right, CCompiledValue& result)
+{
+	switch (op) {
+		case VALUE_MOD_OPERATOR:
+			compiled_set_float(result, (float)fmod((double)left, (double)right));
+			return true;
+		case VALUE_ADD_OPERATOR:
+			compiled_set_float(result, left + right);
+			return true;
+		case VALUE_SUB_OPERATOR:
+			compiled_set_float(result, left - right);
+			return true;
+		case VALUE_MUL_OPERATOR:
+			compiled_set_float(result, left * right);
+			return true;
+		case VALUE_DIV_OPERATOR:
+			if (right == 0.0f) {
+				return false;
+			}
+			compiled_set_float(result, left / right);
+			return true;
+		case VALUE_EQL_OPERATOR:
+			compiled_set_bool(result, left == right);
+			return true;
+		case VALUE_NEQ_OPERATOR:
+			compiled_set_bool(result, left != right);
+			return true;
+		case VALUE_GRE_OPERATOR:
+			compiled_set_bool(result, left > right);
+			return true;
+		case VALUE_LES_OPERATOR:
+			compiled_set_bool(result, left < right);
+			return true;
+		case VALUE_GEQ_OPERATOR:
+			compiled_set_bool(result, left >= right);
+			return true;
+		case VALUE_LEQ_OPERATOR:
+			compiled_set_bool(result, left <= right);
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool compiled_binary_int(VALUE_OPERATOR op, cInt left, cInt right, CCompiledValue& result)
+{
+	result.m_type = CCompiledValue::INT;
+	switch (op) {
+		case VALUE_MOD_OPERATOR:
+			if (right == 0) {
+				return false;
+			}
+			result.m_int = left % right;
+			return true;
+		case VALUE_ADD_OPERATOR:
+			result.m_int = left + right;
+			return true;
+		case VALUE_SUB_OPERATOR:
+			result.m_int = left - right;
+			return true;
+		case VALUE_MUL_OPERATOR:
+			result.m_int = left * right;
+			return true;
+		case VALUE_DIV_OPERATOR:
+			if (right == 0) {
+				return false;
+			}
+			result.m_int = left / right;
+			return true;
+		case VALUE_EQL_OPERATOR:
+			compiled_set_bool(result, left == right);
+			return true;
+		case VALUE_NEQ_OPERATOR:
+			compiled_set_bool(result, left != right);
+			return true;
+		case VALUE_GRE_OPERATOR:
+			compiled_set_bool(result, left > right);
+			return true;
+		case VALUE_LES_OPERATOR:
+			compiled_set_bool(result, left < right);
+			return true;
+		case VALUE_GEQ_OPERATOR:
+			compiled_set_bool(result, left >= right);
+			return true;
+		case VALUE_LEQ_OPERATOR:
+			compiled_set_bool(result, left <= right);
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool compiled_binary_bool(VALUE_OPERATOR op, bool left, bool right, CCompiledValue& result)
+{
+	switch (op) {
+		case VALUE_AND_OPERATOR:
+			compiled_set_bool(result, left && right);
+			return true;
+		case VALUE_OR_OPERATOR:
+			compiled_set_bool(result, left || right);
+			return true;
+		case VALUE_EQL_OPERATOR:
+			compiled_set_bool(result, left == right);
+			return true;
+		case VALUE_NEQ_OPERATOR:
+			compiled_set_bool(result, left != right);
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool compiled_binary_string(VALUE_OPERATOR op, const STR_String& left, const STR_String& right,
+                                   CCompiledValue& result)
+{
+	// The concatenation creates a string, it's left to the tree.
+	switch (op) {
+		case VALUE_EQL_OPERATOR:
+			compiled_set_bool(result, left == right);
+			return true;
+		case VALUE_NEQ_OPERATOR:
+			compiled_set_bool(result, left != right);
+			return true;
+		case VALUE_GRE_OPERATOR:
+			compiled_set_bool(result, left > right);
+			return true;
+		case VALUE_LES_OPERATOR:
+			compiled_set_bool(result, left < right);
+			return true;
+		case VALUE_GEQ_OPERATOR:
+			compiled_set_bool(result, left >= right);
+			return true;
+		case VALUE_LEQ_OPERATOR:
+			compiled_set_bool(result, left <= right);
+			return true;
+		default:
+			return false;
+	}
+}
+
+/// Same as left->Calc(op, right), return false when the tree gives an error or a new string.
+static bool compiled_binary(VALUE_OPERATOR op, const CCompiledValue& left, const CCompiledValue& right,
+                            CCompiledValue& result)
+{
+	switch (left.m_type) {
+		case CCompiledValue::INT:
+		{
+			switch (right.m_type) {
+				case CCompiledValue::INT:
+					return compiled_binary_int(op, left.m_int, right.m_int, result);
+				case CCompiledValue::FLOAT:
+					if (op == VALUE_MOD_OPERATOR) {
+						// The tree doesn't convert the integer to float for fmod.
+						compiled_set_float(result, (float)fmod((double)left.m_int, (double)right.m_float));
+						return true;
+					}
+					return compiled_binary_float(op, (float)left.m_int, right.m_float, result);
+				default:
+					return false;
+			}
+		}
+		case CCompiledValue::FLOAT:
+		{
+			switch (right.m_type) {
+				case CCompiledValue::INT:
+					if (op == VALUE_MOD_OPERATOR) {
+						compiled_set_float(result, (float)fmod((double)left.m_float, (double)right.m_int));
+						return true;
+					}
+					return compiled_binary_float(op, left.m_float, (float)right.m_int, result);
+				case CCompiledValue::FLOAT:
+					return compiled_binary_float(op, left.m_float, right.m_float, result);
+				default:
+					return false;
+			}
+		}
+		case CCompiledValue::BOOL:
+		{
+			if (right.m_type == CCompiledValue::BOOL) {
+				return compiled_binary_bool(op, left.m_bool, right.m_bool, result);
+			}
+			return false;
+		}
+		case CCompiledValue::STRING:
+		{
+			if (right.m_type == CCompiledValue::STRING) {
+				return compiled_binary_string(op, *left.m_string, *right.m_string, result);
+			}
+			return false;
+		}
+	}
+
+	return false;
+}
+
+CCompiledExpr::CCompiledExpr()
+	:m_depth(0),
+	m_overflow(false)
+{
+}
+
+CCompiledExpr::~CCompiledExpr()
+{
+	for (std::vector<CValue *>::iterator it = m_constantValues.begin(), end = m_constantValues.end(); it != end; ++it) {
+		(*it)->Release();
+	}
+}
+
+CCompiledExpr *CCompiledExpr::Compile(CExpression *expr)
+{
+	CCompiledExpr *compiled = new CCompiledExpr();
+	if (!expr->Compile(*compiled) || compiled->m_overflow) {
+		delete compiled;
+		return NULL;
+	}
+
+	BLI_assert(compiled->m_depth == 1);
+	return compiled;
+}
+
+void CCompiledExpr::AddInstruction(OpCode opcode, VALUE_OPERATOR op, unsigned int index, int depth)
+{
+	Instruction instruction;
+	instruction.m_opcode = opcode;
+	instruction.m_operator = op;
+	instruction.m_index = index;
+	m_instructions.push_back(instruction);
+
+	m_depth += depth;
+	if (m_depth > EXP_COMPILEDEXPR_MAX_STACK) {
+		m_overflow = true;
+	}
+}
+
+void CCompiledExpr::AddConstant(CValue *value)
+{
+	CCompiledValue constant;
+	if (!constant.SetValue(value)) {
+		// Reaching the value stops the evaluation, the tree creates the error.
+		AddInstruction(OP_UNSUPPORTED, VALUE_NO_OPERATOR, 0, 1);
+		return;
+	}
+
+	if (constant.m_type == CCompiledValue::STRING) {
+		// Keep the text alive.
+		m_constantValues.push_back(value->AddRef());
+	}
+
+	AddInstruction(OP_CONSTANT, VALUE_NO_OPERATOR, m_constants.size(), 1);
+	m_constants.push_back(constant);
+}
+
+void CCompiledExpr::AddIdentifier(const STR_String& name, unsigned int id)
+{
+	Identifier identifier;
+	identifier.m_name = name;
+	identifier.m_id = id;
+
+	AddInstruction(OP_IDENTIFIER, VALUE_NO_OPERATOR, m_identifiers.size(), 1);
+	m_identifiers.push_back(identifier);
+}
+
+void CCompiledExpr::AddUnaryOperator(VALUE_OPERATOR op)
+{
+	AddInstruction(OP_UNARY, op, 0, 0);
+}
+
+void CCompiledExpr::AddBinaryOperator(VALUE_OPERATOR op)
+{
+	AddInstruction(OP_BINARY, op, 0, -1);
+}
+
+unsigned int CCompiledExpr::AddBranch(BranchType type)
+{
+	AddInstruction((type == BRANCH_ALWAYS) ? OP_BRANCH : OP_BRANCH_IF_FALSE, VALUE_NO_OPERATOR, 0, -1);
+	return m_instructions.size() - 1;
+}
+
+void CCompiledExpr::SetBranchTarget(unsigned int branch)
+{
+	m_instructions[branch].m_index = m_instructions.size();
+}
+
+bool CCompiledExpr::Evaluate(CCompiledExprContext *context, CCompiledValue& result) const
+{
+	CCompiledValue stack[EXP_COMPILEDEXPR_MAX_STACK];
+	unsigned int depth = 0;
+
+	const unsigned int size = m_instructions.size();
+	for (unsigned int i = 0; i < size;) {
+		const Instruction& instruction = m_instructions[i++];
+		switch (instruction.m_opcode) {
+			case OP_CONSTANT:
+			{
+				stack[depth++] = m_constants[instruction.m_index];
+				break;
+			}
+			case OP_IDENTIFIER:
+			{
+				const Identifier& identifier = m_identifiers[instruction.m_index];
+				if (!context->GetIdentifierValue(identifier.m_name, identifier.m_id, stack[depth++])) {
+					return false;
+				}
+				break;
+			}
+			case OP_UNARY:
+			{
+				CCompiledValue& value = stack[depth - 1];
+				if (!compiled_unary(instruction.m_operator, value, value)) {
+					return false;
+				}
+				break;
+			}
+			case OP_BINARY:
+			{
+				--depth;
+				CCompiledValue& left = stack[depth - 1];
+				if (!compiled_binary(instruction.m_operator, left, stack[depth], left)) {
+					return false;
+				}
+				break;
+			}
+			case OP_BRANCH:
+			{
+				i = instruction.m_index;
+				break;
+			}
+			case OP_BRANCH_IF_FALSE:
+			{
+				// Same as CIfExpr, only a boolean is a valid guard.
+				const CCompiledValue& guard = stack[--depth];
+				if (guard.m_type != CCompiledValue::BOOL) {
+					return false;
+				}
+				if (!guard.m_bool) {
+					i = instruction.m_index;
+				}
+				break;
+			}
+			case OP_UNSUPPORTED:
+			{
+				return false;
+			}
+		}
+	}
+
+	result = stack[0];
+	return true;
+}
@@ -18,6 +18,7 @@
 
 #include "EXP_Value.h" // for precompiled header
 #include "EXP_ConstExpr.h"
+#include "EXP_CompiledExpr.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -128,3 +129,11 @@ bool CConstExpr::MergeExpression(CExpression *otherexpr)
 	assertd(false);
 	return false;
 }
+
+
+
+bool CConstExpr::Compile(CCompiledExpr& compiled)
+{
+	compiled.AddConstant(m_value);
+	return true;
+}
@@ -37,6 +37,11 @@ CExpression::~CExpression()
 	assert (m_refcount == 0);
 }
 
+bool CExpression::Compile(CCompiledExpr& compiled)
+{
+	return false;
+}
+
 
 
 // destuctor for CBrokenLinkInfo
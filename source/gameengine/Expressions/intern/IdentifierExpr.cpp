@@ -31,9 +31,11 @@
 
 
 #include "EXP_IdentifierExpr.h"
+#include "EXP_CompiledExpr.h"
 
 CIdentifierExpr::CIdentifierExpr(const STR_String& identifier,CValue* id_context)
-:m_identifier(identifier)
+:m_identifier(identifier),
+m_identifierId(CPropertyNames::InternIdentifier(identifier))
 {
 	if (id_context)
 		m_idContext = id_context->AddRef();
@@ -54,7 +56,7 @@ CValue*	CIdentifierExpr::Calculate()
 {
 	CValue* result = NULL;
 	if (m_idContext)
-		result = m_idContext->FindIdentifier(m_identifier);
+		result = m_idContext->FindIdentifier(m_identifier, m_identifierId);
 
 	return result;
 }
@@ -101,3 +103,12 @@ void CIdentifierExpr::BroadcastOperators(VALUE_OPERATOR op)
 {
 	assertd(false); // not implemented yet
 }
+
+
+
+bool CIdentifierExpr::Compile(CCompiledExpr& compiled)
+{
+	// The identifier is looked up in the context given to the evaluation.
+	compiled.AddIdentifier(m_identifier, m_identifierId);
+	return true;
+}
@@ -19,6 +19,7 @@
 #include "EXP_EmptyValue.h"
 #include "EXP_ErrorValue.h"
 #include "EXP_BoolValue.h"
+#include "EXP_CompiledExpr.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -91,6 +92,29 @@ CValue* CIfExpr::Calculate()
 
 
 
+bool CIfExpr::Compile(CCompiledExpr& compiled)
+{
+	if (!m_guard->Compile(compiled)) {
+		return false;
+	}
+	const unsigned int elseBranch = compiled.AddBranch(CCompiledExpr::BRANCH_IF_FALSE);
+
+	if (!m_e1->Compile(compiled)) {
+		return false;
+	}
+	const unsigned int endBranch = compiled.AddBranch(CCompiledExpr::BRANCH_ALWAYS);
+
+	compiled.SetBranchTarget(elseBranch);
+	if (!m_e2->Compile(compiled)) {
+		return false;
+	}
+	compiled.SetBranchTarget(endBranch);
+
+	return true;
+}
+
+
+
 bool CIfExpr::MergeExpression(CExpression *otherexpr)
 {
 	assertd(false);
@@ -17,6 +17,7 @@
 
 #include "EXP_Operator1Expr.h"
 #include "EXP_EmptyValue.h"
+#include "EXP_CompiledExpr.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -67,6 +68,15 @@ ret: a new object containing the result of applying the operator m_op to the
 	return ret;
 }
 
+bool COperator1Expr::Compile(CCompiledExpr& compiled)
+{
+	if (!m_lhs->Compile(compiled)) {
+		return false;
+	}
+	compiled.AddUnaryOperator(m_op);
+	return true;
+}
+
 /*
 bool COperator1Expr::IsInside(float x, float y, float z,bool bBorderInclude)
 {
@@ -22,6 +22,7 @@
 #include "EXP_Operator2Expr.h"
 #include "EXP_StringValue.h"
 #include "EXP_VoidValue.h"
+#include "EXP_CompiledExpr.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -113,6 +114,15 @@ and m_rhs
 	
 }
 
+bool COperator2Expr::Compile(CCompiledExpr& compiled)
+{
+	if (!m_lhs->Compile(compiled) || !m_rhs->Compile(compiled)) {
+		return false;
+	}
+	compiled.AddBinaryOperator(m_op);
+	return true;
+}
+
 #if 0
 bool COperator2Expr::IsInside(float x, float y, float z,bool bBorderInclude)
 {
@@ -0,0 +1,134 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Expressions/PropertyNames.cpp
+ *  \ingroup expressions
+ */
+
+#include "EXP_PropertyNames.h"
+#include "STR_HashedString.h"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <string.h>
+
+#include "BLI_threads.h"
+
+// The names are only added, never removed, a deque keeps the references returned by GetName valid.
+static ThreadRWMutex names_lock = BLI_RWLOCK_INITIALIZER;
+static std::deque<STR_String> names;
+static std::vector<unsigned int> names_hash;
+/// Open addressing table of the name identifiers plus one, zero for an empty slot. The size is a power of two.
+static std::vector<unsigned int> names_slots;
+
+static unsigned int names_find(const char *name, unsigned int len, unsigned int hash)
+{
+	if (names_slots.empty()) {
+		return EXP_PROPERTY_ID_NONE;
+	}
+
+	const unsigned int mask = names_slots.size() - 1;
+	for (unsigned int i = hash & mask;; i = (i + 1) & mask) {
+		const unsigned int slot = names_slots[i];
+		if (slot == 0) {
+			return EXP_PROPERTY_ID_NONE;
+		}
+
+		const unsigned int id = slot - 1;
+		const STR_String& other = names[id];
+		if (names_hash[id] == hash && (unsigned int)other.Length() == len && memcmp(other.ReadPtr(), name, len) == 0) {
+			return id;
+		}
+	}
+}
+
+static void names_insert_slot(unsigned int id)
+{
+	const unsigned int mask = names_slots.size() - 1;
+	unsigned int i = names_hash[id] & mask;
+	while (names_slots[i] != 0) {
+		i = (i + 1) & mask;
+	}
+	names_slots[i] = id + 1;
+}
+
+static unsigned int names_intern(const char *name, unsigned int len)
+{
+	const unsigned int hash = STR_gHash(name, len, 0);
+
+	BLI_rw_mutex_lock(&names_lock, THREAD_LOCK_READ);
+	unsigned int id = names_find(name, len, hash);
+	BLI_rw_mutex_unlock(&names_lock);
+
+	if (id != EXP_PROPERTY_ID_NONE) {
+		return id;
+	}
+
+	BLI_rw_mutex_lock(&names_lock, THREAD_LOCK_WRITE);
+	// Another thread could have interned the name meanwhile.
+	id = names_find(name, len, hash);
+	if (id == EXP_PROPERTY_ID_NONE) {
+		id = names.size();
+		names.push_back(STR_String(name, len));
+		names_hash.push_back(hash);
+
+		// Keep the table at most half full.
+		if (names.size() * 2 > names_slots.size()) {
+			names_slots.assign(std::max<unsigned int>(names_slots.size() * 2, 64), 0);
+			for (unsigned int i = 0; i < names.size(); ++i) {
+				names_insert_slot(i);
+			}
+		}
+		else {
+			names_insert_slot(id);
+		}
+	}
+	BLI_rw_mutex_unlock(&names_lock);
+
+	return id;
+}
+
+unsigned int CPropertyNames::Intern(const char *name)
+{
+	return names_intern(name, strlen(name));
+}
+
+unsigned int CPropertyNames::Intern(const STR_String& name)
+{
+	return names_intern(name.ReadPtr(), name.Length());
+}
+
+unsigned int CPropertyNames::InternIdentifier(const STR_String& name)
+{
+	if (name.Find('.') >= 0) {
+		return EXP_PROPERTY_ID_NONE;
+	}
+	return Intern(name);
+}
+
+const STR_String& CPropertyNames::GetName(unsigned int id)
+{
+	BLI_rw_mutex_lock(&names_lock, THREAD_LOCK_READ);
+	const STR_String& name = names[id];
+	BLI_rw_mutex_unlock(&names_lock);
+
+	return name;
+}
@@ -1123,6 +1123,7 @@ PyObject *PyObjectPlus::py_repr(void)
 
 PyObject *PyObjectPlus::GetProxyPlus_Ext(PyObjectPlus *self, PyTypeObject *tp, void *ptr)
 {
+	bool created = false;
 	if (self->m_proxy==NULL)
 	{
 		self->m_proxy = reinterpret_cast<PyObject *>PyObject_NEW( PyObjectPlus_Proxy, tp);
@@ -1131,6 +1132,7 @@ PyObject *PyObjectPlus::GetProxyPlus_Ext(PyObjectPlus *self, PyTypeObject *tp, v
 #ifdef USE_WEAKREFS
 		BGE_PROXY_WKREF(self->m_proxy) = NULL;
 #endif
+		created = true;
 	}
 	//PyObject_Print(self->m_proxy, stdout, 0);
 	//printf("ref %d\n", self->m_proxy->ob_refcnt);
@@ -1138,6 +1140,8 @@ PyObject *PyObjectPlus::GetProxyPlus_Ext(PyObjectPlus *self, PyTypeObject *tp, v
 	BGE_PROXY_REF(self->m_proxy) = self; /* Its possible this was set to NULL, so set it back here */
 	BGE_PROXY_PTR(self->m_proxy) = ptr;
 	Py_INCREF(self->m_proxy); /* we own one, thos ones fore the return */
+	if (created)
+		self->py_proxy_created();
 	return self->m_proxy;
 }
 
@@ -93,6 +93,7 @@ CValue::CValue()
 		: PyObjectPlus(),
 	
 m_pNamedPropertyArray(NULL),
+m_listeners(NULL),
 m_refcount(1)
 /*
 pre: false
@@ -117,6 +118,7 @@ effect: deletes the object
 */
 {
 	ClearProperties();
+	NotifyListeners();
 
 	assertd (m_refcount==0);
 #ifdef CVALUE_DEBUG
@@ -209,27 +211,15 @@ STR_String CValue::op2str(VALUE_OPERATOR op)
 //
 void CValue::SetProperty(const STR_String & name,CValue* ioProperty)
 {
-	if (ioProperty==NULL)
-	{	// Check if somebody is setting an empty property
-		trace("Warning:trying to set empty property!");
-		return;
-	}
-
-	if (m_pNamedPropertyArray)
-	{	// Try to replace property (if so -> exit as soon as we replaced it)
-		CValue* oldval = (*m_pNamedPropertyArray)[name];
-		if (oldval)
-			oldval->Release();
-	}
-	else { // Make sure we have a property array
-		m_pNamedPropertyArray = new std::map<STR_String,CValue *>;
-	}
-	
-	// Add property at end of array
-	(*m_pNamedPropertyArray)[name] = ioProperty->AddRef();//->Add(ioProperty);
+	SetPropertyFromId(CPropertyNames::Intern(name), ioProperty);
 }
 
 void CValue::SetProperty(const char* name,CValue* ioProperty)
+{
+	SetPropertyFromId(CPropertyNames::Intern(name), ioProperty);
+}
+
+void CValue::SetPropertyFromId(unsigned int id, CValue *ioProperty)
 {
 	if (ioProperty==NULL)
 	{	// Check if somebody is setting an empty property
@@ -239,37 +229,77 @@ void CValue::SetProperty(const char* name,CValue* ioProperty)
 
 	if (m_pNamedPropertyArray)
 	{	// Try to replace property (if so -> exit as soon as we replaced it)
-		CValue* oldval = (*m_pNamedPropertyArray)[name];
-		if (oldval)
-			oldval->Release();
+		for (std::vector<NamedProperty>::iterator it = m_pNamedPropertyArray->begin(), end = m_pNamedPropertyArray->end();
+		     it != end; ++it)
+		{
+			if (it->m_id == id) {
+				// Add the reference first in case the property is set to itself.
+				ioProperty->AddRef();
+				it->m_value->NotifyListeners();
+				it->m_value->Release();
+				it->m_value = ioProperty;
+				return;
+			}
+		}
 	}
 	else { // Make sure we have a property array
-		m_pNamedPropertyArray = new std::map<STR_String,CValue *>;
+		m_pNamedPropertyArray = new std::vector<NamedProperty>;
 	}
 	
-	// Add property at end of array
-	(*m_pNamedPropertyArray)[name] = ioProperty->AddRef();//->Add(ioProperty);
+	// Insert the property at its place in the name order
+	const STR_String& name = CPropertyNames::GetName(id);
+	NamedProperty property = {id, &name, ioProperty->AddRef()};
+	m_pNamedPropertyArray->insert(LowerBoundProperty(name.ReadPtr()), property);
+}
+
+std::vector<CValue::NamedProperty>::iterator CValue::LowerBoundProperty(const char *name)
+{
+	std::vector<NamedProperty>::iterator first = m_pNamedPropertyArray->begin();
+	unsigned int count = m_pNamedPropertyArray->size();
+
+	while (count > 0) {
+		const unsigned int step = count / 2;
+		std::vector<NamedProperty>::iterator it = first + step;
+		if (strcmp(it->m_name->ReadPtr(), name) < 0) {
+			first = it + 1;
+			count -= step + 1;
+		}
+		else {
+			count = step;
+		}
+	}
+	return first;
 }
 
 //
 // Get pointer to a property with name <inName>, returns NULL if there is no property named <inName>
 //
 CValue* CValue::GetProperty(const STR_String & inName)
+{
+	return GetProperty(inName.ReadPtr());
+}
+
+CValue* CValue::GetProperty(const char *inName)
 {
 	if (m_pNamedPropertyArray) {
-		std::map<STR_String,CValue*>::iterator it = m_pNamedPropertyArray->find(inName);
-		if (it != m_pNamedPropertyArray->end())
-			return (*it).second;
+		// Only the properties of this value are read, the names table isn't locked.
+		std::vector<NamedProperty>::iterator it = LowerBoundProperty(inName);
+		if (it != m_pNamedPropertyArray->end() && *it->m_name == inName)
+			return it->m_value;
 	}
 	return NULL;
 }
 
-CValue* CValue::GetProperty(const char *inName)
+CValue *CValue::GetPropertyFromId(unsigned int id)
 {
 	if (m_pNamedPropertyArray) {
-		std::map<STR_String,CValue*>::iterator it = m_pNamedPropertyArray->find(inName);
-		if (it != m_pNamedPropertyArray->end())
-			return (*it).second;
+		for (std::vector<NamedProperty>::const_iterator it = m_pNamedPropertyArray->begin(), end = m_pNamedPropertyArray->end();
+		     it != end; ++it)
+		{
+			if (it->m_id == id) {
+				return it->m_value;
+			}
+		}
 	}
 	return NULL;
 }
@@ -307,10 +337,12 @@ bool CValue::RemoveProperty(const char *inName)
 	// Check if there are properties at all which can be removed
 	if (m_pNamedPropertyArray)
 	{
-		std::map<STR_String,CValue*>::iterator it = m_pNamedPropertyArray->find(inName);
-		if (it != m_pNamedPropertyArray->end())
+		std::vector<NamedProperty>::iterator it = LowerBoundProperty(inName);
+		if (it != m_pNamedPropertyArray->end() && *it->m_name == inName)
 		{
-			((*it).second)->Release();
+			it->m_value->NotifyListeners();
+			it->m_value->Release();
+			// Keep the name order.
 			m_pNamedPropertyArray->erase(it);
 			return true;
 		}
@@ -319,6 +351,43 @@ bool CValue::RemoveProperty(const char *inName)
 	return false;
 }
 
+void CValue::AddListener(CValueListener *listener)
+{
+	listener->StopListening();
+	listener->m_listenedValue = this;
+	listener->m_nextListener = m_listeners;
+	m_listeners = listener;
+}
+
+void CValue::NotifyListeners()
+{
+	// Detach the listeners first, a listener can listen again from ValueModified.
+	CValueListener *listener = m_listeners;
+	m_listeners = NULL;
+	while (listener) {
+		CValueListener *next = listener->m_nextListener;
+		listener->m_listenedValue = NULL;
+		listener->m_nextListener = NULL;
+		listener->ValueModified(this);
+		listener = next;
+	}
+}
+
+void CValueListener::StopListening()
+{
+	if (!m_listenedValue) {
+		return;
+	}
+
+	CValueListener **link = &m_listenedValue->m_listeners;
+	while (*link != this) {
+		link = &(*link)->m_nextListener;
+	}
+	*link = m_nextListener;
+	m_listenedValue = NULL;
+	m_nextListener = NULL;
+}
+
 //
 // Get Property Names
 //
@@ -328,10 +397,10 @@ vector<STR_String> CValue::GetPropertyNames()
 	if (!m_pNamedPropertyArray) return result;
 	result.reserve(m_pNamedPropertyArray->size());
 	
-	std::map<STR_String,CValue*>::iterator it;
+	std::vector<NamedProperty>::iterator it;
 	for (it= m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++)
 	{
-		result.push_back((*it).first);
+		result.push_back(*it->m_name);
 	}
 	return result;
 }
@@ -346,12 +415,11 @@ void CValue::ClearProperties()
 		return;
 
 	// Remove all properties
-	std::map<STR_String,CValue*>::iterator it;
+	std::vector<NamedProperty>::iterator it;
 	for (it= m_pNamedPropertyArray->begin();(it != m_pNamedPropertyArray->end()); it++)
 	{
-		CValue* tmpval = (*it).second;
-		//STR_String name = (*it).first;
-		tmpval->Release();
+		it->m_value->NotifyListeners();
+		it->m_value->Release();
 	}
 
 	// Delete property array
@@ -367,10 +435,10 @@ void CValue::ClearProperties()
 void CValue::SetPropertiesModified(bool inModified)
 {
 	if (!m_pNamedPropertyArray) return;
-	std::map<STR_String,CValue*>::iterator it;
+	std::vector<NamedProperty>::iterator it;
 	
 	for (it= m_pNamedPropertyArray->begin();(it != m_pNamedPropertyArray->end()); it++)
-		((*it).second)->SetModified(inModified);
+		it->m_value->SetModified(inModified);
 }
 
 
@@ -381,10 +449,10 @@ void CValue::SetPropertiesModified(bool inModified)
 bool CValue::IsAnyPropertyModified()
 {
 	if (!m_pNamedPropertyArray) return false;
-	std::map<STR_String,CValue*>::iterator it;
+	std::vector<NamedProperty>::iterator it;
 	
 	for (it= m_pNamedPropertyArray->begin();(it != m_pNamedPropertyArray->end()); it++)
-		if (((*it).second)->IsModified())
+		if (it->m_value->IsModified())
 			return true;
 	
 	return false;
@@ -397,24 +465,11 @@ bool CValue::IsAnyPropertyModified()
 //
 CValue* CValue::GetProperty(int inIndex)
 {
-
-	int count=0;
-	CValue* result = NULL;
-
-	if (m_pNamedPropertyArray)
+	if (m_pNamedPropertyArray && inIndex >= 0 && inIndex < (int)m_pNamedPropertyArray->size())
 	{
-		std::map<STR_String,CValue*>::iterator it;
-		for (it= m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++)
-		{
-			if (count++ == inIndex)
-			{
-				result = (*it).second;
-				break;
-			}
-		}
-
+		return (*m_pNamedPropertyArray)[inIndex].m_value;
 	}
-	return result;
+	return NULL;
 }
 
 
@@ -470,6 +525,8 @@ void CValue::DisableRefCount()
 void CValue::ProcessReplica() /* was AddDataToReplica in 2.48 */
 {
 	m_refcount = 1;
+	// The listeners listen to the original value.
+	m_listeners = NULL;
 	
 #ifdef DEBUG
 	//gRefCountValue++;
@@ -481,14 +538,13 @@ void CValue::ProcessReplica() /* was AddDataToReplica in 2.48 */
 	/* copy all props */
 	if (m_pNamedPropertyArray)
 	{
-		std::map<STR_String,CValue*> *pOldArray = m_pNamedPropertyArray;
-		m_pNamedPropertyArray=NULL;
-		std::map<STR_String,CValue*>::iterator it;
-		for (it= pOldArray->begin(); (it != pOldArray->end()); it++)
+		std::vector<NamedProperty> *pOldArray = m_pNamedPropertyArray;
+		m_pNamedPropertyArray = new std::vector<NamedProperty>(*pOldArray);
+		std::vector<NamedProperty>::iterator it;
+		for (it= m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++)
 		{
-			CValue *val = (*it).second->GetReplica();
-			SetProperty((*it).first,val);
-			val->Release();
+			// The replica owns the only reference.
+			it->m_value = it->m_value->GetReplica();
 		}
 	}
 }
@@ -503,13 +559,19 @@ int CValue::GetValueType()
 
 
 CValue*	CValue::FindIdentifier(const STR_String& identifiername)
+{
+	// Don't intern the name, the names of missing properties would stay in the table.
+	return FindIdentifier(identifiername, EXP_PROPERTY_ID_NONE);
+}
+
+CValue *CValue::FindIdentifier(const STR_String& identifiername, unsigned int id)
 {
 
 	CValue* result = NULL;
 
 	int pos = 0;
 	// if a dot exists, explode the name into pieces to get the subcontext
-	if ((pos=identifiername.Find('.'))>=0)
+	if (id == EXP_PROPERTY_ID_NONE && (pos=identifiername.Find('.'))>=0)
 	{
 		const STR_String rightstring = identifiername.Right(identifiername.Length() -1 - pos);
 		const STR_String leftstring = identifiername.Left(pos);
@@ -520,7 +582,8 @@ CValue*	CValue::FindIdentifier(const STR_String& identifiername)
 		} 
 	} else
 	{
-		result = GetProperty(identifiername);
+		// Without identifier the property is looked up by name.
+		result = (id != EXP_PROPERTY_ID_NONE) ? GetPropertyFromId(id) : GetProperty(identifiername);
 		if (result)
 			return result->AddRef();
 	}
@@ -635,10 +698,10 @@ PyObject *CValue::ConvertKeysToPython(void)
 		PyObject *pylist= PyList_New(m_pNamedPropertyArray->size());
 		Py_ssize_t i= 0;
 
-		std::map<STR_String,CValue*>::iterator it;
+		std::vector<NamedProperty>::iterator it;
 		for (it= m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++)
 		{
-			PyList_SET_ITEM(pylist, i++, PyUnicode_From_STR_String((*it).first));
+			PyList_SET_ITEM(pylist, i++, PyUnicode_From_STR_String(*it->m_name));
 		}
 
 		return pylist;
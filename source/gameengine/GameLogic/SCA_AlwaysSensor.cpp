@@ -84,6 +84,14 @@ bool SCA_AlwaysSensor::IsPositiveTrigger()
 
 
 
+bool SCA_AlwaysSensor::WaitForChange()
+{
+	// Only the first evaluation after Init triggers.
+	return !m_alwaysresult;
+}
+
+
+
 bool SCA_AlwaysSensor::Evaluate()
 {
 	/* Nice! :) */
@@ -48,6 +48,7 @@ public:
 	virtual bool Evaluate();
 	virtual bool IsPositiveTrigger();
 	virtual void Init();
+	virtual bool WaitForChange();
 };
 
 #endif  /* __SCA_ALWAYSSENSOR_H__ */
@@ -52,10 +52,23 @@ SCA_BasicEventManager::~SCA_BasicEventManager()
 
 void SCA_BasicEventManager::NextFrame()
 {
+	if (m_sensors.Empty()) {
+		return;
+	}
+
+	/* The sensors can be moved to the idle list while iterating, and the sensors woken
+	 * meanwhile are added after the last one, they are evaluated from the next frame. */
+	SCA_ISensor *last = (SCA_ISensor *)m_sensors.Back();
 	SG_DList::iterator<SCA_ISensor> it(m_sensors);
-	for (it.begin();!it.end();++it)
-	{
-		(*it)->Activate(m_logicmgr);
+	it.begin();
+	while (true) {
+		SCA_ISensor *sensor = *it;
+		++it;
+		sensor->Activate(m_logicmgr);
+		sensor->Sleep();
+		if (sensor == last) {
+			break;
+		}
 	}
 }
 
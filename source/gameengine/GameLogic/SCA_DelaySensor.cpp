@@ -89,6 +89,14 @@ bool SCA_DelaySensor::IsPositiveTrigger()
 	return (m_invert ? !m_lastResult : m_lastResult);
 }
 
+bool SCA_DelaySensor::WaitForChange()
+{
+	/* A delay not repeated keeps its last result once its duration is over, until Init.
+	 * The result switches off one frame after the end of a non null duration. */
+	return (!m_repeat && !m_reset && m_frameCount != -1 && m_frameCount >= m_delay + m_duration &&
+	        m_lastResult == (m_duration == 0));
+}
+
 bool SCA_DelaySensor::Evaluate()
 {
 	bool trigger = false;
@@ -159,9 +167,9 @@ PyMethodDef SCA_DelaySensor::Methods[] = {
 };
 
 PyAttributeDef SCA_DelaySensor::Attributes[] = {
-	KX_PYATTRIBUTE_INT_RW("delay",0,100000,true,SCA_DelaySensor,m_delay),
-	KX_PYATTRIBUTE_INT_RW("duration",0,100000,true,SCA_DelaySensor,m_duration),
-	KX_PYATTRIBUTE_BOOL_RW("repeat",SCA_DelaySensor,m_repeat),
+	KX_PYATTRIBUTE_INT_RW_CHECK("delay",0,100000,true,SCA_DelaySensor,m_delay,pyattr_check_wake),
+	KX_PYATTRIBUTE_INT_RW_CHECK("duration",0,100000,true,SCA_DelaySensor,m_duration,pyattr_check_wake),
+	KX_PYATTRIBUTE_BOOL_RW_CHECK("repeat",SCA_DelaySensor,m_repeat,pyattr_check_wake),
 	{ NULL }	//Sentinel
 };
 
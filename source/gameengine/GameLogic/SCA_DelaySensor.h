@@ -56,6 +56,7 @@ public:
 	virtual bool Evaluate();
 	virtual bool IsPositiveTrigger();
 	virtual void Init();
+	virtual bool WaitForChange();
 
 
 	/* --------------------------------------------------------------------- */
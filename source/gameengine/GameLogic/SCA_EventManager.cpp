@@ -47,6 +47,7 @@ SCA_EventManager::~SCA_EventManager()
 {
 	// all sensors should be removed
 	assert(m_sensors.Empty());
+	assert(m_idleSensors.Empty());
 }
 
 void SCA_EventManager::RegisterSensor(class SCA_ISensor* sensor)
@@ -54,6 +55,18 @@ void SCA_EventManager::RegisterSensor(class SCA_ISensor* sensor)
 	m_sensors.AddBack(sensor);
 }
 
+void SCA_EventManager::SleepSensor(class SCA_ISensor* sensor)
+{
+	sensor->Delink();
+	m_idleSensors.AddBack(sensor);
+}
+
+void SCA_EventManager::WakeSensor(class SCA_ISensor* sensor)
+{
+	sensor->Delink();
+	m_sensors.AddBack(sensor);
+}
+
 void SCA_EventManager::RemoveSensor(class SCA_ISensor* sensor)
 {
 	sensor->Delink();
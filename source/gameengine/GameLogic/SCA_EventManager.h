@@ -46,6 +46,10 @@ protected:
 	// use a set to speed-up insertion/removal
 	//std::set <class SCA_ISensor*>				m_sensors;
 	SG_DList		m_sensors;
+	/** Sensors not evaluated by NextFrame until a change wakes them, see SCA_ISensor::CanSleep.
+	 * Only the managers calling SleepSensor have idle sensors.
+	 */
+	SG_DList		m_idleSensors;
 
 public:
 	enum EVENT_MANAGER_TYPE {
@@ -72,6 +76,10 @@ public:
 	virtual void    UpdateFrame();
 	virtual void	EndFrame();
 	virtual void	RegisterSensor(class SCA_ISensor* sensor);
+	/// Move a registered sensor to the idle sensors.
+	void			SleepSensor(class SCA_ISensor* sensor);
+	/// Move an idle sensor back to the evaluated sensors, called by SCA_ISensor::Wake.
+	void			WakeSensor(class SCA_ISensor* sensor);
 	int		GetType();
 	//SG_DList &GetSensors() { return m_sensors; }
 
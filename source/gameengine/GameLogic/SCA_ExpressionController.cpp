@@ -51,7 +51,8 @@ SCA_ExpressionController::SCA_ExpressionController(SCA_IObject* gameobj,
 												   const STR_String& exprtext)
 	:SCA_IController(gameobj),
 	m_exprText(exprtext),
-	m_exprCache(NULL)
+	m_exprCache(NULL),
+	m_compiledExpr(NULL)
 {
 }
 
@@ -61,6 +62,8 @@ SCA_ExpressionController::~SCA_ExpressionController()
 {
 	if (m_exprCache)
 		m_exprCache->Release();
+	if (m_compiledExpr)
+		delete m_compiledExpr;
 }
 
 
@@ -70,6 +73,7 @@ CValue* SCA_ExpressionController::GetReplica()
 	SCA_ExpressionController* replica = new SCA_ExpressionController(*this);
 	replica->m_exprText = m_exprText;
 	replica->m_exprCache = NULL;
+	replica->m_compiledExpr = NULL;
 	// this will copy properties and so on...
 	replica->ProcessReplica();
 
@@ -86,6 +90,11 @@ void SCA_ExpressionController::Delete()
 		m_exprCache->Release();
 		m_exprCache = NULL;
 	}
+	if (m_compiledExpr)
+	{
+		delete m_compiledExpr;
+		m_compiledExpr = NULL;
+	}
 	Release();
 }
 
@@ -99,8 +108,18 @@ void SCA_ExpressionController::Trigger(SCA_LogicManager* logicmgr)
 		CParser parser;
 		parser.SetContext(this->AddRef());
 		m_exprCache = parser.ProcessText(m_exprText);
+		if (m_exprCache)
+			m_compiledExpr = CCompiledExpr::Compile(m_exprCache);
 	}
-	if (m_exprCache)
+
+	CCompiledValue compiledvalue;
+	if (m_compiledExpr && m_compiledExpr->Evaluate(this, compiledvalue))
+	{
+		float num = (float)compiledvalue.GetNumber();
+		expressionresult = !MT_fuzzyZero(num);
+	}
+	// The compiled expression stops on errors and strings creation, the tree is calculated instead.
+	else if (m_exprCache)
 	{
 		CValue* value = m_exprCache->Calculate();
 		if (value)
@@ -129,6 +148,11 @@ void SCA_ExpressionController::Trigger(SCA_LogicManager* logicmgr)
 
 
 CValue* SCA_ExpressionController::FindIdentifier(const STR_String& identifiername)
+{
+	return FindIdentifier(identifiername, EXP_PROPERTY_ID_NONE);
+}
+
+CValue *SCA_ExpressionController::FindIdentifier(const STR_String& identifiername, unsigned int id)
 {
 
 	CValue* identifierval = NULL;
@@ -154,6 +178,28 @@ CValue* SCA_ExpressionController::FindIdentifier(const STR_String& identifiernam
 	if (identifierval)
 		return identifierval;
 
-	return  GetParent()->FindIdentifier(identifiername);
+	return  GetParent()->FindIdentifier(identifiername, id);
+
+}
+
+bool SCA_ExpressionController::GetIdentifierValue(const STR_String& name, unsigned int id, CCompiledValue& value)
+{
+	for (vector<SCA_ISensor*>::const_iterator is=m_linkedsensors.begin();
+	!(is==m_linkedsensors.end());is++)
+	{
+		SCA_ISensor* sensor = *is;
+		if (sensor->GetName() == name)
+		{
+			value.m_type = CCompiledValue::BOOL;
+			value.m_bool = sensor->GetState();
+			return true;
+		}
+	}
+
+	// Names with a dot are looked up in a sub context by FindIdentifier.
+	if (id == EXP_PROPERTY_ID_NONE)
+		return false;
 
+	CValue* prop = GetParent()->GetPropertyFromId(id);
+	return (prop && value.SetValue(prop));
 }
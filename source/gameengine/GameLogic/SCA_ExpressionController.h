@@ -36,12 +36,15 @@
 #define __SCA_EXPRESSIONCONTROLLER_H__
 
 #include "SCA_IController.h"
+#include "EXP_CompiledExpr.h"
 
-class SCA_ExpressionController : public SCA_IController
+class SCA_ExpressionController : public SCA_IController, public CCompiledExprContext
 {
 //	Py_Header
 	STR_String			m_exprText;
 	CExpression*		m_exprCache;
+	/// Compiled m_exprCache, NULL if the expression can't be compiled.
+	CCompiledExpr*		m_compiledExpr;
 
 public:
 	SCA_ExpressionController(SCA_IObject* gameobj,
@@ -51,6 +54,9 @@ public:
 	virtual CValue* GetReplica();
 	virtual void Trigger(SCA_LogicManager* logicmgr);
 	virtual CValue*		FindIdentifier(const STR_String& identifiername);
+	virtual CValue*		FindIdentifier(const STR_String& identifiername, unsigned int id);
+	/// Same as FindIdentifier for the compiled expression.
+	virtual bool		GetIdentifierValue(const STR_String& name, unsigned int id, CCompiledValue& value);
 	/** 
 	 *  used to release the expression cache
 	 *  so that self references are removed before the controller itself is released
@@ -70,6 +70,7 @@ SCA_ISensor::SCA_ISensor(SCA_IObject* gameobj,
 	m_skipped_ticks = 0;
 	m_state = false;
 	m_prev_state = false;
+	m_idle = false;
 	
 	m_eventmgr = eventmgr;
 }
@@ -84,6 +85,7 @@ void SCA_ISensor::ProcessReplica()
 {
 	SCA_ILogicBrick::ProcessReplica();
 	m_linkedcontrollers.clear();
+	m_idle = false;
 }
 
 bool SCA_ISensor::IsPositiveTrigger()
@@ -143,6 +145,50 @@ bool SCA_ISensor::IsSuspended()
 void SCA_ISensor::Resume()
 {
 	m_suspended = false;
+	Wake();
+}
+
+void SCA_ISensor::Sleep()
+{
+	if (m_idle || !m_links) {
+		return;
+	}
+
+	// A suspended sensor isn't evaluated anyway.
+	if (!m_suspended) {
+		// The pulses and the level triggers of the controllers just activated need an evaluation each frame.
+		if (m_pos_pulsemode || m_neg_pulsemode || m_level) {
+			return;
+		}
+		// The previous state and the tap mode change the state or the status at the next frame.
+		if (m_state != m_prev_state || (m_tap && m_state)) {
+			return;
+		}
+		if (!WaitForChange()) {
+			return;
+		}
+	}
+
+	m_idle = true;
+	m_eventmgr->SleepSensor(this);
+}
+
+void SCA_ISensor::Wake()
+{
+	if (m_idle) {
+		m_idle = false;
+		StopWaiting();
+		m_eventmgr->WakeSensor(this);
+	}
+}
+
+bool SCA_ISensor::WaitForChange()
+{
+	return false;
+}
+
+void SCA_ISensor::StopWaiting()
+{
 }
 
 void SCA_ISensor::Init()
@@ -178,6 +224,10 @@ void SCA_ISensor::Replace_EventManager(class SCA_LogicManager* logicmgr)
 	if (m_links) { /* true if we're used currently */
 
 		m_eventmgr->RemoveSensor(this);
+		if (m_idle) {
+			m_idle = false;
+			StopWaiting();
+		}
 		m_eventmgr= logicmgr->FindEventManager(m_eventmgr->GetType());
 		m_eventmgr->RegisterSensor(this);
 	}
@@ -221,6 +271,10 @@ void SCA_ISensor::UnlinkAllControllers()
 void SCA_ISensor::UnregisterToManager()
 {
 	m_eventmgr->RemoveSensor(this);
+	if (m_idle) {
+		m_idle = false;
+		StopWaiting();
+	}
 	m_links = 0;
 }
 
@@ -330,6 +384,7 @@ KX_PYMETHODDEF_DOC_NOARGS(SCA_ISensor, reset,
 {
 	Init();
 	m_prev_state = false;
+	Wake();
 	Py_RETURN_NONE;
 }
 
@@ -365,10 +420,10 @@ PyMethodDef SCA_ISensor::Methods[] = {
 };
 
 PyAttributeDef SCA_ISensor::Attributes[] = {
-	KX_PYATTRIBUTE_BOOL_RW("usePosPulseMode",SCA_ISensor,m_pos_pulsemode),
-	KX_PYATTRIBUTE_BOOL_RW("useNegPulseMode",SCA_ISensor,m_neg_pulsemode),
+	KX_PYATTRIBUTE_BOOL_RW_CHECK("usePosPulseMode",SCA_ISensor,m_pos_pulsemode,pyattr_check_wake),
+	KX_PYATTRIBUTE_BOOL_RW_CHECK("useNegPulseMode",SCA_ISensor,m_neg_pulsemode,pyattr_check_wake),
 	KX_PYATTRIBUTE_INT_RW("skippedTicks",0,100000,true,SCA_ISensor,m_skipped_ticks),
-	KX_PYATTRIBUTE_BOOL_RW("invert",SCA_ISensor,m_invert),
+	KX_PYATTRIBUTE_BOOL_RW_CHECK("invert",SCA_ISensor,m_invert,pyattr_check_wake),
 	KX_PYATTRIBUTE_BOOL_RW_CHECK("level",SCA_ISensor,m_level,pyattr_check_level),
 	KX_PYATTRIBUTE_BOOL_RW_CHECK("tap",SCA_ISensor,m_tap,pyattr_check_tap),
 	KX_PYATTRIBUTE_RO_FUNCTION("triggered", SCA_ISensor, pyattr_get_triggered),
@@ -435,6 +490,7 @@ int SCA_ISensor::pyattr_check_level(void *self_v, const KX_PYATTRIBUTE_DEF *attr
 	SCA_ISensor* self = static_cast<SCA_ISensor*>(self_v);
 	if (self->m_level)
 		self->m_tap = false;
+	self->Wake();
 	return 0;
 }
 
@@ -443,6 +499,14 @@ int SCA_ISensor::pyattr_check_tap(void *self_v, const KX_PYATTRIBUTE_DEF *attrde
 	SCA_ISensor* self = static_cast<SCA_ISensor*>(self_v);
 	if (self->m_tap)
 		self->m_level = false;
+	self->Wake();
+	return 0;
+}
+
+int SCA_ISensor::pyattr_check_wake(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef)
+{
+	SCA_ISensor* self = static_cast<SCA_ISensor*>(self_v);
+	self->Wake();
 	return 0;
 }
 
@@ -42,7 +42,7 @@
  * Interface Class for all logic Sensors. Implements
  * pulsemode,pulsefrequency 
  * Use of SG_DList element: link sensors to their respective event manager
- *                          Head: SCA_EventManager::m_sensors
+ *                          Head: SCA_EventManager::m_sensors or SCA_EventManager::m_idleSensors
  * Use of SG_QList element: not used
  */
 class SCA_ISensor : public SCA_ILogicBrick
@@ -90,6 +90,9 @@ protected:
 	/** previous state (for tap option) */
 	bool m_prev_state;
 
+	/** sensor is not evaluated until Wake is called, see Sleep */
+	bool m_idle;
+
 	std::vector<class SCA_IController*>		m_linkedcontrollers;
 
 public:
@@ -116,6 +119,22 @@ public:
 	virtual bool IsPositiveTrigger();
 	virtual void Init();
 
+	/** Stop evaluating the sensor until Wake is called, if nothing but the changes
+	 * subscribed by WaitForChange can trigger it. Called after Activate by the event
+	 * managers which don't need to evaluate their sensors each frame.
+	 */
+	void Sleep();
+	/** Evaluate the sensor again from the next frame, called when something that
+	 * could trigger an idle sensor changed.
+	 */
+	void Wake();
+	/** Return true if Evaluate keeps returning false with the same positive trigger until
+	 * Wake is called, after subscribing to the changes which call Wake.
+	 */
+	virtual bool WaitForChange();
+	/// Cancel the subscriptions of WaitForChange.
+	virtual void StopWaiting();
+
 	virtual CValue* GetReplica()=0;
 
 	/** Set parameters for the pulsing behavior.
@@ -206,6 +225,8 @@ public:
 
 	static int          pyattr_check_level(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef);
 	static int          pyattr_check_tap(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef);
+	/// Wake the sensor after a change of an attribute used by Evaluate or IsPositiveTrigger.
+	static int          pyattr_check_wake(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef);
 	
 	enum SensorStatus {
 		KX_SENSOR_INACTIVE = 0,
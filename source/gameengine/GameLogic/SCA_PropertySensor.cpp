@@ -46,6 +46,8 @@
 #include "EXP_BoolValue.h"
 #include "EXP_FloatValue.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 
 SCA_PropertySensor::SCA_PropertySensor(SCA_EventManager* eventmgr,
 									 SCA_IObject* gameobj,
@@ -57,22 +59,59 @@ SCA_PropertySensor::SCA_PropertySensor(SCA_EventManager* eventmgr,
 	  m_checktype(checktype),
 	  m_checkpropval(propval),
 	  m_checkpropmaxval(propmaxval),
-	  m_checkpropname(propname)
+	  m_checkpropname(propname),
+	  m_checkpropid(CPropertyNames::InternIdentifier(propname))
 {
 	//CParser pars;
 	//pars.SetContext(this->AddRef());
 	//CValue* resultval = m_rightexpr->Calculate();
 
-	CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname);
+	CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname, m_checkpropid);
 	if (!orgprop->IsError())
 	{
 		m_previoustext = orgprop->GetText();
 	}
 	orgprop->Release();
 
+	UpdateCheckValues();
 	Init();
 }
 
+void SCA_PropertySensor::UpdateCheckValues()
+{
+	m_checkvalfloat = m_checkpropval.ToFloat();
+	m_checkmaxvalfloat = m_checkpropmaxval.ToFloat();
+	m_checkvalscanned = (sscanf(m_checkpropval.ReadPtr(), "%f", &m_checkvalscanfloat) == 1);
+
+	// An integer property is equal to the value only if its text is exactly the value.
+	m_checkvalint = strtoll(m_checkpropval.ReadPtr(), NULL, 10);
+	STR_String inttext;
+	inttext.Format("%lld", m_checkvalint);
+	m_checkvalisint = (inttext == m_checkpropval);
+}
+
+CValue *SCA_PropertySensor::FindCheckProperty()
+{
+	CValue *orgprop;
+	if (m_checkpropid != EXP_PROPERTY_ID_NONE) {
+		orgprop = GetParent()->GetPropertyFromId(m_checkpropid);
+		if (!orgprop) {
+			return NULL;
+		}
+		orgprop->AddRef();
+	}
+	else {
+		// The name contains a dot, look it up in the sub context.
+		orgprop = GetParent()->FindIdentifier(m_checkpropname, m_checkpropid);
+	}
+
+	if (orgprop->IsError()) {
+		orgprop->Release();
+		return NULL;
+	}
+	return orgprop;
+}
+
 void SCA_PropertySensor::Init()
 {
 	m_recentresult = false;
@@ -124,6 +163,45 @@ bool SCA_PropertySensor::Evaluate()
 }
 
 
+bool SCA_PropertySensor::WaitForChange()
+{
+	// A missing property or a property of a sub context can be added without notification.
+	if (m_reset || m_checkpropid == EXP_PROPERTY_ID_NONE) {
+		return false;
+	}
+
+	CValue *orgprop = GetParent()->GetPropertyFromId(m_checkpropid);
+	if (!orgprop) {
+		return false;
+	}
+
+	// Only the simple values notify all their modifications.
+	switch (orgprop->GetValueType()) {
+		case VALUE_INT_TYPE:
+		case VALUE_FLOAT_TYPE:
+		case VALUE_BOOL_TYPE:
+		case VALUE_STRING_TYPE:
+		{
+			orgprop->AddListener(this);
+			return true;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+void SCA_PropertySensor::StopWaiting()
+{
+	StopListening();
+}
+
+void SCA_PropertySensor::ValueModified(CValue *value)
+{
+	Wake();
+}
+
 bool	SCA_PropertySensor::CheckPropertyCondition()
 {
 	m_recentresult=false;
@@ -136,33 +214,48 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 		/* fall-through */
 	case KX_PROPSENSOR_EQUAL:
 		{
-			CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-			if (!orgprop->IsError())
+			CValue* orgprop = FindCheckProperty();
+			if (orgprop)
 			{
-				const STR_String& testprop = orgprop->GetText();
-				// Force strings to upper case, to avoid confusion in
-				// bool tests. It's stupid the prop's identity is lost
-				// on the way here...
-				if ((&testprop == &CBoolValue::sTrueString) || (&testprop == &CBoolValue::sFalseString)) {
-					m_checkpropval.Upper();
-				}
-				result = (testprop == m_checkpropval);
-				
-				/* Patch: floating point values cant use strings usefully since you can have "0.0" == "0.0000"
-				 * this could be made into a generic Value class function for comparing values with a string.
-				 */
-				if (result==false && (orgprop->GetValueType() == VALUE_FLOAT_TYPE)) {
-					float f;
-					if (sscanf(m_checkpropval.ReadPtr(), "%f", &f) == 1) {
-						result = (f == ((CFloatValue *)orgprop)->GetFloat());
-					} 
-					else {
-						/* error */
+				switch (orgprop->GetValueType()) {
+					case VALUE_INT_TYPE:
+					{
+						// Same as comparing the text of the integer, without formatting it.
+						result = m_checkvalisint && (((CIntValue *)orgprop)->GetInt() == m_checkvalint);
+						break;
+					}
+					case VALUE_FLOAT_TYPE:
+					{
+						/* Patch: floating point values cant use strings usefully since you can have "0.0" == "0.0000"
+						 * this could be made into a generic Value class function for comparing values with a string.
+						 */
+						const float value = ((CFloatValue *)orgprop)->GetFloat();
+						if (m_checkvalscanned) {
+							result = (m_checkvalscanfloat == value);
+							/* The text of the float is only equal to the value if the value rounds to it,
+							 * the nearest float of the value is then never further than 1e-6. */
+							if (!result && !(fabs((double)value - (double)m_checkvalscanfloat) > 2e-6)) {
+								result = (orgprop->GetText() == m_checkpropval);
+							}
+						}
+						/* A text not read by sscanf is never the text of a float. */
+						break;
+					}
+					default:
+					{
+						const STR_String& testprop = orgprop->GetText();
+						// Force strings to upper case, to avoid confusion in
+						// bool tests. It's stupid the prop's identity is lost
+						// on the way here...
+						if ((&testprop == &CBoolValue::sTrueString) || (&testprop == &CBoolValue::sFalseString)) {
+							m_checkpropval.Upper();
+						}
+						result = (testprop == m_checkpropval);
+						break;
 					}
 				}
-				/* end patch */
+				orgprop->Release();
 			}
-			orgprop->Release();
 
 			if (reverse)
 				result = !result;
@@ -192,11 +285,11 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 		}
 	case KX_PROPSENSOR_INTERVAL:
 		{
-			CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-			if (!orgprop->IsError())
+			CValue* orgprop = FindCheckProperty();
+			if (orgprop)
 			{
-				const float min = m_checkpropval.ToFloat();
-				const float max = m_checkpropmaxval.ToFloat();
+				const float min = m_checkvalfloat;
+				const float max = m_checkmaxvalfloat;
 				float val;
 
 				if (orgprop->GetValueType() == VALUE_STRING_TYPE){
@@ -207,14 +300,14 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 				}
 
 				result = (min <= val) && (val <= max);
+				orgprop->Release();
 			}
-			orgprop->Release();
 
 		break;
 		}
 	case KX_PROPSENSOR_CHANGED:
 		{
-			CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname);
+			CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname, m_checkpropid);
 				
 			if (!orgprop->IsError())
 			{
@@ -234,10 +327,10 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 		/* fall-through */
 	case KX_PROPSENSOR_GREATERTHAN:
 		{
-			CValue* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-			if (!orgprop->IsError())
+			CValue* orgprop = FindCheckProperty();
+			if (orgprop)
 			{
-				const float ref = m_checkpropval.ToFloat();
+				const float ref = m_checkvalfloat;
 				float val;
 
 				if (orgprop->GetValueType() == VALUE_STRING_TYPE){
@@ -254,8 +347,8 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 					result = val > ref;
 				}
 
+				orgprop->Release();
 			}
-			orgprop->Release();
 
 			break;
 		}
@@ -275,6 +368,11 @@ CValue* SCA_PropertySensor::FindIdentifier(const STR_String& identifiername)
 	return  GetParent()->FindIdentifier(identifiername);
 }
 
+CValue *SCA_PropertySensor::FindIdentifier(const STR_String& identifiername, unsigned int id)
+{
+	return GetParent()->FindIdentifier(identifiername, id);
+}
+
 #ifdef WITH_PYTHON
 
 /* ------------------------------------------------------------------------- */
@@ -288,6 +386,21 @@ int SCA_PropertySensor::validValueForProperty(void *self, const PyAttributeDef*)
 	 * function directly */
 
 	/*  There is no type checking at this moment, unfortunately...           */
+	SCA_PropertySensor *sensor = reinterpret_cast<SCA_PropertySensor *>(self);
+	sensor->UpdateCheckValues();
+	sensor->Wake();
+	return 0;
+}
+
+int SCA_PropertySensor::CheckPropertyName(void *self, const PyAttributeDef *attrdef)
+{
+	if (CheckProperty(self, attrdef) != 0) {
+		return 1;
+	}
+
+	SCA_PropertySensor *sensor = reinterpret_cast<SCA_PropertySensor *>(self);
+	sensor->m_checkpropid = CPropertyNames::InternIdentifier(sensor->m_checkpropname);
+	sensor->Wake();
 	return 0;
 }
 
@@ -319,8 +432,8 @@ PyMethodDef SCA_PropertySensor::Methods[] = {
 };
 
 PyAttributeDef SCA_PropertySensor::Attributes[] = {
-	KX_PYATTRIBUTE_INT_RW("mode",KX_PROPSENSOR_NODEF,KX_PROPSENSOR_MAX-1,false,SCA_PropertySensor,m_checktype),
-	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_PropertySensor,m_checkpropname,CheckProperty),
+	KX_PYATTRIBUTE_INT_RW_CHECK("mode",KX_PROPSENSOR_NODEF,KX_PROPSENSOR_MAX-1,false,SCA_PropertySensor,m_checktype,pyattr_check_wake),
+	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_PropertySensor,m_checkpropname,CheckPropertyName),
 	KX_PYATTRIBUTE_STRING_RW_CHECK("value",0,100,false,SCA_PropertySensor,m_checkpropval,validValueForProperty),
 	KX_PYATTRIBUTE_STRING_RW_CHECK("min",0,100,false,SCA_PropertySensor,m_checkpropval,validValueForProperty),
 	KX_PYATTRIBUTE_STRING_RW_CHECK("max",0,100,false,SCA_PropertySensor,m_checkpropmaxval,validValueForProperty),
@@ -34,8 +34,12 @@
 #define __SCA_PROPERTYSENSOR_H__
 
 #include "SCA_ISensor.h"
+#include "EXP_IntValue.h"
 
-class SCA_PropertySensor : public SCA_ISensor
+/** The sensor listens to its property while it's idle, the property
+ * is only read again after a modification.
+ */
+class SCA_PropertySensor : public SCA_ISensor, public CValueListener
 {
 	Py_Header
 	//class CExpression*	m_rightexpr;
@@ -43,10 +47,29 @@ class SCA_PropertySensor : public SCA_ISensor
 	STR_String		m_checkpropval;
 	STR_String		m_checkpropmaxval;
 	STR_String		m_checkpropname;
+	/// Identifier of m_checkpropname, see CValue::FindIdentifier.
+	unsigned int	m_checkpropid;
 	STR_String		m_previoustext;
 	bool			m_lastresult;
 	bool			m_recentresult;
 
+	/// m_checkpropval and m_checkpropmaxval parsed once, see UpdateCheckValues.
+	float			m_checkvalfloat;
+	float			m_checkmaxvalfloat;
+	/// m_checkpropval read by sscanf, used to compare float properties.
+	bool			m_checkvalscanned;
+	float			m_checkvalscanfloat;
+	/// True if m_checkpropval is the text of the integer m_checkvalint.
+	bool			m_checkvalisint;
+	cInt			m_checkvalint;
+
+	/// Parse the values compared to the property, to call when they change.
+	void UpdateCheckValues();
+	/** Return the checked property with a new reference, NULL if it doesn't exist.
+	 * Unlike FindIdentifier no error value is created for a missing property.
+	 */
+	CValue *FindCheckProperty();
+
  protected:
 
 public:
@@ -78,7 +101,11 @@ public:
 
 	virtual bool Evaluate();
 	virtual bool	IsPositiveTrigger();
+	virtual bool WaitForChange();
+	virtual void StopWaiting();
+	virtual void ValueModified(CValue *value);
 	virtual CValue*		FindIdentifier(const STR_String& identifiername);
+	virtual CValue*		FindIdentifier(const STR_String& identifiername, unsigned int id);
 
 #ifdef WITH_PYTHON
 
@@ -91,6 +118,9 @@ public:
 	 */
 	static int validValueForProperty(void* self, const PyAttributeDef*);
 
+	/// Check the property name and update its identifier.
+	static int CheckPropertyName(void *self, const PyAttributeDef *attrdef);
+
 #endif
 };
 
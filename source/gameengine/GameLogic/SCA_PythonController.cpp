@@ -40,6 +40,7 @@
 #include "SCA_ISensor.h"
 #include "SCA_IActuator.h"
 #include "EXP_PyObjectPlus.h"
+#include "SG_Profiler.h"
 
 #ifdef WITH_PYTHON
 #include "compile.h"
@@ -62,7 +63,8 @@ SCA_PythonController::SCA_PythonController(SCA_IObject* gameobj, int mode)
 	m_function_argc(0),
 	m_bModified(true),
 	m_debug(false),
-	m_mode(mode)
+	m_mode(mode),
+	m_profileName("Python controller")
 #ifdef WITH_PYTHON
 	, m_pythondictionary(NULL)
 #endif
@@ -148,6 +150,7 @@ void SCA_PythonController::SetScriptText(const STR_String& text)
 void SCA_PythonController::SetScriptName(const STR_String& name)
 {
 	m_scriptName = name;
+	m_profileName = SG_Profiler::InternName(std::string(name.ReadPtr()));
 }
 
 
@@ -385,6 +388,8 @@ bool SCA_PythonController::Import()
 
 void SCA_PythonController::Trigger(SCA_LogicManager* logicmgr)
 {
+	SG_PROFILE_ZONE(m_profileName);
+
 	m_sCurrentController = this;
 
 	PyObject *excdict=		NULL;
@@ -56,6 +56,8 @@ class SCA_PythonController : public SCA_IController
  protected:
 	STR_String				m_scriptText;
 	STR_String				m_scriptName;
+	/// Name of the controller zone in the profiler, interned script name.
+	const char				*m_profileName;
 #ifdef WITH_PYTHON
 	PyObject*				m_pythondictionary;	/* for SCA_PYEXEC_SCRIPT only */
 	PyObject*				m_pythonfunction;	/* for SCA_PYEXEC_MODULE only */
@@ -81,6 +81,11 @@ extern "C"
 
 #include "KX_NetworkMessageManager.h"
 #include "KX_BlenderSceneConverter.h"
+#include "SG_Profiler.h"
+
+#ifdef WITH_BULLET
+#include "CcdBvhCache.h"
+#endif
 
 #include "GPC_MouseDevice.h"
 #include "GPG_Canvas.h" 
@@ -577,7 +582,12 @@ bool GPG_Application::initEngine(GHOST_IWindow* window, const int stereoMode)
 		bool showBoundingBox = (SYS_GetCommandLineInt(syshandle, "show_bounding_box", gm->flag & GAME_SHOW_BOUNDING_BOX) != 0);
 		bool showArmatures = (SYS_GetCommandLineInt(syshandle, "show_armatures", gm->flag & GAME_SHOW_ARMATURES) != 0);
 		bool nodepwarnings = (SYS_GetCommandLineInt(syshandle, "ignore_deprecation_warnings", 1) != 0);
+#ifdef WITH_BULLET
+		// The triangle mesh trees are loaded from and saved in this directory when set.
+		CcdBvhCache::SetDirectory(SYS_GetCommandLineString(syshandle, "conversion_cache", ""));
+#endif
 		bool restrictAnimFPS = (gm->flag & GAME_RESTRICT_ANIM_UPDATES) != 0;
+		bool parallelScenes = (gm->flag & GAME_USE_PARALLEL_SCENES) != 0;
 
 		RAS_STORAGE_TYPE raster_storage = RAS_AUTO_STORAGE;
 		int storageInfo = RAS_STORAGE_INFO_NONE;
@@ -654,6 +664,7 @@ bool GPG_Application::initEngine(GHOST_IWindow* window, const int stereoMode)
 		m_ketsjiengine->SetUseFixedTime(fixed_framerate);
 		m_ketsjiengine->SetTimingDisplay(frameRate, profile, properties);
 		m_ketsjiengine->SetRestrictAnimationFPS(restrictAnimFPS);
+		m_ketsjiengine->SetUseParallelScenes(parallelScenes);
 		m_ketsjiengine->SetShowBoundingBox(showBoundingBox);
 		m_ketsjiengine->SetShowArmatures(showArmatures);
 
@@ -755,6 +766,11 @@ bool GPG_Application::startEngine(void)
 		m_rasterizer->Init();
 		m_ketsjiengine->StartEngine(true);
 		m_engineRunning = true;
+
+		// Record the profiler zones of the whole game, written when the engine stops.
+		if (SYS_GetCommandLineString(SYS_GetSystem(), "profile_trace", "")[0] != '\0') {
+			SG_Profiler::StartCapture();
+		}
 		
 		// Set the animation playback rate for ipo's and actions
 		// the framerate below should patch with FPS macro defined in blendef.h
@@ -788,6 +804,12 @@ void GPG_Application::stopEngine()
 	
 	m_ketsjiengine->StopEngine();
 
+	const char *tracepath = SYS_GetCommandLineString(SYS_GetSystem(), "profile_trace", "");
+	if (tracepath[0] != '\0') {
+		SG_Profiler::StopCapture(tracepath);
+		SG_Profiler::Update();
+	}
+
 	if (m_sceneconverter) {
 		delete m_sceneconverter;
 		m_sceneconverter = 0;
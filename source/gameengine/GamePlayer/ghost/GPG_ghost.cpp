@@ -278,8 +278,10 @@ static void usage(const char* program, bool isBlenderPlayer)
 	printf("       show_framerate                 0         Show the frame rate\n");
 	printf("       show_properties                0         Show debug properties\n");
 	printf("       show_profile                   0         Show profiling information\n");
+	printf("       profile_trace                            Write a Chrome trace of the profiler zones to this file\n");
 	printf("       blender_material               0         Enable material settings\n");
 	printf("       ignore_deprecation_warnings    1         Ignore deprecation warnings\n");
+	printf("       conversion_cache                         Load and save the converted physics meshes in this directory\n");
 	printf("\n");
 	printf("  - : all arguments after this are ignored, allowing python to access them from sys.argv\n");
 	printf("\n");
@@ -63,6 +63,7 @@ BL_Action::BL_Action(class KX_GameObject* gameobj)
 	m_tmpaction(NULL),
 	m_blendpose(NULL),
 	m_blendinpose(NULL),
+	m_curveList(NULL),
 	m_obj(gameobj),
 	m_startframe(0.f),
 	m_endframe(0.f),
@@ -155,6 +156,9 @@ bool BL_Action::Play(const char* name,
 	}
 	m_tmpaction = BKE_action_copy(m_action);
 
+	m_curveList = kxscene->GetSceneConverter()->GetActionCurveList(m_action);
+	m_curveBinding.Clear();
+
 	// First get rid of any old controllers
 	ClearControllerList();
 
@@ -432,7 +436,17 @@ void BL_Action::Update(float curtime)
 			obj->GetPose(&m_blendpose);
 
 		// Extract the pose from the action
-		obj->SetPoseByAction(m_tmpaction, m_localframe);
+		bPose *pose = obj->GetArmatureObject()->pose;
+		if (m_curveBinding.GetTarget() != pose) {
+			m_curveBinding.BindPose(m_curveList, m_tmpaction, pose);
+		}
+
+		if (m_curveBinding.IsValid()) {
+			m_curveBinding.Evaluate(m_localframe);
+		}
+		else {
+			obj->SetPoseByAction(m_tmpaction, m_localframe);
+		}
 
 		// Handle blending between armature actions
 		if (m_blendin && m_blendframe<m_blendin)
@@ -463,10 +477,19 @@ void BL_Action::Update(float curtime)
 		{
 			Key *key = shape_deformer->GetKey();
 
-			PointerRNA ptrrna;
-			RNA_id_pointer_create(&key->id, &ptrrna);
+			if (m_curveBinding.GetTarget() != key) {
+				m_curveBinding.BindKey(m_curveList, m_tmpaction, key);
+			}
 
-			animsys_evaluate_action(&ptrrna, m_tmpaction, NULL, m_localframe);
+			if (m_curveBinding.IsValid()) {
+				m_curveBinding.Evaluate(m_localframe);
+			}
+			else {
+				PointerRNA ptrrna;
+				RNA_id_pointer_create(&key->id, &ptrrna);
+
+				animsys_evaluate_action(&ptrrna, m_tmpaction, NULL, m_localframe);
+			}
 
 			// Handle blending between shape actions
 			if (m_blendin && m_blendframe < m_blendin)
@@ -497,6 +520,13 @@ void BL_Action::Update(float curtime)
 	}
 }
 
+void BL_Action::EvaluateIPOs()
+{
+	for (std::vector<SG_Controller *>::iterator it = m_sg_contr_list.begin(); it != m_sg_contr_list.end(); ++it) {
+		(*it)->Evaluate(m_localframe);
+	}
+}
+
 void BL_Action::UpdateIPOs()
 {
 	/* This function does nothing if the scene graph controllers are already removed
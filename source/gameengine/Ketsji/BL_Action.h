@@ -28,6 +28,8 @@
 #define __BL_ACTION_H__
 
 
+#include "BL_ActionCurves.h"
+
 #include <vector>
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -42,6 +44,10 @@ private:
 	struct bPose* m_blendpose;
 	struct bPose* m_blendinpose;
 	std::vector<class SG_Controller*> m_sg_contr_list;
+	/// Targets of the F-curves of m_action, shared with the other objects playing it.
+	BL_ActionCurveList *m_curveList;
+	/// F-curves of m_tmpaction bound to the pose or shape key of the object.
+	BL_ActionCurveBinding m_curveBinding;
 	class KX_GameObject* m_obj;
 	std::vector<float>	m_blendshape;
 	std::vector<float>	m_blendinshape;
@@ -103,6 +109,11 @@ public:
 	 * Update the action's frame, etc.
 	 */
 	void Update(float curtime);
+	/**
+	 * Evaluate the IPO curves for the current frame ahead of UpdateIPOs,
+	 * thread-safe for different objects.
+	 */
+	void EvaluateIPOs();
 	/**
 	 * Update object IPOs (note: not thread-safe!)
 	 */
@@ -124,6 +124,11 @@ public:
 	 */
 	void Update(float);
 
+	/**
+	 * Evaluate the IPO curves of the actions ahead of UpdateIPOs
+	 */
+	void EvaluateIPOs();
+
 	/**
 	 * Update object IPOs (note: not thread-safe!)
 	 */
@@ -53,28 +53,30 @@ const std::vector<KX_NetworkMessageManager::Message> KX_NetworkMessageManager::G
 {
 	std::vector<KX_NetworkMessageManager::Message> messages;
 
-	// look at messages without receiver.
-	std::map<STR_String, std::vector<Message> >& messagesNoReceiver = m_messages[1 - m_currentList][""];
-	std::map<STR_String, std::vector<Message> >& messagesReceiver = m_messages[1 - m_currentList][to];
-	if (subject.IsEmpty()) {
-		// Add all message without receiver and subject.
-		for (std::map<STR_String, std::vector<Message> >::iterator it = messagesNoReceiver.begin(), end = messagesNoReceiver.end();
-			it != end; ++it)
-		{
-			messages.insert(messages.end(), it->second.begin(), it->second.end());
+	/* Look at messages without receiver and with the given receiver.
+	 * The maps are only searched and never modified here as scenes
+	 * updated concurrently can read the messages at the same time. */
+	const ReceiverMap& receivers = m_messages[1 - m_currentList];
+	const STR_String receiverNames[2] = {"", to};
+	for (unsigned short i = 0; i < 2; ++i) {
+		ReceiverMap::const_iterator receiverit = receivers.find(receiverNames[i]);
+		if (receiverit == receivers.end()) {
+			continue;
 		}
-		// Add all message with the given receiver and no subject.
-		for (std::map<STR_String, std::vector<Message> >::iterator it = messagesReceiver.begin(), end = messagesReceiver.end();
-			 it != end; ++it)
-		{
-			messages.insert(messages.end(), it->second.begin(), it->second.end());
+
+		const SubjectMap& subjects = receiverit->second;
+		if (subject.IsEmpty()) {
+			// Add all message with this receiver and any subject.
+			for (SubjectMap::const_iterator it = subjects.begin(), end = subjects.end(); it != end; ++it) {
+				messages.insert(messages.end(), it->second.begin(), it->second.end());
+			}
+		}
+		else {
+			SubjectMap::const_iterator it = subjects.find(subject);
+			if (it != subjects.end()) {
+				messages.insert(messages.end(), it->second.begin(), it->second.end());
+			}
 		}
-	}
-	else {
-		std::vector<KX_NetworkMessageManager::Message>& messagesNoReceiverSubject = messagesNoReceiver[subject];
-		messages.insert(messages.end(), messagesNoReceiverSubject.begin(), messagesNoReceiverSubject.end());
-		std::vector<KX_NetworkMessageManager::Message>& messagesReceiverSubject = messagesReceiver[subject];
-		messages.insert(messages.end(), messagesReceiverSubject.begin(), messagesReceiverSubject.end());
 	}
 
 	return messages;
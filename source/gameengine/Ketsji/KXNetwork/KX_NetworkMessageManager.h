@@ -57,11 +57,14 @@ public:
 	};
 
 private:
+	typedef std::map<STR_String, std::vector<Message> > SubjectMap;
+	typedef std::map<STR_String, SubjectMap> ReceiverMap;
+
 	/** List of all messages, filtered by receiver object(s) name and subject name.
 	 * We use two lists, one handle sended message in the current frame and the other
 	 * is used for handle message sended in the last frame for sensors.
 	 */
-	std::map<STR_String, std::map<STR_String, std::vector<Message> > > m_messages[2];
+	ReceiverMap m_messages[2];
 
 	/** Since we use two list for the current and last frame we have to switch of
 	 * current message list each frame. This value is only 0 or 1.
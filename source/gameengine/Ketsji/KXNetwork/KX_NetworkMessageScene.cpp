@@ -33,7 +33,8 @@
 #include "KX_NetworkMessageScene.h"
 
 KX_NetworkMessageScene::KX_NetworkMessageScene(KX_NetworkMessageManager *messageManager)
-	:m_messageManager(messageManager)
+	:m_messageManager(messageManager),
+	m_deferMessages(false)
 {
 }
 
@@ -49,11 +50,31 @@ void KX_NetworkMessageScene::SendMessage(STR_String to, SCA_IObject *from, STR_S
 	message.subject = subject;
 	message.body = body;
 
-	// Put the new message in map for the given receiver and subject.
-	m_messageManager->AddMessage(message);
+	if (m_deferMessages) {
+		m_deferredMessages.push_back(message);
+	}
+	else {
+		// Put the new message in map for the given receiver and subject.
+		m_messageManager->AddMessage(message);
+	}
 }
 
 const std::vector<KX_NetworkMessageManager::Message> KX_NetworkMessageScene::FindMessages(STR_String to, STR_String subject)
 {
 	return m_messageManager->GetMessages(to, subject);
 }
+
+void KX_NetworkMessageScene::SetDeferMessages(bool defer)
+{
+	m_deferMessages = defer;
+}
+
+void KX_NetworkMessageScene::FlushMessages()
+{
+	for (std::vector<KX_NetworkMessageManager::Message>::iterator it = m_deferredMessages.begin(), end = m_deferredMessages.end();
+		 it != end; ++it)
+	{
+		m_messageManager->AddMessage(*it);
+	}
+	m_deferredMessages.clear();
+}
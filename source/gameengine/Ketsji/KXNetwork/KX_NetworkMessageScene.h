@@ -50,6 +50,10 @@ class KX_NetworkMessageScene
 private:
 	KX_NetworkMessageManager *m_messageManager;
 
+	/// Messages sent while the message sending is deferred, see SetDeferMessages.
+	std::vector<KX_NetworkMessageManager::Message> m_deferredMessages;
+	bool m_deferMessages;
+
 public:
 	KX_NetworkMessageScene(KX_NetworkMessageManager *messageManager);
 	virtual ~KX_NetworkMessageScene();
@@ -68,6 +72,14 @@ public:
 	 * \param subject The message subject/filter.
 	 */
 	const std::vector<KX_NetworkMessageManager::Message> FindMessages(STR_String to, STR_String subject);
+
+	/** Keep the sent messages in this scene instead of adding them to the manager,
+	 * used when the scene logic is updated on a worker thread.
+	 * \param defer True to defer the messages, false to send them directly again.
+	 */
+	void SetDeferMessages(bool defer);
+	/// Add all the deferred messages to the manager in the order they were sent.
+	void FlushMessages();
 };
 
 #endif // __KX_NETWORKMESSAGESCENE_H__
@@ -40,7 +40,7 @@
 #include "MT_Matrix3x3.h"
 #include "KX_GameObject.h"
 #include "KX_RayCast.h"
-#include "KX_Globals.h" // KX_GetActiveScene
+#include "KX_Scene.h"
 #include "RAS_MeshObject.h"
 
 #include <stdio.h>
@@ -333,7 +333,7 @@ bool KX_ConstraintActuator::Update(double curtime, bool frame)
 			}
 			{
 				MT_Vector3 topoint = position + (m_maximumBound) * direction;
-				PHY_IPhysicsEnvironment* pe = KX_GetActiveScene()->GetPhysicsEnvironment();
+				PHY_IPhysicsEnvironment* pe = obj->GetScene()->GetPhysicsEnvironment();
 				PHY_IPhysicsController *spc = obj->GetPhysicsController();
 
 				if (!pe) {
@@ -445,7 +445,7 @@ bool KX_ConstraintActuator::Update(double curtime, bool frame)
 			}
 			normal.normalize();
 			{
-				PHY_IPhysicsEnvironment* pe = KX_GetActiveScene()->GetPhysicsEnvironment();
+				PHY_IPhysicsEnvironment* pe = obj->GetScene()->GetPhysicsEnvironment();
 				PHY_IPhysicsController *spc = obj->GetPhysicsController();
 
 				if (!pe) {
@@ -0,0 +1,183 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_DistanceSchedule.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_DistanceSchedule.h"
+#include "KX_GameObject.h"
+
+KX_DistanceSchedule::KX_DistanceSchedule(Slot slot)
+	:m_slot(slot),
+	m_travel(0.0),
+	m_cameraPosition(0.0f, 0.0f, 0.0f),
+	m_cameraValid(false)
+{
+}
+
+KX_DistanceSchedule::~KX_DistanceSchedule()
+{
+}
+
+unsigned int KX_DistanceSchedule::GetCount() const
+{
+	return m_heap.size();
+}
+
+void KX_DistanceSchedule::SetIndex(unsigned int index)
+{
+	m_heap[index].m_gameobj->SetDistanceScheduleIndex(m_slot, index);
+}
+
+void KX_DistanceSchedule::SiftUp(unsigned int index)
+{
+	const Entry entry = m_heap[index];
+	while (index > 0) {
+		const unsigned int parent = (index - 1) / 2;
+		if (m_heap[parent].m_deadline <= entry.m_deadline) {
+			break;
+		}
+		m_heap[index] = m_heap[parent];
+		SetIndex(index);
+		index = parent;
+	}
+	m_heap[index] = entry;
+	SetIndex(index);
+}
+
+void KX_DistanceSchedule::SiftDown(unsigned int index)
+{
+	const Entry entry = m_heap[index];
+	const unsigned int size = m_heap.size();
+	while (true) {
+		unsigned int child = index * 2 + 1;
+		if (child >= size) {
+			break;
+		}
+		if (child + 1 < size && m_heap[child + 1].m_deadline < m_heap[child].m_deadline) {
+			++child;
+		}
+		if (entry.m_deadline <= m_heap[child].m_deadline) {
+			break;
+		}
+		m_heap[index] = m_heap[child];
+		SetIndex(index);
+		index = child;
+	}
+	m_heap[index] = entry;
+	SetIndex(index);
+}
+
+void KX_DistanceSchedule::Push(KX_GameObject *gameobj, double deadline)
+{
+	Entry entry = {deadline, gameobj};
+	m_heap.push_back(entry);
+	SiftUp(m_heap.size() - 1);
+}
+
+void KX_DistanceSchedule::RemoveAt(unsigned int index)
+{
+	const unsigned int last = m_heap.size() - 1;
+	if (index != last) {
+		const double deadline = m_heap[index].m_deadline;
+		m_heap[index] = m_heap[last];
+		m_heap.pop_back();
+		if (m_heap[index].m_deadline < deadline) {
+			SiftUp(index);
+		}
+		else {
+			SiftDown(index);
+		}
+	}
+	else {
+		m_heap.pop_back();
+	}
+}
+
+void KX_DistanceSchedule::AddObject(KX_GameObject *gameobj)
+{
+	if (gameobj->GetDistanceScheduleIndex(m_slot) == KX_DISTANCE_SCHEDULE_NONE) {
+		Push(gameobj, -1.0);
+	}
+}
+
+void KX_DistanceSchedule::RemoveObject(KX_GameObject *gameobj)
+{
+	const int index = gameobj->GetDistanceScheduleIndex(m_slot);
+	if (index != KX_DISTANCE_SCHEDULE_NONE) {
+		RemoveAt(index);
+		gameobj->SetDistanceScheduleIndex(m_slot, KX_DISTANCE_SCHEDULE_NONE);
+	}
+}
+
+void KX_DistanceSchedule::ObjectMoved(KX_GameObject *gameobj)
+{
+	const int index = gameobj->GetDistanceScheduleIndex(m_slot);
+	if (index != KX_DISTANCE_SCHEDULE_NONE && m_heap[index].m_deadline >= 0.0) {
+		m_heap[index].m_deadline = -1.0;
+		SiftUp(index);
+	}
+}
+
+void KX_DistanceSchedule::Invalidate()
+{
+	// All the deadlines are equal, the heap stays valid.
+	for (std::vector<Entry>::iterator it = m_heap.begin(), end = m_heap.end(); it != end; ++it) {
+		it->m_deadline = -1.0;
+	}
+}
+
+void KX_DistanceSchedule::Clear()
+{
+	for (std::vector<Entry>::iterator it = m_heap.begin(), end = m_heap.end(); it != end; ++it) {
+		it->m_gameobj->SetDistanceScheduleIndex(m_slot, KX_DISTANCE_SCHEDULE_NONE);
+	}
+	m_heap.clear();
+}
+
+void KX_DistanceSchedule::Update(const MT_Vector3& campos, UpdateFunc func, void *userdata)
+{
+	/* The travel is a bound of the distance between the camera positions of
+	 * two updates, whatever the path of the camera. */
+	if (m_cameraValid) {
+		m_travel += (campos - m_cameraPosition).length();
+	}
+	m_cameraPosition = campos;
+	m_cameraValid = true;
+
+	// Pop all the objects first, an update of margin zero is done again at the next frame only.
+	m_dueObjects.clear();
+	while (!m_heap.empty() && m_heap[0].m_deadline <= m_travel) {
+		KX_GameObject *gameobj = m_heap[0].m_gameobj;
+		RemoveAt(0);
+		gameobj->SetDistanceScheduleIndex(m_slot, KX_DISTANCE_SCHEDULE_NONE);
+		m_dueObjects.push_back(gameobj);
+	}
+
+	for (std::vector<KX_GameObject *>::iterator it = m_dueObjects.begin(), end = m_dueObjects.end(); it != end; ++it) {
+		KX_GameObject *gameobj = *it;
+		const float margin = func(gameobj, campos, userdata);
+		// The object could have been added again by the update.
+		if (gameobj->GetDistanceScheduleIndex(m_slot) == KX_DISTANCE_SCHEDULE_NONE) {
+			Push(gameobj, m_travel + margin);
+		}
+	}
+}
@@ -0,0 +1,106 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_DistanceSchedule.h
+ *  \ingroup ketsji
+ */
+
+#ifndef __KX_DISTANCESCHEDULE_H__
+#define __KX_DISTANCESCHEDULE_H__
+
+#include "MT_Vector3.h"
+
+#include <vector>
+
+class KX_GameObject;
+
+/// Index of an object not added to a schedule.
+#define KX_DISTANCE_SCHEDULE_NONE -1
+
+/**
+ * Schedule of an update of the objects depending on their distance to the camera,
+ * e.g. the activity culling or the levels of detail.
+ * The update of an object returns a margin: the distance the camera and the object can
+ * travel without changing the result of the update. An object is updated again only
+ * once the camera travelled more than this margin or when the object moved, the objects
+ * far from any boundary are not visited each frame.
+ */
+class KX_DistanceSchedule
+{
+public:
+	/// Schedules of the scene, each object stores its index in every schedule.
+	enum Slot {
+		SLOT_ACTIVITY = 0,
+		SLOT_LOD,
+		SLOT_MAX
+	};
+
+	/** Update the object for the camera position and return its margin,
+	 * zero to update it again at the next frame.
+	 */
+	typedef float (*UpdateFunc)(KX_GameObject *gameobj, const MT_Vector3& campos, void *userdata);
+
+private:
+	struct Entry
+	{
+		/// Camera travel from which the object must be updated, negative for a pending update.
+		double m_deadline;
+		KX_GameObject *m_gameobj;
+	};
+
+	Slot m_slot;
+	/// Binary min heap of the deadlines, the index of an object is stored in the object.
+	std::vector<Entry> m_heap;
+	/// Objects updated by Update, kept to not allocate each frame.
+	std::vector<KX_GameObject *> m_dueObjects;
+	/// Sum of the distances travelled by the camera at each Update.
+	double m_travel;
+	MT_Vector3 m_cameraPosition;
+	bool m_cameraValid;
+
+	void SetIndex(unsigned int index);
+	void SiftUp(unsigned int index);
+	void SiftDown(unsigned int index);
+	void Push(KX_GameObject *gameobj, double deadline);
+	/// Remove the entry at index without changing the index stored in its object.
+	void RemoveAt(unsigned int index);
+
+public:
+	KX_DistanceSchedule(Slot slot);
+	~KX_DistanceSchedule();
+
+	/// Number of objects in the schedule.
+	unsigned int GetCount() const;
+
+	/// Add an object, updated at the next Update.
+	void AddObject(KX_GameObject *gameobj);
+	void RemoveObject(KX_GameObject *gameobj);
+	/// Update again an added object at the next Update, called when the object moved.
+	void ObjectMoved(KX_GameObject *gameobj);
+	/// Update all the objects at the next Update, called when the settings of the update change.
+	void Invalidate();
+	/// Remove all the objects.
+	void Clear();
+
+	/// Update the objects needing an update for the new camera position.
+	void Update(const MT_Vector3& campos, UpdateFunc func, void *userdata);
+};
+
+#endif  /* __KX_DISTANCESCHEDULE_H__ */
@@ -55,6 +55,7 @@
 #include "RAS_BucketManager.h"
 #include "KX_RayCast.h"
 #include "KX_Globals.h"
+#include "KX_KetsjiEngine.h"
 #include "KX_PyMath.h"
 #include "SCA_IActuator.h"
 #include "SCA_ISensor.h"
@@ -108,11 +109,14 @@ KX_GameObject::KX_GameObject(
       m_meshUser(NULL),
       m_pBlenderObject(NULL),
       m_pBlenderGroupObject(NULL),
+      m_libraryLink(this),
       m_bIsNegativeScaling(false),
       m_objectColor(1.0f, 1.0f, 1.0f, 1.0f),
       m_bVisible(true),
       m_bCulled(true),
       m_bOccluder(false),
+      m_staticShadowCaster(false),
+      m_dynamicShadowCaster(false),
       m_autoUpdateBounds(false),
       m_pPhysicsController(NULL),
       m_pGraphicController(NULL),
@@ -126,6 +130,9 @@ KX_GameObject::KX_GameObject(
 #endif
 {
 	m_ignore_activity_culling = false;
+	for (unsigned short i = 0; i < KX_DistanceSchedule::SLOT_MAX; ++i) {
+		m_distanceScheduleIndex[i] = KX_DISTANCE_SCHEDULE_NONE;
+	}
 	m_pClient_info = new KX_ClientObjectInfo(this, KX_ClientObjectInfo::ACTOR);
 	m_pSGNode = new SG_Node(this,sgReplicationInfo,callbacks);
 
@@ -479,7 +486,10 @@ void KX_GameObject::StopAction(short layer)
 
 void KX_GameObject::RemoveTaggedActions()
 {
-	GetActionManager()->RemoveTaggedActions();
+	// Don't create an action manager for nothing.
+	if (m_actionManager) {
+		m_actionManager->RemoveTaggedActions();
+	}
 }
 
 bool KX_GameObject::IsActionDone(short layer)
@@ -492,6 +502,11 @@ void KX_GameObject::UpdateActionManager(float curtime)
 	GetActionManager()->Update(curtime);
 }
 
+void KX_GameObject::EvaluateActionIPOs()
+{
+	GetActionManager()->EvaluateIPOs();
+}
+
 void KX_GameObject::UpdateActionIPOs()
 {
 	GetActionManager()->UpdateIPOs();
@@ -543,6 +558,19 @@ void KX_GameObject::ProcessReplica()
 	m_pClient_info->m_gameobject = this;
 	m_actionManager = NULL;
 	m_state = 0;
+	for (unsigned short i = 0; i < KX_DistanceSchedule::SLOT_MAX; ++i) {
+		m_distanceScheduleIndex[i] = KX_DISTANCE_SCHEDULE_NONE;
+	}
+	// The replica isn't drawn in the shadow caches yet.
+	m_staticShadowCaster = false;
+	m_dynamicShadowCaster = false;
+
+	// The replica belongs to the library of the original object, the copied link isn't linked.
+	KX_GameObject *orgobj = m_libraryLink.m_gameobject;
+	m_libraryLink.m_gameobject = this;
+	if (!orgobj->m_libraryLink.Empty()) {
+		orgobj->m_libraryLink.AddBack(&m_libraryLink);
+	}
 
 	m_meshUser = NULL;
 	if (m_lodList) {
@@ -782,6 +810,10 @@ void KX_GameObject::UpdateBuckets()
 
 void KX_GameObject::RemoveMeshes()
 {
+	if (m_staticShadowCaster) {
+		InvalidateShadowCaches(false);
+	}
+
 	for (size_t i=0;i<m_meshes.size();i++)
 		m_meshes[i]->RemoveFromBuckets(m_pClient_info);
 	// Remove all mesh slots.
@@ -805,8 +837,13 @@ void KX_GameObject::UpdateLod(const MT_Vector3& cam_pos)
 		}
 	}
 
+	UpdateLodLevel(cam_pos);
+}
+
+float KX_GameObject::UpdateLodLevel(const MT_Vector3& cam_pos)
+{
 	if (!m_lodList) {
-		return;
+		return FLT_MAX;
 	}
 
 	KX_Scene *scene = GetScene();
@@ -823,6 +860,8 @@ void KX_GameObject::UpdateLod(const MT_Vector3& cam_pos)
 		m_currentLodLevel = level;
 		m_previousLodLevel = level;
 	}
+
+	return m_lodList->GetLevelMargin(scene, level, sqrtf(distance2));
 }
 
 void KX_GameObject::UpdateTransform()
@@ -834,6 +873,31 @@ void KX_GameObject::UpdateTransform()
 		// update the culling tree
 		m_pGraphicController->SetGraphicTransform();
 
+	if (m_staticShadowCaster) {
+		InvalidateShadowCaches(true);
+	}
+
+	// the distance to the camera changed
+	if (m_distanceScheduleIndex[KX_DistanceSchedule::SLOT_ACTIVITY] != KX_DISTANCE_SCHEDULE_NONE ||
+	    m_distanceScheduleIndex[KX_DistanceSchedule::SLOT_LOD] != KX_DISTANCE_SCHEDULE_NONE)
+	{
+		GetScene()->ObjectMoved(this);
+	}
+}
+
+bool KX_GameObject::IsDynamicShadowCaster()
+{
+	// The deformed meshes and the simulated objects change each frame.
+	return (m_dynamicShadowCaster || GetDeformer() || (m_pPhysicsController && m_pPhysicsController->IsDynamic()));
+}
+
+void KX_GameObject::InvalidateShadowCaches(bool moved)
+{
+	GetScene()->InvalidateShadowCaches();
+	m_staticShadowCaster = false;
+	if (moved) {
+		m_dynamicShadowCaster = true;
+	}
 }
 
 void KX_GameObject::UpdateTransformFunc(SG_IObject* node, void* gameobj, void* scene)
@@ -912,6 +976,9 @@ KX_GameObject::SetVisible(
 	)
 {
 	if (GetSGNode()) {
+		if (m_staticShadowCaster && m_bVisible != v) {
+			InvalidateShadowCaches(false);
+		}
 		m_bVisible = v;
 		if (m_pGraphicController)
 			m_pGraphicController->Activate(m_bVisible);
@@ -992,6 +1059,9 @@ KX_GameObject::SetLayer(
 	int l
 	)
 {
+	if (m_staticShadowCaster && m_layer != l) {
+		InvalidateShadowCaches(false);
+	}
 	m_layer = l;
 }
 
@@ -1455,6 +1525,7 @@ void KX_GameObject::SetBoundsAabb(MT_Vector3 aabbMin, MT_Vector3 aabbMax)
 	SG_BBox &box = m_pSGNode->BBox();
 	box.SetMin(aabbMin);
 	box.SetMax(aabbMax);
+	m_pSGNode->SetBBoxModified();
 
 	// And in the object's graphic controller if it exists.
 	if (m_pGraphicController) {
@@ -1499,6 +1570,7 @@ void KX_GameObject::RegisterCollisionCallbacks()
 
 	// Register from callbacks
 	KX_Scene* scene = GetScene();
+	scene->InvalidateConcurrentUpdate();
 	PHY_IPhysicsEnvironment* pe = scene->GetPhysicsEnvironment();
 	PHY_IPhysicsController* spc = GetPhysicsController();
 	// If we are the first to register on this physics controller
@@ -1509,16 +1581,18 @@ void KX_GameObject::RegisterCollisionCallbacks()
 			pe->AddSensor(spc);
 	}
 }
-void KX_GameObject::RunCollisionCallbacks(KX_GameObject *collider, KX_CollisionContactPointList *contactPointList)
+void KX_GameObject::RunCollisionCallbacks(KX_GameObject *collider, const PHY_CollData *collData, bool first)
 {
 #ifdef WITH_PYTHON
 	if (!m_collisionCallbacks || PyList_GET_SIZE(m_collisionCallbacks) == 0)
 		return;
 
-	CListWrapper *listWrapper = contactPointList->GetListWrapper();
+	// The contact points are read from the collision data, nothing is copied.
+	KX_CollisionContactPointList contactPointList(collData, first);
+	CListWrapper *listWrapper = contactPointList.GetListWrapper();
 	PyObject *args[] = {collider->GetProxy(),
-						PyObjectFrom(contactPointList->GetCollData()->GetWorldPoint(0, contactPointList->GetFirstObject())),
-						PyObjectFrom(contactPointList->GetCollData()->GetNormal(0, contactPointList->GetFirstObject())),
+						PyObjectFrom(collData->GetWorldPoint(0, first)),
+						PyObjectFrom(collData->GetNormal(0, first)),
 						listWrapper->GetProxy()};
 	RunPythonCallBackList(m_collisionCallbacks, args, 1, ARRAY_SIZE(args));
 
@@ -1529,7 +1603,6 @@ void KX_GameObject::RunCollisionCallbacks(KX_GameObject *collider, KX_CollisionC
 	// Invalidate the collison contact point to avoid acces to it in next frame
 	listWrapper->InvalidateProxy();
 	delete listWrapper;
-	delete contactPointList;
 #endif
 }
 
@@ -1711,6 +1784,16 @@ void KX_GameObject::UpdateComponents()
 #endif // WITH_PYTHON
 }
 
+#ifdef WITH_PYTHON
+void KX_GameObject::py_proxy_created(void)
+{
+	KX_Scene *scene = GetScene();
+	if (scene) {
+		scene->InvalidateConcurrentUpdate();
+	}
+}
+#endif // WITH_PYTHON
+
 KX_Scene* KX_GameObject::GetScene()
 {
 	SG_Node* node = this->GetSGNode();
@@ -1996,6 +2079,7 @@ PyMethodDef KX_GameObject::Methods[] = {
 
 	KX_PYMETHODTABLE(KX_GameObject, rayCastTo),
 	KX_PYMETHODTABLE(KX_GameObject, rayCast),
+	KX_PYMETHODTABLE(KX_GameObject, rayCastBatch),
 	KX_PYMETHODTABLE_O(KX_GameObject, getDistanceTo),
 	KX_PYMETHODTABLE_O(KX_GameObject, getVectTo),
 	KX_PYMETHODTABLE(KX_GameObject, sendMessage),
@@ -3708,15 +3792,16 @@ KX_PYMETHODDEF_DOC_O(KX_GameObject, getVectTo,
 
 struct KX_GameObject::RayCastData
 {
-	RayCastData(STR_String prop, bool xray, unsigned int mask)
-		:m_prop(prop),
+	RayCastData(const STR_String& prop, bool xray, unsigned int mask)
+		:m_prop(&prop),
 		m_xray(xray),
 		m_mask(mask),
 		m_hitObject(NULL)
 	{
 	}
 
-	STR_String m_prop;
+	/// Shared by all the rays of a batch, a pointer to keep the data assignable.
+	const STR_String *m_prop;
 	bool m_xray;
 	unsigned int m_mask;
 	KX_GameObject *m_hitObject;
@@ -3728,7 +3813,7 @@ bool KX_GameObject::RayHit(KX_ClientObjectInfo *client, KX_RayCast *result, RayC
 
 	// if X-ray option is selected, the unwnted objects were not tested, so get here only with true hit
 	// if not, all objects were tested and the front one may not be the correct one.
-	if ((rayData->m_xray || rayData->m_prop.Length() == 0 || hitKXObj->GetProperty(rayData->m_prop) != NULL) && 
+	if ((rayData->m_xray || rayData->m_prop->Length() == 0 || hitKXObj->GetProperty(*rayData->m_prop) != NULL) && 
 		hitKXObj->GetUserCollisionGroup() & rayData->m_mask)
 	{
 		rayData->m_hitObject = hitKXObj;
@@ -3756,7 +3841,7 @@ bool KX_GameObject::NeedRayCast(KX_ClientObjectInfo *client, RayCastData *rayDat
 	
 	// if X-Ray option is selected, skip object that don't match the criteria as we see through them
 	// if not, test all objects because we don't know yet which one will be on front
-	if ((!rayData->m_xray || rayData->m_prop.Length() == 0 || hitKXObj->GetProperty(rayData->m_prop) != NULL) && 
+	if ((!rayData->m_xray || rayData->m_prop->Length() == 0 || hitKXObj->GetProperty(*rayData->m_prop) != NULL) && 
 		hitKXObj->GetUserCollisionGroup() & rayData->m_mask)
 	{
 		return true;
@@ -3806,7 +3891,8 @@ KX_PYMETHODDEF_DOC(KX_GameObject, rayCastTo,
 	if (!spc && parent)
 		spc = parent->GetPhysicsController();
 
-	RayCastData rayData(propName, false, (1u << OB_MAX_COL_MASKS) - 1);
+	const STR_String prop(propName);
+	RayCastData rayData(prop, false, (1u << OB_MAX_COL_MASKS) - 1);
 	KX_RayCast::Callback<KX_GameObject, RayCastData> callback(this, spc, &rayData);
 	if (KX_RayCast::RayTest(pe, fromPoint, toPoint, callback) && rayData.m_hitObject) {
 		return rayData.m_hitObject->GetProxy();
@@ -3954,7 +4040,8 @@ KX_PYMETHODDEF_DOC(KX_GameObject, rayCast,
 		spc = parent->GetPhysicsController();
 
 	// to get the hit results
-	RayCastData rayData(propName, xray, mask);
+	const STR_String prop(propName);
+	RayCastData rayData(prop, xray, mask);
 	KX_RayCast::Callback<KX_GameObject, RayCastData> callback(this, spc, &rayData, face, (poly == 2));
 
 	if (KX_RayCast::RayTest(pe, fromPoint, toPoint, callback) && rayData.m_hitObject) {
@@ -4004,6 +4091,129 @@ KX_PYMETHODDEF_DOC(KX_GameObject, rayCast,
 		return none_tuple_3();
 }
 
+KX_PYMETHODDEF_DOC(KX_GameObject, rayCastBatch,
+"rayCastBatch(rays,prop,face,xray,mask,threads): cast many rays at once and return a 2-tuple (objects,hits).\n"
+" rays = buffer of floats or doubles, 6 values per ray: the origin then the destination of the ray\n"
+" prop, face, xray, mask = same as rayCast\n"
+" threads = 1=>spread the rays over the worker threads; 0 or omitted => cast the rays in the calling thread\n"
+" objects = list of the hit object of each ray, None if there is no hit\n"
+" hits = memoryview of floats, 6 values per ray: the hit point then the hit normal, zeros if there is no hit\n")
+{
+	PyObject *pyrays;
+	char *propName = NULL;
+	int face = 0, xray = 0, threads = 0;
+	int mask = (1 << OB_MAX_COL_MASKS) - 1;
+
+	if (!PyArg_ParseTuple(args, "O|siiii:rayCastBatch", &pyrays, &propName, &face, &xray, &mask, &threads)) {
+		return NULL; // Python sets a simple error
+	}
+
+	if (mask == 0 || mask & ~((1 << OB_MAX_COL_MASKS) - 1)) {
+		PyErr_Format(PyExc_TypeError, "gameOb.rayCastBatch(rays,prop,face,xray,mask,threads): KX_GameObject, mask argument to rayCastBatch must be a int bitfield, 0 < mask < %i", (1 << OB_MAX_COL_MASKS));
+		return NULL;
+	}
+
+	Py_buffer buffer;
+	if (PyObject_GetBuffer(pyrays, &buffer, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == -1) {
+		return NULL;
+	}
+
+	const bool isDouble = (buffer.itemsize == sizeof(double) && buffer.format && strcmp(buffer.format, "d") == 0);
+	const bool isFloat = (buffer.itemsize == sizeof(float) && buffer.format && strcmp(buffer.format, "f") == 0);
+	const Py_ssize_t numValues = (isDouble || isFloat) ? buffer.len / buffer.itemsize : 0;
+	if ((!isDouble && !isFloat) || numValues % 6 != 0) {
+		PyBuffer_Release(&buffer);
+		PyErr_SetString(PyExc_TypeError, "gameOb.rayCastBatch(rays,prop,face,xray,mask,threads): KX_GameObject, rays must be a buffer of floats or doubles with 6 values per ray");
+		return NULL;
+	}
+
+	const unsigned int numRays = numValues / 6;
+	std::vector<MT_Vector3> fromPoints(numRays);
+	std::vector<MT_Vector3> toPoints(numRays);
+	for (unsigned int i = 0; i < numRays; ++i) {
+		if (isDouble) {
+			const double *values = (const double *)buffer.buf + i * 6;
+			fromPoints[i].setValue(values);
+			toPoints[i].setValue(values + 3);
+		}
+		else {
+			const float *values = (const float *)buffer.buf + i * 6;
+			fromPoints[i].setValue(values);
+			toPoints[i].setValue(values + 3);
+		}
+	}
+	PyBuffer_Release(&buffer);
+
+	PHY_IPhysicsEnvironment* pe = GetScene()->GetPhysicsEnvironment();
+	PHY_IPhysicsController *spc = GetPhysicsController();
+	KX_GameObject *parent = GetParent();
+	if (!spc && parent)
+		spc = parent->GetPhysicsController();
+
+	const STR_String prop(propName);
+	std::vector<RayCastData> rayDatas(numRays, RayCastData(prop, xray, mask));
+	std::vector<KX_RayCast::Callback<KX_GameObject, RayCastData> > callbacks;
+	callbacks.reserve(numRays);
+	for (unsigned int i = 0; i < numRays; ++i) {
+		callbacks.push_back(KX_RayCast::Callback<KX_GameObject, RayCastData>(this, spc, &rayDatas[i], face));
+	}
+
+	// Zero length rays are skipped, as in rayCast.
+	std::vector<MT_Vector3> batchFromPoints;
+	std::vector<MT_Vector3> batchToPoints;
+	std::vector<KX_RayCast *> batchCallbacks;
+	std::vector<unsigned int> batchIndices;
+	for (unsigned int i = 0; i < numRays; ++i) {
+		if (!MT_fuzzyZero((toPoints[i] - fromPoints[i]).length2())) {
+			batchFromPoints.push_back(fromPoints[i]);
+			batchToPoints.push_back(toPoints[i]);
+			batchCallbacks.push_back(&callbacks[i]);
+			batchIndices.push_back(i);
+		}
+	}
+
+	const unsigned int numBatchRays = batchCallbacks.size();
+	bool *results = new bool[numBatchRays];
+	if (numBatchRays > 0) {
+		TaskScheduler *scheduler = threads ? KX_GetActiveEngine()->GetTaskScheduler() : NULL;
+		KX_RayCast::RayTestBatch(pe, &batchFromPoints[0], &batchToPoints[0], &batchCallbacks[0], results,
+		                         numBatchRays, scheduler);
+	}
+
+	PyObject *pyobjects = PyList_New(numRays);
+	PyObject *bytes = PyByteArray_FromStringAndSize(NULL, numRays * 6 * sizeof(float));
+	float *hits = (float *)PyByteArray_AS_STRING(bytes);
+	memset(hits, 0, numRays * 6 * sizeof(float));
+	for (unsigned int i = 0; i < numRays; ++i) {
+		Py_INCREF(Py_None);
+		PyList_SET_ITEM(pyobjects, i, Py_None);
+	}
+
+	for (unsigned int i = 0; i < numBatchRays; ++i) {
+		const unsigned int index = batchIndices[i];
+		KX_GameObject *hitObject = rayDatas[index].m_hitObject;
+		if (results[i] && hitObject) {
+			Py_DECREF(Py_None);
+			PyList_SET_ITEM(pyobjects, index, hitObject->GetProxy());
+			callbacks[index].m_hitPoint.getValue(hits + index * 6);
+			callbacks[index].m_hitNormal.getValue(hits + index * 6 + 3);
+		}
+	}
+	delete[] results;
+
+	PyObject *view = PyMemoryView_FromObject(bytes);
+	Py_DECREF(bytes);
+	PyObject *floatview = PyObject_CallMethod(view, "cast", "s", "f");
+	Py_DECREF(view);
+
+	if (!floatview) {
+		Py_DECREF(pyobjects);
+		return NULL;
+	}
+
+	return Py_BuildValue("(NN)", pyobjects, floatview);
+}
+
 KX_PYMETHODDEF_DOC_VARARGS(KX_GameObject, sendMessage, 
 						   "sendMessage(subject, [body, to])\n"
 "sends a message in same manner as a message actuator"
@@ -63,7 +63,7 @@ class PHY_IPhysicsController;
 class BL_ActionManager;
 struct Object;
 class KX_ObstacleSimulation;
-class KX_CollisionContactPointList;
+class PHY_CollData;
 struct bAction;
 
 #ifdef WITH_PYTHON
@@ -75,6 +75,20 @@ bool ConvertPythonToGameObject(SCA_LogicManager *logicmgr, PyObject *value, KX_G
 void KX_GameObject_Mathutils_Callback_Init(void);
 #endif
 
+/** Element of the list of the objects converted from a library and of their replicas,
+ * see KX_BlenderSceneConverter::FreeBlendFile. The object is unlinked when deleted.
+ */
+class KX_LibraryObjectLink : public SG_DList
+{
+public:
+	KX_GameObject *m_gameobject;
+
+	KX_LibraryObjectLink(KX_GameObject *gameobject)
+		:m_gameobject(gameobject)
+	{
+	}
+};
+
 /**
  * KX_GameObject is the main class for dynamic objects.
  */
@@ -92,9 +106,13 @@ protected:
 	KX_LodList							*m_lodList;
 	int                                 m_currentLodLevel;
 	short								m_previousLodLevel;
+	/// Index of the object in each distance schedule of the scene, see KX_DistanceSchedule.
+	int									m_distanceScheduleIndex[KX_DistanceSchedule::SLOT_MAX];
 	RAS_MeshUser						*m_meshUser;
 	struct Object*						m_pBlenderObject;
 	struct Object*						m_pBlenderGroupObject;
+	/// Link in the objects of the library the object is converted from.
+	KX_LibraryObjectLink				m_libraryLink;
 	
 	bool								m_bIsNegativeScaling;
 	MT_Vector4							m_objectColor;
@@ -108,6 +126,10 @@ protected:
 	bool       							m_bVisible; 
 	bool       							m_bCulled; 
 	bool								m_bOccluder;
+	/// The object is drawn in the shadow caches of the lights, see KX_Scene::SetShadowCulling.
+	bool								m_staticShadowCaster;
+	/// The object changed while in the shadow caches, it's always drawn over the caches.
+	bool								m_dynamicShadowCaster;
 
 	bool								m_autoUpdateBounds;
 
@@ -327,6 +349,11 @@ public:
 	 */
 	void UpdateActionManager(float curtime);
 
+	/**
+	 * Have the action manager evaluate the IPO curves ahead of UpdateActionIPOs
+	 */
+	void EvaluateActionIPOs();
+
 	/**
 	 * Have the action manager update IPOs
 	 * note: not thread-safe!
@@ -816,6 +843,22 @@ public:
 	 */
 	void UpdateLod(const MT_Vector3& cam_pos);
 
+	/**
+	 * Updates the current lod level of this object only, without the dupli group instances.
+	 * Return the distance the object or the camera can travel without changing the level.
+	 */
+	float UpdateLodLevel(const MT_Vector3& cam_pos);
+
+	int GetDistanceScheduleIndex(KX_DistanceSchedule::Slot slot) const
+	{
+		return m_distanceScheduleIndex[slot];
+	}
+
+	void SetDistanceScheduleIndex(KX_DistanceSchedule::Slot slot, int index)
+	{
+		m_distanceScheduleIndex[slot] = index;
+	}
+
 	/**
 	 * Pick out a mesh associated with the integer 'num'.
 	 */
@@ -870,6 +913,30 @@ public:
 		bool c
 	) { m_bCulled = c; }
 	
+	bool IsStaticShadowCaster() const
+	{
+		return m_staticShadowCaster;
+	}
+
+	void SetStaticShadowCaster(bool cached)
+	{
+		m_staticShadowCaster = cached;
+	}
+
+	/// Return true if the object must be drawn in each shadow render instead of the shadow caches.
+	bool IsDynamicShadowCaster();
+
+	KX_LibraryObjectLink *GetLibraryLink()
+	{
+		return &m_libraryLink;
+	}
+
+	/**
+	 * Outdate the shadow caches drawing this object, called when the object changes.
+	 * A moved object isn't cached anymore.
+	 */
+	void InvalidateShadowCaches(bool moved);
+
 	/**
 	 * Is this object an occluder?
 	 */
@@ -938,7 +1005,8 @@ public:
 
 	void RegisterCollisionCallbacks();
 	void UnregisterCollisionCallbacks();
-	void RunCollisionCallbacks(KX_GameObject *collider, KX_CollisionContactPointList *contactPointList);
+	/// Run the collision callbacks, first tells if this object is the first of the collision data.
+	void RunCollisionCallbacks(KX_GameObject *collider, const PHY_CollData *collData, bool first);
 	/**
 	 * Stop making progress
 	 */
@@ -984,6 +1052,9 @@ public:
 		return PyUnicode_From_STR_String(GetName());
 	}
 
+	/// An object with a proxy prevents the concurrent update of its scene.
+	virtual void py_proxy_created(void);
+
 	KX_PYMETHOD_O(KX_GameObject,SetWorldPosition);
 	KX_PYMETHOD_VARARGS(KX_GameObject, ApplyForce);
 	KX_PYMETHOD_VARARGS(KX_GameObject, ApplyTorque);
@@ -1024,6 +1095,7 @@ public:
 	KX_PYMETHOD_NOARGS(KX_GameObject,EndObject);
 	KX_PYMETHOD_DOC(KX_GameObject,rayCastTo);
 	KX_PYMETHOD_DOC(KX_GameObject,rayCast);
+	KX_PYMETHOD_DOC(KX_GameObject,rayCastBatch);
 	KX_PYMETHOD_DOC_O(KX_GameObject,getDistanceTo);
 	KX_PYMETHOD_DOC_O(KX_GameObject,getVectTo);
 	KX_PYMETHOD_DOC_VARARGS(KX_GameObject, sendMessage);
@@ -60,6 +60,8 @@ KX_IpoSGController::KX_IpoSGController()
   m_ipo_local(false),
   m_modified(true),
   m_ipotime(1.0),
+  m_evaluated(false),
+  m_evaluatedtime(0.0),
   m_ipo_start_initialized(false),
   m_ipo_start_euler(0.0f, 0.0f, 0.0f),
   m_ipo_euler_initialized(false)
@@ -113,13 +115,26 @@ void KX_IpoSGController::SetGameObject(KX_GameObject *go)
 	m_game_object = go;
 }
 
+void KX_IpoSGController::Evaluate(double time)
+{
+	// The interpolators only write in m_ipo_xform.
+	for (T_InterpolatorList::iterator i = m_interpolators.begin(); i != m_interpolators.end(); ++i) {
+		(*i)->Execute(time);
+	}
+	m_evaluated = true;
+	m_evaluatedtime = time;
+}
+
 bool KX_IpoSGController::Update(double currentTime)
 {
 	if (m_modified) {
-		T_InterpolatorList::iterator i;
-		for (i = m_interpolators.begin(); i != m_interpolators.end(); ++i) {
-			(*i)->Execute(m_ipotime);//currentTime);
+		if (!m_evaluated || m_evaluatedtime != m_ipotime) {
+			T_InterpolatorList::iterator i;
+			for (i = m_interpolators.begin(); i != m_interpolators.end(); ++i) {
+				(*i)->Execute(m_ipotime);//currentTime);
+			}
 		}
+		m_evaluated = false;
 
 		SG_Spatial *ob = (SG_Spatial *)m_pObject;
 
@@ -341,6 +356,7 @@ SG_Controller *KX_IpoSGController::GetReplica(SG_Node *destnode)
 	// clear object that ipo acts on in the replica.
 	iporeplica->ClearObject();
 	iporeplica->SetGameObject((KX_GameObject *)destnode->GetSGClientObject());
+	iporeplica->m_evaluated = false;
 
 	// dirty hack, ask Gino for a better solution in the ipo implementation
 	// hacken en zagen, in what we call datahiding, not written for replication :(
@@ -63,6 +63,10 @@ class KX_IpoSGController : public SG_Controller
 	/** Local time of this ipo.*/
 	double m_ipotime;
 
+	/** Were the interpolators executed by Evaluate and for which time? */
+	bool m_evaluated;
+	double m_evaluatedtime;
+
 	/** Location of the object when the IPO is first fired (for local transformations) */
 	MT_Vector3 m_ipo_start_point;
 
@@ -110,6 +114,7 @@ public:
 
 	void AddInterpolator(KX_IInterpolator *interp);
 	virtual bool Update(double time);
+	virtual void Evaluate(double time);
 	virtual void SetSimulatedTime(double time)
 	{
 		m_ipotime = time;
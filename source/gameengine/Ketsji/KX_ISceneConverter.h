@@ -66,6 +66,8 @@ public:
 	// handle any pending merges from asynchronous loads
 	virtual void MergeAsyncLoads()=0;
 	virtual void FinalizeAsyncLoads() = 0;
+	// continue the libraries freed over several frames
+	virtual void FreeDeferredLibraries() = 0;
 
 	virtual void	SetAlwaysUseExpandFraming(bool to_what) = 0;
 
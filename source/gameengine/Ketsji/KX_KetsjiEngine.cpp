@@ -38,6 +38,7 @@
 #include <stdio.h>
 
 #include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "KX_KetsjiEngine.h"
 
@@ -47,6 +48,9 @@
 #include "EXP_FloatValue.h"
 
 #include "RAS_BucketManager.h"
+#include "RAS_InstancingBuffer.h"
+
+#include "SG_Profiler.h"
 #include "RAS_Rect.h"
 #include "RAS_IRasterizer.h"
 #include "RAS_ICanvas.h"
@@ -104,6 +108,17 @@ double KX_KetsjiEngine::m_average_framerate = 0.0;
 bool KX_KetsjiEngine::m_restrict_anim_fps = false;
 short KX_KetsjiEngine::m_exitkey = 130; // ESC Key
 
+/// Data shared by the tasks updating the scenes concurrently.
+struct NextFrameSceneData
+{
+	KX_KetsjiEngine *engine;
+	double timestep;
+	double framestep;
+};
+
+/// Serialize the physics steps of the scenes updated concurrently.
+static ThreadMutex physics_lock = BLI_MUTEX_INITIALIZER;
+
 /**
  * Constructor of the Ketsji Engine
  */
@@ -154,6 +169,7 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem *system)
 	m_overrideFrameColorR(0.0f),
 	m_overrideFrameColorG(0.0f),
 	m_overrideFrameColorB(0.0f),
+	m_useParallelScenes(false),
 	m_usedome(false)
 {
 	// Initialize the time logger
@@ -167,6 +183,9 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem *system)
 #endif
 
 	m_taskscheduler = BLI_task_scheduler_create(TASK_SCHEDULER_AUTO_THREADS);
+	// The blender functions called by the mesh conversion tasks, e.g. for the tangents, create
+	// the global scheduler at their first use without any lock, create it from the main thread.
+	BLI_task_scheduler_get();
 
 	m_scenes = new CListValue();
 }
@@ -496,6 +515,10 @@ void KX_KetsjiEngine::EndFrame()
 
 bool KX_KetsjiEngine::NextFrame()
 {
+	// Start or stop the profile capture between two frames, when no task is running.
+	SG_Profiler::Update();
+	SG_PROFILE_ZONE("NextFrame");
+
 	double timestep = m_timescale / m_ticrate;
 	double framestep = timestep;
 
@@ -573,80 +596,55 @@ bool KX_KetsjiEngine::NextFrame()
 		m_frameTime += framestep;
 
 		m_sceneconverter->MergeAsyncLoads();
+		m_sceneconverter->FreeDeferredLibraries();
 
-		// for each scene, call the proceed functions
+		/* When parallel scenes are enabled, the scenes without Python logic are updated
+		 * first on the task scheduler, the scenes using Python are then updated on the
+		 * main thread as Python can access any scene. */
+		std::vector<KX_Scene *> concurrentScenes;
+		std::vector<KX_Scene *> serialScenes;
 		for (CListValue::iterator sceit = m_scenes->GetBegin(); sceit != m_scenes->GetEnd(); ++sceit) {
 			KX_Scene *scene = (KX_Scene *)*sceit;
+			if (m_useParallelScenes && scene->CanUpdateConcurrently()) {
+				concurrentScenes.push_back(scene);
+			}
+			else {
+				serialScenes.push_back(scene);
+			}
+		}
 
-			/* Suspension holds the physics and logic processing for an
-			 * entire scene. Objects can be suspended individually, and
-			 * the settings for that precede the logic and physics
-			 * update. */
+		if (concurrentScenes.size() == 1) {
+			// Not worth a task.
+			serialScenes.insert(serialScenes.begin(), concurrentScenes.front());
+		}
+		else if (concurrentScenes.size() > 1) {
 			m_logger->StartLog(tc_logic, m_kxsystem->GetTimeInSeconds(), true);
+			SG_SetActiveStage(SG_STAGE_CONTROLLER);
 
-			scene->UpdateObjectActivity();
-
-			if (!scene->IsSuspended()) {
-				m_logger->StartLog(tc_physics, m_kxsystem->GetTimeInSeconds(), true);
-				SG_SetActiveStage(SG_STAGE_PHYSICS1);
-				// set Python hooks for each scene
-#ifdef WITH_PYTHON
-				PHY_SetActiveEnvironment(scene->GetPhysicsEnvironment());
-#endif
-				KX_SetActiveScene(scene);
-
-				scene->GetPhysicsEnvironment()->EndFrame();
-
-				// Update scenegraph after physics step. This maps physics calculations
-				// into node positions.
-				//m_logger->StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds(), true);
-				//SG_SetActiveStage(SG_STAGE_PHYSICS1_UPDATE);
-				//scene->UpdateParents(m_frameTime);
-
-				// Process sensors, and controllers
-				m_logger->StartLog(tc_logic, m_kxsystem->GetTimeInSeconds(), true);
-				SG_SetActiveStage(SG_STAGE_CONTROLLER);
-				scene->LogicBeginFrame(m_frameTime);
-
-				// Scenegraph needs to be updated again, because Logic Controllers
-				// can affect the local matrices.
-				m_logger->StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds(), true);
-				SG_SetActiveStage(SG_STAGE_CONTROLLER_UPDATE);
-				scene->UpdateParents(m_frameTime);
-
-				// Process actuators
-
-				// Do some cleanup work for this logic frame
-				m_logger->StartLog(tc_logic, m_kxsystem->GetTimeInSeconds(), true);
-				SG_SetActiveStage(SG_STAGE_ACTUATOR);
-				scene->LogicUpdateFrame(m_frameTime, true);
-
-				scene->LogicEndFrame();
-
-				// Actuators can affect the scenegraph
-				m_logger->StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds(), true);
-				SG_SetActiveStage(SG_STAGE_ACTUATOR_UPDATE);
-				scene->UpdateParents(m_frameTime);
-
-				// update levels of detail
-				scene->UpdateObjectLods();
-
-				m_logger->StartLog(tc_physics, m_kxsystem->GetTimeInSeconds(), true);
-				SG_SetActiveStage(SG_STAGE_PHYSICS2);
-				scene->GetPhysicsEnvironment()->BeginFrame();
-
-				// Perform physics calculations on the scene. This can involve
-				// many iterations of the physics solver.
-				scene->GetPhysicsEnvironment()->ProceedDeltaTime(m_frameTime, timestep, framestep);//m_deltatimerealDeltaTime);
+			NextFrameSceneData data = {this, timestep, framestep};
+			TaskPool *pool = BLI_task_pool_create(m_taskscheduler, &data);
+			for (std::vector<KX_Scene *>::iterator it = concurrentScenes.begin(); it != concurrentScenes.end(); ++it) {
+				(*it)->GetNetworkMessageScene()->SetDeferMessages(true);
+				BLI_task_pool_push(pool, NextFrameSceneTask, *it, false, TASK_PRIORITY_HIGH);
+			}
+			BLI_task_pool_work_and_wait(pool);
+			BLI_task_pool_free(pool);
 
-				m_logger->StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds(), true);
-				SG_SetActiveStage(SG_STAGE_PHYSICS2_UPDATE);
-				scene->UpdateParents(m_frameTime);
+			// Apply the cross scene side effects in scene order.
+			for (std::vector<KX_Scene *>::iterator it = concurrentScenes.begin(); it != concurrentScenes.end(); ++it) {
+				(*it)->GetNetworkMessageScene()->SetDeferMessages(false);
+				FlushSceneRequests(*it);
 			}
 
 			m_logger->StartLog(tc_services, m_kxsystem->GetTimeInSeconds(), true);
 		}
 
+		// for each scene, call the proceed functions
+		for (std::vector<KX_Scene *>::iterator it = serialScenes.begin(); it != serialScenes.end(); ++it) {
+			NextFrameScene(*it, timestep, framestep, false);
+			FlushSceneRequests(*it);
+		}
+
 		m_logger->StartLog(tc_network, m_kxsystem->GetTimeInSeconds(), true);
 		SG_SetActiveStage(SG_STAGE_NETWORK);
 		m_networkMessageManager->ClearMessages();
@@ -674,6 +672,170 @@ bool KX_KetsjiEngine::NextFrame()
 	return doRender;
 }
 
+void KX_KetsjiEngine::NextFrameScene(KX_Scene *scene, double timestep, double framestep, bool concurrent)
+{
+	/* Suspension holds the physics and logic processing for an
+	 * entire scene. Objects can be suspended individually, and
+	 * the settings for that precede the logic and physics
+	 * update. */
+	SG_PROFILE_ZONE(scene->GetProfileName());
+
+	if (!concurrent) {
+		m_logger->StartLog(tc_logic, m_kxsystem->GetTimeInSeconds(), true);
+	}
+
+	scene->UpdateObjectActivity();
+
+	if (!scene->IsSuspended()) {
+		if (!concurrent) {
+			m_logger->StartLog(tc_physics, m_kxsystem->GetTimeInSeconds(), true);
+			SG_SetActiveStage(SG_STAGE_PHYSICS1);
+			// set Python hooks for each scene
+#ifdef WITH_PYTHON
+			PHY_SetActiveEnvironment(scene->GetPhysicsEnvironment());
+#endif
+			KX_SetActiveScene(scene);
+		}
+		else {
+			// The bundled Bullet keeps a global profiler, physics steps can't overlap.
+			BLI_mutex_lock(&physics_lock);
+		}
+
+		scene->GetPhysicsEnvironment()->EndFrame();
+
+		if (concurrent) {
+			BLI_mutex_unlock(&physics_lock);
+		}
+
+		// Update scenegraph after physics step. This maps physics calculations
+		// into node positions.
+		//m_logger->StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds(), true);
+		//SG_SetActiveStage(SG_STAGE_PHYSICS1_UPDATE);
+		//scene->UpdateParents(m_frameTime);
+
+		// Process sensors, and controllers
+		if (!concurrent) {
+			m_logger->StartLog(tc_logic, m_kxsystem->GetTimeInSeconds(), true);
+			SG_SetActiveStage(SG_STAGE_CONTROLLER);
+		}
+		scene->LogicBeginFrame(m_frameTime);
+
+		// Scenegraph needs to be updated again, because Logic Controllers
+		// can affect the local matrices.
+		if (!concurrent) {
+			m_logger->StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds(), true);
+			SG_SetActiveStage(SG_STAGE_CONTROLLER_UPDATE);
+		}
+		{
+			SG_PROFILE_ZONE("UpdateParents (controllers)");
+			scene->UpdateParents(m_frameTime);
+		}
+
+		// Process actuators
+
+		// Do some cleanup work for this logic frame
+		if (!concurrent) {
+			m_logger->StartLog(tc_logic, m_kxsystem->GetTimeInSeconds(), true);
+			SG_SetActiveStage(SG_STAGE_ACTUATOR);
+		}
+		scene->LogicUpdateFrame(m_frameTime, true);
+
+		scene->LogicEndFrame();
+
+		// Actuators can affect the scenegraph
+		if (!concurrent) {
+			m_logger->StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds(), true);
+			SG_SetActiveStage(SG_STAGE_ACTUATOR_UPDATE);
+		}
+		{
+			SG_PROFILE_ZONE("UpdateParents (actuators)");
+			scene->UpdateParents(m_frameTime);
+		}
+
+		// update levels of detail
+		scene->UpdateObjectLods();
+
+		if (!concurrent) {
+			m_logger->StartLog(tc_physics, m_kxsystem->GetTimeInSeconds(), true);
+			SG_SetActiveStage(SG_STAGE_PHYSICS2);
+		}
+		else {
+			BLI_mutex_lock(&physics_lock);
+		}
+
+		scene->GetPhysicsEnvironment()->BeginFrame();
+
+		// Perform physics calculations on the scene. This can involve
+		// many iterations of the physics solver.
+		scene->GetPhysicsEnvironment()->ProceedDeltaTime(m_frameTime, timestep, framestep);//m_deltatimerealDeltaTime);
+
+		if (!concurrent) {
+			m_logger->StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds(), true);
+			SG_SetActiveStage(SG_STAGE_PHYSICS2_UPDATE);
+		}
+		else {
+			BLI_mutex_unlock(&physics_lock);
+		}
+		{
+			SG_PROFILE_ZONE("UpdateParents (physics)");
+			scene->UpdateParents(m_frameTime);
+		}
+	}
+
+	if (!concurrent) {
+		m_logger->StartLog(tc_services, m_kxsystem->GetTimeInSeconds(), true);
+	}
+}
+
+void KX_KetsjiEngine::NextFrameSceneTask(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	NextFrameSceneData *data = (NextFrameSceneData *)BLI_task_pool_userdata(pool);
+	data->engine->NextFrameScene((KX_Scene *)taskdata, data->timestep, data->framestep, true);
+}
+
+void KX_KetsjiEngine::FlushSceneRequests(KX_Scene *scene)
+{
+	scene->GetNetworkMessageScene()->FlushMessages();
+
+	std::vector<KX_SceneRequest>& requests = scene->GetSceneRequests();
+	for (std::vector<KX_SceneRequest>::iterator it = requests.begin(), end = requests.end(); it != end; ++it) {
+		const KX_SceneRequest& request = *it;
+		switch (request.m_mode) {
+			case KX_SceneRequest::ADD_OVERLAY:
+			{
+				ConvertAndAddScene(request.m_name, true);
+				break;
+			}
+			case KX_SceneRequest::ADD_BACKGROUND:
+			{
+				ConvertAndAddScene(request.m_name, false);
+				break;
+			}
+			case KX_SceneRequest::REMOVE:
+			{
+				RemoveScene(request.m_name);
+				break;
+			}
+			case KX_SceneRequest::REPLACE:
+			{
+				ReplaceScene(request.m_name, request.m_newName);
+				break;
+			}
+			case KX_SceneRequest::SUSPEND:
+			{
+				SuspendScene(request.m_name);
+				break;
+			}
+			case KX_SceneRequest::RESUME:
+			{
+				ResumeScene(request.m_name);
+				break;
+			}
+		}
+	}
+	requests.clear();
+}
+
 void KX_KetsjiEngine::UpdateSuspendedScenes()
 {
 	for (CListValue::iterator sceneit = m_scenes->GetBegin(); sceneit != m_scenes->GetEnd(); ++sceneit) {
@@ -695,6 +857,11 @@ void KX_KetsjiEngine::UpdateSuspendedScenes()
 
 void KX_KetsjiEngine::Render()
 {
+	SG_PROFILE_ZONE("Render");
+
+	// The instancing upload counters are shown per frame, for all eyes and passes.
+	RAS_InstancingBuffer::ResetUploadStats();
+
 	if (m_usedome) {
 		RenderDome();
 		return;
@@ -970,15 +1137,15 @@ void KX_KetsjiEngine::UpdateAnimations(KX_Scene *scene)
 
 void KX_KetsjiEngine::RenderShadowBuffers(KX_Scene *scene)
 {
+	SG_PROFILE_ZONE("RenderShadowBuffers");
+
 	CListValue *lightlist = scene->GetLightList();
-	int i;
+	std::vector<KX_LightObject *> shadowlights;
 
 	m_rasterizer->SetAuxilaryClientInfo(scene);
 
-	for (i = 0; i < lightlist->GetCount(); i++) {
-		KX_GameObject *gameobj = (KX_GameObject *)lightlist->GetValue(i);
-
-		KX_LightObject *light = (KX_LightObject *)gameobj;
+	for (CListValue::iterator it = lightlist->GetBegin(), end = lightlist->GetEnd(); it != end; ++it) {
+		KX_LightObject *light = (KX_LightObject *)*it;
 		RAS_ILightObject *raslight = light->GetLightData();
 
 		raslight->Update();
@@ -986,40 +1153,70 @@ void KX_KetsjiEngine::RenderShadowBuffers(KX_Scene *scene)
 		if (light->GetVisible() && m_rasterizer->GetDrawingMode() == RAS_IRasterizer::RAS_TEXTURED &&
 			raslight->HasShadowBuffer() && raslight->NeedShadowUpdate())
 		{
-			/* make temporary camera */
-			RAS_CameraData camdata = RAS_CameraData();
-			KX_Camera *cam = new KX_Camera(scene, scene->m_callbacks, camdata, true, true);
-			cam->SetName("__shadow__cam__");
+			/* the camera is kept by the light for the next frames */
+			light->UpdateShadowCamera();
+			shadowlights.push_back(light);
+		}
+	}
 
-			MT_Transform camtrans;
+	if (shadowlights.empty()) {
+		return;
+	}
+
+	/* cull for all the lights at once, then update the animations of the objects seen by any light */
+	scene->CalculateShadowVisibleMeshes(shadowlights);
+
+	m_logger->StartLog(tc_animations, m_kxsystem->GetTimeInSeconds(), true);
+	SG_SetActiveStage(SG_STAGE_ANIMATION_UPDATE);
+	UpdateAnimations(scene);
+	m_logger->StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds(), true);
+	SG_SetActiveStage(SG_STAGE_RENDER);
 
-			/* switch drawmode for speed */
-			RAS_IRasterizer::DrawType drawmode = m_rasterizer->GetDrawingMode();
-			m_rasterizer->SetDrawingMode(RAS_IRasterizer::RAS_SHADOW);
+	/* switch drawmode for speed */
+	RAS_IRasterizer::DrawType drawmode = m_rasterizer->GetDrawingMode();
+	m_rasterizer->SetDrawingMode(RAS_IRasterizer::RAS_SHADOW);
+
+	for (unsigned int i = 0, size = shadowlights.size(); i < size; ++i) {
+		KX_LightObject *light = shadowlights[i];
+		RAS_ILightObject *raslight = light->GetLightData();
+		const MT_Transform& camtrans = light->GetShadowCameraTransform();
 
-			/* binds framebuffer object, sets up camera .. */
-			raslight->BindShadowBuffer(m_canvas, cam, camtrans);
+		const bool cached = raslight->m_cachedShadow && raslight->CreateShadowCache();
 
-			/* update scene */
-			scene->CalculateVisibleMeshes(m_rasterizer, cam, raslight->GetShadowLayer());
+		/* binds framebuffer object, sets up the rasterizer matrices */
+		raslight->BindShadowBuffer(m_canvas, light->GetShadowCamera());
 
-			m_logger->StartLog(tc_animations, m_kxsystem->GetTimeInSeconds(), true);
-			SG_SetActiveStage(SG_STAGE_ANIMATION_UPDATE);
-			UpdateAnimations(scene);
-			m_logger->StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds(), true);
-			SG_SetActiveStage(SG_STAGE_RENDER);
+		if (cached) {
+			if (light->IsShadowCacheValid(scene->GetShadowCacheVersion())) {
+				raslight->RestoreShadowCache();
+			}
+			else {
+				/* draw the static casters once in the cache */
+				m_rasterizer->Clear(RAS_IRasterizer::RAS_DEPTH_BUFFER_BIT);
+				m_rasterizer->Clear(RAS_IRasterizer::RAS_COLOR_BUFFER_BIT);
+				scene->SetShadowCulling(i, KX_Scene::SHADOW_CASTERS_STATIC);
+				scene->RenderBuckets(camtrans, m_rasterizer);
+				raslight->StoreShadowCache();
+				light->SetShadowCacheValid(scene->GetShadowCacheVersion());
+			}
 
-			/* render */
+			/* draw the moving casters over the cache */
+			scene->SetShadowCulling(i, KX_Scene::SHADOW_CASTERS_DYNAMIC);
+			scene->RenderBuckets(camtrans, m_rasterizer);
+		}
+		else {
 			m_rasterizer->Clear(RAS_IRasterizer::RAS_DEPTH_BUFFER_BIT);
 			m_rasterizer->Clear(RAS_IRasterizer::RAS_COLOR_BUFFER_BIT);
+			scene->SetShadowCulling(i, KX_Scene::SHADOW_CASTERS_ALL);
 			scene->RenderBuckets(camtrans, m_rasterizer);
-
-			/* unbind framebuffer object, restore drawmode, free camera */
-			raslight->UnbindShadowBuffer();
-			m_rasterizer->SetDrawingMode(drawmode);
-			cam->Release();
 		}
+
+		/* unbind framebuffer object */
+		raslight->UnbindShadowBuffer();
 	}
+
+	/* restore drawmode */
+	m_rasterizer->SetDrawingMode(drawmode);
 }
 
 // update graphics
@@ -1032,6 +1229,8 @@ void KX_KetsjiEngine::RenderFrame(KX_Scene *scene, KX_Camera *cam)
 	if (!cam)
 		return;
 
+	SG_PROFILE_ZONE(scene->GetProfileName());
+
 	bool isfirstscene = (scene == m_scenes->GetFront());
 
 	KX_SetActiveScene(scene);
@@ -1365,6 +1564,48 @@ void KX_KetsjiEngine::RenderDebugProperties()
 			m_rasterizer->RenderBox2D(xcoord + (int)(2.2 * profile_indent), ycoord, m_canvas->GetWidth(), m_canvas->GetHeight(), time/tottime);
 			ycoord += const_ysize;
 		}
+
+		// Vertex memory uploaded by each scene, and saved by the compact vertex formats
+		for (CListValue::iterator sceit = m_scenes->GetBegin(); sceit != m_scenes->GetEnd(); ++sceit) {
+			KX_Scene *scene = (KX_Scene *)*sceit;
+			unsigned int storageSize, savedSize;
+
+			scene->GetBucketManager()->GetVertexMemorySize(storageSize, savedSize);
+
+			m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+			                           scene->GetName().ReadPtr(),
+			                           xcoord + const_xindent,
+			                           ycoord,
+			                           m_canvas->GetWidth(),
+			                           m_canvas->GetHeight());
+
+			debugtxt.Format("%.2fMB | %.2fMB saved", storageSize / 1048576.0f, savedSize / 1048576.0f);
+			m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+			                           debugtxt.ReadPtr(),
+			                           xcoord + const_xindent + profile_indent, ycoord,
+			                           m_canvas->GetWidth(),
+			                           m_canvas->GetHeight());
+			ycoord += const_ysize;
+		}
+
+		// Instancing data uploaded this frame, compared to the size of all the instances drawn
+		unsigned int uploadedSize, instancesSize;
+		RAS_InstancingBuffer::GetUploadStats(uploadedSize, instancesSize);
+
+		m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+		                           "Instancing:",
+		                           xcoord + const_xindent,
+		                           ycoord,
+		                           m_canvas->GetWidth(),
+		                           m_canvas->GetHeight());
+
+		debugtxt.Format("%.1fKB | %.1fKB", uploadedSize / 1024.0f, instancesSize / 1024.0f);
+		m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+		                           debugtxt.ReadPtr(),
+		                           xcoord + const_xindent + profile_indent, ycoord,
+		                           m_canvas->GetWidth(),
+		                           m_canvas->GetHeight());
+		ycoord += const_ysize;
 	}
 	// Add the ymargin for titles below the other section of debug info
 	ycoord += title_y_top_margin;
@@ -1709,6 +1950,16 @@ void KX_KetsjiEngine::SetRestrictAnimationFPS(bool bRestrictAnimFPS)
 	m_restrict_anim_fps = bRestrictAnimFPS;
 }
 
+void KX_KetsjiEngine::SetUseParallelScenes(bool parallel)
+{
+	m_useParallelScenes = parallel;
+}
+
+bool KX_KetsjiEngine::GetUseParallelScenes() const
+{
+	return m_useParallelScenes;
+}
+
 double KX_KetsjiEngine::GetAnimFrameRate()
 {
 	return m_anim_framerate;
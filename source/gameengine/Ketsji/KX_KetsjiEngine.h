@@ -43,6 +43,7 @@
 #include <vector>
 
 struct TaskScheduler;
+struct TaskPool;
 class KX_TimeCategoryLogger;
 class KX_ISystem;
 class KX_ISceneConverter;
@@ -226,6 +227,9 @@ private:
 	/// Task scheduler for multi-threading
 	TaskScheduler *m_taskscheduler;
 
+	/// Update the scenes without Python logic concurrently on the task scheduler.
+	bool m_useParallelScenes;
+
 	/** Set scene's total pause duration for animations process.
 	 * This is done in a separate loop to get the proper state of each scenes.
 	 * eg: There's 2 scenes, the first is suspended and the second is active.
@@ -238,6 +242,20 @@ private:
 	 */
 	void UpdateSuspendedScenes();
 
+	/** Proceed the logic, scenegraph and physics of a scene for one logic frame.
+	 * \param concurrent True when the scene is updated from a worker thread, in this case
+	 * the time logger and the active scene are left untouched and the physics
+	 * steps are serialized with the ones of the other concurrent scenes.
+	 */
+	void NextFrameScene(KX_Scene *scene, double timestep, double framestep, bool concurrent);
+	static void NextFrameSceneTask(TaskPool *pool, void *taskdata, int threadid);
+
+	/** Hand the scene management requests and network messages emitted by the
+	 * logic of a scene to the engine, called in scene order after each logic
+	 * frame to keep cross scene side effects deterministic.
+	 */
+	void FlushSceneRequests(KX_Scene *scene);
+
 	void RenderFrame(KX_Scene *scene, KX_Camera *cam);
 	void PostRenderScene(KX_Scene *scene);
 	void RenderDebugProperties();
@@ -425,6 +443,16 @@ public:
 	 */
 	static void SetRestrictAnimationFPS(bool bRestrictAnimFPS);
 
+	/**
+	 * Sets whether the scenes without Python logic are updated concurrently.
+	 */
+	void SetUseParallelScenes(bool parallel);
+
+	/**
+	 * Gets whether the scenes without Python logic are updated concurrently.
+	 */
+	bool GetUseParallelScenes() const;
+
 	/**
 	 * Gets the framerate for playing animations. (actions and ipos)
 	 */
@@ -37,6 +37,7 @@
 
 #include "KX_Light.h"
 #include "KX_Camera.h"
+#include "KX_Scene.h"
 #include "RAS_IRasterizer.h"
 #include "RAS_ICanvas.h"
 #include "RAS_ILightObject.h"
@@ -56,7 +57,11 @@ KX_LightObject::KX_LightObject(void *sgReplicationInfo, SG_Callbacks callbacks,
                                RAS_IRasterizer *rasterizer,
                                RAS_ILightObject *lightobj)
 	:KX_GameObject(sgReplicationInfo, callbacks),
-	m_rasterizer(rasterizer)
+	m_rasterizer(rasterizer),
+	m_shadowCamera(NULL),
+	m_shadowCacheValid(false),
+	m_shadowCacheVersion(0),
+	m_shadowCacheLayer(0)
 {
 	m_lightobj = lightobj;
 	m_lightobj->m_scene = sgReplicationInfo;
@@ -68,6 +73,10 @@ KX_LightObject::KX_LightObject(void *sgReplicationInfo, SG_Callbacks callbacks,
 
 KX_LightObject::~KX_LightObject()
 {
+	if (m_shadowCamera) {
+		m_shadowCamera->Release();
+	}
+
 	if (m_lightobj) {
 		m_rasterizer->RemoveLight(m_lightobj);
 		delete(m_lightobj);
@@ -85,6 +94,9 @@ CValue *KX_LightObject::GetReplica()
 
 	replica->ProcessReplica();
 
+	replica->m_shadowCamera = NULL;
+	replica->m_shadowCacheValid = false;
+
 	replica->m_lightobj = m_lightobj->Clone();
 	replica->m_lightobj->m_light = replica;
 	m_rasterizer->AddLight(replica->m_lightobj);
@@ -99,6 +111,67 @@ void KX_LightObject::UpdateScene(KX_Scene *kxscene)
 	m_lightobj->m_scene = (void *)kxscene;
 	m_blenderscene = kxscene->GetBlenderScene();
 	m_base = BKE_scene_base_add(m_blenderscene, GetBlenderObject());
+
+	// The shadow camera belongs to the previous scene.
+	if (m_shadowCamera) {
+		m_shadowCamera->Release();
+		m_shadowCamera = NULL;
+	}
+	m_shadowCacheValid = false;
+}
+
+void KX_LightObject::UpdateShadowCamera()
+{
+	if (!m_shadowCamera) {
+		KX_Scene *scene = GetScene();
+		RAS_CameraData camdata = RAS_CameraData();
+		m_shadowCamera = new KX_Camera(scene, scene->m_callbacks, camdata, true, true);
+		m_shadowCamera->SetName("__shadow__cam__");
+	}
+
+	m_lightobj->UpdateShadowCamera(m_shadowCamera, m_shadowCameraTransform);
+}
+
+KX_Camera *KX_LightObject::GetShadowCamera() const
+{
+	return m_shadowCamera;
+}
+
+const MT_Transform& KX_LightObject::GetShadowCameraTransform() const
+{
+	return m_shadowCameraTransform;
+}
+
+static bool matrix_equals(const MT_Matrix4x4& mat1, const MT_Matrix4x4& mat2)
+{
+	for (unsigned short i = 0; i < 4; ++i) {
+		if (!(mat1[i] == mat2[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool KX_LightObject::IsShadowCacheValid(unsigned int version) const
+{
+	return (m_shadowCacheValid && m_shadowCacheVersion == version &&
+	        m_shadowCacheLayer == m_lightobj->GetShadowLayer() &&
+	        matrix_equals(m_shadowCacheModelview, m_shadowCamera->GetModelviewMatrix()) &&
+	        matrix_equals(m_shadowCacheProjection, m_shadowCamera->GetProjectionMatrix()));
+}
+
+void KX_LightObject::SetShadowCacheValid(unsigned int version)
+{
+	m_shadowCacheValid = true;
+	m_shadowCacheVersion = version;
+	m_shadowCacheLayer = m_lightobj->GetShadowLayer();
+	m_shadowCacheModelview = m_shadowCamera->GetModelviewMatrix();
+	m_shadowCacheProjection = m_shadowCamera->GetProjectionMatrix();
+}
+
+void KX_LightObject::InvalidateShadowCache()
+{
+	m_shadowCacheValid = false;
 }
 
 void KX_LightObject::SetLayer(int layer)
@@ -170,6 +243,7 @@ PyAttributeDef KX_LightObject::Attributes[] = {
 	KX_PYATTRIBUTE_RO_FUNCTION("HEMI", KX_LightObject, pyattr_get_typeconst),
 	KX_PYATTRIBUTE_RW_FUNCTION("type", KX_LightObject, pyattr_get_type, pyattr_set_type),
 	KX_PYATTRIBUTE_RW_FUNCTION("staticShadow", KX_LightObject, pyattr_get_static_shadow, pyattr_set_static_shadow),
+	KX_PYATTRIBUTE_RW_FUNCTION("cachedShadow", KX_LightObject, pyattr_get_cached_shadow, pyattr_set_cached_shadow),
 	{NULL} // Sentinel
 };
 
@@ -513,4 +587,24 @@ int KX_LightObject::pyattr_set_static_shadow(void *self_v, const KX_PYATTRIBUTE_
 	self->m_lightobj->m_staticShadow = param;
 	return PY_SET_ATTR_SUCCESS;
 }
+
+PyObject *KX_LightObject::pyattr_get_cached_shadow(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef)
+{
+	KX_LightObject *self = static_cast<KX_LightObject *>(self_v);
+	return PyBool_FromLong(self->m_lightobj->m_cachedShadow);
+}
+
+int KX_LightObject::pyattr_set_cached_shadow(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef, PyObject *value)
+{
+	KX_LightObject *self = static_cast<KX_LightObject *>(self_v);
+	int param = PyObject_IsTrue(value);
+	if (param == -1) {
+		PyErr_SetString(PyExc_AttributeError, "light.cachedShadow = val: KX_LightObject, expected True or False");
+		return PY_SET_ATTR_FAIL;
+	}
+
+	self->m_lightobj->m_cachedShadow = param;
+	self->InvalidateShadowCache();
+	return PY_SET_ATTR_SUCCESS;
+}
 #endif // WITH_PYTHON
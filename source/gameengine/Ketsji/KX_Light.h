@@ -33,6 +33,8 @@
 #define __KX_LIGHT_H__
 
 #include "KX_GameObject.h"
+#include "MT_Transform.h"
+#include "MT_Matrix4x4.h"
 
 #define MAX_LIGHT_LAYERS ((1 << 20) - 1)
 
@@ -55,6 +57,18 @@ protected:
 	Scene *m_blenderscene;
 	Base *m_base;
 
+	/// Camera of the shadow buffer, created at the first shadow render and kept.
+	KX_Camera *m_shadowCamera;
+	/// Camera to world transform of the shadow buffer.
+	MT_Transform m_shadowCameraTransform;
+
+	/// The shadow cache holds the static casters for this version, view, projection and layer.
+	bool m_shadowCacheValid;
+	unsigned int m_shadowCacheVersion;
+	MT_Matrix4x4 m_shadowCacheModelview;
+	MT_Matrix4x4 m_shadowCacheProjection;
+	int m_shadowCacheLayer;
+
 public:
 	KX_LightObject(void *sgReplicationInfo, SG_Callbacks callbacks, RAS_IRasterizer *rasterizer, RAS_ILightObject *lightobj);
 	virtual ~KX_LightObject();
@@ -66,6 +80,17 @@ public:
 	}
 
 	void UpdateScene(KX_Scene *kxscene);
+
+	/// Update the camera of the shadow buffer to the light, it must be done before the shadow culling.
+	void UpdateShadowCamera();
+	KX_Camera *GetShadowCamera() const;
+	const MT_Transform& GetShadowCameraTransform() const;
+
+	/// Return true if the shadow cache holds the static casters of version for the current shadow camera.
+	bool IsShadowCacheValid(unsigned int version) const;
+	/// Mark the shadow cache as holding the static casters of version.
+	void SetShadowCacheValid(unsigned int version);
+	void InvalidateShadowCache();
 	virtual void SetLayer(int layer);
 
 	virtual int GetGameObjectType()
@@ -109,6 +134,8 @@ public:
 	static int pyattr_set_type(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef, PyObject *value);
 	static PyObject *pyattr_get_static_shadow(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef);
 	static int pyattr_set_static_shadow(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef, PyObject *value);
+	static PyObject *pyattr_get_cached_shadow(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef);
+	static int pyattr_set_cached_shadow(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef, PyObject *value);
 #endif
 };
 
@@ -26,6 +26,9 @@
 #include "DNA_object_types.h"
 #include "BLI_listbase.h"
 
+#include <algorithm>
+#include <float.h>
+
 KX_LodList::KX_LodList(Object *ob, KX_Scene* scene, KX_BlenderSceneConverter* converter, bool libloading)
 	:m_refcount(1)
 {
@@ -114,3 +117,35 @@ const KX_LodList::Level& KX_LodList::GetLevel(KX_Scene *scene, unsigned short pr
 	}
 	return m_lodLevelList[level];
 }
+
+float KX_LodList::GetLevelMargin(KX_Scene *scene, unsigned short level, float distance)
+{
+	/* Same thresholds as GetLevel with level as previous lod, the level only changes
+	 * when the distance crosses one of the thresholds tested before breaking. */
+	float margin = FLT_MAX;
+	const unsigned short count = m_lodLevelList.size();
+	for (unsigned short i = 0; i < count - 1; ++i) {
+		float newdistance = m_lodLevelList[i + 1].distance;
+		if (i == level || i == (level + 1)) {
+			newdistance += GetHysteresis(scene, i);
+		}
+		else if (i == (level - 1)) {
+			newdistance -= GetHysteresis(scene, i);
+		}
+		newdistance = fabsf(newdistance);
+
+		if (newdistance > distance) {
+			// GetLevel breaks at this threshold.
+			if (i != level) {
+				return 0.0f;
+			}
+			return std::min(margin, newdistance - distance);
+		}
+		if (i >= level) {
+			return 0.0f;
+		}
+		margin = std::min(margin, distance - newdistance);
+	}
+
+	return (level == (count - 1)) ? margin : 0.0f;
+}
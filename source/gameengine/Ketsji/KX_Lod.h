@@ -67,6 +67,14 @@ public:
 	 */
 	const KX_LodList::Level& GetLevel(KX_Scene *scene, unsigned short previouslod, float distance2);
 
+	/** Get the distance the object can travel without changing its lod level.
+	 * \param scene Scene used to get default hysteresis.
+	 * \param level Level returned by GetLevel for this distance, used as previous lod.
+	 * \param distance Distance object to the camera.
+	 * \return Zero if GetLevel with level as previous lod returns another level.
+	 */
+	float GetLevelMargin(KX_Scene *scene, unsigned short level, float distance);
+
 	/// If it returns true, then the lod is useless then.
 	inline bool Empty() const
 	{
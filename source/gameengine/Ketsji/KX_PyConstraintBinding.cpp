@@ -146,6 +146,11 @@ PyDoc_STRVAR(gPyGetAppliedImpulse__doc__,
 "getAppliedImpulse(int constraintId)\n"
 ""
 );
+PyDoc_STRVAR(gPyGetCollisions__doc__,
+"getCollisions()\n"
+"Return the collisions of the objects using collision callbacks during the last physics step "
+"and a float buffer of all their contact points"
+);
 
 
 
@@ -594,6 +599,51 @@ static PyObject *gPyRemoveConstraint(PyObject *self,
 	Py_RETURN_NONE;
 }
 
+static PyObject *gPyCollisionObject(PHY_IPhysicsController *ctrl)
+{
+	KX_GameObject *gameobj = KX_GameObject::GetClientObject((KX_ClientObjectInfo *)ctrl->GetNewClientInfo());
+	if (gameobj) {
+		return gameobj->GetProxy();
+	}
+	Py_RETURN_NONE;
+}
+
+static PyObject *gPyGetCollisions(PyObject *self)
+{
+	const PHY_Collision *collisions = NULL;
+	const PHY_ContactPoint *points = NULL;
+	unsigned int numCollisions = 0;
+	unsigned int numPoints = 0;
+
+	if (PHY_GetActiveEnvironment()) {
+		PHY_GetActiveEnvironment()->GetCollisions(collisions, numCollisions, points, numPoints);
+	}
+
+	PyObject *pycollisions = PyList_New(numCollisions);
+	for (unsigned int i = 0; i < numCollisions; ++i) {
+		const PHY_Collision& collision = collisions[i];
+		PyList_SET_ITEM(pycollisions, i, Py_BuildValue("(NNII)",
+		                                               gPyCollisionObject(collision.m_first),
+		                                               gPyCollisionObject(collision.m_second),
+		                                               collision.m_firstPoint, collision.m_numPoints));
+	}
+
+	/* All the contact points are copied at once in a buffer owned by Python,
+	 * the physics environment reuses its own one at the next step. */
+	PyObject *bytes = PyByteArray_FromStringAndSize((const char *)points, numPoints * sizeof(PHY_ContactPoint));
+	PyObject *view = PyMemoryView_FromObject(bytes);
+	Py_DECREF(bytes);
+	PyObject *floatview = PyObject_CallMethod(view, "cast", "s", "f");
+	Py_DECREF(view);
+
+	if (!floatview) {
+		Py_DECREF(pycollisions);
+		return NULL;
+	}
+
+	return Py_BuildValue("(NN)", pycollisions, floatview);
+}
+
 static PyObject *gPyExportBulletFile(PyObject *, PyObject *args)
 {
 	char* filename;
@@ -660,6 +710,8 @@ static struct PyMethodDef physicsconstraints_methods[] = {
 	 METH_VARARGS, (const char *)gPyRemoveConstraint__doc__},
 	{"getAppliedImpulse",(PyCFunction) gPyGetAppliedImpulse,
 	 METH_VARARGS, (const char *)gPyGetAppliedImpulse__doc__},
+	{"getCollisions",(PyCFunction) gPyGetCollisions,
+	 METH_NOARGS, (const char *)gPyGetCollisions__doc__},
 
 	{"exportBulletFile",(PyCFunction)gPyExportBulletFile,
 	 METH_VARARGS, "export a .bullet file"},
@@ -76,6 +76,7 @@ extern "C" {
 #include "KX_PyConstraintBinding.h"
 
 #include "KX_KetsjiEngine.h"
+#include "SG_Profiler.h"
 #include "KX_RadarSensor.h"
 #include "KX_RaySensor.h"
 #include "KX_MovementSensor.h"
@@ -368,6 +369,36 @@ static PyObject *gPyGetProfileInfo(PyObject *)
 	return KX_GetActiveEngine()->GetPyProfileDict();
 }
 
+PyDoc_STRVAR(gPyStartProfileTrace_doc,
+"startProfileTrace()\n"
+"Starts recording the profiler zones of each frame, from the next frame"
+);
+static PyObject *gPyStartProfileTrace(PyObject *)
+{
+	SG_Profiler::StartCapture();
+	Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(gPyStopProfileTrace_doc,
+"stopProfileTrace(filepath)\n"
+"Stops recording the profiler zones at the end of the frame and writes them\n"
+"to filepath in the Chrome trace event format"
+);
+static PyObject *gPyStopProfileTrace(PyObject *, PyObject *args)
+{
+	char filepath[FILE_MAX];
+	char *filename;
+
+	if (!PyArg_ParseTuple(args, "s:stopProfileTrace", &filename))
+		return NULL;
+
+	BLI_strncpy(filepath, filename, FILE_MAX);
+	BLI_path_abs(filepath, gp_GamePythonPath);
+	SG_Profiler::StopCapture(filepath);
+
+	Py_RETURN_NONE;
+}
+
 PyDoc_STRVAR(gPySendMessage_doc,
 "sendMessage(subject, [body, to, from])\n"
 "sends a message in same manner as a message actuator"
@@ -677,12 +708,12 @@ static PyObject *gLibLoad(PyObject *, PyObject *args, PyObject *kwds)
 	KX_LibLoadStatus *status = NULL;
 
 	short options=0;
-	int load_actions=0, verbose=0, load_scripts=1, async=0;
+	int load_actions=0, verbose=0, load_scripts=1, async=0, priority=0;
 
-	static const char *kwlist[] = {"path", "group", "buffer", "load_actions", "verbose", "load_scripts", "async", NULL};
+	static const char *kwlist[] = {"path", "group", "buffer", "load_actions", "verbose", "load_scripts", "async", "priority", NULL};
 	
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "ss|y*iiIi:LibLoad", const_cast<char**>(kwlist),
-									&path, &group, &py_buffer, &load_actions, &verbose, &load_scripts, &async))
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "ss|y*iiIii:LibLoad", const_cast<char**>(kwlist),
+									&path, &group, &py_buffer, &load_actions, &verbose, &load_scripts, &async, &priority))
 		return NULL;
 
 	/* setup options */
@@ -702,14 +733,14 @@ static PyObject *gLibLoad(PyObject *, PyObject *args, PyObject *kwds)
 		BLI_strncpy(abs_path, path, sizeof(abs_path));
 		BLI_path_abs(abs_path, gp_GamePythonPath);
 
-		if ((status=kx_scene->GetSceneConverter()->LinkBlendFilePath(abs_path, group, kx_scene, &err_str, options))) {
+		if ((status=kx_scene->GetSceneConverter()->LinkBlendFilePath(abs_path, group, kx_scene, &err_str, options, priority))) {
 			return status->GetProxy();
 		}
 	}
 	else
 	{
 
-		if ((status=kx_scene->GetSceneConverter()->LinkBlendFileMemory(py_buffer.buf, py_buffer.len, path, group, kx_scene, &err_str, options)))	{
+		if ((status=kx_scene->GetSceneConverter()->LinkBlendFileMemory(py_buffer.buf, py_buffer.len, path, group, kx_scene, &err_str, options, priority)))	{
 			PyBuffer_Release(&py_buffer);
 			return status->GetProxy();
 		}
@@ -787,11 +818,12 @@ static PyObject *gLibFree(PyObject *, PyObject *args)
 {
 	KX_Scene *kx_scene= KX_GetActiveScene();
 	char *path;
+	int deferred = 0;
 
-	if (!PyArg_ParseTuple(args,"s:LibFree",&path))
+	if (!PyArg_ParseTuple(args,"s|i:LibFree",&path, &deferred))
 		return NULL;
 
-	if (kx_scene->GetSceneConverter()->FreeBlendFile(path))
+	if (kx_scene->GetSceneConverter()->FreeBlendFile(path, deferred != 0))
 	{
 		Py_RETURN_TRUE;
 	}
@@ -875,6 +907,8 @@ static struct PyMethodDef game_methods[] = {
 	{"PrintMemInfo", (PyCFunction)pyPrintStats, METH_NOARGS, (const char *)"Print engine statistics"},
 	{"NextFrame", (PyCFunction)gPyNextFrame, METH_NOARGS, (const char *)"Render next frame (if Python has control)"},
 	{"getProfileInfo", (PyCFunction)gPyGetProfileInfo, METH_NOARGS, gPyGetProfileInfo_doc},
+	{"startProfileTrace", (PyCFunction)gPyStartProfileTrace, METH_NOARGS, gPyStartProfileTrace_doc},
+	{"stopProfileTrace", (PyCFunction)gPyStopProfileTrace, METH_VARARGS, gPyStopProfileTrace_doc},
 	/* library functions */
 	{"LibLoad", (PyCFunction)gLibLoad, METH_VARARGS|METH_KEYWORDS, (const char *)""},
 	{"LibNew", (PyCFunction)gLibNew, METH_VARARGS, (const char *)""},
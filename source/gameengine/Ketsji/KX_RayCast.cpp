@@ -33,6 +33,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <algorithm>
 
 #include "KX_RayCast.h"
 
@@ -42,6 +43,11 @@
 #include "PHY_IPhysicsEnvironment.h"
 #include "PHY_IPhysicsController.h"
 
+#include "BLI_task.h"
+
+/// Rays tested by a single task of RayTestBatch.
+#define KX_RAYCAST_RAYS_PER_TASK 64
+
 KX_RayCast::KX_RayCast(PHY_IPhysicsController* ignoreController, bool faceNormal, bool faceUV)
 	:PHY_IRayCastFilterCallback(ignoreController, faceNormal, faceUV)
 {
@@ -119,3 +125,57 @@ bool KX_RayCast::RayTest(PHY_IPhysicsEnvironment* physics_environment, const MT_
 	return false;
 }
 
+struct KX_RayCastBatchData
+{
+	PHY_IPhysicsEnvironment *m_physEnv;
+	const MT_Vector3 *m_frompoints;
+	const MT_Vector3 *m_topoints;
+	KX_RayCast **m_callbacks;
+	bool *m_results;
+	unsigned int m_numRays;
+};
+
+static void raycast_batch_task(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	KX_RayCastBatchData *data = (KX_RayCastBatchData *)BLI_task_pool_userdata(pool);
+	const unsigned int start = GET_UINT_FROM_POINTER(taskdata) * KX_RAYCAST_RAYS_PER_TASK;
+	const unsigned int end = std::min(start + KX_RAYCAST_RAYS_PER_TASK, data->m_numRays);
+
+	for (unsigned int i = start; i < end; ++i) {
+		data->m_results[i] = KX_RayCast::RayTest(data->m_physEnv, data->m_frompoints[i], data->m_topoints[i],
+		                                         *data->m_callbacks[i]);
+	}
+}
+
+void KX_RayCast::RayTestBatch(PHY_IPhysicsEnvironment *physics_environment, const MT_Vector3 *frompoints,
+                              const MT_Vector3 *topoints, KX_RayCast **callbacks, bool *results,
+                              unsigned int numRays, TaskScheduler *scheduler)
+{
+	// Not worth the tasks overhead.
+	if (!scheduler || numRays <= KX_RAYCAST_RAYS_PER_TASK) {
+		for (unsigned int i = 0; i < numRays; ++i) {
+			results[i] = RayTest(physics_environment, frompoints[i], topoints[i], *callbacks[i]);
+		}
+		return;
+	}
+
+	for (unsigned int i = 0; i < numRays; ++i) {
+		callbacks[i]->m_concurrent = true;
+	}
+
+	KX_RayCastBatchData data;
+	data.m_physEnv = physics_environment;
+	data.m_frompoints = frompoints;
+	data.m_topoints = topoints;
+	data.m_callbacks = callbacks;
+	data.m_results = results;
+	data.m_numRays = numRays;
+
+	TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+	const unsigned int numTasks = (numRays + KX_RAYCAST_RAYS_PER_TASK - 1) / KX_RAYCAST_RAYS_PER_TASK;
+	for (unsigned int i = 0; i < numTasks; ++i) {
+		BLI_task_pool_push(pool, raycast_batch_task, SET_UINT_IN_POINTER(i), false, TASK_PRIORITY_HIGH);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+}
@@ -42,6 +42,7 @@
 
 class RAS_MeshObject; 
 struct KX_ClientObjectInfo;
+struct TaskScheduler;
 
 /**
  *  Defines a function for doing a ray cast.
@@ -97,6 +98,20 @@ public:
 		const MT_Vector3& frompoint, 
 		const MT_Vector3& topoint, 
 		KX_RayCast& callback);
+
+	/** Ray test many rays at once, the ray i goes from frompoints[i] to topoints[i] and
+	 * uses callbacks[i], results[i] receives the value returned by RayTest.
+	 * With a task scheduler the rays are spread over its threads: RayHit and
+	 * NeedRayCast are called from the worker threads and must only read shared data.
+	 */
+	static void RayTestBatch(
+		PHY_IPhysicsEnvironment *physics_environment,
+		const MT_Vector3 *frompoints,
+		const MT_Vector3 *topoints,
+		KX_RayCast **callbacks,
+		bool *results,
+		unsigned int numRays,
+		TaskScheduler *scheduler);
 	
 	
 #ifdef WITH_CXX_GUARDEDALLOC
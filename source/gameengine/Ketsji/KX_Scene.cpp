@@ -36,6 +36,7 @@
 #endif
 
 #include <stdio.h>
+#include <algorithm>
 
 #include "KX_Scene.h"
 #include "KX_Globals.h"
@@ -70,6 +71,7 @@
 #include "SCA_IController.h"
 #include "SCA_IActuator.h"
 #include "SG_Node.h"
+#include "SG_Profiler.h"
 #include "BL_System.h"
 #include "SG_Controller.h"
 #include "SG_IObject.h"
@@ -88,6 +90,7 @@
 
 #include "BL_ModifierDeformer.h"
 #include "BL_ShapeDeformer.h"
+#include "BL_ArmatureObject.h"
 #include "BL_DeformableGameObject.h"
 #include "KX_ObstacleSimulation.h"
 
@@ -100,6 +103,7 @@
 #endif
 
 #include "KX_Light.h"
+#include "RAS_ILightObject.h"
 
 #include "BLI_task.h"
 
@@ -149,17 +153,24 @@ KX_Scene::KX_Scene(class SCA_IInputDevice* keyboarddevice,
 	m_sceneConverter(NULL),
 	m_physicsEnvironment(0),
 	m_sceneName(sceneName),
+	m_profileName(SG_Profiler::InternName(std::string(sceneName.ReadPtr()))),
 	m_active_camera(NULL),
 	m_ueberExecutionPriority(0),
 	m_blenderScene(scene),
 	m_isActivedHysteresis(false),
-	m_lodHysteresisValue(0)
+	m_lodHysteresisValue(0),
+	m_activitySchedule(KX_DistanceSchedule::SLOT_ACTIVITY),
+	m_lodSchedule(KX_DistanceSchedule::SLOT_LOD),
+	m_activityScheduleRadius(0.0f)
 {
 	m_suspendedtime = 0.0;
 	m_suspendeddelta = 0.0;
 
 	m_dbvt_culling = false;
 	m_dbvt_occlusion_res = 0;
+	m_canUpdateConcurrently = false;
+	m_concurrentUpdateDirty = true;
+	m_shadowCacheVersion = 0;
 	m_activity_culling = false;
 	m_suspend = false;
 	m_isclearingZbuffer = true;
@@ -232,6 +243,8 @@ KX_Scene::~KX_Scene()
 	// reference might be hanging and causing late release of objects
 	RemoveAllDebugProperties();
 
+	ClearObjectPools();
+
 	while (GetRootParentList()->GetCount() > 0) 
 	{
 		KX_GameObject* parentobj = (KX_GameObject*) GetRootParentList()->GetValue(0);
@@ -241,6 +254,9 @@ KX_Scene::~KX_Scene()
 	if (m_obstacleSimulation)
 		delete m_obstacleSimulation;
 
+	m_activitySchedule.Clear();
+	m_lodSchedule.Clear();
+
 	if (m_objectlist)
 		m_objectlist->Release();
 
@@ -322,6 +338,12 @@ STR_String& KX_Scene::GetName()
 void KX_Scene::SetName(const char *name)
 {
 	m_sceneName = name;
+	m_profileName = SG_Profiler::InternName(std::string(name));
+}
+
+const char *KX_Scene::GetProfileName() const
+{
+	return m_profileName;
 }
 
 CValue *KX_Scene::GetReplica()
@@ -441,6 +463,10 @@ void KX_Scene::Resume()
 
 void KX_Scene::SetActivityCulling(bool b)
 {
+	// The camera travel isn't accumulated while the activity culling is disabled.
+	if (b && !m_activity_culling) {
+		m_activitySchedule.Invalidate();
+	}
 	m_activity_culling = b;
 }
 
@@ -553,6 +579,8 @@ KX_GameObject* KX_Scene::AddNodeReplicaObject(class SG_IObject* node, class CVal
 
 	// this is the list of object that are send to the graphics pipeline
 	m_objectlist->Add(newobj->AddRef());
+	InvalidateConcurrentUpdate();
+	AddDistanceScheduleObject(newobj);
 	if (newobj->GetGameObjectType()==SCA_IObject::OBJ_LIGHT)
 		m_lightlist->Add(newobj->AddRef());
 	else if (newobj->GetGameObjectType()==SCA_IObject::OBJ_TEXT)
@@ -627,6 +655,9 @@ void KX_Scene::ReplicateLogic(KX_GameObject* newobj)
 	if (KX_GetActiveEngine()->GetAutoAddDebugProperties()) {
 		AddObjectDebugProperties(newobj);
 	}
+	// the replicated controllers can be Python controllers
+	InvalidateConcurrentUpdate();
+
 	// also relink the controller to sensors/actuators
 	SCA_ControllerList& controllers = newobj->GetControllers();
 	//SCA_SensorList&     sensors     = newobj->GetSensors();
@@ -892,6 +923,12 @@ SCA_IObject* KX_Scene::AddReplicaObject(class CValue* originalobject,
 	KX_GameObject* originalobj = (KX_GameObject*) originalobject;
 	KX_GameObject* referenceobj = (KX_GameObject*) referenceobject;
 
+	// reuse a deactivated replica if the object is pooled
+	KX_GameObject *pooledobj = SpawnPooledObject(originalobj, referenceobj, lifespan);
+	if (pooledobj) {
+		return pooledobj;
+	}
+
 	m_ueberExecutionPriority++;
 
 	// lets create a replica
@@ -999,10 +1036,207 @@ SCA_IObject* KX_Scene::AddReplicaObject(class CValue* originalobject,
 	}
 	childrecursive->Release();
 
+	// the pool ran out of replicas, this one will be recycled as well
+	if (m_objectPools.find(originalobj) != m_objectPools.end()) {
+		m_pooledObjects[replica] = originalobj;
+	}
+
 	//	don't release replica here because we are returning it, not done with it...
 	return replica;
 }
 
+bool KX_Scene::IsPoolableObject(KX_GameObject *prototype)
+{
+	switch (prototype->GetGameObjectType()) {
+		case SCA_IObject::OBJ_CAMERA:
+		case SCA_IObject::OBJ_LIGHT:
+		case SCA_IObject::OBJ_TEXT:
+			return false;
+		default:
+			break;
+	}
+
+	return (!prototype->IsDupliGroup() && prototype->GetSGNode()->GetSGChildren().empty());
+}
+
+void KX_Scene::ReserveObjects(KX_GameObject *prototype, int count)
+{
+	BLI_assert(IsPoolableObject(prototype));
+
+	/* Move the already reserved replicas aside, otherwise AddReplicaObject()
+	 * would give them back instead of creating new ones. */
+	std::vector<KX_GameObject *> reserved;
+	reserved.swap(m_objectPools[prototype]);
+
+	/* All the replicas are created before any is recycled, a recycled replica
+	 * would be given back by the next AddReplicaObject(). */
+	std::vector<KX_GameObject *> replicas;
+	for (int i = reserved.size(); i < count; i++) {
+		replicas.push_back((KX_GameObject *)AddReplicaObject(prototype, NULL));
+	}
+
+	for (std::vector<KX_GameObject *>::iterator it = replicas.begin(), end = replicas.end(); it != end; ++it) {
+		KX_GameObject *replica = *it;
+		RecycleObject(replica);
+		// release here because AddReplicaObject AddRef's, the pool holds its own reference
+		replica->Release();
+	}
+
+	std::vector<KX_GameObject *>& pool = m_objectPools[prototype];
+	pool.insert(pool.end(), reserved.begin(), reserved.end());
+}
+
+KX_GameObject *KX_Scene::SpawnPooledObject(KX_GameObject *prototype, KX_GameObject *referenceobj, int lifespan)
+{
+	std::map<KX_GameObject *, std::vector<KX_GameObject *> >::iterator poolit = m_objectPools.find(prototype);
+	if (poolit == m_objectPools.end() || poolit->second.empty()) {
+		return NULL;
+	}
+
+	// the reference of the pool is given to the caller, like for a new replica
+	KX_GameObject *replica = poolit->second.back();
+	poolit->second.pop_back();
+
+	m_objectlist->Add(replica->AddRef());
+	InvalidateConcurrentUpdate();
+	AddDistanceScheduleObject(replica);
+	m_parentlist->Add(replica->AddRef());
+
+	/* Give back the properties, the visibility and the color of the prototype,
+	 * scripts could have changed them while the replica was in use. */
+	replica->ClearProperties();
+	std::vector<STR_String> propnames = prototype->GetPropertyNames();
+	for (std::vector<STR_String>::iterator it = propnames.begin(), end = propnames.end(); it != end; ++it) {
+		CValue *prop = prototype->GetProperty(*it)->GetReplica();
+		replica->SetProperty(*it, prop);
+		prop->Release();
+	}
+	replica->SetVisible(prototype->GetVisible(), false);
+	replica->SetObjectColor(prototype->GetObjectColor());
+
+	// the debug properties were removed by RecycleObject
+	if (KX_GetActiveEngine()->GetAutoAddDebugProperties()) {
+		AddObjectDebugProperties(replica);
+	}
+
+	if (lifespan > 0) {
+		m_tempObjectList->Add(replica->AddRef());
+		// see AddReplicaObject for the conversion from frames
+		CValue *fval = new CFloatValue(lifespan * 0.02f);
+		replica->SetProperty("::timebomb", fval);
+		fval->Release();
+	}
+
+	// start again from the transform of the prototype, as a new replica would
+	replica->NodeSetLocalPosition(prototype->NodeGetLocalPosition());
+	replica->NodeSetLocalOrientation(prototype->NodeGetLocalOrientation());
+	replica->NodeSetLocalScale(prototype->NodeGetLocalScaling());
+
+	if (referenceobj) {
+		replica->NodeSetLocalPosition(referenceobj->NodeGetWorldPosition());
+		replica->NodeSetLocalOrientation(referenceobj->NodeGetWorldOrientation());
+		replica->NodeSetRelativeScale(referenceobj->GetSGNode()->GetRootSGParent()->GetLocalScale());
+		replica->SetLayer(referenceobj->GetLayer());
+	}
+	else {
+		replica->SetLayer(m_blenderScene->lay);
+	}
+
+	replica->GetSGNode()->UpdateWorldData(0);
+	replica->ActivateGraphicController(false);
+
+	PHY_IPhysicsController *ctrl = replica->GetPhysicsController();
+	if (ctrl) {
+		ctrl->RestorePhysics();
+		if (ctrl->IsDynamic()) {
+			ctrl->SetLinearVelocity(MT_Vector3(0.0f, 0.0f, 0.0f), false);
+			ctrl->SetAngularVelocity(MT_Vector3(0.0f, 0.0f, 0.0f), false);
+		}
+	}
+
+	if (m_obstacleSimulation && prototype->GetBlenderObject()->gameflag & OB_HASOBSTACLE) {
+		m_obstacleSimulation->AddObstacleForObj(replica);
+	}
+
+	// links the sensors and actuators of the initial state again
+	replica->ResetState();
+
+	return replica;
+}
+
+/**
+ * Deactivate a pooled replica and give it back to its pool, return false if the
+ * object is not pooled or can't be recycled anymore and must be removed.
+ */
+bool KX_Scene::RecycleObject(KX_GameObject *gameobj)
+{
+	std::map<KX_GameObject *, KX_GameObject *>::iterator it = m_pooledObjects.find(gameobj);
+	if (it == m_pooledObjects.end()) {
+		return false;
+	}
+
+	// the object was parented or got children since it was spawned
+	SG_Node *node = gameobj->GetSGNode();
+	if (node->GetSGParent() || !node->GetSGChildren().empty()) {
+		return false;
+	}
+
+	m_objectPools[it->second].push_back((KX_GameObject *)gameobj->AddRef());
+
+	RemoveObjectDebugProperties(gameobj);
+	// same as NewRemoveObject, scripts must not use the object anymore
+	gameobj->InvalidateProxy();
+
+	// an empty state unlinks all the sensors and actuators from the logic managers
+	gameobj->SetState(0);
+	gameobj->RemoveProperty("::timebomb");
+
+	PHY_IPhysicsController *ctrl = gameobj->GetPhysicsController();
+	if (ctrl) {
+		ctrl->SuspendPhysics();
+	}
+	PHY_IGraphicController *graphicctrl = gameobj->GetGraphicController();
+	if (graphicctrl) {
+		graphicctrl->Activate(false);
+	}
+
+	if (m_obstacleSimulation) {
+		m_obstacleSimulation->DestroyObstacleForObj(gameobj);
+	}
+
+	// The cached shadow maps still draw a static caster, as for a removed object.
+	if (gameobj->IsStaticShadowCaster()) {
+		gameobj->InvalidateShadowCaches(false);
+	}
+
+	/* Only objects of m_objectlist are rendered. The object stays in m_animatedlist,
+	 * so that actions started before the removal continue. */
+	RemoveDistanceScheduleObject(gameobj);
+	if (m_objectlist->RemoveValue(gameobj))
+		gameobj->Release();
+	InvalidateConcurrentUpdate();
+	if (m_tempObjectList->RemoveValue(gameobj))
+		gameobj->Release();
+	if (m_parentlist->RemoveValue(gameobj))
+		gameobj->Release();
+
+	return true;
+}
+
+void KX_Scene::ClearObjectPools()
+{
+	for (std::map<KX_GameObject *, std::vector<KX_GameObject *> >::iterator it = m_objectPools.begin(),
+	     end = m_objectPools.end(); it != end; ++it)
+	{
+		// NewRemoveObject releases the reference of the pool
+		while (!it->second.empty()) {
+			RemoveObject(it->second.back());
+		}
+	}
+	m_objectPools.clear();
+	m_pooledObjects.clear();
+}
+
 
 
 void KX_Scene::RemoveObject(class CValue* gameobj)
@@ -1050,6 +1284,25 @@ int KX_Scene::NewRemoveObject(class CValue* gameobj)
 	int ret;
 	KX_GameObject* newobj = (KX_GameObject*) gameobj;
 
+	// the replicas of a removed prototype can't be spawned anymore
+	std::map<KX_GameObject *, std::vector<KX_GameObject *> >::iterator poolit = m_objectPools.find(newobj);
+	if (poolit != m_objectPools.end()) {
+		std::vector<KX_GameObject *>& pool = poolit->second;
+		while (!pool.empty()) {
+			RemoveObject(pool.back());
+		}
+		m_objectPools.erase(newobj);
+
+		for (std::map<KX_GameObject *, KX_GameObject *>::iterator it = m_pooledObjects.begin(); it != m_pooledObjects.end();) {
+			if (it->second == newobj) {
+				m_pooledObjects.erase(it++);
+			}
+			else {
+				++it;
+			}
+		}
+	}
+
 	/* remove property from debug list */
 	RemoveObjectDebugProperties(newobj);
 
@@ -1141,6 +1394,7 @@ int KX_Scene::NewRemoveObject(class CValue* gameobj)
 	ret = 1;
 	if (newobj->GetGameObjectType()==SCA_IObject::OBJ_LIGHT && m_lightlist->RemoveValue(newobj))
 		ret = newobj->Release();
+	RemoveDistanceScheduleObject(newobj);
 	if (m_objectlist->RemoveValue(newobj))
 		ret = newobj->Release();
 	if (m_tempObjectList->RemoveValue(newobj))
@@ -1149,11 +1403,24 @@ int KX_Scene::NewRemoveObject(class CValue* gameobj)
 		ret = newobj->Release();
 	if (m_inactivelist->RemoveValue(newobj))
 		ret = newobj->Release();
+	InvalidateConcurrentUpdate();
 	if (m_euthanasyobjects->RemoveValue(newobj))
 		ret = newobj->Release();
 	if (m_animatedlist->RemoveValue(newobj))
 		ret = newobj->Release();
 
+	std::map<KX_GameObject *, KX_GameObject *>::iterator pooledit = m_pooledObjects.find(newobj);
+	if (pooledit != m_pooledObjects.end()) {
+		std::vector<KX_GameObject *>& pool = m_objectPools[pooledit->second];
+		m_pooledObjects.erase(pooledit);
+
+		std::vector<KX_GameObject *>::iterator it = std::find(pool.begin(), pool.end(), newobj);
+		if (it != pool.end()) {
+			pool.erase(it);
+			ret = newobj->Release();
+		}
+	}
+
 	/* Warning 'newobj' maye be freed now, only compare, don't access */
 
 
@@ -1409,54 +1676,96 @@ void KX_Scene::SetCameraOnTop(KX_Camera* cam)
 	}
 }
 
-void KX_Scene::MarkVisible(RAS_IRasterizer* rasty, KX_GameObject* gameobj,KX_Camera*  cam,int layer)
+unsigned int KX_Scene::SetCullingBlocks(const std::vector<KX_GameObject *>& objects)
 {
-	// User (Python/Actuator) has forced object invisible...
-	if (!gameobj->GetSGNode() || !gameobj->GetVisible())
-		return;
-	
-	// Shadow lamp layers
-	if (layer && !(gameobj->GetLayer() & layer)) {
-		gameobj->SetCulled(true);
-		return;
+	// Gather the world bounds of all the objects in contiguous blocks, the last block is padded with empty bounds.
+	const unsigned int numObjects = objects.size();
+	const unsigned int numBlocks = (numObjects + FRUSTUM_CULL_BLOCK_SIZE - 1) / FRUSTUM_CULL_BLOCK_SIZE;
+	m_cullingBlocks.resize(numBlocks);
+
+	for (unsigned int i = 0; i < numBlocks * FRUSTUM_CULL_BLOCK_SIZE; ++i) {
+		float center[3] = {0.0f, 0.0f, 0.0f};
+		float axis[3][3] = {{0.0f}};
+
+		if (i < numObjects) {
+			SG_Node *node = objects[i]->GetSGNode();
+			const MT_Vector3 *worldAxis = node->GetWorldBoundsAxis();
+
+			node->GetWorldBoundsCenter().getValue(center);
+			for (unsigned short j = 0; j < 3; ++j) {
+				worldAxis[j].getValue(axis[j]);
+			}
+		}
+
+		BLI_frustum_cull_block_set(&m_cullingBlocks[i / FRUSTUM_CULL_BLOCK_SIZE], i % FRUSTUM_CULL_BLOCK_SIZE, center, axis);
 	}
 
-	// If Frustum culling is off, the object is always visible.
-	bool vis = !cam->GetFrustumCulling();
-	
-	// If the camera is inside this node, then the object is visible.
-	if (!vis)
-	{
-		vis = gameobj->GetSGNode()->inside( cam->GetCameraLocation() );
+	return numBlocks;
+}
+
+void KX_Scene::CullBlocks(KX_Camera *cam, const std::vector<KX_GameObject *>& objects, unsigned char *visible)
+{
+	// Test the objects bound sphere and then bound box against the view frustum, all at once.
+	float planes[6][4];
+	const MT_Vector4 *cplanes = cam->GetNormalizedClipPlanes();
+	for (unsigned short i = 0; i < 6; ++i) {
+		cplanes[i].getValue(planes[i]);
 	}
-		
-	// Test the object's bound sphere against the view frustum.
-	if (!vis)
-	{
-		SG_BBox &box = gameobj->GetSGNode()->BBox();
-		const MT_Vector3& scale = gameobj->NodeGetWorldScaling();
-		const MT_Scalar radius = fabs(scale[scale.closestAxis()] * box.GetRadius());
-		const MT_Vector3 center = gameobj->NodeGetWorldPosition() + (box.GetCenter() * scale) * gameobj->NodeGetWorldOrientation();
-		switch (cam->SphereInsideFrustum(center, radius))
-		{
-			case KX_Camera::INSIDE:
-				vis = true;
-				break;
-			case KX_Camera::OUTSIDE:
-				vis = false;
-				break;
-			case KX_Camera::INTERSECT:
-				// Test the object's bound box against the view frustum.
-				MT_Vector3 box[8];
-				gameobj->GetSGNode()->getBBox(box); 
-				vis = cam->BoxInsideFrustum(box) != KX_Camera::OUTSIDE;
-				break;
+
+	BLI_frustum_cull_blocks(planes, 6, &m_cullingBlocks[0], m_cullingBlocks.size(), visible, true);
+
+	const MT_Vector3 cameraLocation = cam->GetCameraLocation();
+	for (unsigned int i = 0, size = objects.size(); i < size; ++i) {
+		// If the camera is inside this node, then the object is visible.
+		if (!visible[i]) {
+			visible[i] = objects[i]->GetSGNode()->inside(cameraLocation);
 		}
 	}
+}
+
+void KX_Scene::MarkVisibleObjects(KX_Camera *cam, int layer)
+{
+	const bool frustumCulling = cam->GetFrustumCulling();
 
-	// Visibility/ non-visibility are marked
-	// elsewhere now.
-	gameobj->SetCulled(!vis);
+	m_cullingObjects.clear();
+
+	for (CListValue::iterator it = m_objectlist->GetBegin(), end = m_objectlist->GetEnd(); it != end; ++it) {
+		KX_GameObject *gameobj = static_cast<KX_GameObject *>(*it);
+
+		// User (Python/Actuator) has forced object invisible...
+		if (!gameobj->GetSGNode() || !gameobj->GetVisible()) {
+			continue;
+		}
+
+		// Shadow lamp layers
+		if (layer && !(gameobj->GetLayer() & layer)) {
+			gameobj->SetCulled(true);
+			continue;
+		}
+
+		// If Frustum culling is off, the object is always visible.
+		if (!frustumCulling) {
+			gameobj->SetCulled(false);
+			continue;
+		}
+
+		m_cullingObjects.push_back(gameobj);
+	}
+
+	const unsigned int numObjects = m_cullingObjects.size();
+	if (numObjects == 0) {
+		return;
+	}
+
+	const unsigned int numBlocks = SetCullingBlocks(m_cullingObjects);
+	m_cullingVisible.resize(numBlocks * FRUSTUM_CULL_BLOCK_SIZE);
+	CullBlocks(cam, m_cullingObjects, &m_cullingVisible[0]);
+
+	for (unsigned int i = 0; i < numObjects; ++i) {
+		// Visibility/ non-visibility are marked
+		// elsewhere now.
+		m_cullingObjects[i]->SetCulled(!m_cullingVisible[i]);
+	}
 }
 
 void KX_Scene::PhysicsCullingCallback(KX_ClientObjectInfo *objectInfo, void* cullingInfo)
@@ -1473,11 +1782,12 @@ void KX_Scene::PhysicsCullingCallback(KX_ClientObjectInfo *objectInfo, void* cul
 	gameobj->SetCulled(false);
 }
 
-void KX_Scene::CalculateVisibleMeshes(RAS_IRasterizer* rasty,KX_Camera* cam, int layer)
+void KX_Scene::UpdateObjectBounds()
 {
-	// Update the object boudning volume box if the object had a deformer.
-	for (int i = 0; i < m_objectlist->GetCount(); i++) {
-		KX_GameObject *gameobj = static_cast<KX_GameObject*>(m_objectlist->GetValue(i));
+	for (CListValue::iterator it = m_objectlist->GetBegin(), end = m_objectlist->GetEnd(); it != end; ++it) {
+		KX_GameObject *gameobj = static_cast<KX_GameObject *>(*it);
+
+		// Update the object boudning volume box if the object had a deformer.
 		if (gameobj->GetDeformer()) {
 			/** Update all the deformer, not only per material.
 			 * One of the side effect is to clear some flags about AABB calculation.
@@ -1487,50 +1797,183 @@ void KX_Scene::CalculateVisibleMeshes(RAS_IRasterizer* rasty,KX_Camera* cam, int
 		}
 		gameobj->UpdateBounds();
 	}
+}
+
+bool KX_Scene::DbvtCullingTest(KX_Camera *cam, int layer, const int *viewport)
+{
+	// test culling through Bullet
+	MT_Vector4 planes[6];
+	// get the clip planes
+	MT_Vector4* cplanes = cam->GetNormalizedClipPlanes();
+	// and convert
+	planes[0].setValue(cplanes[4].getValue());	// near
+	planes[1].setValue(cplanes[5].getValue());	// far
+	planes[2].setValue(cplanes[0].getValue());	// left
+	planes[3].setValue(cplanes[1].getValue());	// right
+	planes[4].setValue(cplanes[2].getValue());	// top
+	planes[5].setValue(cplanes[3].getValue());	// bottom
+	CullingInfo info(layer);
+
+	float mvmat[16] = {0};
+	cam->GetModelviewMatrix().getValue(mvmat);
+	float pmat[16] = {0};
+	cam->GetProjectionMatrix().getValue(pmat);
+
+	return m_physicsEnvironment->CullingTest(PhysicsCullingCallback,&info,planes,6,m_dbvt_occlusion_res,
+	                                         viewport, mvmat, pmat);
+}
+
+void KX_Scene::CalculateVisibleMeshes(RAS_IRasterizer* rasty,KX_Camera* cam, int layer)
+{
+	SG_PROFILE_ZONE("CalculateVisibleMeshes");
+
+	UpdateObjectBounds();
 
 	bool dbvt_culling = false;
-	if (m_dbvt_culling) 
-	{
+	if (m_dbvt_culling) {
 		/* Reset KX_GameObject m_bCulled to true before doing culling
 		 * since DBVT culling will only set it to false.
 		 * This is similar to what RAS_BucketManager does for RAS_MeshSlot culling.
 		 */
-		for (int i = 0; i < m_objectlist->GetCount(); i++) {
-			KX_GameObject *gameobj = static_cast<KX_GameObject*>(m_objectlist->GetValue(i));
-			gameobj->SetCulled(true);
+		for (CListValue::iterator it = m_objectlist->GetBegin(), end = m_objectlist->GetEnd(); it != end; ++it) {
+			static_cast<KX_GameObject *>(*it)->SetCulled(true);
 		}
 
-		// test culling through Bullet
-		MT_Vector4 planes[6];
-		// get the clip planes
-		MT_Vector4* cplanes = cam->GetNormalizedClipPlanes();
-		// and convert
-		planes[0].setValue(cplanes[4].getValue());	// near
-		planes[1].setValue(cplanes[5].getValue());	// far
-		planes[2].setValue(cplanes[0].getValue());	// left
-		planes[3].setValue(cplanes[1].getValue());	// right
-		planes[4].setValue(cplanes[2].getValue());	// top
-		planes[5].setValue(cplanes[3].getValue());	// bottom
-		CullingInfo info(layer);
-
-		float mvmat[16] = {0};
-		cam->GetModelviewMatrix().getValue(mvmat);
-		float pmat[16] = {0};
-		cam->GetProjectionMatrix().getValue(pmat);
-
-		dbvt_culling = m_physicsEnvironment->CullingTest(PhysicsCullingCallback,&info,planes,6,m_dbvt_occlusion_res,
-		                                                 KX_GetActiveEngine()->GetCanvas()->GetViewPort(),
-		                                                 mvmat, pmat);
+		dbvt_culling = DbvtCullingTest(cam, layer, KX_GetActiveEngine()->GetCanvas()->GetViewPort());
 	}
 	if (!dbvt_culling) {
 		// the physics engine couldn't help us, do it the hard way
-		for (int i = 0; i < m_objectlist->GetCount(); i++)
-		{
-			MarkVisible(rasty, static_cast<KX_GameObject*>(m_objectlist->GetValue(i)), cam, layer);
+		MarkVisibleObjects(cam, layer);
+	}
+}
+
+void KX_Scene::CalculateShadowVisibleMeshes(const std::vector<KX_LightObject *>& lights)
+{
+	SG_PROFILE_ZONE("CalculateShadowVisibleMeshes");
+
+	UpdateObjectBounds();
+
+	m_shadowObjects.clear();
+	for (CListValue::iterator it = m_objectlist->GetBegin(), end = m_objectlist->GetEnd(); it != end; ++it) {
+		KX_GameObject *gameobj = static_cast<KX_GameObject *>(*it);
+		// The objects forced invisible are never drawn, their culled flag is unused.
+		if (gameobj->GetSGNode() && gameobj->GetVisible()) {
+			m_shadowObjects.push_back(gameobj);
+		}
+	}
+
+	const unsigned int numObjects = m_shadowObjects.size();
+	if (numObjects == 0) {
+		m_shadowVisible.clear();
+		return;
+	}
+
+	// The bounds are gathered once, each light writes a row of visibility padded to the blocks size.
+	bool blocksSet = false;
+	const unsigned int stride = ((numObjects + FRUSTUM_CULL_BLOCK_SIZE - 1) / FRUSTUM_CULL_BLOCK_SIZE) * FRUSTUM_CULL_BLOCK_SIZE;
+	m_shadowVisible.resize(stride * lights.size());
+
+	// The shadow buffers are square, only the ratio of the occlusion buffer viewport matters.
+	const int viewport[4] = {0, 0, 1, 1};
+
+	for (unsigned int i = 0, size = lights.size(); i < size; ++i) {
+		KX_Camera *cam = lights[i]->GetShadowCamera();
+		const int layer = lights[i]->GetLightData()->GetShadowLayer();
+		unsigned char *visible = &m_shadowVisible[i * stride];
+
+		bool dbvt_culling = false;
+		if (m_dbvt_culling) {
+			for (unsigned int j = 0; j < numObjects; ++j) {
+				m_shadowObjects[j]->SetCulled(true);
+			}
+			dbvt_culling = DbvtCullingTest(cam, layer, viewport);
+			if (dbvt_culling) {
+				for (unsigned int j = 0; j < numObjects; ++j) {
+					visible[j] = !m_shadowObjects[j]->GetCulled();
+				}
+			}
+		}
+		if (!dbvt_culling) {
+			if (!blocksSet) {
+				SetCullingBlocks(m_shadowObjects);
+				blocksSet = true;
+			}
+			CullBlocks(cam, m_shadowObjects, visible);
+
+			// Shadow lamp layers
+			if (layer) {
+				for (unsigned int j = 0; j < numObjects; ++j) {
+					if (!(m_shadowObjects[j]->GetLayer() & layer)) {
+						visible[j] = false;
+					}
+				}
+			}
+		}
+	}
+
+	// The animations are updated for the objects seen by any light.
+	for (unsigned int j = 0; j < numObjects; ++j) {
+		bool vis = false;
+		for (unsigned int i = 0, size = lights.size(); i < size && !vis; ++i) {
+			vis = m_shadowVisible[i * stride + j];
 		}
+		m_shadowObjects[j]->SetCulled(!vis);
 	}
 }
 
+void KX_Scene::SetShadowCulling(unsigned int index, ShadowCasters casters)
+{
+	const unsigned int numObjects = m_shadowObjects.size();
+	const unsigned int stride = ((numObjects + FRUSTUM_CULL_BLOCK_SIZE - 1) / FRUSTUM_CULL_BLOCK_SIZE) * FRUSTUM_CULL_BLOCK_SIZE;
+	const unsigned char *visible = &m_shadowVisible[index * stride];
+	bool newStaticCaster = false;
+
+	for (unsigned int j = 0; j < numObjects; ++j) {
+		KX_GameObject *gameobj = m_shadowObjects[j];
+		bool vis = visible[j];
+
+		if (vis) {
+			switch (casters) {
+				case SHADOW_CASTERS_ALL:
+				{
+					break;
+				}
+				case SHADOW_CASTERS_STATIC:
+				{
+					vis = !gameobj->IsDynamicShadowCaster();
+					if (vis && !gameobj->IsStaticShadowCaster()) {
+						gameobj->SetStaticShadowCaster(true);
+						newStaticCaster = true;
+					}
+					break;
+				}
+				case SHADOW_CASTERS_DYNAMIC:
+				{
+					vis = !gameobj->IsStaticShadowCaster();
+					break;
+				}
+			}
+		}
+
+		gameobj->SetCulled(!vis);
+	}
+
+	// The caches of the other lights miss the new static casters.
+	if (newStaticCaster) {
+		InvalidateShadowCaches();
+	}
+}
+
+unsigned int KX_Scene::GetShadowCacheVersion() const
+{
+	return m_shadowCacheVersion;
+}
+
+void KX_Scene::InvalidateShadowCaches()
+{
+	++m_shadowCacheVersion;
+}
+
 void KX_Scene::DrawDebug(RAS_IRasterizer *rasty)
 {
 	const bool showBoundingBox = KX_GetActiveEngine()->GetShowBoundingBox();
@@ -1561,6 +2004,8 @@ void KX_Scene::DrawDebug(RAS_IRasterizer *rasty)
 // logic stuff
 void KX_Scene::LogicBeginFrame(double curtime)
 {
+	SG_PROFILE_ZONE("LogicBeginFrame");
+
 	// have a look at temp objects ...
 	int lastobj = m_tempObjectList->GetCount() - 1;
 	
@@ -1597,89 +2042,175 @@ void KX_Scene::AddAnimatedObject(CValue* gameobj)
 	m_animatedlist->Add(gameobj);
 }
 
-static void update_anim_thread_func(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+/// Node of the animation frame graph for an animated object, see KX_Scene::UpdateAnimations.
+struct AnimationNode
 {
-	KX_GameObject *gameobj, *child, *parent;
-	CListValue *children;
-	bool needs_update;
-	double curtime = *(double*)BLI_task_pool_userdata(pool);
-
-	gameobj = (KX_GameObject*)taskdata;
+	KX_GameObject *m_gameobj;
+	/// Set by the pose task when the actions of the object were updated.
+	bool m_updated;
+};
 
+static bool anim_needs_update(KX_GameObject *gameobj)
+{
 	// Non-armature updates are fast enough, so just update them
-	needs_update = gameobj->GetGameObjectType() != SCA_IObject::OBJ_ARMATURE;
+	if (gameobj->GetGameObjectType() != SCA_IObject::OBJ_ARMATURE) {
+		return true;
+	}
 
-	if (!needs_update) {
-		// If we got here, we're looking to update an armature, so check its children meshes
-		// to see if we need to bother with a more expensive pose update
-		children = gameobj->GetChildren();
+	// If we got here, we're looking to update an armature, so check its children meshes
+	// to see if we need to bother with a more expensive pose update
+	CListValue *children = gameobj->GetChildren();
 
-		bool has_mesh = false, has_non_mesh = false;
+	bool needs_update = false;
+	bool has_mesh = false, has_non_mesh = false;
 
-		// Check for meshes that haven't been culled
-		for (int j=0; j<children->GetCount(); ++j) {
-			child = (KX_GameObject*)children->GetValue(j);
+	// Check for meshes that haven't been culled
+	for (int j=0; j<children->GetCount(); ++j) {
+		KX_GameObject *child = (KX_GameObject*)children->GetValue(j);
+
+		if (!child->GetCulled()) {
+			needs_update = true;
+			break;
+		}
+
+		if (child->GetMeshCount() == 0)
+			has_non_mesh = true;
+		else
+			has_mesh = true;
+	}
+
+	// If we didn't find a non-culled mesh, check to see
+	// if we even have any meshes, and update if this
+	// armature has only non-mesh children.
+	if (!needs_update && !has_mesh && has_non_mesh)
+		needs_update = true;
+
+	children->Release();
 
-			if (!child->GetCulled()) {
-				needs_update = true;
+	return needs_update;
+}
+
+/// Pose task: update the actions of an object, evaluate its IPO curves and its armature pose.
+static void update_anim_pose_thread_func(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	double curtime = *(double*)BLI_task_pool_userdata(pool);
+	AnimationNode *node = (AnimationNode *)taskdata;
+	KX_GameObject *gameobj = node->m_gameobj;
+
+	SG_PROFILE_ZONE("UpdateAnimationPose");
+
+	if (!anim_needs_update(gameobj)) {
+		return;
+	}
+
+	gameobj->UpdateActionManager(curtime);
+	gameobj->EvaluateActionIPOs();
+
+	if (gameobj->GetGameObjectType() == SCA_IObject::OBJ_ARMATURE) {
+		CListValue *children = gameobj->GetChildren();
+		for (int j=0; j<children->GetCount(); ++j) {
+			if (((KX_GameObject*)children->GetValue(j))->GetDeformer()) {
+				/* Evaluate the pose once here, the skinning tasks of the children
+				 * then only apply the evaluated pose. */
+				BL_ArmatureObject *armature = (BL_ArmatureObject *)gameobj;
+				armature->ApplyPose();
+				armature->RestorePose();
 				break;
 			}
-
-			if (child->GetMeshCount() == 0)
-				has_non_mesh = true;
-			else
-				has_mesh = true;
 		}
+		children->Release();
+	}
 
-		// If we didn't find a non-culled mesh, check to see
-		// if we even have any meshes, and update if this
-		// armature has only non-mesh children.
-		if (!needs_update && !has_mesh && has_non_mesh)
-			needs_update = true;
+	node->m_updated = true;
+}
 
-		children->Release();
+/// Deformer task: shape keys blending and skinning of one mesh.
+static void update_anim_deformer_thread_func(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	SG_PROFILE_ZONE("UpdateAnimationDeformer");
+
+	((RAS_Deformer *)taskdata)->Update();
+}
+
+void KX_Scene::UpdateAnimations(double curtime)
+{
+	SG_PROFILE_ZONE("UpdateAnimations");
+
+	/* The animations are updated in a small frame graph of three stages, each stage
+	 * depends on the previous one:
+	 * - Pose: one task per animated object, the actions update the armature poses and the
+	 *   shape keys coefficients. The IPO curves are evaluated and the armature poses too.
+	 * - Deform: one task per deformer of the updated objects, the child meshes of an armature
+	 *   are skinned concurrently. The shape keys are blended in the same task before the skinning
+	 *   as both write in the vertices of the mesh.
+	 * - IPO: the evaluated IPO curves are applied to the scene graph in the main thread, the node
+	 *   updates call the physics and graphic controllers which are not thread-safe.
+	 */
+	const unsigned int count = m_animatedlist->GetCount();
+	std::vector<AnimationNode> nodes(count);
+
+	TaskScheduler *scheduler = KX_GetActiveEngine()->GetTaskScheduler();
+	TaskPool *pool = BLI_task_pool_create(scheduler, &curtime);
+
+	for (unsigned int i = 0; i < count; ++i) {
+		AnimationNode& node = nodes[i];
+		node.m_gameobj = (KX_GameObject *)m_animatedlist->GetValue(i);
+		node.m_updated = false;
+		BLI_task_pool_push(pool, update_anim_pose_thread_func, &node, false, TASK_PRIORITY_LOW);
 	}
 
-	if (needs_update) {
-		gameobj->UpdateActionManager(curtime);
-		children = gameobj->GetChildren();
-		parent = gameobj->GetParent();
+	BLI_task_pool_work_and_wait(pool);
+
+	std::vector<RAS_Deformer *> deformers;
+	for (unsigned int i = 0; i < count; ++i) {
+		if (!nodes[i].m_updated) {
+			continue;
+		}
+
+		KX_GameObject *gameobj = nodes[i].m_gameobj;
+		KX_GameObject *parent = gameobj->GetParent();
 
 		// Only do deformers here if they are not parented to an armature, otherwise the armature will
 		// handle updating its children
-		if (gameobj->GetDeformer() && (!parent || (parent && parent->GetGameObjectType() != SCA_IObject::OBJ_ARMATURE)))
-			gameobj->GetDeformer()->Update();
+		if (gameobj->GetDeformer() && (!parent || parent->GetGameObjectType() != SCA_IObject::OBJ_ARMATURE)) {
+			deformers.push_back(gameobj->GetDeformer());
+		}
 
+		CListValue *children = gameobj->GetChildren();
 		for (int j=0; j<children->GetCount(); ++j) {
-			child = (KX_GameObject*)children->GetValue(j);
+			KX_GameObject *child = (KX_GameObject*)children->GetValue(j);
 
 			if (child->GetDeformer()) {
-				child->GetDeformer()->Update();
+				deformers.push_back(child->GetDeformer());
 			}
 		}
-
 		children->Release();
 	}
-}
 
-void KX_Scene::UpdateAnimations(double curtime)
-{
-	TaskPool *pool = BLI_task_pool_create(KX_GetActiveEngine()->GetTaskScheduler(), &curtime);
+	// A deformer can be reached from its object and from its parent, update it only once.
+	std::sort(deformers.begin(), deformers.end());
+	deformers.erase(std::unique(deformers.begin(), deformers.end()), deformers.end());
 
-	for (int i=0; i<m_animatedlist->GetCount(); ++i) {
-		BLI_task_pool_push(pool, update_anim_thread_func, m_animatedlist->GetValue(i), false, TASK_PRIORITY_LOW);
+	for (std::vector<RAS_Deformer *>::iterator it = deformers.begin(), end = deformers.end(); it != end; ++it) {
+		BLI_task_pool_push(pool, update_anim_deformer_thread_func, *it, false, TASK_PRIORITY_LOW);
 	}
 
 	BLI_task_pool_work_and_wait(pool);
 	BLI_task_pool_free(pool);
 
-	for (unsigned int i = 0; i < m_animatedlist->GetCount(); ++i) {
-		((KX_GameObject *)m_animatedlist->GetValue(i))->UpdateActionIPOs();
+	{
+		SG_PROFILE_ZONE("UpdateAnimationIPOs");
+
+		for (unsigned int i = 0; i < count; ++i) {
+			nodes[i].m_gameobj->UpdateActionIPOs();
+		}
 	}
 }
 
 void KX_Scene::LogicUpdateFrame(double curtime, bool frame)
 {
+	SG_PROFILE_ZONE("LogicUpdateFrame");
+
 	// Update object components
 	for (int i = 0; i < m_objectlist->GetCount(); ++i) {
 		((KX_GameObject*)m_objectlist->GetValue(i))->UpdateComponents();
@@ -1689,6 +2220,8 @@ void KX_Scene::LogicUpdateFrame(double curtime, bool frame)
 
 void KX_Scene::LogicEndFrame()
 {
+	SG_PROFILE_ZONE("LogicEndFrame");
+
 	m_logicmgr->EndFrame();
 	int numobj;
 
@@ -1700,7 +2233,9 @@ void KX_Scene::LogicEndFrame()
 		obj = (KX_GameObject*)m_euthanasyobjects->GetValue(numobj-1);
 		m_euthanasyobjects->Remove(numobj-1);
 		obj->Release();
-		RemoveObject(obj);
+		if (!RecycleObject(obj)) {
+			RemoveObject(obj);
+		}
 	}
 
 	//prepare obstacle simulation for new frame
@@ -1768,24 +2303,69 @@ void KX_Scene::RenderFonts()
 	}
 }
 
+/** Reduce the margin of an update by the float precision of the distances,
+ * to update again the objects near a boundary.
+ */
+static float scene_schedule_margin(float margin, float distance)
+{
+	return std::max(margin - (distance + 1.0f) * 1.0e-5f, 0.0f);
+}
+
+static float scene_update_lod(KX_GameObject *gameobj, const MT_Vector3& campos, void *UNUSED(userdata))
+{
+	const float margin = gameobj->UpdateLodLevel(campos);
+	if (margin == FLT_MAX) {
+		return margin;
+	}
+	return scene_schedule_margin(margin, gameobj->NodeGetWorldPosition().distance(campos));
+}
+
 void KX_Scene::UpdateObjectLods()
 {
 	if (!m_active_camera)
 		return;
 
-	const MT_Vector3& cam_pos = m_active_camera->NodeGetWorldPosition();
+	SyncDistanceSchedule(m_lodSchedule);
+
+	/* The dupli group instances are objects of the object list, they are updated
+	 * by the schedule and not by their group object like in KX_GameObject::UpdateLod. */
+	m_lodSchedule.Update(m_active_camera->NodeGetWorldPosition(), scene_update_lod, NULL);
+}
+
+void KX_Scene::SyncDistanceSchedule(KX_DistanceSchedule& schedule)
+{
+	// All the removals of the object list remove the object from the schedules.
+	if (schedule.GetCount() == m_objectlist->GetCount()) {
+		return;
+	}
 
 	for (CListValue::iterator it = m_objectlist->GetBegin(), end = m_objectlist->GetEnd(); it != end; ++it) {
-		KX_GameObject *gameobj = (KX_GameObject *)*it;
-		if (!gameobj->GetCulled()) {
-			gameobj->UpdateLod(cam_pos);
-		}
+		schedule.AddObject((KX_GameObject *)*it);
 	}
 }
 
+void KX_Scene::AddDistanceScheduleObject(KX_GameObject *gameobj)
+{
+	m_activitySchedule.AddObject(gameobj);
+	m_lodSchedule.AddObject(gameobj);
+}
+
+void KX_Scene::RemoveDistanceScheduleObject(KX_GameObject *gameobj)
+{
+	m_activitySchedule.RemoveObject(gameobj);
+	m_lodSchedule.RemoveObject(gameobj);
+}
+
+void KX_Scene::ObjectMoved(KX_GameObject *gameobj)
+{
+	m_activitySchedule.ObjectMoved(gameobj);
+	m_lodSchedule.ObjectMoved(gameobj);
+}
+
 void KX_Scene::SetLodHysteresis(bool active)
 {
 	m_isActivedHysteresis = active;
+	m_lodSchedule.Invalidate();
 }
 
 bool KX_Scene::IsActivedLodHysteresis(void)
@@ -1796,6 +2376,7 @@ bool KX_Scene::IsActivedLodHysteresis(void)
 void KX_Scene::SetLodHysteresisValue(int hysteresisvalue)
 {
 	m_lodHysteresisValue = hysteresisvalue;
+	m_lodSchedule.Invalidate();
 }
 
 int KX_Scene::GetLodHysteresisValue(void)
@@ -1803,35 +2384,114 @@ int KX_Scene::GetLodHysteresisValue(void)
 	return m_lodHysteresisValue;
 }
 
+static float scene_update_activity(KX_GameObject *gameobj, const MT_Vector3& campos, void *userdata)
+{
+	if (gameobj->GetIgnoreActivityCulling()) {
+		return FLT_MAX;
+	}
+
+	const float radius = *(float *)userdata;
+	/* Simple test: more than the radius away from the camera, count
+	 * Manhattan distance. */
+	const MT_Vector3& obpos = gameobj->NodeGetWorldPosition();
+	const float distance = std::max(std::max(fabsf(campos[0] - obpos[0]), fabsf(campos[1] - obpos[1])),
+	                                fabsf(campos[2] - obpos[2]));
+
+	// Suspend and Resume do nothing if the activity didn't change.
+	if (distance > radius) {
+		gameobj->Suspend();
+	}
+	else {
+		gameobj->Resume();
+	}
+
+	// The distance changes at most as fast as the euclidean distance travelled.
+	return scene_schedule_margin(fabsf(distance - radius), distance);
+}
+
 void KX_Scene::UpdateObjectActivity(void) 
 {
 	if (m_activity_culling) {
-		/* determine the activity criterium and set objects accordingly */
-		int i=0;
-		
-		MT_Vector3 camloc = GetActiveCamera()->NodeGetWorldPosition(); //GetCameraLocation();
-		
-		for (i=0;i<GetObjectList()->GetCount();i++)
-		{
-			KX_GameObject* ob = (KX_GameObject*) GetObjectList()->GetValue(i);
-			
-			if (!ob->GetIgnoreActivityCulling()) {
-				/* Simple test: more than 10 away from the camera, count
-				 * Manhattan distance. */
-				MT_Vector3 obpos = ob->NodeGetWorldPosition();
-				
-				if ((fabsf(camloc[0] - obpos[0]) > m_activity_box_radius) ||
-				    (fabsf(camloc[1] - obpos[1]) > m_activity_box_radius) ||
-				    (fabsf(camloc[2] - obpos[2]) > m_activity_box_radius) )
-				{
-					ob->Suspend();
-				}
-				else {
-					ob->Resume();
-				}
+		/* determine the activity criterium and set objects accordingly,
+		 * only the objects that could cross the box boundary are updated */
+		if (m_activity_box_radius != m_activityScheduleRadius) {
+			m_activityScheduleRadius = m_activity_box_radius;
+			m_activitySchedule.Invalidate();
+		}
+
+		SyncDistanceSchedule(m_activitySchedule);
+
+		m_activitySchedule.Update(GetActiveCamera()->NodeGetWorldPosition(), scene_update_activity, &m_activityScheduleRadius);
+	}
+}
+
+void KX_Scene::AddSceneRequest(KX_SceneRequest::Mode mode, const STR_String& name, const STR_String& newname)
+{
+	KX_SceneRequest request;
+	request.m_mode = mode;
+	request.m_name = name;
+	request.m_newName = newname;
+	m_sceneRequests.push_back(request);
+}
+
+std::vector<KX_SceneRequest>& KX_Scene::GetSceneRequests()
+{
+	return m_sceneRequests;
+}
+
+#ifdef WITH_PYTHON
+static bool object_use_python(KX_GameObject *gameobj)
+{
+	// Python proxies are freed with the object, which requires the GIL.
+	if (gameobj->m_proxy || gameobj->m_collisionCallbacks) {
+		return true;
+	}
+
+	CListValue *components = gameobj->GetComponents();
+	if (components && components->GetCount() > 0) {
+		return true;
+	}
+
+	SCA_ControllerList& controllers = gameobj->GetControllers();
+	for (SCA_ControllerList::iterator it = controllers.begin(), end = controllers.end(); it != end; ++it) {
+		if (dynamic_cast<SCA_PythonController *>(*it)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+#endif  // WITH_PYTHON
+
+bool KX_Scene::CanUpdateConcurrently()
+{
+	if (!m_concurrentUpdateDirty) {
+		return m_canUpdateConcurrently;
+	}
+
+	m_concurrentUpdateDirty = false;
+	m_canUpdateConcurrently = true;
+
+#ifdef WITH_PYTHON
+	// Inactive objects are checked too as they can be added during the logic frame.
+	CListValue *lists[] = {m_objectlist, m_inactivelist};
+	for (unsigned short i = 0; i < ARRAY_SIZE(lists); ++i) {
+		CListValue *list = lists[i];
+		for (CListValue::iterator it = list->GetBegin(), end = list->GetEnd(); it != end; ++it) {
+			if (object_use_python((KX_GameObject *)*it)) {
+				m_canUpdateConcurrently = false;
+				return false;
 			}
 		}
 	}
+#endif  // WITH_PYTHON
+
+	return true;
+}
+
+void KX_Scene::InvalidateConcurrentUpdate()
+{
+	m_concurrentUpdateDirty = true;
 }
 
 void KX_Scene::SetActivityCullingRadius(float f)
@@ -2081,12 +2741,21 @@ bool KX_Scene::MergeScene(KX_Scene *other)
 	GetTempObjectList()->MergeList(other->GetTempObjectList());
 	other->GetTempObjectList()->ReleaseAndRemoveAll();
 
+	// The objects are scheduled by this scene now.
+	other->m_activitySchedule.Clear();
+	other->m_lodSchedule.Clear();
+	for (CListValue::iterator it = other->GetObjectList()->GetBegin(), end = other->GetObjectList()->GetEnd(); it != end; ++it) {
+		AddDistanceScheduleObject((KX_GameObject *)*it);
+	}
+
 	GetObjectList()->MergeList(other->GetObjectList());
 	other->GetObjectList()->ReleaseAndRemoveAll();
 
 	GetInactiveList()->MergeList(other->GetInactiveList());
 	other->GetInactiveList()->ReleaseAndRemoveAll();
 
+	InvalidateConcurrentUpdate();
+
 	GetRootParentList()->MergeList(other->GetRootParentList());
 	other->GetRootParentList()->ReleaseAndRemoveAll();
 
@@ -2181,6 +2850,7 @@ PyTypeObject KX_Scene::Type = {
 
 PyMethodDef KX_Scene::Methods[] = {
 	KX_PYMETHODTABLE(KX_Scene, addObject),
+	KX_PYMETHODTABLE(KX_Scene, reserveObjects),
 	KX_PYMETHODTABLE(KX_Scene, end),
 	KX_PYMETHODTABLE(KX_Scene, restart),
 	KX_PYMETHODTABLE(KX_Scene, replace),
@@ -2538,6 +3208,38 @@ KX_PYMETHODDEF_DOC(KX_Scene, addObject,
 	return replica->GetProxy();
 }
 
+KX_PYMETHODDEF_DOC(KX_Scene, reserveObjects,
+"reserveObjects(object, count)\n"
+"Prepares count deactivated instances of object, reused by addObject.\n")
+{
+	PyObject *pyob;
+	KX_GameObject *ob;
+	int count;
+
+	if (!PyArg_ParseTuple(args, "Oi:reserveObjects", &pyob, &count))
+		return NULL;
+
+	if (!ConvertPythonToGameObject(m_logicmgr, pyob, &ob, false, "scene.reserveObjects(object, count): KX_Scene (first argument)"))
+		return NULL;
+
+	if (!m_inactivelist->SearchValue(ob)) {
+		PyErr_Format(PyExc_ValueError, "scene.reserveObjects(object, count): KX_Scene (first argument): object must be in an inactive layer");
+		return NULL;
+	}
+	if (!IsPoolableObject(ob)) {
+		PyErr_Format(PyExc_ValueError, "scene.reserveObjects(object, count): KX_Scene (first argument): object can't have children, a dupli group or be a camera, a light or a text");
+		return NULL;
+	}
+	if (count < 0) {
+		PyErr_Format(PyExc_ValueError, "scene.reserveObjects(object, count): KX_Scene (second argument): count must be positive");
+		return NULL;
+	}
+
+	ReserveObjects(ob, count);
+
+	Py_RETURN_NONE;
+}
+
 KX_PYMETHODDEF_DOC(KX_Scene, end,
 "end()\n"
 "Removes this scene from the game.\n")
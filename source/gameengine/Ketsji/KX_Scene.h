@@ -38,6 +38,7 @@
 #include <vector>
 #include <set>
 #include <list>
+#include <map>
 
 #include "SG_IObject.h"
 #include "SCA_IScene.h"
@@ -50,6 +51,10 @@
 #include "EXP_PyObjectPlus.h"
 #include "EXP_Value.h"
 
+#include "BLI_frustum_cull.h"
+
+#include "KX_DistanceSchedule.h"
+
 /**
  * \section Forward declarations
  */
@@ -92,6 +97,28 @@ class KX_ObstacleSimulation;
 /* for ID freeing */
 #define IS_TAGGED(_id) ((_id) && (((ID *)_id)->tag & LIB_TAG_DOIT))
 
+/**
+ * Scene management request emitted by the logic of a scene,
+ * handed to the engine at the end of the scene logic frame.
+ */
+struct KX_SceneRequest
+{
+	enum Mode {
+		ADD_OVERLAY = 0,
+		ADD_BACKGROUND,
+		REMOVE,
+		REPLACE,
+		SUSPEND,
+		RESUME
+	};
+
+	Mode m_mode;
+	/// Name of the scene to add, remove, replace, suspend or resume.
+	STR_String m_name;
+	/// Name of the new scene, only used by REPLACE.
+	STR_String m_newName;
+};
+
 /**
  * The KX_Scene holds all data for an independent scene. It relates
  * KX_Objects to the specific objects in the modules.
@@ -172,6 +199,9 @@ protected:
 	 * The name of the scene
 	 */
 	STR_String	m_sceneName;
+
+	/// The scene name used by the profiler zones.
+	const char *m_profileName;
 	
 	/**
 	 * stores the world-settings for a scene
@@ -257,12 +287,36 @@ protected:
 	 * Toggle to enable or disable culling via DBVT broadphase of Bullet.
 	 */
 	bool m_dbvt_culling;
+
+	/**
+	 * Cached result of CanUpdateConcurrently, recomputed only when
+	 * m_concurrentUpdateDirty is set by InvalidateConcurrentUpdate.
+	 */
+	bool m_canUpdateConcurrently;
+	bool m_concurrentUpdateDirty;
 	
 	/**
 	 * Occlusion culling resolution
 	 */ 
 	int m_dbvt_occlusion_res;
 
+	/**
+	 * Objects tested by the frustum culling when DBVT culling is not used,
+	 * with their world bounds and the culling result, see MarkVisibleObjects().
+	 */
+	std::vector<KX_GameObject *> m_cullingObjects;
+	std::vector<FrustumCullBlock> m_cullingBlocks;
+	std::vector<unsigned char> m_cullingVisible;
+
+	/**
+	 * Objects culled for the shadow lights and their visibility from each light,
+	 * one row padded to the culling blocks per light, see CalculateShadowVisibleMeshes().
+	 */
+	std::vector<KX_GameObject *> m_shadowObjects;
+	std::vector<unsigned char> m_shadowVisible;
+	/// Incremented when the static shadow casters change, the shadow caches of an older version are drawn again.
+	unsigned int m_shadowCacheVersion;
+
 	/**
 	 * The framing settings used by this scene
 	 */
@@ -278,7 +332,15 @@ protected:
 	/**
 	 * Visibility testing functions.
 	 */
-	void MarkVisible(RAS_IRasterizer* rasty, KX_GameObject* gameobj, KX_Camera*cam, int layer=0);
+	void MarkVisibleObjects(KX_Camera *cam, int layer=0);
+	/// Set the culling blocks to the world bounds of objects, return the number of blocks.
+	unsigned int SetCullingBlocks(const std::vector<KX_GameObject *>& objects);
+	/// Test the culling blocks of objects against the frustum of cam, one visibility per object.
+	void CullBlocks(KX_Camera *cam, const std::vector<KX_GameObject *>& objects, unsigned char *visible);
+	/// Mark the objects visible from cam through the physics culling tree, return false if not supported.
+	bool DbvtCullingTest(KX_Camera *cam, int layer, const int *viewport);
+	/// Update the bounds of the deformed objects and of the objects with an automatic bounds update.
+	void UpdateObjectBounds();
 	static void PhysicsCullingCallback(KX_ClientObjectInfo* objectInfo, void* cullingInfo);
 
 	double				m_suspendedtime;
@@ -296,6 +358,34 @@ protected:
 	bool m_isActivedHysteresis;
 	int m_lodHysteresisValue;
 
+	/**
+	 * Objects of m_objectlist scheduled for the activity culling and the levels
+	 * of detail, only the objects crossing a boundary are updated each frame.
+	 */
+	KX_DistanceSchedule m_activitySchedule;
+	KX_DistanceSchedule m_lodSchedule;
+	/// Activity box radius used for the margins of m_activitySchedule.
+	float m_activityScheduleRadius;
+
+	/**
+	 * Scene management requests emitted during the current logic frame, see
+	 * KX_KetsjiEngine::FlushSceneRequests.
+	 */
+	std::vector<KX_SceneRequest> m_sceneRequests;
+
+	/**
+	 * Object pools, see ReserveObjects(). For each pooled prototype (an object of
+	 * an inactive layer) the list of its deactivated replicas, a reference is kept
+	 * on each of them.
+	 */
+	std::map<KX_GameObject *, std::vector<KX_GameObject *> > m_objectPools;
+	/// All the replicas owned by a pool, active or not, with their prototype.
+	std::map<KX_GameObject *, KX_GameObject *> m_pooledObjects;
+
+	KX_GameObject *SpawnPooledObject(KX_GameObject *prototype, KX_GameObject *referenceobj, int lifespan);
+	bool RecycleObject(KX_GameObject *gameobj);
+	void ClearObjectPools();
+
 public:
 	KX_Scene(class SCA_IInputDevice* keyboarddevice,
 		class SCA_IInputDevice* mousedevice,
@@ -342,6 +432,20 @@ public:
 
 	void AddAnimatedObject(CValue* gameobj);
 
+	/**
+	 * Return true if replicas of \a prototype can be pooled: an object without children
+	 * nor dupli group, which is not a camera, a light or a text.
+	 */
+	bool IsPoolableObject(KX_GameObject *prototype);
+	/**
+	 * Make sure that \a count deactivated replicas of \a prototype are ready to be used.
+	 * From now on AddReplicaObject() reuses them instead of replicating \a prototype and
+	 * its removed replicas are deactivated and given back to the pool instead of being freed.
+	 * A reused replica gets the transform, the properties, the visibility, the color and the
+	 * initial state of \a prototype again.
+	 */
+	void ReserveObjects(KX_GameObject *prototype, int count);
+
 	/**
 	 * \section Logic stuff
 	 * Initiate an update of the logic system.
@@ -527,6 +631,29 @@ public:
 	void SetWorldInfo(class KX_WorldInfo* wi);
 	KX_WorldInfo* GetWorldInfo();
 	void CalculateVisibleMeshes(RAS_IRasterizer* rasty, KX_Camera *cam, int layer=0);
+
+	/// Casters drawn in a shadow render, see SetShadowCulling().
+	enum ShadowCasters {
+		/// All the objects visible from the light.
+		SHADOW_CASTERS_ALL,
+		/// The visible objects drawn in the shadow cache of the light, they are marked as static casters.
+		SHADOW_CASTERS_STATIC,
+		/// The visible objects drawn over the shadow cache of the light.
+		SHADOW_CASTERS_DYNAMIC
+	};
+
+	/**
+	 * Cull the objects from the shadow cameras of all the lights in a single pass: the bounds
+	 * are updated and gathered once and the visibility from each light is kept for SetShadowCulling().
+	 * The objects seen by any light are marked visible, for the animations update.
+	 */
+	void CalculateShadowVisibleMeshes(const std::vector<KX_LightObject *>& lights);
+	/// Mark visible the casters seen by the light at index in the lights of CalculateShadowVisibleMeshes().
+	void SetShadowCulling(unsigned int index, ShadowCasters casters);
+	/// Return the version of the static shadow casters, a shadow cache of another version is outdated.
+	unsigned int GetShadowCacheVersion() const;
+	/// Outdate all the shadow caches, called when a static shadow caster changes.
+	void InvalidateShadowCaches();
 	void DrawDebug(RAS_IRasterizer *rasty);
 	KX_Camera* GetpCamera();
 	KX_BlenderSceneConverter *GetSceneConverter() { return m_sceneConverter; }
@@ -556,6 +683,28 @@ public:
 	// Update the activity box settings for objects in this scene, if needed.
 	void UpdateObjectActivity(void);
 
+	/// Add the objects of the object list missing in the schedule, e.g. after a scene merge.
+	void SyncDistanceSchedule(KX_DistanceSchedule& schedule);
+	void AddDistanceScheduleObject(KX_GameObject *gameobj);
+	void RemoveDistanceScheduleObject(KX_GameObject *gameobj);
+	/// Update the activity and the level of detail of a moved object at the next frame.
+	void ObjectMoved(KX_GameObject *gameobj);
+
+	/// Queue a scene management request, it is processed by the engine at the end of the logic frame.
+	void AddSceneRequest(KX_SceneRequest::Mode mode, const STR_String& name, const STR_String& newname = "");
+	std::vector<KX_SceneRequest>& GetSceneRequests();
+
+	/**
+	 * Return true if the logic frame of this scene can't run any Python code and
+	 * doesn't own any Python proxy, meaning it can be updated on a worker thread.
+	 */
+	bool CanUpdateConcurrently();
+	/**
+	 * Request a new check of CanUpdateConcurrently, to call when an object is added to
+	 * or removed from the scene or when an object starts to use Python.
+	 */
+	void InvalidateConcurrentUpdate();
+
 	// Enable/disable activity culling.
 	void SetActivityCulling(bool b);
 
@@ -610,6 +759,9 @@ public:
 	/** Inherited from CValue -- set the name of this object. */
 	void SetName(const char *name);
 
+	/// Return the scene name living until exit, for the profiler zones.
+	const char *GetProfileName() const;
+
 	/** Inherited from CValue -- does nothing! */
 	virtual CValue *GetReplica();
 
@@ -619,6 +771,7 @@ public:
 	/* --------------------------------------------------------------------- */
 
 	KX_PYMETHOD_DOC(KX_Scene, addObject);
+	KX_PYMETHOD_DOC(KX_Scene, reserveObjects);
 	KX_PYMETHOD_DOC(KX_Scene, end);
 	KX_PYMETHOD_DOC(KX_Scene, restart);
 	KX_PYMETHOD_DOC(KX_Scene, replace);
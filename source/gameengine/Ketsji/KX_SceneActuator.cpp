@@ -122,7 +122,7 @@ bool KX_SceneActuator::Update()
 	{
 	case KX_SCENE_RESTART:
 		{
-			m_KetsjiEngine->ReplaceScene(m_scene->GetName(),m_scene->GetName());
+			m_scene->AddSceneRequest(KX_SceneRequest::REPLACE, m_scene->GetName(), m_scene->GetName());
 			break;
 		}
 	case KX_SCENE_SET_CAMERA:
@@ -151,34 +151,32 @@ bool KX_SceneActuator::Update()
 	{
 	case KX_SCENE_SET_SCENE:
 		{
-			m_KetsjiEngine->ReplaceScene(m_scene->GetName(),m_nextSceneName);
+			m_scene->AddSceneRequest(KX_SceneRequest::REPLACE, m_scene->GetName(), m_nextSceneName);
 			break;
 		}
 	case KX_SCENE_ADD_FRONT_SCENE:
 		{
-			bool overlay=true;
-			m_KetsjiEngine->ConvertAndAddScene(m_nextSceneName,overlay);
+			m_scene->AddSceneRequest(KX_SceneRequest::ADD_OVERLAY, m_nextSceneName);
 			break;
 		}
 	case KX_SCENE_ADD_BACK_SCENE:
 		{
-			bool overlay=false;
-			m_KetsjiEngine->ConvertAndAddScene(m_nextSceneName,overlay);
+			m_scene->AddSceneRequest(KX_SceneRequest::ADD_BACKGROUND, m_nextSceneName);
 			break;
 		}
 	case KX_SCENE_REMOVE_SCENE:
 		{
-			m_KetsjiEngine->RemoveScene(m_nextSceneName);
+			m_scene->AddSceneRequest(KX_SceneRequest::REMOVE, m_nextSceneName);
 			break;
 		}
 	case KX_SCENE_SUSPEND:
 		{
-			m_KetsjiEngine->SuspendScene(m_nextSceneName);
+			m_scene->AddSceneRequest(KX_SceneRequest::SUSPEND, m_nextSceneName);
 			break;
 		}
 	case KX_SCENE_RESUME:
 		{
-			m_KetsjiEngine->ResumeScene(m_nextSceneName);
+			m_scene->AddSceneRequest(KX_SceneRequest::RESUME, m_nextSceneName);
 			break;
 		}
 	default:
@@ -49,7 +49,7 @@ typedef float sample_t;
 
 #include "KX_GameObject.h"
 #include "KX_PyMath.h" // needed for PyObjectFrom()
-#include "KX_Globals.h"
+#include "KX_Scene.h"
 #include "KX_Camera.h"
 #include <iostream>
 
@@ -248,10 +248,10 @@ bool KX_SoundActuator::Update(double curtime, bool frame)
 	{
 		if (m_is3d)
 		{
-			KX_Camera* cam = KX_GetActiveScene()->GetActiveCamera();
+			KX_GameObject* obj = (KX_GameObject*)this->GetParent();
+			KX_Camera* cam = obj->GetScene()->GetActiveCamera();
 			if (cam)
 			{
-				KX_GameObject* obj = (KX_GameObject*)this->GetParent();
 				MT_Vector3 p;
 				MT_Matrix3x3 Mo;
 				float data[4];
@@ -34,7 +34,6 @@
 #include "SCA_ISensor.h"
 #include "KX_TouchSensor.h"
 #include "KX_GameObject.h"
-#include "KX_CollisionContactPoints.h"
 #include "PHY_IPhysicsEnvironment.h"
 #include "PHY_IPhysicsController.h"
 
@@ -62,9 +61,6 @@ KX_TouchEventManager::~KX_TouchEventManager()
 
 void KX_TouchEventManager::RemoveNewCollisions()
 {
-	for (std::set<NewCollision>::iterator it = m_newCollisions.begin(), end = m_newCollisions.end(); it != end; ++it) {
-		delete it->colldata;
-	}
 	m_newCollisions.clear();
 }
 
@@ -74,7 +70,7 @@ bool	KX_TouchEventManager::NewHandleCollision(void* object1, void* object2, cons
 	PHY_IPhysicsController* obj1 = static_cast<PHY_IPhysicsController*>(object1);
 	PHY_IPhysicsController* obj2 = static_cast<PHY_IPhysicsController*>(object2);
 	
-	m_newCollisions.insert(NewCollision(obj1, obj2, coll_data));
+	m_newCollisions.push_back(NewCollision(obj1, obj2, coll_data));
 		
 	return false;
 }
@@ -193,7 +189,7 @@ void KX_TouchEventManager::NextFrame()
 		for (it.begin();!it.end();++it)
 			(*it)->SynchronizeTransform();
 		
-		for (std::set<NewCollision>::iterator cit = m_newCollisions.begin(); cit != m_newCollisions.end(); ++cit)
+		for (std::vector<NewCollision>::iterator cit = m_newCollisions.begin(); cit != m_newCollisions.end(); ++cit)
 		{
 			// Controllers
 			PHY_IPhysicsController* ctrl1 = (*cit).first;
@@ -223,10 +219,8 @@ void KX_TouchEventManager::NextFrame()
 			}
 			// Run python callbacks
 			const PHY_CollData *colldata = cit->colldata;
-			KX_CollisionContactPointList *contactPointList0 = new KX_CollisionContactPointList(colldata, true);
-			KX_CollisionContactPointList *contactPointList1 = new KX_CollisionContactPointList(colldata, false);
-			kxObj1->RunCollisionCallbacks(kxObj2, contactPointList0);
-			kxObj2->RunCollisionCallbacks(kxObj1, contactPointList1);
+			kxObj1->RunCollisionCallbacks(kxObj2, colldata, true);
+			kxObj2->RunCollisionCallbacks(kxObj1, colldata, false);
 		}
 
 		for (it.begin();!it.end();++it)
@@ -240,19 +234,3 @@ KX_TouchEventManager::NewCollision::NewCollision(PHY_IPhysicsController *first,
                                                  const PHY_CollData *colldata)
     : first(first), second(second), colldata(colldata)
 {}
-
-KX_TouchEventManager::NewCollision::NewCollision(const NewCollision &to_copy)
-	: first(to_copy.first), second(to_copy.second), colldata(to_copy.colldata)
-{}
-
-bool KX_TouchEventManager::NewCollision::operator<(const NewCollision &other) const
-{
-	//see strict weak ordering: https://support.microsoft.com/en-us/kb/949171
-	if (first == other.first) {
-		if (second == other.second) {
-			return colldata < other.colldata;
-		}
-		return second < other.second;
-	}
-	return first < other.first;
-}
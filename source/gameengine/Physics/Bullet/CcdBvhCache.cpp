@@ -0,0 +1,248 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Physics/Bullet/CcdBvhCache.cpp
+ *  \ingroup physbullet
+ */
+
+#include "CcdBvhCache.h"
+
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
+#include "BulletCollision/CollisionShapes/btStridingMeshInterface.h"
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#include "atomic_ops.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_hash_md5.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_system.h"
+}
+
+#include BLI_SYSTEM_PID_H
+
+/// Version of the cache files, increased when their content changes.
+#define CCD_BVH_CACHE_VERSION 1
+
+static const char bvh_cache_magic[8] = {'B', 'G', 'E', 'B', 'V', 'H', '\0', '\0'};
+
+/// Header of a cache file, followed by the serialized BVH.
+struct BvhCacheHeader
+{
+	char m_magic[8];
+	unsigned int m_size;
+	unsigned int m_pad;
+};
+
+/** Everything the serialized BVH depends on. The memory layout of the BVH depends
+ * on the Bullet version, the precision and the compiler, it's part of the key too.
+ */
+struct BvhCacheKey
+{
+	int m_version;
+	int m_bulletVersion;
+	int m_scalarSize;
+	int m_bvhSize;
+	int m_pointerSize;
+	int m_numVerts;
+	int m_vertexType;
+	int m_vertexStride;
+	int m_numFaces;
+	int m_indexType;
+	int m_indexStride;
+	float m_aabbMin[3];
+	float m_aabbMax[3];
+	float m_scaling[3];
+	unsigned char m_vertexDigest[16];
+	unsigned char m_indexDigest[16];
+};
+
+std::string CcdBvhCache::m_directory;
+
+void CcdBvhCache::SetDirectory(const std::string& directory)
+{
+	m_directory = directory;
+	if (!m_directory.empty() && !BLI_dir_create_recursive(m_directory.c_str())) {
+		printf("Warning: the physics cache directory \"%s\" can't be created, the cache is disabled\n",
+		       m_directory.c_str());
+		m_directory.clear();
+	}
+}
+
+const std::string& CcdBvhCache::GetDirectory()
+{
+	return m_directory;
+}
+
+bool CcdBvhCache::GetFilePath(btStridingMeshInterface *mesh, const btVector3& aabbMin, const btVector3& aabbMax,
+                              std::string& path)
+{
+	// The BVH of several parts isn't worth the complexity, the converted meshes have only one.
+	if (m_directory.empty() || mesh->getNumSubParts() != 1) {
+		return false;
+	}
+
+	BvhCacheKey key;
+	// The padding is hashed too.
+	memset(&key, 0, sizeof(key));
+
+	const unsigned char *vertexbase;
+	const unsigned char *indexbase;
+	PHY_ScalarType vertexType;
+	PHY_ScalarType indexType;
+	mesh->getLockedReadOnlyVertexIndexBase(&vertexbase, key.m_numVerts, vertexType, key.m_vertexStride,
+	                                       &indexbase, key.m_indexStride, key.m_numFaces, indexType);
+
+	BLI_hash_md5_buffer((const char *)vertexbase, (size_t)key.m_numVerts * key.m_vertexStride, key.m_vertexDigest);
+	BLI_hash_md5_buffer((const char *)indexbase, (size_t)key.m_numFaces * key.m_indexStride, key.m_indexDigest);
+
+	mesh->unLockReadOnlyVertexBase(0);
+
+	key.m_version = CCD_BVH_CACHE_VERSION;
+	key.m_bulletVersion = btGetVersion();
+	key.m_scalarSize = sizeof(btScalar);
+	key.m_bvhSize = sizeof(btOptimizedBvh);
+	key.m_pointerSize = sizeof(void *);
+	key.m_vertexType = vertexType;
+	key.m_indexType = indexType;
+	const btVector3& scaling = mesh->getScaling();
+	for (int i = 0; i < 3; ++i) {
+		key.m_aabbMin[i] = aabbMin[i];
+		key.m_aabbMax[i] = aabbMax[i];
+		key.m_scaling[i] = scaling[i];
+	}
+
+	unsigned char digest[16];
+	char hexdigest[33];
+	BLI_hash_md5_buffer((const char *)&key, sizeof(key), digest);
+	BLI_hash_md5_to_hexdigest(digest, hexdigest);
+
+	char filepath[FILE_MAX];
+	BLI_join_dirfile(filepath, sizeof(filepath), m_directory.c_str(), (std::string(hexdigest) + ".bvh").c_str());
+	path = filepath;
+	return true;
+}
+
+static btOptimizedBvh *bvh_build(btStridingMeshInterface *mesh, const btVector3& aabbMin, const btVector3& aabbMax)
+{
+	// Same as btBvhTriangleMeshShape::buildOptimizedBvh.
+	void *mem = btAlignedAlloc(sizeof(btOptimizedBvh), 16);
+	btOptimizedBvh *bvh = new(mem) btOptimizedBvh();
+	bvh->build(mesh, true, aabbMin, aabbMax);
+	return bvh;
+}
+
+static btOptimizedBvh *bvh_load(const std::string& path)
+{
+	FILE *file = BLI_fopen(path.c_str(), "rb");
+	if (!file) {
+		return NULL;
+	}
+
+	BvhCacheHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.m_magic, bvh_cache_magic, sizeof(bvh_cache_magic)) != 0 ||
+		header.m_size < sizeof(btOptimizedBvh))
+	{
+		fclose(file);
+		return NULL;
+	}
+
+	// The BVH is deserialized in place, the buffer is the BVH.
+	void *buffer = btAlignedAlloc(header.m_size, 16);
+	const bool read = (fread(buffer, 1, header.m_size, file) == header.m_size);
+	fclose(file);
+
+	btOptimizedBvh *bvh = read ? btOptimizedBvh::deSerializeInPlace(buffer, header.m_size, false) : NULL;
+	if (!bvh) {
+		btAlignedFree(buffer);
+	}
+
+	return bvh;
+}
+
+/// Number of saves started by this process, part of the temporary file names.
+static unsigned int bvh_save_count = 0;
+
+static void bvh_save(btOptimizedBvh *bvh, const std::string& path)
+{
+	BvhCacheHeader header;
+	memcpy(header.m_magic, bvh_cache_magic, sizeof(bvh_cache_magic));
+	header.m_size = bvh->calculateSerializeBufferSize();
+	header.m_pad = 0;
+
+	void *buffer = btAlignedAlloc(header.m_size, 16);
+	bool written = false;
+
+	if (bvh->serializeInPlace(buffer, header.m_size, false)) {
+		/* Written in a temporary file first, an interrupted write leaves no truncated file.
+		 * The file is unique to this save, other threads or processes can save the same key. */
+		char suffix[64];
+		BLI_snprintf(suffix, sizeof(suffix), ".%d-%u.tmp", abs(getpid()), atomic_add_u(&bvh_save_count, 1));
+		const std::string tmppath = path + suffix;
+		FILE *file = BLI_fopen(tmppath.c_str(), "wb");
+		if (file) {
+			written = (fwrite(&header, sizeof(header), 1, file) == 1 &&
+			           fwrite(buffer, 1, header.m_size, file) == header.m_size);
+			written = (fclose(file) == 0) && written;
+
+			if (!written || BLI_rename(tmppath.c_str(), path.c_str()) != 0) {
+				BLI_delete(tmppath.c_str(), false, false);
+				written = false;
+			}
+		}
+	}
+
+	// The serialized BVH only references the buffer.
+	btAlignedFree(buffer);
+
+	if (!written) {
+		printf("Warning: the physics cache file \"%s\" can't be written\n", path.c_str());
+	}
+}
+
+btOptimizedBvh *CcdBvhCache::GetBvh(btStridingMeshInterface *mesh, const btVector3& aabbMin, const btVector3& aabbMax)
+{
+	std::string path;
+	if (!GetFilePath(mesh, aabbMin, aabbMax, path)) {
+		return bvh_build(mesh, aabbMin, aabbMax);
+	}
+
+	btOptimizedBvh *bvh = bvh_load(path);
+	if (!bvh) {
+		bvh = bvh_build(mesh, aabbMin, aabbMax);
+		bvh_save(bvh, path);
+	}
+
+	return bvh;
+}
+
+void CcdBvhCache::FreeBvh(btOptimizedBvh *bvh)
+{
+	/* The destructor is virtual, a loaded BVH is only a btQuantizedBvh
+	 * not owning its nodes, they are in its buffer. */
+	bvh->~btOptimizedBvh();
+	btAlignedFree(bvh);
+}
@@ -0,0 +1,66 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file CcdBvhCache.h
+ *  \ingroup physbullet
+ *
+ * On disk cache of the BVH of the triangle mesh shapes, the most expensive part of the
+ * conversion of the static level geometry. A file is named by the hash of the triangles,
+ * the quantization bounds and the Bullet build settings, an unchanged mesh is loaded in
+ * place from its file without building its tree again.
+ */
+
+#ifndef __CCDBVHCACHE_H__
+#define __CCDBVHCACHE_H__
+
+#include "LinearMath/btVector3.h"
+
+#include <string>
+
+class btOptimizedBvh;
+class btStridingMeshInterface;
+
+class CcdBvhCache
+{
+private:
+	/// Directory of the cache files, empty when the cache is disabled.
+	static std::string m_directory;
+
+public:
+	/// Set the directory of the cache files, created if missing, an empty directory disables the cache.
+	static void SetDirectory(const std::string& directory);
+	static const std::string& GetDirectory();
+
+	/** Return the quantized BVH of the triangles of mesh for the bounds aabbMin and aabbMax, the same
+	 * as btBvhTriangleMeshShape builds. The BVH is loaded from the cache or built and saved in it.
+	 * It isn't owned by the shapes using it and must be freed with FreeBvh.
+	 */
+	static btOptimizedBvh *GetBvh(btStridingMeshInterface *mesh, const btVector3& aabbMin, const btVector3& aabbMax);
+	/// Free a BVH returned by GetBvh, built or loaded.
+	static void FreeBvh(btOptimizedBvh *bvh);
+
+	/** Return the path of the cache file of the BVH, false if the mesh can't be cached,
+	 * e.g. it has several parts or the cache is disabled.
+	 */
+	static bool GetFilePath(btStridingMeshInterface *mesh, const btVector3& aabbMin, const btVector3& aabbMax,
+	                        std::string& path);
+};
+
+#endif  /* __CCDBVHCACHE_H__ */
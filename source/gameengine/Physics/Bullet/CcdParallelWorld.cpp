@@ -0,0 +1,450 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Physics/Bullet/CcdParallelWorld.cpp
+ *  \ingroup physbullet
+ */
+
+#include "CcdParallelWorld.h"
+
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+#include "BulletCollision/CollisionDispatch/btCollisionConfiguration.h"
+#include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
+#include "BulletCollision/CollisionShapes/btCompoundShape.h"
+
+#include <algorithm>
+
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+/// Pairs processed by a single task.
+#define CCD_PAIRS_PER_TASK 128
+/// Below this amount of pairs the threading overhead is higher than the narrowphase itself.
+#define CCD_PARALLEL_MIN_PAIRS (CCD_PAIRS_PER_TASK * 2)
+
+CcdConvexConvexAlgorithm::CcdConvexConvexAlgorithm(btPersistentManifold *mf, const btCollisionAlgorithmConstructionInfo& ci,
+                                                   const btCollisionObjectWrapper *body0Wrap, const btCollisionObjectWrapper *body1Wrap,
+                                                   btConvexPenetrationDepthSolver *pdSolver, int numPerturbationIterations,
+                                                   int minimumPointsPerturbationThreshold)
+	// The base class only stores the simplex solver pointer.
+	:btConvexConvexAlgorithm(mf, ci, body0Wrap, body1Wrap, &m_ownSimplexSolver, pdSolver, numPerturbationIterations,
+	                         minimumPointsPerturbationThreshold)
+{
+}
+
+CcdConvexConvexAlgorithm::CreateFunc::CreateFunc(const btConvexConvexAlgorithm::CreateFunc& stockFunc)
+	:m_pdSolver(stockFunc.m_pdSolver),
+	m_numPerturbationIterations(stockFunc.m_numPerturbationIterations),
+	m_minimumPointsPerturbationThreshold(stockFunc.m_minimumPointsPerturbationThreshold)
+{
+}
+
+btCollisionAlgorithm *CcdConvexConvexAlgorithm::CreateFunc::CreateCollisionAlgorithm(btCollisionAlgorithmConstructionInfo& ci,
+                                                                                     const btCollisionObjectWrapper *body0Wrap,
+                                                                                     const btCollisionObjectWrapper *body1Wrap)
+{
+	void *mem = ci.m_dispatcher1->allocateCollisionAlgorithm(sizeof(CcdConvexConvexAlgorithm));
+	return new(mem) CcdConvexConvexAlgorithm(ci.m_manifold, ci, body0Wrap, body1Wrap, m_pdSolver,
+	                                         m_numPerturbationIterations, m_minimumPointsPerturbationThreshold);
+}
+
+CcdCollisionDispatcher::CcdCollisionDispatcher(btCollisionConfiguration *collisionConfiguration, TaskScheduler *taskScheduler)
+	:btCollisionDispatcher(collisionConfiguration),
+	m_taskScheduler(taskScheduler)
+{
+	btCollisionAlgorithmCreateFunc *stockConvexFunc = collisionConfiguration->getCollisionAlgorithmCreateFunc(
+		CONVEX_HULL_SHAPE_PROXYTYPE, CONVEX_HULL_SHAPE_PROXYTYPE);
+	m_convexConvexCreateFunc = new CcdConvexConvexAlgorithm::CreateFunc(
+		*static_cast<btConvexConvexAlgorithm::CreateFunc *>(stockConvexFunc));
+	m_sphereSphereCreateFunc = collisionConfiguration->getCollisionAlgorithmCreateFunc(
+		SPHERE_SHAPE_PROXYTYPE, SPHERE_SHAPE_PROXYTYPE);
+	m_boxBoxCreateFunc = collisionConfiguration->getCollisionAlgorithmCreateFunc(BOX_SHAPE_PROXYTYPE, BOX_SHAPE_PROXYTYPE);
+
+	btAssert(getCollisionConfiguration()->getCollisionAlgorithmPool()->getElementSize() >=
+	         (int)sizeof(CcdConvexConvexAlgorithm));
+
+	for (int i = 0; i < MAX_BROADPHASE_COLLISION_TYPES; ++i) {
+		for (int j = 0; j < MAX_BROADPHASE_COLLISION_TYPES; ++j) {
+			if (m_doubleDispatch[i][j] == stockConvexFunc) {
+				m_doubleDispatch[i][j] = m_convexConvexCreateFunc;
+			}
+		}
+	}
+}
+
+CcdCollisionDispatcher::~CcdCollisionDispatcher()
+{
+	delete m_convexConvexCreateFunc;
+}
+
+bool CcdCollisionDispatcher::IsParallelPair(const btBroadphasePair& pair) const
+{
+	if (!pair.m_algorithm) {
+		return false;
+	}
+
+	const int type0 = ((btCollisionObject *)pair.m_pProxy0->m_clientObject)->getCollisionShape()->getShapeType();
+	const int type1 = ((btCollisionObject *)pair.m_pProxy1->m_clientObject)->getCollisionShape()->getShapeType();
+	// The shape types select the algorithm, the pairs are cleaned when a shape is replaced.
+	const btCollisionAlgorithmCreateFunc *createFunc = m_doubleDispatch[type0][type1];
+
+	if (createFunc == m_convexConvexCreateFunc) {
+		// The manifold is created by the first collision processing.
+		return (static_cast<CcdConvexConvexAlgorithm *>(pair.m_algorithm)->getManifold() != NULL);
+	}
+
+	// These algorithms create their manifold with the algorithm.
+	return (createFunc == m_sphereSphereCreateFunc || createFunc == m_boxBoxCreateFunc);
+}
+
+struct CcdDispatchTaskData
+{
+	CcdCollisionDispatcher *m_dispatcher;
+	const btDispatcherInfo *m_dispatchInfo;
+	unsigned int m_numPairs;
+};
+
+static void ccd_dispatch_pairs_task(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	CcdDispatchTaskData *data = (CcdDispatchTaskData *)BLI_task_pool_userdata(pool);
+	const unsigned int start = GET_UINT_FROM_POINTER(taskdata) * CCD_PAIRS_PER_TASK;
+	const unsigned int end = std::min(start + CCD_PAIRS_PER_TASK, data->m_numPairs);
+
+	data->m_dispatcher->DispatchParallelPairs(start, end, *data->m_dispatchInfo);
+}
+
+void CcdCollisionDispatcher::DispatchParallelPairs(unsigned int start, unsigned int end, const btDispatcherInfo& dispatchInfo)
+{
+	for (unsigned int i = start; i < end; ++i) {
+		defaultNearCallback(*m_parallelPairs[i], *this, dispatchInfo);
+	}
+}
+
+void CcdCollisionDispatcher::dispatchAllCollisionPairs(btOverlappingPairCache *pairCache, const btDispatcherInfo& dispatchInfo,
+                                                       btDispatcher *dispatcher)
+{
+	const int numPairs = pairCache->getNumOverlappingPairs();
+
+	if (numPairs < CCD_PARALLEL_MIN_PAIRS || dispatchInfo.m_dispatchFunc != btDispatcherInfo::DISPATCH_DISCRETE ||
+	    getNearCallback() != defaultNearCallback)
+	{
+		btCollisionDispatcher::dispatchAllCollisionPairs(pairCache, dispatchInfo, dispatcher);
+		return;
+	}
+
+	btBroadphasePair *pairs = pairCache->getOverlappingPairArrayPtr();
+	m_parallelPairs.clear();
+
+	/* Algorithms and manifolds are only allocated here, in the order of the pairs,
+	 * the manifolds list is then the same than with the stock dispatcher. */
+	for (int i = 0; i < numPairs; ++i) {
+		btBroadphasePair& pair = pairs[i];
+		if (IsParallelPair(pair)) {
+			m_parallelPairs.push_back(&pair);
+		}
+		else {
+			defaultNearCallback(pair, *this, dispatchInfo);
+		}
+	}
+
+	if (m_parallelPairs.empty()) {
+		return;
+	}
+
+	CcdDispatchTaskData data;
+	data.m_dispatcher = this;
+	data.m_dispatchInfo = &dispatchInfo;
+	data.m_numPairs = m_parallelPairs.size();
+
+	const unsigned int numTasks = (data.m_numPairs + CCD_PAIRS_PER_TASK - 1) / CCD_PAIRS_PER_TASK;
+
+	TaskPool *pool = BLI_task_pool_create(m_taskScheduler, &data);
+	for (unsigned int i = 0; i < numTasks; ++i) {
+		BLI_task_pool_push(pool, ccd_dispatch_pairs_task, SET_UINT_IN_POINTER(i), false, TASK_PRIORITY_HIGH);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+}
+
+static int ccd_constraint_island_id(const btTypedConstraint *constraint)
+{
+	const btCollisionObject& colObj0 = constraint->getRigidBodyA();
+	const btCollisionObject& colObj1 = constraint->getRigidBodyB();
+	return (colObj0.getIslandTag() >= 0) ? colObj0.getIslandTag() : colObj1.getIslandTag();
+}
+
+/// Same order than the stock world, see btSortConstraintOnIslandPredicate.
+struct CcdConstraintIslandLess
+{
+	bool operator()(const btTypedConstraint *lhs, const btTypedConstraint *rhs) const
+	{
+		return ccd_constraint_island_id(lhs) < ccd_constraint_island_id(rhs);
+	}
+
+	bool operator()(const btTypedConstraint *lhs, int islandId) const
+	{
+		return ccd_constraint_island_id(lhs) < islandId;
+	}
+
+	bool operator()(int islandId, const btTypedConstraint *rhs) const
+	{
+		return islandId < ccd_constraint_island_id(rhs);
+	}
+};
+
+/** Static and kinematic objects are not merged in islands, but the solver
+ * writes to the kinematic ones, an island referencing one can't be solved with another.
+ */
+static bool ccd_is_shared_solver_body(const btCollisionObject *object)
+{
+	const btRigidBody *body = btRigidBody::upcast(object);
+	return (body && body->isStaticOrKinematicObject() && (body->isKinematicObject() || body->getInvMass() != 0.0f));
+}
+
+struct CcdIslandGatherCallback : public btSimulationIslandManager::IslandCallback
+{
+	CcdDynamicsWorld *m_world;
+	btTypedConstraint **m_sortedConstraints;
+	int m_numConstraints;
+
+	CcdIslandGatherCallback(CcdDynamicsWorld *world, btTypedConstraint **sortedConstraints, int numConstraints)
+		:m_world(world),
+		m_sortedConstraints(sortedConstraints),
+		m_numConstraints(numConstraints)
+	{
+	}
+
+	virtual void processIsland(btCollisionObject **bodies, int numBodies, btPersistentManifold **manifolds,
+	                           int numManifolds, int islandId)
+	{
+		CcdDynamicsWorld::Island island;
+		// The bodies array of the island manager is reused for the next island.
+		island.m_bodyStart = m_world->m_islandBodies.size();
+		island.m_numBodies = numBodies;
+		for (int i = 0; i < numBodies; ++i) {
+			m_world->m_islandBodies.push_back(bodies[i]);
+		}
+
+		island.m_manifolds = manifolds;
+		island.m_numManifolds = numManifolds;
+
+		btTypedConstraint **constraintsEnd = m_sortedConstraints + m_numConstraints;
+		island.m_constraints = std::lower_bound(m_sortedConstraints, constraintsEnd, islandId, CcdConstraintIslandLess());
+		island.m_numConstraints = std::upper_bound(island.m_constraints, constraintsEnd, islandId, CcdConstraintIslandLess()) -
+		                          island.m_constraints;
+
+		bool shared = false;
+		for (int i = 0; i < numManifolds && !shared; ++i) {
+			shared = ccd_is_shared_solver_body(manifolds[i]->getBody0()) || ccd_is_shared_solver_body(manifolds[i]->getBody1());
+		}
+		for (int i = 0; i < island.m_numConstraints && !shared; ++i) {
+			shared = ccd_is_shared_solver_body(&island.m_constraints[i]->getRigidBodyA()) ||
+			         ccd_is_shared_solver_body(&island.m_constraints[i]->getRigidBodyB());
+		}
+
+		if (shared) {
+			m_world->m_serialIslands.push_back(island);
+		}
+		else {
+			m_world->m_islands.push_back(island);
+		}
+	}
+};
+
+CcdDynamicsWorld::CcdDynamicsWorld(btDispatcher *dispatcher, btBroadphaseInterface *pairCache, btConstraintSolver *constraintSolver,
+                                   btCollisionConfiguration *collisionConfiguration, TaskScheduler *taskScheduler)
+	:btSoftRigidDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration),
+	m_taskScheduler(taskScheduler)
+{
+	const int numThreads = BLI_task_scheduler_num_threads(m_taskScheduler);
+	for (int i = 0; i < numThreads; ++i) {
+		m_threadSolvers.push_back(new btSequentialImpulseConstraintSolver());
+	}
+}
+
+CcdDynamicsWorld::~CcdDynamicsWorld()
+{
+	for (std::vector<btSequentialImpulseConstraintSolver *>::iterator it = m_threadSolvers.begin(), end = m_threadSolvers.end();
+	     it != end; ++it)
+	{
+		delete *it;
+	}
+}
+
+void CcdDynamicsWorld::SolveIslands(unsigned int start, unsigned int end, btSequentialImpulseConstraintSolver *solver,
+                                    const btContactSolverInfo& solverInfo)
+{
+	for (unsigned int i = start; i < end; ++i) {
+		const Island& island = m_islands[i];
+		// The random order of SOLVER_RANDMIZE_ORDER must not depend on the thread solving the island.
+		solver->setRandSeed(0);
+		solver->solveGroup(&m_islandBodies[island.m_bodyStart], island.m_numBodies, island.m_manifolds,
+		                   island.m_numManifolds, island.m_constraints, island.m_numConstraints, solverInfo, NULL,
+		                   m_dispatcher1);
+	}
+}
+
+struct CcdSolveTaskData
+{
+	CcdDynamicsWorld *m_world;
+	const btContactSolverInfo *m_solverInfo;
+	/// Index of the first island of each task, followed by the amount of islands.
+	std::vector<unsigned int> m_taskStarts;
+};
+
+static void ccd_solve_islands_task(TaskPool *__restrict pool, void *taskdata, int threadid)
+{
+	CcdSolveTaskData *data = (CcdSolveTaskData *)BLI_task_pool_userdata(pool);
+	const unsigned int task = GET_UINT_FROM_POINTER(taskdata);
+
+	data->m_world->SolveIslands(data->m_taskStarts[task], data->m_taskStarts[task + 1],
+	                            data->m_world->GetThreadSolver(threadid), *data->m_solverInfo);
+}
+
+void CcdDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
+{
+	if (!m_islandManager->getSplitIslands()) {
+		btSoftRigidDynamicsWorld::solveConstraints(solverInfo);
+		return;
+	}
+
+	m_sortedConstraints.resize(m_constraints.size());
+	for (int i = 0; i < m_constraints.size(); ++i) {
+		m_sortedConstraints[i] = m_constraints[i];
+	}
+	m_sortedConstraints.quickSort(CcdConstraintIslandLess());
+
+	m_islands.clear();
+	m_serialIslands.clear();
+	m_islandBodies.resize(0);
+
+	CcdIslandGatherCallback callback(this, m_sortedConstraints.size() ? &m_sortedConstraints[0] : NULL,
+	                                 m_sortedConstraints.size());
+	m_constraintSolver->prepareSolve(getNumCollisionObjects(), m_dispatcher1->getNumManifolds());
+	m_islandManager->buildAndProcessIslands(m_dispatcher1, this, &callback);
+
+	if (!m_islands.empty()) {
+		CcdSolveTaskData data;
+		data.m_world = this;
+		data.m_solverInfo = &solverInfo;
+
+		/* Small islands are grouped in a task until they reach the batch size of the solver,
+		 * but each island is still solved alone, the grouping doesn't change the results. */
+		int batchSize = 0;
+		data.m_taskStarts.push_back(0);
+		for (unsigned int i = 0, size = m_islands.size(); i < size; ++i) {
+			batchSize += m_islands[i].m_numManifolds + m_islands[i].m_numConstraints;
+			if (batchSize >= solverInfo.m_minimumSolverBatchSize || i == (size - 1)) {
+				data.m_taskStarts.push_back(i + 1);
+				batchSize = 0;
+			}
+		}
+
+		TaskPool *pool = BLI_task_pool_create(m_taskScheduler, &data);
+		for (unsigned int i = 0, size = data.m_taskStarts.size() - 1; i < size; ++i) {
+			BLI_task_pool_push(pool, ccd_solve_islands_task, SET_UINT_IN_POINTER(i), false, TASK_PRIORITY_HIGH);
+		}
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+
+	for (std::vector<Island>::iterator it = m_serialIslands.begin(), end = m_serialIslands.end(); it != end; ++it) {
+		const Island& island = *it;
+		m_constraintSolver->solveGroup(&m_islandBodies[island.m_bodyStart], island.m_numBodies, island.m_manifolds,
+		                               island.m_numManifolds, island.m_constraints, island.m_numConstraints, solverInfo,
+		                               m_debugDrawer, m_dispatcher1);
+	}
+
+	m_constraintSolver->allSolved(solverInfo, m_debugDrawer);
+}
+
+/// Serializes the ray tests of the shapes writing in themselves, see ccd_shape_ray_test_is_serial.
+static ThreadMutex ccd_serial_ray_test_mutex = BLI_MUTEX_INITIALIZER;
+
+/** Return true when the ray test of the shape isn't safe from several threads, the GImpact
+ * meshes lock and unlock the vertices of their mesh in the shared primitive manager.
+ */
+static bool ccd_shape_ray_test_is_serial(const btCollisionShape *shape)
+{
+	if (shape->getShapeType() == GIMPACT_SHAPE_PROXYTYPE) {
+		return true;
+	}
+
+	if (shape->isCompound()) {
+		const btCompoundShape *compound = static_cast<const btCompoundShape *>(shape);
+		for (int i = 0, size = compound->getNumChildShapes(); i < size; ++i) {
+			if (ccd_shape_ray_test_is_serial(compound->getChildShape(i))) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/// Ray test the objects of the broadphase leaves, the traversal stack is local to the ray.
+struct CcdConcurrentRayTester : btDbvt::ICollide
+{
+	btTransform m_rayFromTrans;
+	btTransform m_rayToTrans;
+	btCollisionWorld::RayResultCallback& m_resultCallback;
+
+	CcdConcurrentRayTester(const btVector3& rayFrom, const btVector3& rayTo, btCollisionWorld::RayResultCallback& resultCallback)
+		:m_rayFromTrans(btQuaternion::getIdentity(), rayFrom),
+		m_rayToTrans(btQuaternion::getIdentity(), rayTo),
+		m_resultCallback(resultCallback)
+	{
+	}
+
+	void Process(const btDbvtNode *leaf)
+	{
+		// Same as btSoftSingleRayCallback::process.
+		if (m_resultCallback.m_closestHitFraction == 0.0f) {
+			return;
+		}
+
+		btBroadphaseProxy *proxy = (btBroadphaseProxy *)leaf->data;
+		btCollisionObject *collisionObject = (btCollisionObject *)proxy->m_clientObject;
+		if (m_resultCallback.needsCollision(collisionObject->getBroadphaseHandle())) {
+			const btCollisionShape *shape = collisionObject->getCollisionShape();
+			const bool serial = ccd_shape_ray_test_is_serial(shape);
+			if (serial) {
+				BLI_mutex_lock(&ccd_serial_ray_test_mutex);
+			}
+
+			btSoftRigidDynamicsWorld::rayTestSingle(m_rayFromTrans, m_rayToTrans, collisionObject, shape,
+			                                        collisionObject->getWorldTransform(), m_resultCallback);
+
+			if (serial) {
+				BLI_mutex_unlock(&ccd_serial_ray_test_mutex);
+			}
+		}
+	}
+};
+
+void CcdConcurrentRayTest(const btDbvtBroadphase *broadphase, const btVector3& rayFrom, const btVector3& rayTo,
+                          btCollisionWorld::RayResultCallback& resultCallback)
+{
+	CcdConcurrentRayTester tester(rayFrom, rayTo, resultCallback);
+	// Dynamic and static sets.
+	btDbvt::rayTest(broadphase->m_sets[0].m_root, rayFrom, rayTo, tester);
+	btDbvt::rayTest(broadphase->m_sets[1].m_root, rayFrom, rayTo, tester);
+}
@@ -0,0 +1,159 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file CcdParallelWorld.h
+ *  \ingroup physbullet
+ *
+ * Multithreaded narrowphase and constraint solving on top of the stock Bullet classes.
+ * The results don't depend on the amount of threads: the contact manifolds are only created
+ * and released in the serial parts, and each island is always solved alone.
+ */
+
+#ifndef __CCDPARALLELWORLD_H__
+#define __CCDPARALLELWORLD_H__
+
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcher.h"
+#include "BulletCollision/CollisionDispatch/btConvexConvexAlgorithm.h"
+#include "BulletCollision/NarrowPhaseCollision/btVoronoiSimplexSolver.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h"
+#include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
+
+#include <vector>
+
+struct TaskScheduler;
+
+/** Convex algorithm owning its simplex solver. The stock algorithms all share
+ * the simplex solver of the collision configuration, which prevents processing
+ * two pairs at the same time.
+ */
+class CcdConvexConvexAlgorithm : public btConvexConvexAlgorithm
+{
+private:
+	btVoronoiSimplexSolver m_ownSimplexSolver;
+
+public:
+	CcdConvexConvexAlgorithm(btPersistentManifold *mf, const btCollisionAlgorithmConstructionInfo& ci,
+	                         const btCollisionObjectWrapper *body0Wrap, const btCollisionObjectWrapper *body1Wrap,
+	                         btConvexPenetrationDepthSolver *pdSolver, int numPerturbationIterations,
+	                         int minimumPointsPerturbationThreshold);
+
+	struct CreateFunc : public btCollisionAlgorithmCreateFunc
+	{
+		btConvexPenetrationDepthSolver *m_pdSolver;
+		int m_numPerturbationIterations;
+		int m_minimumPointsPerturbationThreshold;
+
+		/// Use the same settings than the stock create function.
+		CreateFunc(const btConvexConvexAlgorithm::CreateFunc& stockFunc);
+
+		virtual btCollisionAlgorithm *CreateCollisionAlgorithm(btCollisionAlgorithmConstructionInfo& ci,
+		                                                       const btCollisionObjectWrapper *body0Wrap,
+		                                                       const btCollisionObjectWrapper *body1Wrap);
+	};
+};
+
+/** Dispatcher processing the pairs of convex shapes over the task scheduler.
+ * Pairs needing a new algorithm or manifold, and pairs using algorithms creating
+ * sub algorithms (compound, concave, soft bodies...) are processed first in the calling thread.
+ * The collision configuration must be created with a maximum algorithm element size
+ * of at least sizeof(CcdConvexConvexAlgorithm).
+ */
+class CcdCollisionDispatcher : public btCollisionDispatcher
+{
+private:
+	TaskScheduler *m_taskScheduler;
+	CcdConvexConvexAlgorithm::CreateFunc *m_convexConvexCreateFunc;
+	/// Create functions of the algorithms without sub algorithms nor lazy manifold creation.
+	btCollisionAlgorithmCreateFunc *m_sphereSphereCreateFunc;
+	btCollisionAlgorithmCreateFunc *m_boxBoxCreateFunc;
+
+	/// Pairs processed in parallel, reused every step.
+	std::vector<btBroadphasePair *> m_parallelPairs;
+
+	bool IsParallelPair(const btBroadphasePair& pair) const;
+
+public:
+	CcdCollisionDispatcher(btCollisionConfiguration *collisionConfiguration, TaskScheduler *taskScheduler);
+	virtual ~CcdCollisionDispatcher();
+
+	virtual void dispatchAllCollisionPairs(btOverlappingPairCache *pairCache, const btDispatcherInfo& dispatchInfo,
+	                                       btDispatcher *dispatcher);
+
+	/// Process a range of the parallel pairs, called from the tasks.
+	void DispatchParallelPairs(unsigned int start, unsigned int end, const btDispatcherInfo& dispatchInfo);
+};
+
+/** Dynamics world solving the simulation islands over the task scheduler,
+ * each worker thread using its own constraint solver.
+ */
+class CcdDynamicsWorld : public btSoftRigidDynamicsWorld
+{
+public:
+	struct Island
+	{
+		/// Range in m_islandBodies.
+		int m_bodyStart;
+		int m_numBodies;
+		btPersistentManifold **m_manifolds;
+		int m_numManifolds;
+		btTypedConstraint **m_constraints;
+		int m_numConstraints;
+	};
+
+private:
+	TaskScheduler *m_taskScheduler;
+	/// One solver per thread of the scheduler, indexed by thread id.
+	std::vector<btSequentialImpulseConstraintSolver *> m_threadSolvers;
+
+	/// Islands of the current step, filled during the islands build.
+	std::vector<Island> m_islands;
+	/// Islands sharing a kinematic object with another one, solved in the calling thread.
+	std::vector<Island> m_serialIslands;
+	btAlignedObjectArray<btCollisionObject *> m_islandBodies;
+
+	friend struct CcdIslandGatherCallback;
+
+protected:
+	virtual void solveConstraints(btContactSolverInfo& solverInfo);
+
+public:
+	CcdDynamicsWorld(btDispatcher *dispatcher, btBroadphaseInterface *pairCache, btConstraintSolver *constraintSolver,
+	                 btCollisionConfiguration *collisionConfiguration, TaskScheduler *taskScheduler);
+	virtual ~CcdDynamicsWorld();
+
+	/// Solve a range of the parallel islands, called from the tasks.
+	void SolveIslands(unsigned int start, unsigned int end, btSequentialImpulseConstraintSolver *solver,
+	                  const btContactSolverInfo& solverInfo);
+
+	btSequentialImpulseConstraintSolver *GetThreadSolver(int threadid)
+	{
+		return m_threadSolvers[threadid];
+	}
+};
+
+/** Ray test safe to run from several threads at once on a world using a btDbvtBroadphase.
+ * The stock btCollisionWorld::rayTest traverses the broadphase with a stack shared by all the rays.
+ * The shapes whose ray test isn't thread safe, e.g. the GImpact meshes, are tested one ray at a time.
+ */
+void CcdConcurrentRayTest(const btDbvtBroadphase *broadphase, const btVector3& rayFrom, const btVector3& rayTo,
+                          btCollisionWorld::RayResultCallback& resultCallback);
+
+#endif  // __CCDPARALLELWORLD_H__
@@ -28,6 +28,7 @@
 
 #include "PHY_IMotionState.h"
 #include "CcdPhysicsEnvironment.h"
+#include "CcdBvhCache.h"
 
 #include "RAS_DisplayArray.h"
 #include "RAS_MeshObject.h"
@@ -157,6 +158,8 @@ CcdPhysicsController::CcdPhysicsController(const CcdConstructionInfo& ci)
 	m_savedMass = 0.0f;
 	m_savedDyna = false;
 	m_suspended = false;
+	m_motionIndex = -1;
+	m_motionActive = false;
 
 	CreateRigidbody();
 }
@@ -640,6 +643,12 @@ bool CcdPhysicsController::ReplaceControllerShape(btCollisionShape *newShape)
 		// add the new softbody
 		world->addSoftBody(newSoftBody);
 	}
+	else {
+		// a new shape has no scaling
+		btVector3 scale;
+		m_MotionState->GetWorldScaling(scale.m_floats[0], scale.m_floats[1], scale.m_floats[2]);
+		newShape->setLocalScaling(scale);
+	}
 
 	return true;
 }
@@ -781,6 +790,7 @@ void CcdPhysicsController::PostProcessReplica(class PHY_IMotionState *motionstat
 	m_MotionState = motionstate;
 	m_registerCount = 0;
 	m_collisionShape = NULL;
+	m_motionIndex = -1;
 
 	// Clear all old constraints.
 	m_ccdConstraintRefs.clear();
@@ -1051,6 +1061,21 @@ void CcdPhysicsController::RestoreDynamics()
 	}
 }
 
+void CcdPhysicsController::SuspendPhysics()
+{
+	GetPhysicsEnvironment()->RemoveCcdPhysicsController(this);
+}
+
+void CcdPhysicsController::RestorePhysics()
+{
+	// the object may have been moved while it was out of the world
+	SetTransform();
+	GetPhysicsEnvironment()->AddCcdPhysicsController(this);
+	if (GetRigidBody()) {
+		GetRigidBody()->activate();
+	}
+}
+
 void CcdPhysicsController::GetPosition(MT_Vector3&   pos) const
 {
 	const btTransform& xform = m_object->getWorldTransform();
@@ -1094,6 +1119,13 @@ void CcdPhysicsController::SetTransform()
 	                ori[2], ori[6], ori[10]);
 	ForceWorldTransform(rot, pos);
 
+	/* The bodies not moved by the simulation aren't synchronized every step,
+	 * their scaling is updated here when it changes. */
+	btCollisionShape *shape = (m_object) ? m_object->getCollisionShape() : NULL;
+	if (shape && !GetSoftBody() && shape->getLocalScaling() != scale) {
+		shape->setLocalScaling(scale);
+	}
+
 	if (!IsDynamic() && !GetConstructionInfo().m_bSensor && !GetCharacterController()) {
 		btCollisionObject *object = GetRigidBody();
 		object->setActivationState(ACTIVE_TAG);
@@ -2516,10 +2548,25 @@ btCollisionShape *CcdShapeConstructionInfo::CreateBulletShape(btScalar margin, b
 						    3 * sizeof(btScalar));
 					}
 
+					if (m_forceReInstance) {
+						m_shareBvh = false;
+					}
 					m_forceReInstance = false;
 				}
 
-				btBvhTriangleMeshShape *unscaledShape = new btBvhTriangleMeshShape(m_triangleIndexVertexArray, true, useBvh);
+				btBvhTriangleMeshShape *unscaledShape;
+				if (useBvh && m_shareBvh) {
+					// The BVH depends only on the triangles, build it once or load it from the cache.
+					unscaledShape = new btBvhTriangleMeshShape(m_triangleIndexVertexArray, true, false);
+					if (!m_optimizedBvh) {
+						m_optimizedBvh = CcdBvhCache::GetBvh(m_triangleIndexVertexArray, unscaledShape->getLocalAabbMin(),
+						                                     unscaledShape->getLocalAabbMax());
+					}
+					unscaledShape->setOptimizedBvh(m_optimizedBvh);
+				}
+				else {
+					unscaledShape = new btBvhTriangleMeshShape(m_triangleIndexVertexArray, true, useBvh);
+				}
 				unscaledShape->setMargin(margin);
 				collisionShape = new btScaledBvhTriangleMeshShape(unscaledShape, btVector3(1.0f, 1.0f, 1.0f));
 				collisionShape->setMargin(margin);
@@ -2562,6 +2609,8 @@ CcdShapeConstructionInfo::~CcdShapeConstructionInfo()
 	}
 	m_shapeArray.clear();
 
+	if (m_optimizedBvh)
+		CcdBvhCache::FreeBvh(m_optimizedBvh);
 	if (m_triangleIndexVertexArray)
 		delete m_triangleIndexVertexArray;
 	m_vertexArray.clear();
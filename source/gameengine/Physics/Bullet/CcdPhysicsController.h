@@ -44,6 +44,7 @@ class btMotionState;
 class RAS_MeshObject;
 struct DerivedMesh;
 class btCollisionShape;
+class btOptimizedBvh;
 
 #define CCD_BSB_SHAPE_MATCHING  2
 #define CCD_BSB_BENDING_CONSTRAINTS 8
@@ -78,6 +79,8 @@ public:
 		m_refCount(1),
 		m_meshObject(NULL),
 		m_triangleIndexVertexArray(NULL),
+		m_optimizedBvh(NULL),
+		m_shareBvh(true),
 		m_forceReInstance(false),
 		m_weldingThreshold1(0.0f),
 		m_shapeProxy(NULL)
@@ -208,6 +211,10 @@ protected:
 	RAS_MeshObject *m_meshObject;
 	/// The list of vertexes and indexes for the triangle mesh, shared between Bullet shape.
 	btTriangleIndexVertexArray *m_triangleIndexVertexArray;
+	/// The BVH of the triangle mesh shapes, shared between the replicas instead of built for each.
+	btOptimizedBvh *m_optimizedBvh;
+	/// False once the mesh is updated, the previous shapes still use the BVH of the previous mesh.
+	bool m_shareBvh;
 	/// for compound shapes
 	std::vector<CcdShapeConstructionInfo *> m_shapeArray;
 	///use gimpact for concave dynamic/moving collision detection
@@ -576,6 +583,11 @@ protected:
 	bool m_savedDyna;
 	bool m_suspended;
 
+	/// Index in the motion controllers of the environment, -1 if the controller is not moved by the simulation.
+	int m_motionIndex;
+	/// The body was active at the last motion state synchronization.
+	bool m_motionActive;
+
 	void GetWorldOrientation(btMatrix3x3& mat);
 
 	void CreateRigidbody();
@@ -712,6 +724,8 @@ public:
 	virtual void RefreshCollisions();
 	virtual void SuspendDynamics(bool ghost);
 	virtual void RestoreDynamics();
+	virtual void SuspendPhysics();
+	virtual void RestorePhysics();
 
 	// Shape control
 	virtual void AddCompoundChild(PHY_IPhysicsController *child);
@@ -19,6 +19,7 @@
 #include "CcdPhysicsEnvironment.h"
 #include "CcdPhysicsController.h"
 #include "CcdGraphicController.h"
+#include "CcdParallelWorld.h"
 
 #include <algorithm>
 #include "btBulletDynamicsCommon.h"
@@ -43,6 +44,7 @@
 #include "RAS_MeshObject.h"
 #include "RAS_Polygon.h"
 #include "RAS_TexVert.h"
+#include "SG_Profiler.h"
 
 #include "DNA_scene_types.h"
 #include "DNA_world_types.h"
@@ -430,7 +432,8 @@ static void DrawAabb(btIDebugDraw *debugDrawer, const btVector3& from, const btV
 }
 #endif
 
-CcdPhysicsEnvironment::CcdPhysicsEnvironment(bool useDbvtCulling, btDispatcher *dispatcher, btOverlappingPairCache *pairCache)
+CcdPhysicsEnvironment::CcdPhysicsEnvironment(bool useDbvtCulling, TaskScheduler *taskScheduler, btDispatcher *dispatcher,
+                                             btOverlappingPairCache *pairCache)
 	:m_cullingCache(NULL),
 	m_cullingTree(NULL),
 	m_numIterations(10),
@@ -454,12 +457,20 @@ CcdPhysicsEnvironment::CcdPhysicsEnvironment(bool useDbvtCulling, btDispatcher *
 		m_triggerCallbacks[i] = NULL;
 	}
 
+	btDefaultCollisionConstructionInfo constructionInfo;
+	if (taskScheduler) {
+		// The parallel convex algorithms own their simplex solver.
+		constructionInfo.m_customCollisionAlgorithmMaxElementSize = sizeof(CcdConvexConvexAlgorithm);
+	}
+
 //	m_collisionConfiguration = new btDefaultCollisionConfiguration();
-	m_collisionConfiguration = new btSoftBodyRigidBodyCollisionConfiguration();
+	m_collisionConfiguration = new btSoftBodyRigidBodyCollisionConfiguration(constructionInfo);
 	//m_collisionConfiguration->setConvexConvexMultipointIterations();
 
 	if (!dispatcher) {
-		btCollisionDispatcher *disp = new btCollisionDispatcher(m_collisionConfiguration);
+		btCollisionDispatcher *disp = taskScheduler ?
+		                              new CcdCollisionDispatcher(m_collisionConfiguration, taskScheduler) :
+		                              new btCollisionDispatcher(m_collisionConfiguration);
 		dispatcher = disp;
 		btGImpactCollisionAlgorithm::registerAlgorithm(disp);
 		m_ownDispatcher = dispatcher;
@@ -481,7 +492,12 @@ CcdPhysicsEnvironment::CcdPhysicsEnvironment(bool useDbvtCulling, btDispatcher *
 
 	SetSolverType(1);//issues with quickstep and memory allocations
 //	m_dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher,m_broadphase,m_solver,m_collisionConfiguration);
-	m_dynamicsWorld = new btSoftRigidDynamicsWorld(dispatcher, m_broadphase, m_solver, m_collisionConfiguration);
+	if (taskScheduler) {
+		m_dynamicsWorld = new CcdDynamicsWorld(dispatcher, m_broadphase, m_solver, m_collisionConfiguration, taskScheduler);
+	}
+	else {
+		m_dynamicsWorld = new btSoftRigidDynamicsWorld(dispatcher, m_broadphase, m_solver, m_collisionConfiguration);
+	}
 	m_dynamicsWorld->setInternalTickCallback(&CcdPhysicsEnvironment::StaticSimulationSubtickCallback, this);
 	//m_dynamicsWorld->getSolverInfo().m_linearSlop = 0.01f;
 	//m_dynamicsWorld->getSolverInfo().m_solverMode=	SOLVER_USE_WARMSTARTING +	SOLVER_USE_2_FRICTION_DIRECTIONS +	SOLVER_RANDMIZE_ORDER +	SOLVER_USE_FRICTION_WARMSTARTING;
@@ -526,6 +542,8 @@ void CcdPhysicsEnvironment::AddCcdPhysicsController(CcdPhysicsController *ctrl)
 		obj->setActivationState(ISLAND_SLEEPING);
 	}
 
+	UpdateMotionController(ctrl);
+
 	assert(obj->getBroadphaseHandle());
 }
 
@@ -557,6 +575,8 @@ bool CcdPhysicsEnvironment::RemoveCcdPhysicsController(CcdPhysicsController *ctr
 		return false;
 	}
 
+	RemoveMotionController(ctrl);
+
 	//also remove constraint
 	btRigidBody *body = ctrl->GetRigidBody();
 	if (body) {
@@ -632,6 +652,58 @@ void CcdPhysicsEnvironment::UpdateCcdPhysicsController(CcdPhysicsController *ctr
 	ctrl->m_cci.m_collisionFilterGroup = newCollisionGroup;
 	ctrl->m_cci.m_collisionFilterMask = newCollisionMask;
 	ctrl->m_cci.m_collisionFlags = newCollisionFlags;
+
+	// the body can be made static or dynamic
+	if (IsActiveCcdPhysicsController(ctrl)) {
+		UpdateMotionController(ctrl);
+	}
+}
+
+void CcdPhysicsEnvironment::UpdateMotionController(CcdPhysicsController *ctrl)
+{
+	btRigidBody *body = ctrl->GetRigidBody();
+	const bool moving = (ctrl->GetSoftBody() || (body && !body->isStaticObject()));
+
+	if (moving && ctrl->m_motionIndex == -1) {
+		ctrl->m_motionIndex = m_motionControllers.size();
+		// synchronize at least once
+		ctrl->m_motionActive = true;
+		m_motionControllers.push_back(ctrl);
+	}
+	else if (!moving) {
+		RemoveMotionController(ctrl);
+	}
+}
+
+void CcdPhysicsEnvironment::RemoveMotionController(CcdPhysicsController *ctrl)
+{
+	const int index = ctrl->m_motionIndex;
+	if (index == -1) {
+		return;
+	}
+
+	// swap with the last controller, the order doesn't matter
+	CcdPhysicsController *last = m_motionControllers.back();
+	m_motionControllers[index] = last;
+	last->m_motionIndex = index;
+	m_motionControllers.pop_back();
+	ctrl->m_motionIndex = -1;
+}
+
+void CcdPhysicsEnvironment::SynchronizeMotionStates(float timeStep)
+{
+	for (std::vector<CcdPhysicsController *>::iterator it = m_motionControllers.begin(), end = m_motionControllers.end();
+	     it != end; ++it)
+	{
+		CcdPhysicsController *ctrl = *it;
+		const bool active = (ctrl->GetCollisionObject()->isActive() || ctrl->GetSoftBody());
+
+		// a body deactivated during the last step was still moved by it
+		if (active || ctrl->m_motionActive) {
+			ctrl->SynchronizeMotionStates(timeStep);
+		}
+		ctrl->m_motionActive = active;
+	}
 }
 
 void CcdPhysicsEnvironment::RefreshCcdPhysicsController(CcdPhysicsController *ctrl)
@@ -714,25 +786,29 @@ void CcdPhysicsEnvironment::StaticSimulationSubtickCallback(btDynamicsWorld *wor
 
 void CcdPhysicsEnvironment::SimulationSubtickCallback(btScalar timeStep)
 {
-	std::set<CcdPhysicsController *>::iterator it;
-
-	for (it = m_controllers.begin(); it != m_controllers.end(); it++) {
-		(*it)->SimulationTick(timeStep);
+	// the velocities of sleeping bodies are null, there's nothing to clamp
+	for (std::vector<CcdPhysicsController *>::iterator it = m_motionControllers.begin(), end = m_motionControllers.end();
+	     it != end; ++it)
+	{
+		CcdPhysicsController *ctrl = *it;
+		if (ctrl->GetCollisionObject()->isActive()) {
+			ctrl->SimulationTick(timeStep);
+		}
 	}
 }
 
 bool CcdPhysicsEnvironment::ProceedDeltaTime(double curTime, float timeStep, float interval)
 {
-	std::set<CcdPhysicsController *>::iterator it;
+	SG_PROFILE_ZONE("ProceedDeltaTime");
+
 	int i;
 
 	// Update Bullet global variables.
 	gDeactivationTime = m_deactivationTime;
 	gContactBreakingThreshold = m_contactBreakingThreshold;
 
-	for (it = m_controllers.begin(); it != m_controllers.end(); it++) {
-		(*it)->SynchronizeMotionStates(timeStep);
-	}
+	/* The motion states aren't synchronized before the step: the transforms changed
+	 * by the logic are already applied to both the scene graph and the bodies. */
 
 	float subStep = timeStep / float(m_numTimeSubSteps);
 	i = m_dynamicsWorld->stepSimulation(interval, 25, subStep);//perform always a full simulation step
@@ -741,14 +817,7 @@ bool CcdPhysicsEnvironment::ProceedDeltaTime(double curTime, float timeStep, flo
 
 	ProcessFhSprings(curTime, i * subStep);
 
-	for (it = m_controllers.begin(); it != m_controllers.end(); it++) {
-		(*it)->SynchronizeMotionStates(timeStep);
-	}
-
-	//for (it=m_controllers.begin(); it!=m_controllers.end(); it++)
-	//{
-	//	(*it)->SynchronizeMotionStates(timeStep);
-	//}
+	SynchronizeMotionStates(timeStep);
 
 	for (i = 0; i < m_wrapperVehicles.size(); i++) {
 		WrapperVehicle *veh = m_wrapperVehicles[i];
@@ -1209,7 +1278,12 @@ PHY_IPhysicsController *CcdPhysicsEnvironment::RayTest(PHY_IRayCastFilterCallbac
 	rayCallback.m_flags |= btTriangleRaycastCallback::kF_UseSubSimplexConvexCastRaytest;
 	//, ,filterCallback.m_faceNormal);
 
-	m_dynamicsWorld->rayTest(rayFrom, rayTo, rayCallback);
+	if (filterCallback.m_concurrent) {
+		CcdConcurrentRayTest(static_cast<btDbvtBroadphase *>(m_broadphase), rayFrom, rayTo, rayCallback);
+	}
+	else {
+		m_dynamicsWorld->rayTest(rayFrom, rayTo, rayCallback);
+	}
 	if (rayCallback.hasHit()) {
 		CcdPhysicsController *controller = static_cast<CcdPhysicsController *>(rayCallback.m_collisionObject->getUserPointer());
 		result.m_controller = controller;
@@ -2249,8 +2323,44 @@ bool CcdPhysicsEnvironment::RequestCollisionCallback(PHY_IPhysicsController *ctr
 	return ccdCtrl->Register();
 }
 
+static bool collision_manifold_less(const CcdCollisionManifold& a, const CcdCollisionManifold& b)
+{
+	if (a.m_first != b.m_first) {
+		return a.m_first < b.m_first;
+	}
+	if (a.m_second != b.m_second) {
+		return a.m_second < b.m_second;
+	}
+	return a.m_index < b.m_index;
+}
+
+/// Copy a manifold point, the first object of the collision being the first body when swapped is false.
+static void contact_point_copy(PHY_ContactPoint& point, const btManifoldPoint& cp, bool swapped)
+{
+	const btVector3& localA = swapped ? cp.m_localPointB : cp.m_localPointA;
+	const btVector3& localB = swapped ? cp.m_localPointA : cp.m_localPointB;
+	const btVector3& world = swapped ? cp.m_positionWorldOnA : cp.m_positionWorldOnB;
+	// Bullet normal is from the second body to the first one.
+	const btVector3 normal = swapped ? cp.m_normalWorldOnB : -cp.m_normalWorldOnB;
+
+	for (unsigned short i = 0; i < 3; ++i) {
+		point.m_localPointA[i] = localA[i];
+		point.m_localPointB[i] = localB[i];
+		point.m_worldPoint[i] = world[i];
+		point.m_normal[i] = normal[i];
+	}
+	point.m_combinedFriction = cp.m_combinedFriction;
+	point.m_combinedRestitution = cp.m_combinedRestitution;
+	point.m_appliedImpulse = cp.m_appliedImpulse;
+}
+
 void CcdPhysicsEnvironment::CallbackTriggers()
 {
+	m_collisions.clear();
+	m_contactPoints.clear();
+	m_collDatas.clear();
+	m_collisionManifolds.clear();
+
 	bool draw_contact_points = m_debugDrawer && (m_debugDrawer->getDebugMode() & btIDebugDraw::DBG_DrawContactPoints);
 
 	if (!m_triggerCallbacks[PHY_OBJECT_RESPONSE] && !draw_contact_points)
@@ -2294,21 +2404,83 @@ void CcdPhysicsEnvironment::CallbackTriggers()
 			usecallback = true;
 		}
 
-		if (usecallback) {
-			const CcdCollData *coll_data = new CcdCollData(manifold);
-
-			m_triggerCallbacks[PHY_OBJECT_RESPONSE](m_triggerCallbacksUserPtrs[PHY_OBJECT_RESPONSE],
-				colliding_ctrl0 ? ctrl0 : ctrl1, colliding_ctrl0 ? ctrl1 : ctrl0, coll_data);
+		if (usecallback && m_triggerCallbacks[PHY_OBJECT_RESPONSE]) {
+			// The contact points are copied once all the manifolds of the pair are known.
+			CcdCollisionManifold collManifold;
+			collManifold.m_first = colliding_ctrl0 ? ctrl0 : ctrl1;
+			collManifold.m_second = colliding_ctrl0 ? ctrl1 : ctrl0;
+			collManifold.m_manifold = manifold;
+			collManifold.m_index = i;
+			collManifold.m_swapped = !colliding_ctrl0;
+			m_collisionManifolds.push_back(collManifold);
 		}
 		// Bullet does not refresh the manifold contact point for object without contact response
 		// may need to remove this when a newer Bullet version is integrated
-		if (!dispatcher->needsResponse(rb0, rb1)) {
+		else if (!dispatcher->needsResponse(rb0, rb1)) {
 			// Refresh algorithm fails sometimes when there is penetration
 			// (usuall the case with ghost and sensor objects)
 			// Let's just clear the manifold, in any case, it is recomputed on each frame.
 			manifold->clearManifold(); //refreshContactPoints(rb0->getCenterOfMassTransform(),rb1->getCenterOfMassTransform());
 		}
 	}
+
+	if (m_collisionManifolds.empty()) {
+		return;
+	}
+
+	/* Merge the manifolds of a same pair (e.g compound shapes) in one collision,
+	 * the callbacks are called once per pair with all its contact points. */
+	std::sort(m_collisionManifolds.begin(), m_collisionManifolds.end(), collision_manifold_less);
+
+	for (std::vector<CcdCollisionManifold>::iterator it = m_collisionManifolds.begin(), end = m_collisionManifolds.end();
+	     it != end; ++it)
+	{
+		const CcdCollisionManifold& collManifold = *it;
+		btPersistentManifold *manifold = collManifold.m_manifold;
+
+		if (m_collisions.empty() || m_collisions.back().m_first != collManifold.m_first ||
+		    m_collisions.back().m_second != collManifold.m_second)
+		{
+			PHY_Collision collision;
+			collision.m_first = collManifold.m_first;
+			collision.m_second = collManifold.m_second;
+			collision.m_firstPoint = m_contactPoints.size();
+			collision.m_numPoints = 0;
+			m_collisions.push_back(collision);
+		}
+
+		const int numContacts = manifold->getNumContacts();
+		for (int j = 0; j < numContacts; ++j) {
+			m_contactPoints.push_back(PHY_ContactPoint());
+			contact_point_copy(m_contactPoints.back(), manifold->getContactPoint(j), collManifold.m_swapped);
+		}
+		m_collisions.back().m_numPoints += numContacts;
+
+		// The contact points are copied, the manifold can be cleared, see above.
+		if (!dispatcher->needsResponse(manifold->getBody0(), manifold->getBody1())) {
+			manifold->clearManifold();
+		}
+	}
+
+	// The contact buffer is complete, its points can be referenced.
+	for (std::vector<PHY_Collision>::const_iterator it = m_collisions.begin(), end = m_collisions.end(); it != end; ++it) {
+		m_collDatas.push_back(CcdCollData(&m_contactPoints[it->m_firstPoint], it->m_numPoints));
+	}
+
+	for (unsigned int i = 0, size = m_collisions.size(); i < size; ++i) {
+		const PHY_Collision& collision = m_collisions[i];
+		m_triggerCallbacks[PHY_OBJECT_RESPONSE](m_triggerCallbacksUserPtrs[PHY_OBJECT_RESPONSE],
+			collision.m_first, collision.m_second, &m_collDatas[i]);
+	}
+}
+
+void CcdPhysicsEnvironment::GetCollisions(const PHY_Collision *& collisions, unsigned int& numCollisions,
+                                          const PHY_ContactPoint *& points, unsigned int& numPoints)
+{
+	numCollisions = m_collisions.size();
+	collisions = (numCollisions > 0) ? &m_collisions.front() : NULL;
+	numPoints = m_contactPoints.size();
+	points = (numPoints > 0) ? &m_contactPoints.front() : NULL;
 }
 
 // This call back is called before a pair is added in the cache
@@ -2898,7 +3070,9 @@ struct BlenderDebugDraw : public btIDebugDraw
 
 CcdPhysicsEnvironment *CcdPhysicsEnvironment::Create(Scene *blenderscene, bool visualizePhysics)
 {
-	CcdPhysicsEnvironment *ccdPhysEnv = new CcdPhysicsEnvironment((blenderscene->gm.mode & WO_DBVT_CULLING) != 0);
+	TaskScheduler *taskScheduler = (blenderscene->gm.flag & GAME_USE_PARALLEL_PHYSICS) ?
+	                               KX_GetActiveEngine()->GetTaskScheduler() : NULL;
+	CcdPhysicsEnvironment *ccdPhysEnv = new CcdPhysicsEnvironment((blenderscene->gm.mode & WO_DBVT_CULLING) != 0, taskScheduler);
 	ccdPhysEnv->SetDebugDrawer(new BlenderDebugDraw());
 	ccdPhysEnv->SetDeactivationLinearTreshold(blenderscene->gm.lineardeactthreshold);
 	ccdPhysEnv->SetDeactivationAngularTreshold(blenderscene->gm.angulardeactthreshold);
@@ -3431,8 +3605,9 @@ void CcdPhysicsEnvironment::SetupObjectConstraints(KX_GameObject *obj_src, KX_Ga
 	}
 }
 
-CcdCollData::CcdCollData(const btPersistentManifold *manifoldPoint)
-	:m_manifoldPoint(manifoldPoint)
+CcdCollData::CcdCollData(const PHY_ContactPoint *points, unsigned int numPoints)
+	:m_points(points),
+	m_numPoints(numPoints)
 {
 }
 
@@ -3442,47 +3617,45 @@ CcdCollData::~CcdCollData()
 
 unsigned int CcdCollData::GetNumContacts() const
 {
-	return m_manifoldPoint->getNumContacts();
+	return m_numPoints;
 }
 
 MT_Vector3 CcdCollData::GetLocalPointA(unsigned int index, bool first) const
 {
-	const btManifoldPoint& point = m_manifoldPoint->getContactPoint(index);
-	return MT_Vector3(first ? point.m_localPointA.m_floats : point.m_localPointB.m_floats);
+	const PHY_ContactPoint& point = m_points[index];
+	return MT_Vector3(first ? point.m_localPointA : point.m_localPointB);
 }
 
 MT_Vector3 CcdCollData::GetLocalPointB(unsigned int index, bool first) const
 {
-	const btManifoldPoint& point = m_manifoldPoint->getContactPoint(index);
-	return MT_Vector3(first ? point.m_localPointB.m_floats : point.m_localPointA.m_floats);
+	const PHY_ContactPoint& point = m_points[index];
+	return MT_Vector3(first ? point.m_localPointB : point.m_localPointA);
 }
 
 MT_Vector3 CcdCollData::GetWorldPoint(unsigned int index, bool first) const
 {
-	const btManifoldPoint& point = m_manifoldPoint->getContactPoint(index);
-	return MT_Vector3(point.m_positionWorldOnB.m_floats);
+	const PHY_ContactPoint& point = m_points[index];
+	return MT_Vector3(point.m_worldPoint);
 }
 
 MT_Vector3 CcdCollData::GetNormal(unsigned int index, bool first) const
 {
-	const btManifoldPoint& point = m_manifoldPoint->getContactPoint(index);
-	return MT_Vector3(first ? (-point.m_normalWorldOnB).m_floats : point.m_normalWorldOnB.m_floats);
+	const PHY_ContactPoint& point = m_points[index];
+	const MT_Vector3 normal(point.m_normal);
+	return first ? normal : -normal;
 }
 
 float CcdCollData::GetCombinedFriction(unsigned int index, bool first) const
 {
-	const btManifoldPoint& point = m_manifoldPoint->getContactPoint(index);
-	return point.m_combinedFriction;
+	return m_points[index].m_combinedFriction;
 }
 
 float CcdCollData::GetCombinedRestitution(unsigned int index, bool first) const
 {
-	const btManifoldPoint& point = m_manifoldPoint->getContactPoint(index);
-	return point.m_combinedRestitution;
+	return m_points[index].m_combinedRestitution;
 }
 
 float CcdCollData::GetAppliedImpulse(unsigned int index, bool first) const
 {
-	const btManifoldPoint& point = m_manifoldPoint->getContactPoint(index);
-	return point.m_appliedImpulse;
+	return m_points[index].m_appliedImpulse;
 }
@@ -53,6 +53,39 @@ class btDynamicsWorld;
 class PHY_IVehicle;
 class CcdOverlapFilterCallBack;
 class CcdShapeConstructionInfo;
+struct TaskScheduler;
+
+/// Manifold of a collision reported to the collision callbacks.
+struct CcdCollisionManifold
+{
+	/// The controller registered for the callbacks.
+	CcdPhysicsController *m_first;
+	CcdPhysicsController *m_second;
+	btPersistentManifold *m_manifold;
+	/// Index of the manifold in the dispatcher, keeps the merged contact points in a stable order.
+	int m_index;
+	/// The first controller is the second body of the manifold.
+	bool m_swapped;
+};
+
+/// Contact points of a collision, stored in the contact buffer of the environment.
+class CcdCollData : public PHY_CollData
+{
+	const PHY_ContactPoint *m_points;
+	unsigned int m_numPoints;
+public:
+	CcdCollData(const PHY_ContactPoint *points, unsigned int numPoints);
+	virtual ~CcdCollData();
+
+	virtual unsigned int GetNumContacts() const;
+	virtual MT_Vector3 GetLocalPointA(unsigned int index, bool first) const;
+	virtual MT_Vector3 GetLocalPointB(unsigned int index, bool first) const;
+	virtual MT_Vector3 GetWorldPoint(unsigned int index, bool first) const;
+	virtual MT_Vector3 GetNormal(unsigned int index, bool first) const;
+	virtual float GetCombinedFriction(unsigned int index, bool first) const;
+	virtual float GetCombinedRestitution(unsigned int index, bool first) const;
+	virtual float GetAppliedImpulse(unsigned int index, bool first) const;
+};
 
 /** CcdPhysicsEnvironment is an experimental mainloop for physics simulation using optional continuous collision detection.
  * Physics Environment takes care of stepping the simulation and is a container for physics entities.
@@ -96,8 +129,18 @@ protected:
 
 	void ProcessFhSprings(double curTime, float timeStep);
 
+	/// Add or remove the controller from the motion controllers depending on its body.
+	void UpdateMotionController(CcdPhysicsController *ctrl);
+	void RemoveMotionController(CcdPhysicsController *ctrl);
+	/// Synchronize the motion states of the active motion controllers and the ones deactivated since the last call.
+	void SynchronizeMotionStates(float timeStep);
+
 public:
-	CcdPhysicsEnvironment(bool useDbvtCulling, btDispatcher *dispatcher = NULL, btOverlappingPairCache *pairCache = NULL);
+	/** \param taskScheduler When not NULL, the narrowphase and the islands solving
+	 * are processed over this scheduler, see CcdParallelWorld.h.
+	 */
+	CcdPhysicsEnvironment(bool useDbvtCulling, TaskScheduler *taskScheduler = NULL, btDispatcher *dispatcher = NULL,
+	                      btOverlappingPairCache *pairCache = NULL);
 
 	virtual ~CcdPhysicsEnvironment();
 
@@ -216,6 +259,8 @@ public:
 	virtual void AddTouchCallback(int response_class, PHY_ResponseCallback callback, void *user);
 	virtual bool RequestCollisionCallback(PHY_IPhysicsController *ctrl);
 	virtual bool RemoveCollisionCallback(PHY_IPhysicsController *ctrl);
+	virtual void GetCollisions(const PHY_Collision *& collisions, unsigned int& numCollisions,
+	                           const PHY_ContactPoint *& points, unsigned int& numPoints);
 	//These two methods are used *solely* to create controllers for Near/Radar sensor! Don't use for anything else
 	virtual PHY_IPhysicsController *CreateSphereController(float radius, const MT_Vector3& position);
 	virtual PHY_IPhysicsController *CreateConeController(float coneradius, float coneheight);
@@ -300,10 +345,23 @@ public:
 
 protected:
 	std::set<CcdPhysicsController *> m_controllers;
+	/** Controllers moved by the simulation: non static rigid bodies and soft bodies.
+	 * Contiguous as it is iterated every sub step, static objects are never visited.
+	 */
+	std::vector<CcdPhysicsController *> m_motionControllers;
 
 	PHY_ResponseCallback m_triggerCallbacks[PHY_NUM_RESPONSE];
 	void *m_triggerCallbacksUserPtrs[PHY_NUM_RESPONSE];
 
+	/** Collisions of the last step and their contact points, cleared at each step
+	 * without releasing their memory: reporting the collisions doesn't allocate.
+	 */
+	std::vector<PHY_Collision> m_collisions;
+	std::vector<PHY_ContactPoint> m_contactPoints;
+	std::vector<CcdCollData> m_collDatas;
+	/// Manifolds reported by CallbackTriggers, sorted to merge the manifolds of a same pair.
+	std::vector<CcdCollisionManifold> m_collisionManifolds;
+
 	std::vector<WrapperVehicle *>    m_wrapperVehicles;
 
 	/** use explicit btSoftRigidDynamicsWorld/btDiscreteDynamicsWorld* so that we have access to
@@ -334,21 +392,4 @@ protected:
 #endif
 };
 
-class CcdCollData : public PHY_CollData
-{
-	const btPersistentManifold *m_manifoldPoint;
-public:
-	CcdCollData(const btPersistentManifold *manifoldPoint);
-	virtual ~CcdCollData();
-
-	virtual unsigned int GetNumContacts() const;
-	virtual MT_Vector3 GetLocalPointA(unsigned int index, bool first) const;
-	virtual MT_Vector3 GetLocalPointB(unsigned int index, bool first) const;
-	virtual MT_Vector3 GetWorldPoint(unsigned int index, bool first) const;
-	virtual MT_Vector3 GetNormal(unsigned int index, bool first) const;
-	virtual float GetCombinedFriction(unsigned int index, bool first) const;
-	virtual float GetCombinedRestitution(unsigned int index, bool first) const;
-	virtual float GetAppliedImpulse(unsigned int index, bool first) const;
-};
-
 #endif  /* __CCDPHYSICSENVIRONMENT_H__ */
@@ -36,6 +36,30 @@ enum
 	PHY_NUM_RESPONSE
 };
 
+/// Contact point of a collision, made of floats only to be exposed as a buffer.
+struct PHY_ContactPoint
+{
+	/// Contact point in the local space of the first and the second object.
+	float m_localPointA[3];
+	float m_localPointB[3];
+	/// Contact point in world space, on the surface of the second object.
+	float m_worldPoint[3];
+	/// Contact normal in world space, from the first object to the second one.
+	float m_normal[3];
+	float m_combinedFriction;
+	float m_combinedRestitution;
+	float m_appliedImpulse;
+};
+
+/// Collision between two objects during a physics step, its contact points are contiguous.
+struct PHY_Collision
+{
+	class PHY_IPhysicsController *m_first;
+	class PHY_IPhysicsController *m_second;
+	unsigned int m_firstPoint;
+	unsigned int m_numPoints;
+};
+
 class PHY_CollData
 {
 public:
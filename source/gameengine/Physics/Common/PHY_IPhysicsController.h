@@ -100,6 +100,10 @@ public:
 	virtual void RefreshCollisions() = 0;
 	virtual void SuspendDynamics(bool ghost = false) = 0;
 	virtual void RestoreDynamics() = 0;
+	/// Remove the controller from the physics world without freeing it, constraints are removed.
+	virtual void SuspendPhysics() = 0;
+	/// Add back a controller removed by #SuspendPhysics, at its current transform.
+	virtual void RestorePhysics() = 0;
 
 	virtual void SetActive(bool active) = 0;
 
@@ -80,6 +80,8 @@ public:
 	PHY_IPhysicsController *m_ignoreController;
 	bool m_faceNormal;
 	bool m_faceUV;
+	/// The ray test can run at the same time than other ones from other threads.
+	bool m_concurrent;
 
 	virtual ~PHY_IRayCastFilterCallback()
 	{
@@ -95,7 +97,8 @@ public:
 	PHY_IRayCastFilterCallback(PHY_IPhysicsController *ignoreController, bool faceNormal = false, bool faceUV = false)
 		: m_ignoreController(ignoreController),
 		m_faceNormal(faceNormal),
-		m_faceUV(faceUV)
+		m_faceUV(faceUV),
+		m_concurrent(false)
 	{
 	}
 
@@ -224,6 +227,17 @@ public:
 	virtual void AddTouchCallback(int response_class, PHY_ResponseCallback callback, void *user) = 0;
 	virtual bool RequestCollisionCallback(PHY_IPhysicsController *ctrl) = 0;
 	virtual bool RemoveCollisionCallback(PHY_IPhysicsController *ctrl) = 0;
+	/** Return the collisions of the objects using collision callbacks during the last step,
+	 * with all their contact points in a single buffer. Valid until the next step.
+	 */
+	virtual void GetCollisions(const PHY_Collision *& collisions, unsigned int& numCollisions,
+	                           const PHY_ContactPoint *& points, unsigned int& numPoints)
+	{
+		collisions = NULL;
+		numCollisions = 0;
+		points = NULL;
+		numPoints = 0;
+	}
 	//These two methods are *solely* used to create controllers for sensor! Don't use for anything else
 	virtual PHY_IPhysicsController *CreateSphereController(float radius, const MT_Vector3& position) = 0;
 	virtual PHY_IPhysicsController *CreateConeController(float coneradius, float coneheight) = 0;
@@ -40,10 +40,23 @@
 #include "RAS_Polygon.h"
 #include "RAS_IPolygonMaterial.h"
 #include "RAS_IRasterizer.h"
+#include "RAS_IStorage.h"
+#include "RAS_DisplayArray.h"
 
 #include "RAS_BucketManager.h"
 
+#include "SG_Profiler.h"
+
+#include "BLI_task.h"
+#include "BLI_sort_utils.h"
+
 #include <algorithm>
+
+/* Mesh slots whose sort key is computed by a single task. */
+#define SORT_KEY_CHUNK_SIZE 1024
+/* Below this amount of mesh slots, the keys are computed without threading. */
+#define SORT_KEY_THREADED_MIN (SORT_KEY_CHUNK_SIZE * 4)
+
 /* sorting */
 
 void RAS_BucketManager::sortedmeshslot::set(RAS_MeshSlot *ms, RAS_MaterialBucket *bucket, const MT_Vector3& pnorm)
@@ -69,6 +82,10 @@ bool RAS_BucketManager::fronttoback::operator()(const sortedmeshslot &a, const s
 
 RAS_BucketManager::RAS_BucketManager()
 {
+	for (unsigned short i = 0; i < NUM_BUCKET_TYPE; ++i) {
+		m_numActiveMeshSlots[i] = 0;
+		m_numActiveMeshSlotsValid[i] = false;
+	}
 }
 
 RAS_BucketManager::~RAS_BucketManager()
@@ -82,18 +99,55 @@ RAS_BucketManager::~RAS_BucketManager()
 
 unsigned int RAS_BucketManager::GetNumActiveMeshSlots(BucketType bucketType)
 {
+	if (m_numActiveMeshSlotsValid[bucketType]) {
+		return m_numActiveMeshSlots[bucketType];
+	}
+
 	unsigned int count = 0;
 	BucketList& buckets = m_buckets[bucketType];
 	for (BucketList::iterator it = buckets.begin(), end = buckets.end(); it != end; ++it) {
 		count += (*it)->GetNumActiveMeshSlots();
 	}
+
+	m_numActiveMeshSlots[bucketType] = count;
+	m_numActiveMeshSlotsValid[bucketType] = true;
 	return count;
 }
 
+struct SortKeyData
+{
+	RAS_BucketManager::sortedmeshslot *m_slots;
+	uint64_t *m_keys;
+	unsigned int m_size;
+	const MT_Vector3 *m_pnorm;
+	bool m_alpha;
+};
+
+static void sort_key_chunk_func(void *userdata, const int iter)
+{
+	SortKeyData *data = (SortKeyData *)userdata;
+	const unsigned int start = iter * SORT_KEY_CHUNK_SIZE;
+	const unsigned int end = std::min(start + SORT_KEY_CHUNK_SIZE, data->m_size);
+
+	for (unsigned int i = start; i < end; ++i) {
+		RAS_BucketManager::sortedmeshslot& slot = data->m_slots[i];
+		slot.set(slot.m_ms, slot.m_bucket, *data->m_pnorm);
+
+		// Back to front is the increasing depth, front to back reverses the depth bits.
+		unsigned int depth = BLI_sortutil_float_as_key(slot.m_z);
+		if (!data->m_alpha) {
+			depth = ~depth;
+		}
+		data->m_keys[i] |= ((uint64_t)depth) << 32;
+	}
+}
+
 void RAS_BucketManager::OrderBuckets(const MT_Transform& cameratrans, RAS_BucketManager::BucketType bucketType,
-                                     std::vector<sortedmeshslot>& slots, bool alpha, RAS_IRasterizer *rasty)
+                                     bool alpha, RAS_IRasterizer *rasty)
 {
-	size_t i = 0;
+	SG_PROFILE_ZONE("OrderBuckets");
+
+	unsigned int i = 0;
 
 	/* Camera's near plane equation: pnorm.dot(point) + pval,
 	 * but we leave out pval since it's constant anyway */
@@ -101,16 +155,25 @@ void RAS_BucketManager::OrderBuckets(const MT_Transform& cameratrans, RAS_Bucket
 
 	const unsigned int size = GetNumActiveMeshSlots(bucketType);
 
-	slots.resize(size);
+	// Resizing keeps the capacity of the buffers, they are allocated only when the scene grows.
+	m_sortedMeshSlots.resize(size);
+	m_sortKeys.resize(size);
+	m_sortKeysTmp.resize(size);
+	m_sortIndices.resize(size);
+	m_sortIndicesTmp.resize(size);
+
+	if (size == 0) {
+		return;
+	}
 
 	BucketList& buckets = m_buckets[bucketType];
 
-	for (BucketList::iterator bit = buckets.begin(); bit != buckets.end(); ++bit)
-	{
-		RAS_MaterialBucket *bucket = *bit;
-		RAS_DisplayArrayBucketList& displayArrayBucketList = (*bit)->GetDisplayArrayBucketList();
+	for (unsigned int bucketIndex = 0, numBuckets = buckets.size(); bucketIndex < numBuckets; ++bucketIndex) {
+		RAS_MaterialBucket *bucket = buckets[bucketIndex];
+		RAS_DisplayArrayBucketList& displayArrayBucketList = bucket->GetDisplayArrayBucketList();
+		unsigned int displayArrayIndex = 0;
 		for (RAS_DisplayArrayBucketList::iterator dbit = displayArrayBucketList.begin(), dbend = displayArrayBucketList.end();
-		     dbit != dbend; ++dbit)
+		     dbit != dbend; ++dbit, ++displayArrayIndex)
 		{
 			RAS_DisplayArrayBucket *displayArrayBucket = *dbit;
 			RAS_MeshSlotList& activeMeshSlots = displayArrayBucket->GetActiveMeshSlots();
@@ -118,25 +181,39 @@ void RAS_BucketManager::OrderBuckets(const MT_Transform& cameratrans, RAS_Bucket
 			// Update deformer and render settings.
 			displayArrayBucket->UpdateActiveMeshSlots(rasty);
 
+			/* Slots at the same depth are grouped by material and display array to avoid state changes,
+			 * the depth is added by the key computation. */
+			const uint64_t group = ((uint64_t)std::min(bucketIndex, 0xFFFFu) << 16) | std::min(displayArrayIndex, 0xFFFFu);
+
 			for (RAS_MeshSlotList::iterator it = activeMeshSlots.begin(), end = activeMeshSlots.end(); it != end; ++it) {
-				slots[i++].set(*it, bucket, pnorm);
+				sortedmeshslot& slot = m_sortedMeshSlots[i];
+				slot.m_ms = *it;
+				slot.m_bucket = bucket;
+				m_sortKeys[i] = group;
+				m_sortIndices[i] = i;
+				++i;
 			}
 			displayArrayBucket->RemoveActiveMeshSlots();
 		}
 	}
 
-	if (alpha)
-		sort(slots.begin(), slots.end(), backtofront());
-	else
-		sort(slots.begin(), slots.end(), fronttoback());
+	// The depths only read the mesh slot matrices, they are computed in parallel.
+	SortKeyData data;
+	data.m_slots = &m_sortedMeshSlots[0];
+	data.m_keys = &m_sortKeys[0];
+	data.m_size = size;
+	data.m_pnorm = &pnorm;
+	data.m_alpha = alpha;
+
+	const unsigned int numChunks = (size + SORT_KEY_CHUNK_SIZE - 1) / SORT_KEY_CHUNK_SIZE;
+	BLI_task_parallel_range(0, numChunks, &data, sort_key_chunk_func, size >= SORT_KEY_THREADED_MIN);
+
+	BLI_sortutil_radix_u64(&m_sortKeys[0], &m_sortIndices[0], &m_sortKeysTmp[0], &m_sortIndicesTmp[0], size);
 }
 
 void RAS_BucketManager::RenderSortedBuckets(const MT_Transform& cameratrans, RAS_IRasterizer *rasty, RAS_BucketManager::BucketType bucketType)
 {
-	std::vector<sortedmeshslot> slots;
-	std::vector<sortedmeshslot>::iterator sit;
-
-	OrderBuckets(cameratrans, bucketType, slots, true, rasty);
+	OrderBuckets(cameratrans, bucketType, true, rasty);
 
 	// The last display array and material bucket used to avoid double calls.
 	RAS_DisplayArrayBucket *lastDisplayArrayBucket = NULL;
@@ -144,9 +221,10 @@ void RAS_BucketManager::RenderSortedBuckets(const MT_Transform& cameratrans, RAS
 
 	bool matactivated = false;
 
-	for (sit = slots.begin(); sit != slots.end(); ++sit) {
-		RAS_MaterialBucket *bucket = sit->m_bucket;
-		RAS_DisplayArrayBucket *displayArrayBucket = sit->m_ms->m_displayArrayBucket;
+	for (std::vector<unsigned int>::iterator sit = m_sortIndices.begin(), send = m_sortIndices.end(); sit != send; ++sit) {
+		const sortedmeshslot& slot = m_sortedMeshSlots[*sit];
+		RAS_MaterialBucket *bucket = slot.m_bucket;
+		RAS_DisplayArrayBucket *displayArrayBucket = slot.m_ms->m_displayArrayBucket;
 
 		/* Unbind display array here before unset material to use the proper
 		 * number of attributs in RAS_IStorage::Unbind since this variable is
@@ -171,7 +249,7 @@ void RAS_BucketManager::RenderSortedBuckets(const MT_Transform& cameratrans, RAS
 			lastDisplayArrayBucket = displayArrayBucket;
 		}
 
-		bucket->RenderMeshSlot(cameratrans, rasty, sit->m_ms);
+		bucket->RenderMeshSlot(cameratrans, rasty, slot.m_ms);
 	}
 
 	// Always unbind VBO or VA before unset the material to use the correct material attributs.
@@ -193,6 +271,13 @@ void RAS_BucketManager::RenderBasicBuckets(const MT_Transform& cameratrans, RAS_
 
 void RAS_BucketManager::Renderbuckets(const MT_Transform& cameratrans, RAS_IRasterizer *rasty)
 {
+	SG_PROFILE_ZONE("Renderbuckets");
+
+	// The active mesh slots changed since the last render, the counts are computed again on demand.
+	for (unsigned short i = 0; i < NUM_BUCKET_TYPE; ++i) {
+		m_numActiveMeshSlotsValid[i] = false;
+	}
+
 	switch (rasty->GetDrawingMode()) {
 		case RAS_IRasterizer::RAS_SHADOW:
 		{
@@ -354,6 +439,29 @@ void RAS_BucketManager::ReleaseDisplayLists(RAS_IPolyMaterial *mat)
 	}
 }
 
+void RAS_BucketManager::GetVertexMemorySize(unsigned int& storageSize, unsigned int& savedSize)
+{
+	storageSize = 0;
+	savedSize = 0;
+
+	BucketList& buckets = m_buckets[ALL_BUCKET];
+	for (BucketList::iterator it = buckets.begin(), end = buckets.end(); it != end; ++it) {
+		RAS_DisplayArrayBucketList& displayArrayBucketList = (*it)->GetDisplayArrayBucketList();
+		for (RAS_DisplayArrayBucketList::iterator dit = displayArrayBucketList.begin(), dend = displayArrayBucketList.end();
+		     dit != dend; ++dit)
+		{
+			RAS_IStorageInfo *storageInfo = (*dit)->GetStorageInfo();
+			const unsigned int size = storageInfo ? storageInfo->GetVertexMemorySize() : 0;
+			if (size == 0) {
+				continue;
+			}
+
+			storageSize += size;
+			savedSize += (*dit)->GetDisplayArray()->m_vertex.size() * sizeof(RAS_TexVert) - size;
+		}
+	}
+}
+
 void RAS_BucketManager::ReleaseMaterials(RAS_IPolyMaterial *mat)
 {
 	BucketList& buckets = m_buckets[ALL_BUCKET];
@@ -35,6 +35,8 @@
 #include "MT_Transform.h"
 #include "RAS_MaterialBucket.h"
 
+#include "BLI_sys_types.h"
+
 #include <vector>
 
 class SCA_IScene;
@@ -78,6 +80,22 @@ protected:
 
 	BucketList m_buckets[NUM_BUCKET_TYPE];
 
+	/** Number of active mesh slots of each bucket type, computed once per Renderbuckets call
+	 * and valid until the buckets of this type are rendered.
+	 */
+	unsigned int m_numActiveMeshSlots[NUM_BUCKET_TYPE];
+	bool m_numActiveMeshSlotsValid[NUM_BUCKET_TYPE];
+
+	/** The mesh slots of sorted buckets and their sort keys and indices, kept between frames
+	 * to not allocate them for each render.
+	 * A sort key is made of the depth, the material bucket index and the display array bucket index.
+	 */
+	std::vector<sortedmeshslot> m_sortedMeshSlots;
+	std::vector<uint64_t> m_sortKeys;
+	std::vector<uint64_t> m_sortKeysTmp;
+	std::vector<unsigned int> m_sortIndices;
+	std::vector<unsigned int> m_sortIndicesTmp;
+
 public:
 	RAS_BucketManager();
 	virtual ~RAS_BucketManager();
@@ -89,6 +107,12 @@ public:
 	void ReleaseDisplayLists(RAS_IPolyMaterial *material = NULL);
 	void ReleaseMaterials(RAS_IPolyMaterial *material = NULL);
 
+	/**
+	 * Return the size of the vertices copied by the storage (e.g VBO) and the size
+	 * saved by the storage vertex formats compared to full RAS_TexVert copies.
+	 */
+	void GetVertexMemorySize(unsigned int& storageSize, unsigned int& savedSize);
+
 	// freeing scenes only
 	void RemoveMaterial(RAS_IPolyMaterial *mat);
 
@@ -101,8 +125,9 @@ public:
 
 private:
 	unsigned int GetNumActiveMeshSlots(BucketType bucketType);
+	/// Fill m_sortIndices with the indices of the mesh slots in m_sortedMeshSlots sorted by depth.
 	void OrderBuckets(const MT_Transform& cameratrans, RAS_BucketManager::BucketType bucketType,
-	                  std::vector<sortedmeshslot>& slots, bool alpha, RAS_IRasterizer *rasty);
+	                  bool alpha, RAS_IRasterizer *rasty);
 
 	void RenderBasicBuckets(const MT_Transform& cameratrans, RAS_IRasterizer *rasty, BucketType bucketType);
 	void RenderSortedBuckets(const MT_Transform& cameratrans, RAS_IRasterizer *rasty, BucketType bucketType);
@@ -292,11 +292,11 @@ void RAS_DisplayArrayBucket::RenderMeshSlotsInstancing(const MT_Transform& camer
 		}
 
 		// Fill the buffer with the sorted mesh slots.
-		m_instancingBuffer->Update(rasty, material->GetDrawingMode(), meshSlots);
+		m_instancingBuffer->Update(rasty, material->GetDrawingMode(), meshSlots, true);
 	}
 	else {
 		// Fill the buffer with the original mesh slots.
-		m_instancingBuffer->Update(rasty, material->GetDrawingMode(), m_activeMeshSlots);
+		m_instancingBuffer->Update(rasty, material->GetDrawingMode(), m_activeMeshSlots, false);
 	}
 
 	// Bind all vertex attributs for the used material and the given buffer offset.
@@ -81,6 +81,8 @@ public:
 
 	bool m_staticShadow;
 	bool m_requestShadowUpdate;
+	/// Draw the static shadow casters once in a cache, only the moving casters are drawn each frame.
+	bool m_cachedShadow;
 
 	virtual ~RAS_ILightObject() {}
 	virtual RAS_ILightObject* Clone() = 0;
@@ -90,8 +92,16 @@ public:
 	virtual int GetShadowBindCode() = 0;
 	virtual MT_Matrix4x4 GetShadowMatrix() = 0;
 	virtual int GetShadowLayer() = 0;
-	virtual void BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam, MT_Transform& camtrans) = 0;
+	/// Set the view and projection of the shadow buffer to cam, camtrans is the camera to world transform.
+	virtual void UpdateShadowCamera(KX_Camera *cam, MT_Transform& camtrans) = 0;
+	/// Bind the shadow buffer and set the rasterizer matrices of cam, updated by UpdateShadowCamera.
+	virtual void BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam) = 0;
 	virtual void UnbindShadowBuffer() = 0;
+	/// Create the shadow cache, return false if the shadow buffer type can't be cached.
+	virtual bool CreateShadowCache() = 0;
+	/// Copy the bound shadow buffer into the cache and the cache back into the bound shadow buffer.
+	virtual void StoreShadowCache() = 0;
+	virtual void RestoreShadowCache() = 0;
 	virtual Image *GetTextureImage(short texslot) = 0;
 	virtual void Update() = 0;
 };
@@ -54,6 +54,12 @@ public:
 	virtual void SetMeshModified(RAS_IRasterizer::DrawType drawType, bool modified)
 	{
 	}
+
+	/// Return the size in bytes of the vertices copied by the storage, 0 when not copied.
+	virtual unsigned int GetVertexMemorySize() const
+	{
+		return 0;
+	}
 };
 
 class RAS_IStorage
@@ -28,14 +28,30 @@
 
 #include "RAS_InstancingBuffer.h"
 #include "RAS_IRasterizer.h"
+#include "RAS_IPolygonMaterial.h"
 #include "RAS_MeshUser.h"
 #include "glew-mx.h"
 
+#include <algorithm>
+#include <string.h>
+
+/* Dirty instances separated by less clean instances than this are uploaded in a single range,
+ * uploading a few unchanged instances is cheaper than an additional call. */
+#define INSTANCING_RANGE_GAP 16
+
+// Position of an instance not yet placed in the VBO.
+#define INSTANCING_NO_POSITION ((unsigned int)-1)
+
+unsigned int RAS_InstancingBuffer::s_uploadedSize = 0;
+unsigned int RAS_InstancingBuffer::s_instancesSize = 0;
+
 RAS_InstancingBuffer::RAS_InstancingBuffer()
 	:m_matrixOffset(NULL),
 	m_positionOffset(NULL),
 	m_colorOffset(NULL),
-	m_stride(sizeof(RAS_InstancingBuffer::InstancingObject))
+	m_stride(sizeof(RAS_InstancingBuffer::InstancingObject)),
+	m_capacity(0),
+	m_updateId(0)
 {
 	glGenBuffersARB(1, &m_vbo);
 
@@ -59,36 +75,182 @@ void RAS_InstancingBuffer::Unbind()
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void RAS_InstancingBuffer::Update(RAS_IRasterizer *rasty, int drawingmode, RAS_MeshSlotList &meshSlots)
+void RAS_InstancingBuffer::UploadRange(unsigned int start, unsigned int end)
+{
+	const unsigned int size = sizeof(InstancingObject) * (end - start);
+	glBufferSubData(GL_ARRAY_BUFFER, sizeof(InstancingObject) * start, size, &m_instances[start]);
+	s_uploadedSize += size;
+}
+
+void RAS_InstancingBuffer::Update(RAS_IRasterizer *rasty, int drawingmode, RAS_MeshSlotList &meshSlots, bool sorted)
 {
-	glBufferData(GL_ARRAY_BUFFER, sizeof(InstancingObject) * meshSlots.size(), 0, GL_DYNAMIC_DRAW);
-	InstancingObject *buffer = (InstancingObject *)glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+	const unsigned int size = meshSlots.size();
+	const unsigned int prevsize = m_instances.size();
+	bool reallocated = false;
+
+	// Grow the VBO only when needed, its previous content is lost.
+	if (size > m_capacity) {
+		m_capacity = std::max(size, m_capacity * 2);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(InstancingObject) * m_capacity, NULL, GL_DYNAMIC_DRAW);
+		reallocated = true;
+	}
+
+	m_instances.resize(size);
+	s_instancesSize += sizeof(InstancingObject) * size;
+
+	// Find the entry of each mesh slot, the entries of the mesh slots not drawn anymore are removed.
+	++m_updateId;
+	m_slotEntries.resize(size);
+	for (unsigned int i = 0; i < size; ++i) {
+		std::map<RAS_MeshSlot *, InstanceEntry>::iterator it = m_entries.find(meshSlots[i]);
+		if (it == m_entries.end()) {
+			it = m_entries.insert(std::make_pair(meshSlots[i], InstanceEntry())).first;
+			it->second.m_position = INSTANCING_NO_POSITION;
+			it->second.m_hasData = false;
+		}
+		it->second.m_updateId = m_updateId;
+		m_slotEntries[i] = &it->second;
+	}
+
+	for (std::map<RAS_MeshSlot *, InstanceEntry>::iterator it = m_entries.begin(); it != m_entries.end();) {
+		if (it->second.m_updateId != m_updateId) {
+			m_entries.erase(it++);
+		}
+		else {
+			++it;
+		}
+	}
+
+	if (sorted) {
+		for (unsigned int i = 0; i < size; ++i) {
+			m_slotEntries[i]->m_position = i;
+		}
+	}
+	else {
+		// The entries keep their position if it's still in the instances, the others fill the free positions.
+		m_usedPositions.assign(size, false);
+		for (unsigned int i = 0; i < size; ++i) {
+			InstanceEntry *entry = m_slotEntries[i];
+			if (entry->m_position < size && !m_usedPositions[entry->m_position]) {
+				m_usedPositions[entry->m_position] = true;
+			}
+			else {
+				entry->m_position = INSTANCING_NO_POSITION;
+			}
+		}
+
+		unsigned int freeposition = 0;
+		for (unsigned int i = 0; i < size; ++i) {
+			InstanceEntry *entry = m_slotEntries[i];
+			if (entry->m_position == INSTANCING_NO_POSITION) {
+				while (m_usedPositions[freeposition]) {
+					++freeposition;
+				}
+				entry->m_position = freeposition;
+				m_usedPositions[freeposition] = true;
+			}
+		}
+	}
+
+	// The transform of the billboards and shadows depends on the camera or the scene, not only on the object.
+	const bool cachetransform = (drawingmode & (RAS_IPolyMaterial::BILLBOARD_SCREENALIGNED |
+	                                            RAS_IPolyMaterial::BILLBOARD_AXISALIGNED |
+	                                            RAS_IPolyMaterial::SHADOW)) == 0;
+
+	unsigned int numdirty = 0;
+	m_dirtyPositions.assign(size, false);
 
-	for (unsigned int i = 0, size = meshSlots.size(); i < size; ++i) {
+	for (unsigned int i = 0; i < size; ++i) {
 		RAS_MeshSlot *ms = meshSlots[i];
-		InstancingObject& data = buffer[i];
-		float mat[16];
-		rasty->SetClientObject(ms->m_meshUser->GetClientObject());
-		rasty->GetTransform(ms->m_meshUser->GetMatrix(), drawingmode, mat);
-		data.matrix[0] = mat[0];
-		data.matrix[1] = mat[4];
-		data.matrix[2] = mat[8];
-		data.matrix[3] = mat[1];
-		data.matrix[4] = mat[5];
-		data.matrix[5] = mat[9];
-		data.matrix[6] = mat[2];
-		data.matrix[7] = mat[6];
-		data.matrix[8] = mat[10];
-		data.position[0] = mat[12];
-		data.position[1] = mat[13];
-		data.position[2] = mat[14];
+		InstanceEntry *entry = m_slotEntries[i];
+		InstancingObject& data = entry->m_data;
+		float *origmat = ms->m_meshUser->GetMatrix();
+
+		if (!cachetransform || !entry->m_hasData || memcmp(entry->m_sourceMatrix, origmat, sizeof(entry->m_sourceMatrix)) != 0) {
+			float mat[16];
+			rasty->SetClientObject(ms->m_meshUser->GetClientObject());
+			rasty->GetTransform(origmat, drawingmode, mat);
+			data.matrix[0] = mat[0];
+			data.matrix[1] = mat[4];
+			data.matrix[2] = mat[8];
+			data.matrix[3] = mat[1];
+			data.matrix[4] = mat[5];
+			data.matrix[5] = mat[9];
+			data.matrix[6] = mat[2];
+			data.matrix[7] = mat[6];
+			data.matrix[8] = mat[10];
+			data.position[0] = mat[12];
+			data.position[1] = mat[13];
+			data.position[2] = mat[14];
+
+			memcpy(entry->m_sourceMatrix, origmat, sizeof(entry->m_sourceMatrix));
+			entry->m_hasData = true;
+		}
 
 		const MT_Vector4& color = ms->m_meshUser->GetColor();
 		data.color[0] = color[0] * 255.0f;
 		data.color[1] = color[1] * 255.0f;
 		data.color[2] = color[2] * 255.0f;
 		data.color[3] = color[3] * 255.0f;
+
+		// Instances at a position unused in the last update are always dirty, their VBO content is unknown.
+		const unsigned int position = entry->m_position;
+		if (!reallocated && position < prevsize && memcmp(&data, &m_instances[position], sizeof(InstancingObject)) == 0) {
+			continue;
+		}
+
+		m_instances[position] = data;
+		m_dirtyPositions[position] = true;
+		++numdirty;
+	}
+
+	if (numdirty == size && size > 0) {
+		/* Everything changed: orphan the previous storage instead of waiting for the
+		 * draw calls still using it, then fill the new one at once. */
+		if (!reallocated) {
+			glBufferData(GL_ARRAY_BUFFER, sizeof(InstancingObject) * m_capacity, NULL, GL_DYNAMIC_DRAW);
+		}
+		UploadRange(0, size);
+		return;
+	}
+
+	// The range of dirty instances not yet uploaded, empty when rangeStart == rangeEnd.
+	unsigned int rangeStart = 0;
+	unsigned int rangeEnd = 0;
+	m_dirtyRanges.clear();
+
+	for (unsigned int i = 0; i < size; ++i) {
+		if (!m_dirtyPositions[i]) {
+			continue;
+		}
+
+		if (rangeStart == rangeEnd) {
+			rangeStart = i;
+		}
+		else if ((i - rangeEnd) >= INSTANCING_RANGE_GAP) {
+			m_dirtyRanges.push_back(DirtyRange(rangeStart, rangeEnd));
+			rangeStart = i;
+		}
+		rangeEnd = i + 1;
 	}
 
-	glUnmapBuffer(GL_ARRAY_BUFFER);
+	if (rangeStart != rangeEnd) {
+		m_dirtyRanges.push_back(DirtyRange(rangeStart, rangeEnd));
+	}
+
+	for (std::vector<DirtyRange>::iterator it = m_dirtyRanges.begin(), end = m_dirtyRanges.end(); it != end; ++it) {
+		UploadRange(it->first, it->second);
+	}
+}
+
+void RAS_InstancingBuffer::GetUploadStats(unsigned int& uploadedSize, unsigned int& instancesSize)
+{
+	uploadedSize = s_uploadedSize;
+	instancesSize = s_instancesSize;
+}
+
+void RAS_InstancingBuffer::ResetUploadStats()
+{
+	s_uploadedSize = 0;
+	s_instancesSize = 0;
 }
@@ -31,6 +31,10 @@
 
 #include "RAS_MeshSlot.h"
 
+#include <vector>
+#include <map>
+#include <utility>
+
 class RAS_IRasterizer;
 
 class RAS_InstancingBuffer
@@ -45,6 +49,8 @@ class RAS_InstancingBuffer
 	void *m_colorOffset;
 	/// The instance structure stride in the VBO.
 	unsigned int m_stride;
+	/// The number of instances allocated in the VBO.
+	unsigned int m_capacity;
 
 	/// Structure used to store object info for geometry instancing objects render.
 	struct InstancingObject
@@ -54,6 +60,51 @@ class RAS_InstancingBuffer
 		unsigned char color[4];
 	};
 
+	/** Copy of the instances stored in the VBO, an instance is uploaded again only when
+	 * its data changed since the last update.
+	 */
+	std::vector<InstancingObject> m_instances;
+
+	/// Instance of a mesh slot drawn in the last update.
+	struct InstanceEntry
+	{
+		/// Position of the instance in the VBO.
+		unsigned int m_position;
+		/// Value of m_updateId at the last update drawing the mesh slot.
+		unsigned int m_updateId;
+		/// True if m_data was computed from m_sourceMatrix.
+		bool m_hasData;
+		/// Object matrix the transform of m_data was computed from.
+		float m_sourceMatrix[16];
+		InstancingObject m_data;
+	};
+
+	/** Instances of the mesh slots of the last update. An instance keeps its position while its
+	 * mesh slot is drawn, so culling a mesh slot only changes the position it frees.
+	 */
+	std::map<RAS_MeshSlot *, InstanceEntry> m_entries;
+	/// Incremented at each update.
+	unsigned int m_updateId;
+
+	/// Entries of the mesh slots of the current update, in the mesh slots order.
+	std::vector<InstanceEntry *> m_slotEntries;
+	/// Positions of the current update in use or to upload, kept to not allocate them every frame.
+	std::vector<bool> m_usedPositions;
+	std::vector<bool> m_dirtyPositions;
+
+	/// Range of instances to upload, first and past the end index.
+	typedef std::pair<unsigned int, unsigned int> DirtyRange;
+	/// Ranges of the current update, kept to not allocate them every frame.
+	std::vector<DirtyRange> m_dirtyRanges;
+
+	/// Bytes uploaded by all the instancing buffers since the last call to ResetUploadStats.
+	static unsigned int s_uploadedSize;
+	/// Bytes of all the instances updated since the last call to ResetUploadStats.
+	static unsigned int s_instancesSize;
+
+	/// Upload the instances in [start, end[ to the VBO.
+	void UploadRange(unsigned int start, unsigned int end);
+
 public:
 	RAS_InstancingBuffer();
 	virtual ~RAS_InstancingBuffer();
@@ -67,8 +118,17 @@ public:
 	 * \param rasty Rasterizer used to compute the mesh slot matrix, useful for billboard material.
 	 * \param drawingmode The material drawing mode used to detect a billboard/halo/shadow material.
 	 * \param meshSlots The list of all non-culled and visible mesh slots (= game object).
+	 * \param sorted True if the instances must be drawn in the order of meshSlots, e.g. sorted
+	 * by depth, else the mesh slots keep their instance position of the previous update.
+	 */
+	void Update(RAS_IRasterizer *rasty, int drawingmode, RAS_MeshSlotList &meshSlots, bool sorted);
+
+	/** Get the amount of bytes uploaded by all the instancing buffers and the size
+	 * of all the instances they were updated with, since the last reset.
 	 */
-	void Update(RAS_IRasterizer *rasty, int drawingmode, RAS_MeshSlotList &meshSlots);
+	static void GetUploadStats(unsigned int& uploadedSize, unsigned int& instancesSize);
+	/// Reset the upload counters, called at the beginning of each frame.
+	static void ResetUploadStats();
 
 	inline void *GetMatrixOffset() const
 	{
@@ -38,10 +38,13 @@
 #include "RAS_IPolygonMaterial.h"
 #include "RAS_DisplayArray.h"
 #include "RAS_Deformer.h"
+#include "RAS_VertexWelder.h"
 #include "MT_Vector3.h"
 
 #include <algorithm>
 
+#include "BLI_utildefines.h"
+
 // polygon sorting
 
 struct RAS_MeshObject::polygonSlot
@@ -125,6 +128,7 @@ RAS_MeshObject::~RAS_MeshObject()
 		delete (*it);
 
 	m_sharedvertex_map.clear();
+	m_sharedvertices.clear();
 	m_Polygons.clear();
 	m_materials.clear();
 }
@@ -282,7 +286,7 @@ int RAS_MeshObject::GetBlenderMaterialId(RAS_IPolyMaterial *mat)
 	return -1;
 }
 
-void RAS_MeshObject::AddMaterial(RAS_MaterialBucket *bucket, unsigned int index)
+RAS_MeshMaterial *RAS_MeshObject::AddMaterial(RAS_MaterialBucket *bucket, unsigned int index)
 {
 	RAS_MeshMaterial *mmat = GetMeshMaterial(bucket->GetPolyMaterial());
 
@@ -293,7 +297,10 @@ void RAS_MeshObject::AddMaterial(RAS_MaterialBucket *bucket, unsigned int index)
 		meshmat.m_baseslot = meshmat.m_bucket->AddMesh(this);
 		meshmat.m_index = index;
 		m_materials.push_back(meshmat);
+		mmat = &m_materials.back();
 	}
+
+	return mmat;
 }
 
 void RAS_MeshObject::AddLine(RAS_MaterialBucket *bucket, unsigned int v1, unsigned int v2)
@@ -380,17 +387,15 @@ unsigned int RAS_MeshObject::AddVertex(RAS_MaterialBucket *bucket, int i,
 		/* find vertices shared between faces, with the restriction
 		 * that they exist in the same display array, and have the
 		 * same uv coordinate etc */
-		std::vector<SharedVertex>& sharedmap = m_sharedvertex_map[origindex];
-		std::vector<SharedVertex>::iterator it;
-
-		for (it = sharedmap.begin(); it != sharedmap.end(); it++) {
-			if (it->m_darray != darray)
+		for (int index = m_sharedvertex_map[origindex]; index != -1; index = m_sharedvertices[index].m_next) {
+			const SharedVertex& shared = m_sharedvertices[index];
+			if (shared.m_darray != darray)
 				continue;
-			if (!it->m_darray->m_vertex[it->m_offset].closeTo(&texvert))
+			if (!darray->m_vertex[shared.m_offset].closeTo(&texvert))
 				continue;
 
 			// found one, add it and we're done
-			return it->m_offset;
+			return shared.m_offset;
 		}
 	}
 
@@ -401,12 +406,38 @@ unsigned int RAS_MeshObject::AddVertex(RAS_MaterialBucket *bucket, int i,
 		SharedVertex shared;
 		shared.m_darray = darray;
 		shared.m_offset = offset;
-		m_sharedvertex_map[origindex].push_back(shared);
+		shared.m_next = m_sharedvertex_map[origindex];
+		m_sharedvertex_map[origindex] = m_sharedvertices.size();
+		m_sharedvertices.push_back(shared);
 	}
 
 	return offset;
 }
 
+void RAS_MeshObject::SetWeldedVertices(RAS_VertexWelder& welder, const std::vector<RAS_MeshMaterial *>& materials)
+{
+	std::vector<RAS_DisplayArray *> darrays(materials.size());
+	for (unsigned int i = 0, size = materials.size(); i < size; ++i) {
+		RAS_DisplayArray *darray = materials[i]->m_baseslot->GetDisplayArray();
+		BLI_assert(darray->m_vertex.empty());
+		// The vertices aren't copied.
+		darray->m_vertex.swap(welder.GetVertices(i));
+		darrays[i] = darray;
+	}
+
+	m_sharedvertex_map = welder.GetFirstSharedVertices();
+
+	const std::vector<RAS_VertexWelder::SharedVertex>& weldedvertices = welder.GetSharedVertices();
+	m_sharedvertices.resize(weldedvertices.size());
+	for (unsigned int i = 0, size = weldedvertices.size(); i < size; ++i) {
+		const RAS_VertexWelder::SharedVertex& welded = weldedvertices[i];
+		SharedVertex& shared = m_sharedvertices[i];
+		shared.m_darray = darrays[welded.m_array];
+		shared.m_offset = welded.m_offset;
+		shared.m_next = welded.m_next;
+	}
+}
+
 int RAS_MeshObject::NumVertices(RAS_IPolyMaterial *mat)
 {
 	RAS_MeshMaterial *mmat = GetMeshMaterial(mat);
@@ -433,9 +464,8 @@ RAS_TexVert *RAS_MeshObject::GetVertex(unsigned int matid, unsigned int index)
 
 const float *RAS_MeshObject::GetVertexLocation(unsigned int orig_index)
 {
-	std::vector<SharedVertex>& sharedmap = m_sharedvertex_map[orig_index];
-	std::vector<SharedVertex>::iterator it = sharedmap.begin();
-	return it->m_darray->m_vertex[it->m_offset].getXYZ();
+	const SharedVertex& shared = m_sharedvertices[m_sharedvertex_map[orig_index]];
+	return shared.m_darray->m_vertex[shared.m_offset].getXYZ();
 }
 
 RAS_MeshUser* RAS_MeshObject::AddMeshUser(void *clientobj, RAS_Deformer *deformer)
@@ -471,8 +501,9 @@ void RAS_MeshObject::EndConversion()
 {
 #if 0
 	m_sharedvertex_map.clear(); // SharedVertex
-	vector<vector<SharedVertex> >   shared_null(0);
+	std::vector<int> shared_null(0);
 	shared_null.swap(m_sharedvertex_map);   /* really free the memory */
+	std::vector<SharedVertex>().swap(m_sharedvertices);
 #endif
 }
 
@@ -51,6 +51,7 @@ struct Mesh;
 class RAS_MeshUser;
 class RAS_Deformer;
 class RAS_Polygon;
+class RAS_VertexWelder;
 
 /* RAS_MeshObject is a mesh used for rendering. It stores polygons,
  * but the actual vertices and index arrays are stored in material
@@ -131,7 +132,7 @@ public:
 	}
 
 	// mesh construction
-	void AddMaterial(RAS_MaterialBucket *bucket, unsigned int index);
+	RAS_MeshMaterial *AddMaterial(RAS_MaterialBucket *bucket, unsigned int index);
 	void AddLine(RAS_MaterialBucket *bucket, unsigned int v1, unsigned int v2);
 	virtual RAS_Polygon *AddPolygon(RAS_MaterialBucket *bucket, int numverts, unsigned int indices[4],
 									bool visible, bool collider, bool twoside);
@@ -168,14 +169,23 @@ public:
 
 	void GetAabb(MT_Vector3 &aabbMin, MT_Vector3 &aabbMax);
 
+	/** Move the vertices of welder in the display arrays of the materials, the array i of
+	 * welder in materials[i], and set the shared vertices. The mesh must not have any vertex.
+	 */
+	void SetWeldedVertices(RAS_VertexWelder& welder, const std::vector<RAS_MeshMaterial *>& materials);
+
 	// for construction to find shared vertices
 	struct SharedVertex
 	{
 		RAS_DisplayArray *m_darray;
 		int m_offset;
+		/// Next vertex of the same original vertex in m_sharedvertices, -1 for the last one.
+		int m_next;
 	};
 
-	std::vector<std::vector<SharedVertex> > m_sharedvertex_map;
+	/// First vertex of each original vertex in m_sharedvertices, -1 for the unused vertices.
+	std::vector<int> m_sharedvertex_map;
+	std::vector<SharedVertex> m_sharedvertices;
 
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -210,7 +210,29 @@ int RAS_OpenGLLight::GetShadowLayer()
 		return 0;
 }
 
-void RAS_OpenGLLight::BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam, MT_Transform& camtrans)
+void RAS_OpenGLLight::UpdateShadowCamera(KX_Camera *cam, MT_Transform& camtrans)
+{
+	GPULamp *lamp = GetGPULamp();
+	float viewmat[4][4], winmat[4][4];
+
+	GPU_lamp_shadow_buffer_mats(lamp, viewmat, winmat);
+
+	/* setup camera transformation */
+	MT_Matrix4x4 modelviewmat((float *)viewmat);
+	MT_Matrix4x4 projectionmat((float *)winmat);
+
+	MT_Transform trans = MT_Transform((float *)viewmat);
+	camtrans.invert(trans);
+
+	cam->SetModelviewMatrix(modelviewmat);
+	cam->SetProjectionMatrix(projectionmat);
+
+	cam->NodeSetLocalPosition(camtrans.getOrigin());
+	cam->NodeSetLocalOrientation(camtrans.getBasis());
+	cam->NodeUpdateGS(0);
+}
+
+void RAS_OpenGLLight::BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam)
 {
 	GPULamp *lamp;
 	float viewmat[4][4], winmat[4][4];
@@ -230,26 +252,12 @@ void RAS_OpenGLLight::BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam, MT_T
 	/* GPU_lamp_shadow_buffer_bind() changes the viewport, so update the canvas */
 	canvas->UpdateViewPort(0, 0, winsize, winsize);
 
-	/* setup camera transformation */
-	MT_Matrix4x4 modelviewmat((float *)viewmat);
-	MT_Matrix4x4 projectionmat((float *)winmat);
-
-	MT_Transform trans = MT_Transform((float *)viewmat);
-	camtrans.invert(trans);
-
-	cam->SetModelviewMatrix(modelviewmat);
-	cam->SetProjectionMatrix(projectionmat);
-
-	cam->NodeSetLocalPosition(camtrans.getOrigin());
-	cam->NodeSetLocalOrientation(camtrans.getBasis());
-	cam->NodeUpdateGS(0);
-
 	/* setup rasterizer transformations */
 	/* SetViewMatrix may use stereomode which we temporarily disable here */
 	RAS_IRasterizer::StereoMode stereomode = m_rasterizer->GetStereoMode();
 	m_rasterizer->SetStereoMode(RAS_IRasterizer::RAS_STEREO_NOSTEREO);
-	m_rasterizer->SetProjectionMatrix(projectionmat);
-	m_rasterizer->SetViewMatrix(modelviewmat, cam->NodeGetWorldOrientation(), cam->NodeGetWorldPosition(), cam->GetCameraData()->m_perspective);
+	m_rasterizer->SetProjectionMatrix(cam->GetProjectionMatrix());
+	m_rasterizer->SetViewMatrix(cam->GetModelviewMatrix(), cam->NodeGetWorldOrientation(), cam->NodeGetWorldPosition(), cam->GetCameraData()->m_perspective);
 	m_rasterizer->SetStereoMode(stereomode);
 }
 
@@ -263,6 +271,25 @@ void RAS_OpenGLLight::UnbindShadowBuffer()
 	m_requestShadowUpdate = false;
 }
 
+bool RAS_OpenGLLight::CreateShadowCache()
+{
+	GPULamp *lamp;
+
+	if ((lamp = GetGPULamp()))
+		return GPU_lamp_shadow_cache_create(lamp);
+	return false;
+}
+
+void RAS_OpenGLLight::StoreShadowCache()
+{
+	GPU_lamp_shadow_cache_store(GetGPULamp());
+}
+
+void RAS_OpenGLLight::RestoreShadowCache()
+{
+	GPU_lamp_shadow_cache_restore(GetGPULamp());
+}
+
 Image *RAS_OpenGLLight::GetTextureImage(short texslot)
 {
 	KX_LightObject *kxlight = (KX_LightObject *)m_light;
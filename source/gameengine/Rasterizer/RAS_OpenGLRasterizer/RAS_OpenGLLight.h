@@ -54,8 +54,12 @@ public:
 	int GetShadowBindCode();
 	MT_Matrix4x4 GetShadowMatrix();
 	int GetShadowLayer();
-	void BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam, MT_Transform& camtrans);
+	void UpdateShadowCamera(KX_Camera *cam, MT_Transform& camtrans);
+	void BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam);
 	void UnbindShadowBuffer();
+	bool CreateShadowCache();
+	void StoreShadowCache();
+	void RestoreShadowCache();
 	Image *GetTextureImage(short texslot);
 	void Update();
 	void SetShadowUpdateState(short state);
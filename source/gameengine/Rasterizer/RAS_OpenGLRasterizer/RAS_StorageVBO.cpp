@@ -32,12 +32,22 @@
 
 #include "glew-mx.h"
 
+#include <algorithm>
+#include <string.h>
+
+// Size of the attributes always uploaded: position, normal and color.
+#define VBO_BASE_STRIDE (sizeof(GLfloat) * 3 * 2 + sizeof(GLuint))
+
 VBO::VBO(RAS_DisplayArray *data, unsigned int indices)
 {
 	m_data = data;
 	m_size = data->m_vertex.size();
 	m_indices = indices;
-	m_stride = sizeof(RAS_TexVert);
+	m_stride = VBO_BASE_STRIDE;
+	m_uvCount = 0;
+	m_useTangent = false;
+	m_uploaded = false;
+	m_dynamic = false;
 
 	m_mode = m_data->GetOpenGLPrimitiveType();
 
@@ -45,16 +55,15 @@ VBO::VBO(RAS_DisplayArray *data, unsigned int indices)
 	glGenBuffersARB(1, &m_ibo);
 	glGenBuffersARB(1, &m_vbo_id);
 
-	// Fill the buffers with initial data
+	// Fill the index buffer, the vertices are uploaded at the first bind once the format is known
 	UpdateIndices();
-	UpdateData();
 
 	// Establish offsets
-	m_vertex_offset = (void *)(((RAS_TexVert *)0)->getXYZ());
-	m_normal_offset = (void *)(((RAS_TexVert *)0)->getNormal());
-	m_tangent_offset = (void *)(((RAS_TexVert *)0)->getTangent());
-	m_color_offset = (void *)(((RAS_TexVert *)0)->getRGBA());
-	m_uv_offset = (void *)(((RAS_TexVert *)0)->getUV(0));
+	m_vertex_offset = (void *)0;
+	m_normal_offset = (void *)(sizeof(GLfloat) * 3);
+	m_color_offset = (void *)(sizeof(GLfloat) * 3 * 2);
+	m_tangent_offset = (void *)VBO_BASE_STRIDE;
+	m_uv_offset = (void *)VBO_BASE_STRIDE;
 }
 
 VBO::~VBO()
@@ -63,10 +72,91 @@ VBO::~VBO()
 	glDeleteBuffersARB(1, &m_vbo_id);
 }
 
-void VBO::UpdateData()
+/**
+ * Extend the vertex format to the attributes requested by the current material,
+ * return true if the vertices must be uploaded again.
+ */
+bool VBO::UpdateFormat(int texco_num, RAS_IRasterizer::TexCoGen *texco, int attrib_num, RAS_IRasterizer::TexCoGen *attrib,
+                       int *attrib_layer)
 {
+	unsigned int uvCount = m_uvCount;
+	bool useTangent = m_useTangent;
+	int unit;
+
+	for (unit = 0; unit < texco_num; ++unit) {
+		if (texco[unit] == RAS_IRasterizer::RAS_TEXCO_UV) {
+			uvCount = std::max(uvCount, (unsigned int)unit + 1);
+		}
+		else if (texco[unit] == RAS_IRasterizer::RAS_TEXTANGENT) {
+			useTangent = true;
+		}
+	}
+
+	if (GLEW_ARB_vertex_program) {
+		for (unit = 0; unit < attrib_num; ++unit) {
+			if (attrib[unit] == RAS_IRasterizer::RAS_TEXCO_UV) {
+				uvCount = std::max(uvCount, (unsigned int)attrib_layer[unit] + 1);
+			}
+			else if (attrib[unit] == RAS_IRasterizer::RAS_TEXTANGENT) {
+				useTangent = true;
+			}
+		}
+	}
+
+	uvCount = std::min(uvCount, (unsigned int)RAS_TexVert::MAX_UNIT);
+
+	if (uvCount == m_uvCount && useTangent == m_useTangent) {
+		return false;
+	}
+
+	m_uvCount = uvCount;
+	m_useTangent = useTangent;
+	m_uv_offset = (void *)(VBO_BASE_STRIDE + (m_useTangent ? sizeof(GLfloat) * 4 : 0));
+	m_stride = (intptr_t)m_uv_offset + sizeof(GLfloat) * 2 * m_uvCount;
+
+	return true;
+}
+
+void VBO::UpdateData(bool modified)
+{
+	if (modified && m_uploaded) {
+		m_dynamic = true;
+	}
+
+	const size_t uvOffset = (intptr_t)m_uv_offset;
+	const size_t uvSize = sizeof(GLfloat) * 2 * m_uvCount;
+
+	m_packedData.resize(m_stride * m_size);
+
+	for (unsigned int i = 0; i < m_size; ++i) {
+		const RAS_TexVert& v = m_data->m_vertex[i];
+		char *data = &m_packedData[m_stride * i];
+
+		memcpy(data, v.getXYZ(), sizeof(GLfloat) * 3);
+		memcpy(data + (intptr_t)m_normal_offset, v.getNormal(), sizeof(GLfloat) * 3);
+		memcpy(data + (intptr_t)m_color_offset, v.getRGBA(), sizeof(GLuint));
+		if (m_useTangent) {
+			memcpy(data + (intptr_t)m_tangent_offset, v.getTangent(), sizeof(GLfloat) * 4);
+		}
+		// the UV layers are contiguous in RAS_TexVert
+		if (uvSize) {
+			memcpy(data + uvOffset, v.getUV(0), uvSize);
+		}
+	}
+
 	glBindBufferARB(GL_ARRAY_BUFFER_ARB, m_vbo_id);
-	glBufferData(GL_ARRAY_BUFFER, m_stride * m_size, m_data->m_vertex.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, m_packedData.size(), m_packedData.data(), m_dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+	m_uploaded = true;
+
+	// The buffer keeps the only copy of static vertices.
+	if (!m_dynamic) {
+		std::vector<char>().swap(m_packedData);
+	}
+}
+
+unsigned int VBO::GetVertexMemorySize() const
+{
+	return m_stride * m_size;
 }
 
 void VBO::UpdateIndices()
@@ -82,6 +172,10 @@ void VBO::Bind(int texco_num, RAS_IRasterizer::TexCoGen *texco, int attrib_num,
 	bool wireframe = (drawingmode == RAS_IRasterizer::RAS_WIREFRAME);
 	int unit;
 
+	if (UpdateFormat(texco_num, texco, attrib_num, attrib, attrib_layer) || !m_uploaded) {
+		UpdateData(false);
+	}
+
 	// Bind buffers
 	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, m_ibo);
 	glBindBufferARB(GL_ARRAY_BUFFER_ARB, m_vbo_id);
@@ -258,7 +352,7 @@ void RAS_StorageVBO::IndexPrimitives(RAS_MeshSlot *ms)
 
 	// Update the vbo if the mesh is modified or use a dynamic deformer.
 	if (arrayBucket->IsMeshModified()) {
-		vbo->UpdateData();
+		vbo->UpdateData(true);
 	}
 
 	vbo->Draw();
@@ -270,7 +364,7 @@ void RAS_StorageVBO::IndexPrimitivesInstancing(RAS_DisplayArrayBucket *arrayBuck
 
 	// Update the vbo if the mesh is modified or use a dynamic deformer.
 	if (arrayBucket->IsMeshModified()) {
-		vbo->UpdateData();
+		vbo->UpdateData(true);
 	}
 
 	vbo->DrawInstancing(arrayBucket->GetNumActiveMeshSlots());
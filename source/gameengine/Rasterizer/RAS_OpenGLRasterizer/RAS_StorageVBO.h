@@ -29,6 +29,7 @@
 #define __KX_VERTEXBUFFEROBJECTSTORAGE
 
 #include <map>
+#include <vector>
 #include "glew-mx.h"
 
 #include "RAS_IStorage.h"
@@ -47,9 +48,12 @@ public:
 	void Draw();
 	void DrawInstancing(unsigned int numinstance);
 
-	void UpdateData();
+	/// Upload the vertices, modified is true when the mesh changed since the last upload.
+	void UpdateData(bool modified);
 	void UpdateIndices();
 
+	virtual unsigned int GetVertexMemorySize() const;
+
 private:
 	RAS_DisplayArray *m_data;
 	GLuint m_size;
@@ -59,11 +63,29 @@ private:
 	GLuint m_ibo;
 	GLuint m_vbo_id;
 
+	/**
+	 * Only the attributes used by the materials are uploaded: position, normal and color
+	 * always, then the tangent and the first m_uvCount UV layers when needed.
+	 */
+	unsigned int m_uvCount;
+	bool m_useTangent;
+	bool m_uploaded;
+	/// True once the mesh was modified after its first upload, e.g. by a deformer.
+	bool m_dynamic;
+	/**
+	 * Vertices packed with the layout above. Only the dynamic meshes keep them to avoid
+	 * a reallocation every frame, the static meshes free them after the upload.
+	 */
+	std::vector<char> m_packedData;
+
 	void *m_vertex_offset;
 	void *m_normal_offset;
 	void *m_color_offset;
 	void *m_tangent_offset;
 	void *m_uv_offset;
+
+	bool UpdateFormat(int texco_num, RAS_IRasterizer::TexCoGen *texco, int attrib_num, RAS_IRasterizer::TexCoGen *attrib,
+	                  int *attrib_layer);
 };
 
 class RAS_StorageVBO : public RAS_IStorage
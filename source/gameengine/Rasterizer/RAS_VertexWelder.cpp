@@ -0,0 +1,87 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Rasterizer/RAS_VertexWelder.cpp
+ *  \ingroup bgerast
+ */
+
+#include "RAS_VertexWelder.h"
+
+RAS_VertexWelder::RAS_VertexWelder(unsigned int numOrigVertices)
+	:m_firstSharedVertex(numOrigVertices, -1)
+{
+	// Most of the original vertices are used by at least one face.
+	m_sharedVertices.reserve(numOrigVertices);
+}
+
+RAS_VertexWelder::~RAS_VertexWelder()
+{
+}
+
+unsigned int RAS_VertexWelder::AddArray()
+{
+	m_arrays.push_back(std::vector<RAS_TexVert>());
+	return m_arrays.size() - 1;
+}
+
+unsigned int RAS_VertexWelder::GetNumArrays() const
+{
+	return m_arrays.size();
+}
+
+unsigned int RAS_VertexWelder::AddVertex(unsigned int array, const RAS_TexVert& vertex)
+{
+	std::vector<RAS_TexVert>& vertices = m_arrays[array];
+	int& first = m_firstSharedVertex[vertex.getOrigIndex()];
+
+	for (int index = first; index != -1; index = m_sharedVertices[index].m_next) {
+		const SharedVertex& shared = m_sharedVertices[index];
+		if (shared.m_array == array && vertices[shared.m_offset].closeTo(&vertex)) {
+			return shared.m_offset;
+		}
+	}
+
+	// No shared vertex found, add a new one at the head of the chain.
+	SharedVertex shared;
+	shared.m_array = array;
+	shared.m_offset = vertices.size();
+	shared.m_next = first;
+
+	first = m_sharedVertices.size();
+	m_sharedVertices.push_back(shared);
+	vertices.push_back(vertex);
+
+	return shared.m_offset;
+}
+
+std::vector<RAS_TexVert>& RAS_VertexWelder::GetVertices(unsigned int array)
+{
+	return m_arrays[array];
+}
+
+const std::vector<int>& RAS_VertexWelder::GetFirstSharedVertices() const
+{
+	return m_firstSharedVertex;
+}
+
+const std::vector<RAS_VertexWelder::SharedVertex>& RAS_VertexWelder::GetSharedVertices() const
+{
+	return m_sharedVertices;
+}
@@ -0,0 +1,82 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file RAS_VertexWelder.h
+ *  \ingroup bgerast
+ *
+ * Vertices of a mesh being converted, before they are moved in the display arrays.
+ * The vertices of the faces sharing an original vertex are welded when they have the
+ * same attributes, see RAS_TexVert::closeTo. The vertices are chained by original vertex,
+ * a new vertex is only compared with the few vertices of its original vertex. The welder
+ * doesn't access the display arrays or the scene, a mesh can be welded in any thread.
+ */
+
+#ifndef __RAS_VERTEXWELDER_H__
+#define __RAS_VERTEXWELDER_H__
+
+#include "RAS_TexVert.h"
+
+#include <vector>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+class RAS_VertexWelder
+{
+public:
+	struct SharedVertex
+	{
+		/// Array of the vertex, one per material of the mesh.
+		unsigned int m_array;
+		unsigned int m_offset;
+		/// Next vertex of the same original vertex, -1 for the last one.
+		int m_next;
+	};
+
+private:
+	/// First vertex of each original vertex in m_sharedVertices, -1 for the unused vertices.
+	std::vector<int> m_firstSharedVertex;
+	std::vector<SharedVertex> m_sharedVertices;
+	std::vector<std::vector<RAS_TexVert> > m_arrays;
+
+public:
+	RAS_VertexWelder(unsigned int numOrigVertices);
+	~RAS_VertexWelder();
+
+	/// Add an empty vertex array and return its index.
+	unsigned int AddArray();
+	unsigned int GetNumArrays() const;
+
+	/** Return the offset of vertex in the array, vertex is added only if no vertex
+	 * of the array with the same original vertex is close to it.
+	 */
+	unsigned int AddVertex(unsigned int array, const RAS_TexVert& vertex);
+
+	std::vector<RAS_TexVert>& GetVertices(unsigned int array);
+	const std::vector<int>& GetFirstSharedVertices() const;
+	const std::vector<SharedVertex>& GetSharedVertices() const;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:RAS_VertexWelder")
+#endif
+};
+
+#endif  /* __RAS_VERTEXWELDER_H__ */
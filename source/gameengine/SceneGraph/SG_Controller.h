@@ -74,6 +74,18 @@ public:
 		double time
 	)=0;
 
+	/**
+	 * Evaluate the controller for a simulated time ahead of Update.
+	 * The evaluation must not touch the scene graph, it can run
+	 * out of the main thread. Update uses the evaluated values
+	 * if it's called for the same time.
+	 */
+	virtual
+		void
+	Evaluate(
+		double time
+	) {}
+
 	virtual
 		SG_Controller*
 	GetReplica(
@@ -34,8 +34,13 @@
 #include "SG_ParentRelation.h"
 #include <algorithm>
 
+#include "BLI_task.h"
+
 using namespace std;
 
+/* Minimum number of children for a node to update them using the task scheduler. */
+#define SG_NODE_THREADED_CHILDREN 256
+
 
 SG_Node::SG_Node(
 	void* clientobj,
@@ -199,12 +204,78 @@ void SG_Node::UpdateWorldData(double time, bool parentUpdated)
 	Delink();
 
 	// update children's worlddata
+	if (m_children.size() >= SG_NODE_THREADED_CHILDREN) {
+		UpdateChildrenWorldDataThreaded(time, parentUpdated);
+		return;
+	}
+
 	for (NodeList::iterator it = m_children.begin();it!=m_children.end();++it)
 	{
 		(*it)->UpdateWorldData(time, parentUpdated);
 	}
 }
 
+bool SG_Node::IsThreadSafeLeaf()
+{
+	return (m_children.empty() &&
+	        GetSGControllerList().empty() &&
+	        m_parent_relation && m_parent_relation->IsThreadSafe());
+}
+
+struct SG_NodeUpdateData
+{
+	SG_Node **m_nodes;
+	unsigned char *m_updated;
+	const SG_Spatial *m_parent;
+	bool m_parentUpdated;
+};
+
+static void sg_node_update_leaf_func(void *userdata, const int iter)
+{
+	SG_NodeUpdateData *data = (SG_NodeUpdateData *)userdata;
+	bool parentUpdated = data->m_parentUpdated;
+
+	data->m_updated[iter] = data->m_nodes[iter]->ComputeWorldTransforms(data->m_parent, parentUpdated);
+}
+
+void SG_Node::UpdateChildrenWorldDataThreaded(double time, bool parentUpdated)
+{
+	std::vector<SG_Node *> leaves;
+	leaves.reserve(m_children.size());
+
+	for (NodeList::iterator it = m_children.begin(); it != m_children.end(); ++it) {
+		SG_Node *child = *it;
+		if (child->IsThreadSafeLeaf()) {
+			// The update list is shared by the whole scene, remove the node from this thread.
+			child->Delink();
+			leaves.push_back(child);
+		}
+		else {
+			child->UpdateWorldData(time, parentUpdated);
+		}
+	}
+
+	if (leaves.empty()) {
+		return;
+	}
+
+	std::vector<unsigned char> updated(leaves.size());
+	SG_NodeUpdateData data;
+	data.m_nodes = &leaves[0];
+	data.m_updated = &updated[0];
+	data.m_parent = this;
+	data.m_parentUpdated = parentUpdated;
+
+	BLI_task_parallel_range(0, leaves.size(), &data, sg_node_update_leaf_func, true);
+
+	// The callbacks reach the physics and graphic controllers, which are not thread safe.
+	for (unsigned int i = 0, size = leaves.size(); i < size; ++i) {
+		if (updated[i]) {
+			leaves[i]->ActivateUpdateTransformCallback();
+		}
+	}
+}
+
 
 
 void SG_Node::SetSimulatedTime(double time,bool recurse)
@@ -193,6 +193,15 @@ public:
 		bool parentUpdated=false
 	);
 
+	/**
+	 * Return true if this node can be updated at the same time as its
+	 * siblings: it has no children, no controllers and its parent relation
+	 * is thread safe.
+	 */
+		bool
+	IsThreadSafeLeaf(
+	);
+
 	/**
 	 * Update the simulation time of this node. Iterate through
 	 * the children nodes and update their simulated time.
@@ -259,6 +268,16 @@ private:
 		SG_Node** replica
 	);
 
+	/**
+	 * Update the world data of the children, the thread safe leaves
+	 * are updated in parallel.
+	 */
+		void
+	UpdateChildrenWorldDataThreaded(
+		double time,
+		bool parentUpdated
+	);
+
 	/**
 	 * The list of children of this node.
 	 */
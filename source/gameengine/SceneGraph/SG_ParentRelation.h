@@ -110,6 +110,18 @@ public :
 	) { 
 		return false;
 	}
+
+	/**
+	 * Return true if UpdateChildCoordinates only reads the parent world
+	 * coordinates and writes the child ones, in which case siblings can
+	 * be updated at the same time from different threads.
+	 */
+	virtual
+		bool
+	IsThreadSafe(
+	) {
+		return false;
+	}
 protected :
 
 	/** 
@@ -0,0 +1,254 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/SceneGraph/SG_Profiler.cpp
+ *  \ingroup bgesg
+ */
+
+#include "SG_Profiler.h"
+
+#include <vector>
+#include <set>
+#include <stdio.h>
+
+#include "BLI_threads.h"
+#include "PIL_time.h"
+
+#ifdef _MSC_VER
+#  define SG_THREAD_LOCAL __declspec(thread)
+#else
+#  define SG_THREAD_LOCAL __thread
+#endif
+
+/// Zones recorded by a thread above this amount are dropped, to bound the memory of long captures.
+#define SG_PROFILER_MAX_EVENTS (1 << 22)
+/// Index pushed on the zone stack for a dropped zone.
+#define SG_PROFILER_DROPPED_EVENT ((unsigned int)-1)
+
+struct SG_ProfileEvent
+{
+	const char *m_name;
+	double m_start;
+	/// Negative while the zone is open.
+	double m_end;
+};
+
+struct SG_ProfileThread
+{
+	std::vector<SG_ProfileEvent> m_events;
+	/// Indices in m_events of the open zones.
+	std::vector<unsigned int> m_stack;
+	unsigned int m_id;
+	bool m_isMain;
+};
+
+bool SG_Profiler::m_capturing = false;
+
+static SG_THREAD_LOCAL SG_ProfileThread *profile_thread = NULL;
+
+// The threads are only registered once, the buffers are kept until exit.
+static ThreadMutex profile_lock = BLI_MUTEX_INITIALIZER;
+static std::vector<SG_ProfileThread *> profile_threads;
+static std::set<std::string> profile_names;
+
+static bool profile_start_request = false;
+static bool profile_stop_request = false;
+static std::string profile_filepath;
+static double profile_start_time = 0.0;
+
+static SG_ProfileThread *profile_get_thread()
+{
+	if (!profile_thread) {
+		profile_thread = new SG_ProfileThread();
+		profile_thread->m_isMain = BLI_thread_is_main();
+
+		BLI_mutex_lock(&profile_lock);
+		profile_thread->m_id = profile_threads.size();
+		profile_threads.push_back(profile_thread);
+		BLI_mutex_unlock(&profile_lock);
+	}
+
+	return profile_thread;
+}
+
+static void profile_write_string(FILE *file, const char *str)
+{
+	fputc('"', file);
+	for (const char *c = str; *c; ++c) {
+		if (*c == '"' || *c == '\\') {
+			fputc('\\', file);
+			fputc(*c, file);
+		}
+		else if ((unsigned char)*c < 0x20) {
+			fprintf(file, "\\u%04x", (unsigned int)(unsigned char)*c);
+		}
+		else {
+			fputc(*c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+static bool profile_write_trace(const std::string& filepath)
+{
+	FILE *file = fopen(filepath.c_str(), "w");
+	if (!file) {
+		return false;
+	}
+
+	// Copy the registered threads, a worker could register while the file is written.
+	// The capture is stopped, so the events of the threads are left alone.
+	BLI_mutex_lock(&profile_lock);
+	const std::vector<SG_ProfileThread *> threads = profile_threads;
+	BLI_mutex_unlock(&profile_lock);
+
+	bool first = true;
+	fprintf(file, "{\"traceEvents\":[\n");
+
+	for (std::vector<SG_ProfileThread *>::const_iterator it = threads.begin(), end = threads.end(); it != end; ++it) {
+		SG_ProfileThread *thread = *it;
+		if (thread->m_events.empty()) {
+			continue;
+		}
+
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":",
+		        first ? "" : ",\n", thread->m_id);
+		if (thread->m_isMain) {
+			profile_write_string(file, "Main");
+		}
+		else {
+			char name[32];
+			sprintf(name, "Worker %u", thread->m_id);
+			profile_write_string(file, name);
+		}
+		fprintf(file, "}}");
+		first = false;
+
+		for (std::vector<SG_ProfileEvent>::iterator eit = thread->m_events.begin(), eend = thread->m_events.end();
+		     eit != eend; ++eit)
+		{
+			const SG_ProfileEvent& event = *eit;
+			// Zones still open when the capture stopped have no duration.
+			if (event.m_end < 0.0) {
+				continue;
+			}
+
+			fprintf(file, ",\n{\"name\":");
+			profile_write_string(file, event.m_name);
+			// Times in microseconds.
+			fprintf(file, ",\"cat\":\"bge\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			        thread->m_id, (event.m_start - profile_start_time) * 1e6, (event.m_end - event.m_start) * 1e6);
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+
+	const bool success = (ferror(file) == 0);
+	fclose(file);
+	return success;
+}
+
+void SG_Profiler::StartCapture()
+{
+	profile_start_request = true;
+	profile_stop_request = false;
+}
+
+void SG_Profiler::StopCapture(const std::string& filepath)
+{
+	profile_stop_request = true;
+	profile_filepath = filepath;
+}
+
+void SG_Profiler::Update()
+{
+	if (profile_stop_request) {
+		profile_stop_request = false;
+
+		if (m_capturing) {
+			m_capturing = false;
+
+			if (profile_write_trace(profile_filepath)) {
+				printf("Profile trace written to %s\n", profile_filepath.c_str());
+			}
+			else {
+				printf("Error: failed to write the profile trace to %s\n", profile_filepath.c_str());
+			}
+		}
+	}
+
+	if (profile_start_request) {
+		profile_start_request = false;
+
+		BLI_mutex_lock(&profile_lock);
+		for (std::vector<SG_ProfileThread *>::iterator it = profile_threads.begin(), end = profile_threads.end(); it != end; ++it) {
+			(*it)->m_events.clear();
+			(*it)->m_stack.clear();
+		}
+		BLI_mutex_unlock(&profile_lock);
+
+		profile_start_time = PIL_check_seconds_timer();
+		m_capturing = true;
+	}
+}
+
+void SG_Profiler::BeginZone(const char *name)
+{
+	SG_ProfileThread *thread = profile_get_thread();
+
+	if (thread->m_events.size() >= SG_PROFILER_MAX_EVENTS) {
+		thread->m_stack.push_back(SG_PROFILER_DROPPED_EVENT);
+		return;
+	}
+
+	SG_ProfileEvent event;
+	event.m_name = name;
+	event.m_start = PIL_check_seconds_timer();
+	event.m_end = -1.0;
+
+	thread->m_stack.push_back(thread->m_events.size());
+	thread->m_events.push_back(event);
+}
+
+void SG_Profiler::EndZone()
+{
+	SG_ProfileThread *thread = profile_get_thread();
+
+	// The zone was opened before the start of the capture.
+	if (thread->m_stack.empty()) {
+		return;
+	}
+
+	const unsigned int index = thread->m_stack.back();
+	thread->m_stack.pop_back();
+
+	if (index != SG_PROFILER_DROPPED_EVENT) {
+		thread->m_events[index].m_end = PIL_check_seconds_timer();
+	}
+}
+
+const char *SG_Profiler::InternName(const std::string& name)
+{
+	BLI_mutex_lock(&profile_lock);
+	const char *str = profile_names.insert(name).first->c_str();
+	BLI_mutex_unlock(&profile_lock);
+
+	return str;
+}
@@ -0,0 +1,90 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file SG_Profiler.h
+ *  \ingroup bgesg
+ */
+
+#ifndef __SG_PROFILER_H__
+#define __SG_PROFILER_H__
+
+#include <string>
+
+/** Records nested timing zones of every thread during a capture and writes them in the
+ * Chrome trace event format, viewable in chrome://tracing.
+ * Each thread records in its own buffer, opening and closing a zone never locks.
+ * It lives in the scene graph module to be reachable from all the game engine modules.
+ */
+class SG_Profiler
+{
+public:
+	/// Request to start a capture, applied by the next call to Update.
+	static void StartCapture();
+	/// Request to stop the capture and write it to filepath, applied by the next call to Update.
+	static void StopCapture(const std::string& filepath);
+
+	/** Apply the start and stop requests. Must be called from the main thread
+	 * when no task is running, e.g. between frames.
+	 */
+	static void Update();
+
+	static inline bool IsCapturing()
+	{
+		return m_capturing;
+	}
+
+	/// Open a zone in the current thread, name must live until the capture is written.
+	static void BeginZone(const char *name);
+	/// Close the last zone opened in the current thread.
+	static void EndZone();
+
+	/// Return a copy of name living until exit, used to name zones at runtime (e.g with a scene name).
+	static const char *InternName(const std::string& name);
+
+private:
+	static bool m_capturing;
+};
+
+/// Zone recorded from its construction to the end of its scope.
+class SG_ProfileZone
+{
+private:
+	bool m_active;
+
+public:
+	SG_ProfileZone(const char *name)
+		:m_active(SG_Profiler::IsCapturing())
+	{
+		if (m_active) {
+			SG_Profiler::BeginZone(name);
+		}
+	}
+
+	~SG_ProfileZone()
+	{
+		if (m_active) {
+			SG_Profiler::EndZone();
+		}
+	}
+};
+
+#define SG_PROFILE_ZONE(name) SG_ProfileZone sg_profile_zone(name)
+
+#endif  // __SG_PROFILER_H__
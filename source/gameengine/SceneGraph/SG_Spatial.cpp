@@ -54,6 +54,7 @@ SG_Spatial(
 	m_parent_relation (NULL),
 	
 	m_bbox(MT_Vector3(-1.0f, -1.0f, -1.0f), MT_Vector3(1.0f, 1.0f, 1.0f)),
+	m_worldBoundsModified(true),
 	m_modified(false),
 	m_ogldirty(false)
 {
@@ -75,6 +76,7 @@ SG_Spatial(
 	m_parent_relation(NULL),
 	
 	m_bbox(other.m_bbox),
+	m_worldBoundsModified(true),
 	m_modified(false),
 	m_ogldirty(false)
 {
@@ -213,3 +215,14 @@ void SG_Spatial::getAABBox(MT_Vector3 *box) const
 	m_bbox.getaa(box, GetWorldTransform());
 }
 
+void SG_Spatial::UpdateWorldBounds()
+{
+	const MT_Vector3 halfExtents = (m_bbox.GetMax() - m_bbox.GetMin()) * 0.5f;
+
+	m_worldBoundsCenter = m_worldPosition + m_worldRotation * (m_bbox.GetCenter() * m_worldScaling);
+	for (unsigned short i = 0; i < 3; ++i) {
+		m_worldBoundsAxis[i] = m_worldRotation.getColumn(i) * (m_worldScaling[i] * halfExtents[i]);
+	}
+
+	m_worldBoundsModified = false;
+}
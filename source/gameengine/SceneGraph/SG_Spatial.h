@@ -63,6 +63,10 @@ protected:
 	SG_ParentRelation *	m_parent_relation;
 	
 	SG_BBox			m_bbox;
+	/// World space center and half extent axes of m_bbox, see GetWorldBoundsCenter().
+	MT_Vector3		m_worldBoundsCenter;
+	MT_Vector3		m_worldBoundsAxis[3];
+	bool			m_worldBoundsModified;
 	bool			m_modified;
 	bool			m_ogldirty;		// true if the openGL matrix for this object must be recomputed
 
@@ -133,6 +137,7 @@ public:
 	void SetWorldPosition(const MT_Vector3& trans)
 	{
 		m_worldPosition = trans;
+		m_worldBoundsModified = true;
 	}
 
 	
@@ -158,6 +163,7 @@ public:
 	void SetWorldOrientation(const MT_Matrix3x3& rot) 
 	{
 		m_worldRotation = rot;
+		m_worldBoundsModified = true;
 	}
 
 	void RelativeScale(const MT_Vector3& scale)
@@ -175,6 +181,7 @@ public:
 	void SetWorldScale(const MT_Vector3& scale)
 	{ 
 		m_worldScaling = scale;
+		m_worldBoundsModified = true;
 	}
 
 	const MT_Vector3& GetLocalPosition() const
@@ -212,6 +219,7 @@ public:
 		m_worldPosition= m_localPosition;
 		m_worldScaling= m_localScaling;
 		m_worldRotation= m_localRotation;
+		m_worldBoundsModified = true;
 	}
 
 
@@ -235,12 +243,42 @@ public:
 	void SetBBox(SG_BBox& bbox)
 	{
 		m_bbox = bbox;
+		m_worldBoundsModified = true;
+	}
+
+	/**
+	 * Must be called after modifying the box returned by BBox().
+	 */
+	void SetBBoxModified()
+	{
+		m_worldBoundsModified = true;
+	}
+
+	/**
+	 * The bounding box in world space, given as its center and three half
+	 * extent axes. Only recomputed when the world transform or the box changed.
+	 */
+	const MT_Vector3& GetWorldBoundsCenter()
+	{
+		if (m_worldBoundsModified) {
+			UpdateWorldBounds();
+		}
+		return m_worldBoundsCenter;
+	}
+
+	const MT_Vector3 *GetWorldBoundsAxis()
+	{
+		if (m_worldBoundsModified) {
+			UpdateWorldBounds();
+		}
+		return m_worldBoundsAxis;
 	}
 
 
 	bool inside(const MT_Vector3 &point) const;
 	void getBBox(MT_Vector3 *box) const;
 	void getAABBox(MT_Vector3 *box) const;
+	void UpdateWorldBounds();
 
 	bool IsModified() { return m_modified; }
 	bool IsDirty() { return m_ogldirty; }
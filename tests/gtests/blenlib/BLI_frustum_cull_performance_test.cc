@@ -0,0 +1,254 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_frustum_cull.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+#include "PIL_time_utildefines.h"
+}
+
+#define NUM_OBJECTS 50000
+#define NUM_RUNS 20
+/* Distance to a plane under which both tests may disagree because of float rounding. */
+#define CULL_EPSILON 1e-3f
+
+/* Objects as the game engine stores them: a local bounding box and a world transform. */
+typedef struct CullObject {
+	float bbox_min[3], bbox_max[3];
+	float position[3];
+	float rotation[3][3];
+	float scale[3];
+} CullObject;
+
+static void cull_objects_init(CullObject *objects, const int num_objects)
+{
+	RNG *rng = BLI_rng_new(0);
+
+	for (int i = 0; i < num_objects; i++) {
+		CullObject *ob = &objects[i];
+		float eul[3];
+
+		for (int j = 0; j < 3; j++) {
+			ob->bbox_min[j] = -0.5f - BLI_rng_get_float(rng);
+			ob->bbox_max[j] = 0.5f + BLI_rng_get_float(rng);
+			ob->scale[j] = 0.5f + BLI_rng_get_float(rng) * 2.0f;
+			eul[j] = BLI_rng_get_float(rng) * (float)M_PI * 2.0f;
+		}
+		ob->position[0] = (BLI_rng_get_float(rng) - 0.5f) * 400.0f;
+		ob->position[1] = (BLI_rng_get_float(rng) - 0.5f) * 400.0f;
+		ob->position[2] = 10.0f - BLI_rng_get_float(rng) * 300.0f;
+
+		eul_to_mat3(ob->rotation, eul);
+	}
+
+	BLI_rng_free(rng);
+}
+
+/* View frustum looking down -Z, planes normalized and pointing inside (like KX_Camera). */
+static void cull_planes_init(float planes[6][4])
+{
+	float winmat[4][4];
+
+	perspective_m4(winmat, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 250.0f);
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 4; j++) {
+			planes[i * 2][j] = winmat[j][3] + winmat[j][i];
+			planes[i * 2 + 1][j] = winmat[j][3] - winmat[j][i];
+		}
+	}
+
+	for (int i = 0; i < 6; i++) {
+		mul_v4_fl(planes[i], 1.0f / len_v3(planes[i]));
+	}
+}
+
+static void cull_object_world_bounds(const CullObject *ob, float r_center[3], float r_axis[3][3])
+{
+	float center[3];
+
+	mid_v3_v3v3(center, ob->bbox_min, ob->bbox_max);
+	mul_v3_v3(center, ob->scale);
+	mul_v3_m3v3(r_center, (float (*)[3])ob->rotation, center);
+	add_v3_v3(r_center, ob->position);
+
+	for (int i = 0; i < 3; i++) {
+		mul_v3_v3fl(r_axis[i], ob->rotation[i], ob->scale[i] * (ob->bbox_max[i] - ob->bbox_min[i]) * 0.5f);
+	}
+}
+
+/* Same as the per object loop of KX_Scene: sphere test, then the eight box corners when intersecting. */
+static bool cull_object_reference(const CullObject *ob, const float planes[6][4])
+{
+	float center[3], axis[3][3];
+	float radius = 0.0f;
+	bool intersect = false;
+
+	cull_object_world_bounds(ob, center, axis);
+
+	for (int i = 0; i < 3; i++) {
+		radius = max_ff(radius, fabsf(ob->scale[i]));
+	}
+	radius *= len_v3v3(ob->bbox_min, ob->bbox_max) * 0.5f;
+
+	for (int p = 0; p < 6; p++) {
+		const float dist = plane_point_side_v3(planes[p], center);
+
+		if (dist < -radius) {
+			return false;
+		}
+		else if (dist < radius) {
+			intersect = true;
+		}
+	}
+
+	if (!intersect) {
+		return true;
+	}
+
+	float corners[8][3];
+	for (int i = 0; i < 8; i++) {
+		copy_v3_v3(corners[i], center);
+		madd_v3_v3fl(corners[i], axis[0], (i & 1) ? 1.0f : -1.0f);
+		madd_v3_v3fl(corners[i], axis[1], (i & 2) ? 1.0f : -1.0f);
+		madd_v3_v3fl(corners[i], axis[2], (i & 4) ? 1.0f : -1.0f);
+	}
+
+	for (int p = 0; p < 6; p++) {
+		int behind = 0;
+
+		for (int i = 0; i < 8; i++) {
+			if (plane_point_side_v3(planes[p], corners[i]) < 0.0f) {
+				behind++;
+			}
+		}
+
+		if (behind == 8) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* True when the box touches one of the planes, up to CULL_EPSILON. */
+static bool cull_object_near_plane(const CullObject *ob, const float planes[6][4])
+{
+	float center[3], axis[3][3];
+
+	cull_object_world_bounds(ob, center, axis);
+
+	for (int p = 0; p < 6; p++) {
+		float dist = plane_point_side_v3(planes[p], center);
+
+		/* signed distance of the corner the farthest in front of the plane */
+		for (int i = 0; i < 3; i++) {
+			dist += fabsf(dot_v3v3(planes[p], axis[i]));
+		}
+
+		if (fabsf(dist) < CULL_EPSILON) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void cull_blocks_fill(const CullObject *objects, const int num_objects, FrustumCullBlock *blocks, const int num_blocks)
+{
+	for (int i = 0; i < num_blocks * FRUSTUM_CULL_BLOCK_SIZE; i++) {
+		float center[3] = {0.0f, 0.0f, 0.0f};
+		float axis[3][3] = {{0.0f}};
+
+		if (i < num_objects) {
+			cull_object_world_bounds(&objects[i], center, axis);
+		}
+
+		BLI_frustum_cull_block_set(&blocks[i / FRUSTUM_CULL_BLOCK_SIZE], i % FRUSTUM_CULL_BLOCK_SIZE, center, axis);
+	}
+}
+
+TEST(frustum_cull, Cull50k)
+{
+	const int num_blocks = (NUM_OBJECTS + FRUSTUM_CULL_BLOCK_SIZE - 1) / FRUSTUM_CULL_BLOCK_SIZE;
+	CullObject *objects = (CullObject *)MEM_mallocN(sizeof(*objects) * NUM_OBJECTS, __func__);
+	FrustumCullBlock *blocks = (FrustumCullBlock *)MEM_mallocN(sizeof(*blocks) * num_blocks, __func__);
+	unsigned char *visible_ref = (unsigned char *)MEM_mallocN(NUM_OBJECTS, __func__);
+	unsigned char *visible = (unsigned char *)MEM_mallocN(num_blocks * FRUSTUM_CULL_BLOCK_SIZE, __func__);
+	float planes[6][4];
+	int num_visible = 0, num_mismatch = 0, num_mismatch_near = 0;
+
+	BLI_threadapi_init();
+
+	cull_objects_init(objects, NUM_OBJECTS);
+	cull_planes_init(planes);
+
+	printf("\n========== STARTING frustum_cull 50k ==========\n");
+
+	{
+		TIMEIT_START(per_object_loop);
+
+		for (int run = 0; run < NUM_RUNS; run++) {
+			for (int i = 0; i < NUM_OBJECTS; i++) {
+				visible_ref[i] = cull_object_reference(&objects[i], planes);
+			}
+		}
+
+		TIMEIT_END(per_object_loop);
+	}
+
+	{
+		/* Bounds are cached by the scene graph in the game engine, fill them once. */
+		cull_blocks_fill(objects, NUM_OBJECTS, blocks, num_blocks);
+
+		TIMEIT_START(batched);
+
+		for (int run = 0; run < NUM_RUNS; run++) {
+			BLI_frustum_cull_blocks(planes, 6, blocks, num_blocks, visible, false);
+		}
+
+		TIMEIT_END(batched);
+	}
+
+	{
+		TIMEIT_START(batched_threaded);
+
+		for (int run = 0; run < NUM_RUNS; run++) {
+			BLI_frustum_cull_blocks(planes, 6, blocks, num_blocks, visible, true);
+		}
+
+		TIMEIT_END(batched_threaded);
+	}
+
+	for (int i = 0; i < NUM_OBJECTS; i++) {
+		num_visible += visible_ref[i];
+		if ((visible_ref[i] != 0) != (visible[i] != 0)) {
+			if (cull_object_near_plane(&objects[i], planes)) {
+				num_mismatch_near++;
+			}
+			else {
+				num_mismatch++;
+			}
+		}
+	}
+
+	printf("%d objects visible out of %d, %d mismatches, %d touching a plane\n",
+	       num_visible, NUM_OBJECTS, num_mismatch, num_mismatch_near);
+	printf("========== ENDED frustum_cull 50k ==========\n\n");
+
+	/* Both tests only disagree on boxes touching a plane, because of float rounding. */
+	EXPECT_EQ(num_mismatch, 0);
+	EXPECT_GT(num_visible, 0);
+
+	BLI_threadapi_exit();
+
+	MEM_freeN(objects);
+	MEM_freeN(blocks);
+	MEM_freeN(visible_ref);
+	MEM_freeN(visible);
+}
@@ -0,0 +1,182 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_skinning.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+#include "PIL_time.h"
+}
+
+/* A crowd of 100 characters of 5000 vertices each. */
+#define NUM_VERTS 500000
+#define NUM_BONES 64
+#define NUM_RUNS 10
+
+/* Deform weights as stored in a mesh, one to four weights per vertex, not normalized. */
+typedef struct RefVertWeights {
+	int totweight;
+	int bone[SKIN_MAX_INFLUENCES];
+	float weight[SKIN_MAX_INFLUENCES];
+} RefVertWeights;
+
+static void skin_data_init(
+        float (*co)[3], float (*no)[3], RefVertWeights *ref_weights, SkinWeights *weights,
+        float bone_mats[NUM_BONES][4][4], float pre_mat[4][4], float post_mat[4][4])
+{
+	RNG *rng = BLI_rng_new(0);
+	float eul[3], loc[3];
+
+	for (int i = 0; i < NUM_VERTS; i++) {
+		RefVertWeights *rw = &ref_weights[i];
+
+		BLI_rng_get_float_unit_v3(rng, no[i]);
+		for (int j = 0; j < 3; j++) {
+			co[i][j] = (BLI_rng_get_float(rng) - 0.5f) * 2.0f;
+		}
+
+		rw->totweight = 1 + BLI_rng_get_int(rng) % SKIN_MAX_INFLUENCES;
+		for (int j = 0; j < rw->totweight; j++) {
+			rw->bone[j] = BLI_rng_get_int(rng) % NUM_BONES;
+			rw->weight[j] = 0.05f + BLI_rng_get_float(rng);
+		}
+
+		BLI_skin_weights_set(weights, i, rw->bone, rw->weight, rw->totweight);
+	}
+
+	for (int b = 0; b < NUM_BONES; b++) {
+		for (int j = 0; j < 3; j++) {
+			eul[j] = (BLI_rng_get_float(rng) - 0.5f) * 0.5f;
+			loc[j] = (BLI_rng_get_float(rng) - 0.5f) * 0.2f;
+		}
+		eul_to_mat4(bone_mats[b], eul);
+		copy_v3_v3(bone_mats[b][3], loc);
+	}
+
+	unit_m4(post_mat);
+	post_mat[3][2] = 1.0f;
+	invert_m4_m4(pre_mat, post_mat);
+
+	BLI_rng_free(rng);
+}
+
+/* Per vertex loop formerly used by the game engine: blend the offsets given by each bone matrix. */
+static void skin_deform_reference(
+        const RefVertWeights *ref_weights, float bone_mats[NUM_BONES][4][4],
+        float pre_mat[4][4], float post_mat[4][4], float (*co)[3], float (*no)[3])
+{
+	for (int i = 0; i < NUM_VERTS; i++) {
+		const RefVertWeights *rw = &ref_weights[i];
+		float vec[3] = {0.0f, 0.0f, 0.0f}, tmp[3];
+		float contrib = 0.0f, max_weight = -1.0f;
+		int max_bone = 0;
+
+		mul_m4_v3(pre_mat, co[i]);
+
+		for (int j = 0; j < rw->totweight; j++) {
+			mul_v3_m4v3(tmp, bone_mats[rw->bone[j]], co[i]);
+			sub_v3_v3(tmp, co[i]);
+			madd_v3_v3fl(vec, tmp, rw->weight[j]);
+
+			if (rw->weight[j] > max_weight) {
+				max_weight = rw->weight[j];
+				max_bone = rw->bone[j];
+			}
+			contrib += rw->weight[j];
+		}
+
+		mul_mat3_m4_v3(bone_mats[max_bone], no[i]);
+
+		madd_v3_v3fl(co[i], vec, 1.0f / contrib);
+		mul_m4_v3(post_mat, co[i]);
+	}
+}
+
+TEST(skinning, Crowd500k)
+{
+	float (*co_orig)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * NUM_VERTS, __func__);
+	float (*no_orig)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * NUM_VERTS, __func__);
+	float (*co_ref)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * NUM_VERTS, __func__);
+	float (*no_ref)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * NUM_VERTS, __func__);
+	float (*co)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * NUM_VERTS, __func__);
+	float (*no)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * NUM_VERTS, __func__);
+	RefVertWeights *ref_weights = (RefVertWeights *)MEM_mallocN(sizeof(*ref_weights) * NUM_VERTS, __func__);
+	float bone_mats[NUM_BONES][4][4], palette[NUM_BONES][4][4];
+	float pre_mat[4][4], post_mat[4][4];
+	float min[3], max[3];
+	SkinWeights weights;
+	double time_start, time_ref, time_single, time_threaded;
+	float max_error = 0.0f;
+
+	BLI_threadapi_init();
+
+	BLI_skin_weights_init(&weights, NUM_VERTS);
+	skin_data_init(co_orig, no_orig, ref_weights, &weights, bone_mats, pre_mat, post_mat);
+
+	printf("\n========== STARTING skinning 500k ==========\n");
+
+	time_start = PIL_check_seconds_timer();
+	for (int run = 0; run < NUM_RUNS; run++) {
+		memcpy(co_ref, co_orig, sizeof(float[3]) * NUM_VERTS);
+		memcpy(no_ref, no_orig, sizeof(float[3]) * NUM_VERTS);
+		skin_deform_reference(ref_weights, bone_mats, pre_mat, post_mat, co_ref, no_ref);
+	}
+	time_ref = PIL_check_seconds_timer() - time_start;
+
+	/* The palette is built once per update, it is part of the timing. */
+	time_start = PIL_check_seconds_timer();
+	for (int run = 0; run < NUM_RUNS; run++) {
+		memcpy(co, co_orig, sizeof(float[3]) * NUM_VERTS);
+		memcpy(no, no_orig, sizeof(float[3]) * NUM_VERTS);
+		for (int b = 0; b < NUM_BONES; b++) {
+			mul_m4_series(palette[b], post_mat, bone_mats[b], pre_mat);
+		}
+		BLI_skin_deform(&weights, palette, bone_mats, co, no, min, max, false);
+	}
+	time_single = PIL_check_seconds_timer() - time_start;
+
+	time_start = PIL_check_seconds_timer();
+	for (int run = 0; run < NUM_RUNS; run++) {
+		memcpy(co, co_orig, sizeof(float[3]) * NUM_VERTS);
+		memcpy(no, no_orig, sizeof(float[3]) * NUM_VERTS);
+		for (int b = 0; b < NUM_BONES; b++) {
+			mul_m4_series(palette[b], post_mat, bone_mats[b], pre_mat);
+		}
+		BLI_skin_deform(&weights, palette, bone_mats, co, no, min, max, true);
+	}
+	time_threaded = PIL_check_seconds_timer() - time_start;
+
+	printf("reference: %.2f Mverts/s\n", (double)NUM_VERTS * NUM_RUNS / time_ref * 1e-6);
+	printf("palette, single thread: %.2f Mverts/s\n", (double)NUM_VERTS * NUM_RUNS / time_single * 1e-6);
+	printf("palette, threaded: %.2f Mverts/s\n", (double)NUM_VERTS * NUM_RUNS / time_threaded * 1e-6);
+
+	for (int i = 0; i < NUM_VERTS; i++) {
+		max_error = max_ff(max_error, len_v3v3(co[i], co_ref[i]));
+		max_error = max_ff(max_error, len_v3v3(no[i], no_ref[i]));
+		for (int j = 0; j < 3; j++) {
+			EXPECT_GE(co[i][j], min[j]);
+			EXPECT_LE(co[i][j], max[j]);
+		}
+	}
+
+	printf("max error: %g\n", max_error);
+	printf("========== ENDED skinning 500k ==========\n\n");
+
+	EXPECT_LT(max_error, 1e-4f);
+
+	BLI_skin_weights_free(&weights);
+
+	BLI_threadapi_exit();
+
+	MEM_freeN(co_orig);
+	MEM_freeN(no_orig);
+	MEM_freeN(co_ref);
+	MEM_freeN(no_ref);
+	MEM_freeN(co);
+	MEM_freeN(no);
+	MEM_freeN(ref_weights);
+}
@@ -0,0 +1,118 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_sort_utils.h"
+#include "BLI_rand.h"
+#include "PIL_time_utildefines.h"
+}
+
+/* Transparent mesh slots of a scene full of foliage and particles. */
+#define NUM_SLOTS 30000
+#define NUM_MATERIALS 40
+#define NUM_RUNS 100
+
+/* Mesh slot as sorted by the game engine before this sort: a depth, ties ordered by material. */
+typedef struct SortSlot {
+	float depth;
+	unsigned int group;
+	unsigned int index;
+} SortSlot;
+
+static bool sort_slot_cmp(const SortSlot &a, const SortSlot &b)
+{
+	if (a.depth != b.depth) {
+		return a.depth < b.depth;
+	}
+	if (a.group != b.group) {
+		return a.group < b.group;
+	}
+	return a.index < b.index;
+}
+
+static void sort_slots_init(SortSlot *slots, const int num_slots)
+{
+	RNG *rng = BLI_rng_new(0);
+
+	for (int i = 0; i < num_slots; i++) {
+		/* Clusters of slots share the same depth, like particles emitted at once. */
+		slots[i].depth = (i % 8 == 0) ? 10.0f : (BLI_rng_get_float(rng) - 0.75f) * 400.0f;
+		slots[i].group = BLI_rng_get_uint(rng) % NUM_MATERIALS;
+		slots[i].index = i;
+	}
+
+	BLI_rng_free(rng);
+}
+
+TEST(sort_utils, RadixSlots30k)
+{
+	SortSlot *slots = (SortSlot *)MEM_mallocN(sizeof(*slots) * NUM_SLOTS, __func__);
+	std::vector<SortSlot> sorted_ref(NUM_SLOTS);
+	uint64_t *keys = (uint64_t *)MEM_mallocN(sizeof(*keys) * NUM_SLOTS, __func__);
+	uint64_t *keys_tmp = (uint64_t *)MEM_mallocN(sizeof(*keys_tmp) * NUM_SLOTS, __func__);
+	unsigned int *values = (unsigned int *)MEM_mallocN(sizeof(*values) * NUM_SLOTS, __func__);
+	unsigned int *values_tmp = (unsigned int *)MEM_mallocN(sizeof(*values_tmp) * NUM_SLOTS, __func__);
+	int num_mismatch = 0;
+
+	sort_slots_init(slots, NUM_SLOTS);
+
+	printf("\n========== STARTING sort_utils 30k ==========\n");
+
+	{
+		TIMEIT_START(comparison_sort);
+
+		for (int run = 0; run < NUM_RUNS; run++) {
+			sorted_ref.assign(slots, slots + NUM_SLOTS);
+			std::sort(sorted_ref.begin(), sorted_ref.end(), sort_slot_cmp);
+		}
+
+		TIMEIT_END(comparison_sort);
+	}
+
+	{
+		TIMEIT_START(radix_sort);
+
+		for (int run = 0; run < NUM_RUNS; run++) {
+			for (int i = 0; i < NUM_SLOTS; i++) {
+				keys[i] = ((uint64_t)BLI_sortutil_float_as_key(slots[i].depth) << 32) | slots[i].group;
+				values[i] = i;
+			}
+			BLI_sortutil_radix_u64(keys, values, keys_tmp, values_tmp, NUM_SLOTS);
+		}
+
+		TIMEIT_END(radix_sort);
+	}
+
+	for (int i = 0; i < NUM_SLOTS; i++) {
+		if (sorted_ref[i].index != values[i]) {
+			num_mismatch++;
+		}
+	}
+
+	printf("%d mismatches\n", num_mismatch);
+	printf("========== ENDED sort_utils 30k ==========\n\n");
+
+	/* The radix sort is stable, equal keys keep the order of their index like the reference. */
+	EXPECT_EQ(num_mismatch, 0);
+
+	MEM_freeN(slots);
+	MEM_freeN(keys);
+	MEM_freeN(keys_tmp);
+	MEM_freeN(values);
+	MEM_freeN(values_tmp);
+}
+
+TEST(sort_utils, FloatAsKey)
+{
+	const float values[] = {-1e30f, -2.5f, -1.0f, -1e-30f, -0.0f, 0.0f, 1e-30f, 1.0f, 2.5f, 1e30f};
+
+	for (int i = 1; i < (int)ARRAY_SIZE(values); i++) {
+		EXPECT_LT(BLI_sortutil_float_as_key(values[i - 1]), BLI_sortutil_float_as_key(values[i]));
+	}
+}
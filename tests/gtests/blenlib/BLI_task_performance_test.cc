@@ -0,0 +1,104 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "PIL_time_utildefines.h"
+
+#include "atomic_ops.h"
+}
+
+/* Only uses the public task API, so it can be built against older revisions of the scheduler
+ * to compare push/pop throughput. */
+
+#define NUM_TASKS 1000000
+#define NUM_PARENT_TASKS 1000
+#define NUM_CHILD_TASKS (NUM_TASKS / NUM_PARENT_TASKS)
+
+static void task_empty_run(TaskPool *__restrict pool, void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	size_t *num_done = (size_t *)BLI_task_pool_userdata(pool);
+
+	atomic_add_z(num_done, 1);
+}
+
+static void task_parent_run(TaskPool *__restrict pool, void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	size_t *num_done = (size_t *)BLI_task_pool_userdata(pool);
+	int i;
+
+	/* Pushes from worker threads, those go through the scheduler's per-thread queues. */
+	for (i = 0; i < NUM_CHILD_TASKS; i++) {
+		BLI_task_pool_push(pool, task_empty_run, NULL, false, TASK_PRIORITY_LOW);
+	}
+
+	atomic_add_z(num_done, 1);
+}
+
+static void task_push_pop_tests(const int num_threads, const char *id)
+{
+	TaskScheduler *scheduler;
+	TaskPool *pool;
+	size_t num_done;
+
+	printf("\n========== STARTING %s ==========\n", id);
+
+	BLI_threadapi_init();
+	scheduler = BLI_task_scheduler_create(num_threads);
+
+	{
+		num_done = 0;
+		pool = BLI_task_pool_create(scheduler, &num_done);
+
+		TIMEIT_START(push_from_main_thread);
+
+		for (int i = 0; i < NUM_TASKS; i++) {
+			BLI_task_pool_push(pool, task_empty_run, NULL, false, TASK_PRIORITY_LOW);
+		}
+		BLI_task_pool_work_and_wait(pool);
+
+		TIMEIT_END(push_from_main_thread);
+
+		EXPECT_EQ(NUM_TASKS, num_done);
+		EXPECT_EQ(NUM_TASKS, BLI_task_pool_tasks_done(pool));
+
+		BLI_task_pool_free(pool);
+	}
+
+	{
+		num_done = 0;
+		pool = BLI_task_pool_create(scheduler, &num_done);
+
+		TIMEIT_START(push_from_worker_threads);
+
+		for (int i = 0; i < NUM_PARENT_TASKS; i++) {
+			BLI_task_pool_push(pool, task_parent_run, NULL, false, TASK_PRIORITY_HIGH);
+		}
+		BLI_task_pool_work_and_wait(pool);
+
+		TIMEIT_END(push_from_worker_threads);
+
+		EXPECT_EQ(NUM_TASKS + NUM_PARENT_TASKS, num_done);
+
+		BLI_task_pool_free(pool);
+	}
+
+	BLI_task_scheduler_free(scheduler);
+	BLI_threadapi_exit();
+
+	printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(task, PushPopSingleThread)
+{
+	task_push_pop_tests(1, "PushPopSingleThread - 1 thread");
+}
+
+TEST(task, PushPopMultiThread)
+{
+	task_push_pop_tests(0, "PushPopMultiThread - all threads");
+}
@@ -0,0 +1,180 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <vector>
+
+#include "EXP_CompiledExpr.h"
+#include "EXP_Expression.h"
+#include "EXP_InputParser.h"
+#include "EXP_BoolValue.h"
+#include "EXP_EmptyValue.h"
+#include "EXP_FloatValue.h"
+#include "EXP_IntValue.h"
+#include "EXP_StringValue.h"
+#include "MT_Scalar.h"
+
+extern "C" {
+#include "PIL_time.h"
+}
+
+/* Expression controllers of many objects, e.g. the AI logic of a crowd. */
+#define NUM_CONTROLLERS 100000
+#define NUM_OWNERS 1000
+#define NUM_TICKS 10
+
+static const char *expressions[] = {
+	"health > 0 AND ammo >= 1",
+	"IF(speed * 2.5 > 10.0, alive, NOT alive)",
+	"state == \"idle\" OR timer > 3.0",
+	"(score % 7) + level * 3 < 50",
+	"-speed < 0.5 AND NOT (health == 100)",
+	"timer / 2 >= speed - 1 AND state != \"dead\"",
+};
+
+#define NUM_EXPRESSIONS (sizeof(expressions) / sizeof(expressions[0]))
+
+/* Same lookup as SCA_ExpressionController, without sensors. */
+class OwnerContext : public CCompiledExprContext
+{
+public:
+	CValue *m_owner;
+
+	virtual bool GetIdentifierValue(const STR_String& name, unsigned int id, CCompiledValue& value)
+	{
+		if (id == EXP_PROPERTY_ID_NONE) {
+			return false;
+		}
+		CValue *prop = m_owner->GetPropertyFromId(id);
+		return (prop && value.SetValue(prop));
+	}
+};
+
+struct Controller
+{
+	CExpression *m_expr;
+	CCompiledExpr *m_compiled;
+	OwnerContext m_context;
+};
+
+static void owner_set_property(CValue *owner, const char *name, CValue *value)
+{
+	owner->SetProperty(name, value);
+	value->Release();
+}
+
+static void owners_update(std::vector<CValue *>& owners, int tick)
+{
+	for (unsigned int i = 0; i < owners.size(); i++) {
+		CFloatValue *timer = (CFloatValue *)owners[i]->GetProperty("timer");
+		timer->SetFloat((float)((i + tick * 13) % 50) * 0.1f);
+	}
+}
+
+/* Same result as SCA_ExpressionController::Trigger. */
+static bool tree_evaluate(CExpression *expr)
+{
+	bool result = false;
+	CValue *value = expr->Calculate();
+	if (!value->IsError()) {
+		result = !MT_fuzzyZero((float)value->GetNumber());
+	}
+	value->Release();
+	return result;
+}
+
+TEST(expressions, CompiledExpr)
+{
+	printf("\n========== STARTING expressions %d controllers ==========\n", NUM_CONTROLLERS);
+
+	std::vector<CValue *> owners(NUM_OWNERS);
+	for (unsigned int i = 0; i < NUM_OWNERS; i++) {
+		CValue *owner = new CEmptyValue();
+		owner_set_property(owner, "health", new CIntValue(i % 101));
+		owner_set_property(owner, "ammo", new CIntValue(i % 3));
+		owner_set_property(owner, "score", new CIntValue(i * 7));
+		owner_set_property(owner, "level", new CIntValue(i % 20));
+		owner_set_property(owner, "speed", new CFloatValue((float)(i % 17) * 0.5f));
+		owner_set_property(owner, "timer", new CFloatValue(0.0f));
+		owner_set_property(owner, "alive", new CBoolValue((i % 5) != 0));
+		owner_set_property(owner, "state", new CStringValue((i % 4) ? "idle" : "dead", ""));
+		owners[i] = owner;
+	}
+
+	std::vector<Controller> controllers(NUM_CONTROLLERS);
+	int num_compiled = 0;
+	for (unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+		Controller& controller = controllers[i];
+		controller.m_context.m_owner = owners[i % NUM_OWNERS];
+
+		CParser parser;
+		parser.SetContext(controller.m_context.m_owner->AddRef());
+		controller.m_expr = parser.ProcessText(expressions[i % NUM_EXPRESSIONS]);
+		controller.m_compiled = CCompiledExpr::Compile(controller.m_expr);
+		if (controller.m_compiled) {
+			num_compiled++;
+		}
+	}
+	EXPECT_EQ(num_compiled, NUM_CONTROLLERS);
+
+	std::vector<bool> results_tree(NUM_CONTROLLERS);
+	std::vector<bool> results_compiled(NUM_CONTROLLERS);
+	double time_tree = 0.0;
+	double time_compiled = 0.0;
+	int num_mismatch = 0;
+	int num_fallback = 0;
+	int num_true = 0;
+
+	for (int tick = 0; tick < NUM_TICKS; tick++) {
+		owners_update(owners, tick);
+
+		double time_start = PIL_check_seconds_timer();
+		for (unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+			results_tree[i] = tree_evaluate(controllers[i].m_expr);
+		}
+		time_tree += PIL_check_seconds_timer() - time_start;
+
+		time_start = PIL_check_seconds_timer();
+		for (unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+			Controller& controller = controllers[i];
+			CCompiledValue value;
+			if (controller.m_compiled->Evaluate(&controller.m_context, value)) {
+				results_compiled[i] = !MT_fuzzyZero((float)value.GetNumber());
+			}
+			else {
+				results_compiled[i] = tree_evaluate(controller.m_expr);
+				num_fallback++;
+			}
+		}
+		time_compiled += PIL_check_seconds_timer() - time_start;
+
+		for (unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+			if (results_tree[i] != results_compiled[i]) {
+				num_mismatch++;
+			}
+			if (results_tree[i]) {
+				num_true++;
+			}
+		}
+	}
+
+	printf("tree: %.2f ms per tick\n", time_tree / NUM_TICKS * 1000.0);
+	printf("compiled: %.2f ms per tick\n", time_compiled / NUM_TICKS * 1000.0);
+
+	/* The compiled expressions give the same results than the trees without falling back to them. */
+	EXPECT_EQ(num_mismatch, 0);
+	EXPECT_EQ(num_fallback, 0);
+	/* The expressions aren't constant. */
+	EXPECT_GT(num_true, 0);
+	EXPECT_LT(num_true, NUM_CONTROLLERS * NUM_TICKS);
+
+	for (unsigned int i = 0; i < NUM_CONTROLLERS; i++) {
+		delete controllers[i].m_compiled;
+		controllers[i].m_expr->Release();
+	}
+	for (unsigned int i = 0; i < NUM_OWNERS; i++) {
+		owners[i]->Release();
+	}
+
+	printf("========== ENDED expressions ==========\n\n");
+}
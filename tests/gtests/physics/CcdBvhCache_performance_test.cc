@@ -0,0 +1,163 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <vector>
+
+#include "btBulletCollisionCommon.h"
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
+#include "BulletCollision/NarrowPhaseCollision/btRaycastCallback.h"
+
+#include "CcdBvhCache.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "PIL_time.h"
+}
+
+/* A terrain of 2 * GRID_SIZE^2 triangles, e.g. the static ground of an open world tile. */
+#define GRID_SIZE 400
+#define NUM_RAYS 10000
+#define CACHE_DIRECTORY "CcdBvhCache_test"
+
+class Terrain
+{
+public:
+	std::vector<btScalar> m_vertices;
+	std::vector<int> m_indices;
+	btTriangleIndexVertexArray *m_mesh;
+
+	Terrain()
+	{
+		for (int y = 0; y <= GRID_SIZE; y++) {
+			for (int x = 0; x <= GRID_SIZE; x++) {
+				m_vertices.push_back(x);
+				m_vertices.push_back(y);
+				m_vertices.push_back(btSin(x * 0.1f) * btCos(y * 0.13f) * 3.0f);
+			}
+		}
+
+		for (int y = 0; y < GRID_SIZE; y++) {
+			for (int x = 0; x < GRID_SIZE; x++) {
+				const int v = y * (GRID_SIZE + 1) + x;
+				const int quad[6] = {v, v + 1, v + GRID_SIZE + 2, v, v + GRID_SIZE + 2, v + GRID_SIZE + 1};
+				m_indices.insert(m_indices.end(), quad, quad + 6);
+			}
+		}
+
+		m_mesh = new btTriangleIndexVertexArray(m_indices.size() / 3, &m_indices[0], 3 * sizeof(int),
+		                                        m_vertices.size() / 3, &m_vertices[0], 3 * sizeof(btScalar));
+	}
+
+	~Terrain()
+	{
+		delete m_mesh;
+	}
+};
+
+/* Same construction as CcdShapeConstructionInfo::CreateBulletShape. */
+static btBvhTriangleMeshShape *terrain_shape(Terrain& terrain, btOptimizedBvh **r_bvh)
+{
+	btBvhTriangleMeshShape *shape = new btBvhTriangleMeshShape(terrain.m_mesh, true, false);
+	const double time_start = PIL_check_seconds_timer();
+	*r_bvh = CcdBvhCache::GetBvh(terrain.m_mesh, shape->getLocalAabbMin(), shape->getLocalAabbMax());
+	printf("GetBvh: %.2f ms\n", (PIL_check_seconds_timer() - time_start) * 1000.0);
+	shape->setOptimizedBvh(*r_bvh);
+	return shape;
+}
+
+class RayCallback : public btTriangleRaycastCallback
+{
+public:
+	int m_triangleIndex;
+
+	RayCallback(const btVector3& from, const btVector3& to)
+		:btTriangleRaycastCallback(from, to),
+		m_triangleIndex(-1)
+	{
+	}
+
+	virtual btScalar reportHit(const btVector3& UNUSED(hitNormalLocal), btScalar hitFraction, int UNUSED(partId),
+	                           int triangleIndex)
+	{
+		m_triangleIndex = triangleIndex;
+		return hitFraction;
+	}
+};
+
+static void terrain_rays(btBvhTriangleMeshShape *shape, std::vector<int>& r_hits)
+{
+	r_hits.resize(NUM_RAYS);
+	unsigned int seed = 1;
+	for (unsigned int i = 0; i < NUM_RAYS; i++) {
+		float values[2];
+		for (int j = 0; j < 2; j++) {
+			seed = seed * 1103515245 + 12345;
+			values[j] = (float)((seed >> 8) & 0xffff) / 65535.0f * GRID_SIZE;
+		}
+		const btVector3 from(values[0], values[1], 10.0f);
+		const btVector3 to(values[1], values[0], -10.0f);
+		RayCallback callback(from, to);
+		shape->performRaycast(&callback, from, to);
+		r_hits[i] = callback.m_triangleIndex;
+	}
+}
+
+TEST(physics, BvhCache)
+{
+	printf("\n========== STARTING physics BVH cache %d triangles ==========\n", GRID_SIZE * GRID_SIZE * 2);
+
+	Terrain terrain;
+	std::vector<int> hits_built, hits_cached;
+
+	BLI_delete(CACHE_DIRECTORY, true, true);
+
+	/* Without cache, then saved in the cache, then loaded from it. */
+	const char *directories[3] = {"", CACHE_DIRECTORY, CACHE_DIRECTORY};
+	for (int i = 0; i < 3; i++) {
+		CcdBvhCache::SetDirectory(directories[i]);
+
+		btOptimizedBvh *bvh;
+		btBvhTriangleMeshShape *shape = terrain_shape(terrain, &bvh);
+		terrain_rays(shape, (i == 0) ? hits_built : hits_cached);
+		delete shape;
+		CcdBvhCache::FreeBvh(bvh);
+
+		if (i == 0) {
+			continue;
+		}
+
+		/* The loaded tree is the same as the built one. */
+		int num_mismatch = 0;
+		for (unsigned int j = 0; j < NUM_RAYS; j++) {
+			if (hits_built[j] != hits_cached[j]) {
+				num_mismatch++;
+			}
+		}
+		EXPECT_EQ(num_mismatch, 0);
+	}
+
+	int num_hits = 0;
+	for (unsigned int i = 0; i < NUM_RAYS; i++) {
+		if (hits_built[i] != -1) {
+			num_hits++;
+		}
+	}
+	EXPECT_GT(num_hits, NUM_RAYS / 2);
+
+	/* A changed mesh doesn't use the file of the previous one. */
+	std::string path, pathchanged;
+	btBvhTriangleMeshShape *shape = new btBvhTriangleMeshShape(terrain.m_mesh, true, false);
+	EXPECT_TRUE(CcdBvhCache::GetFilePath(terrain.m_mesh, shape->getLocalAabbMin(), shape->getLocalAabbMax(), path));
+	EXPECT_TRUE(BLI_exists(path.c_str()));
+	terrain.m_vertices[2] += 0.5f;
+	EXPECT_TRUE(CcdBvhCache::GetFilePath(terrain.m_mesh, shape->getLocalAabbMin(), shape->getLocalAabbMax(), pathchanged));
+	EXPECT_NE(path, pathchanged);
+	delete shape;
+
+	CcdBvhCache::SetDirectory("");
+	BLI_delete(CACHE_DIRECTORY, true, true);
+
+	printf("========== ENDED physics BVH cache ==========\n\n");
+}
@@ -0,0 +1,199 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <vector>
+#include <string.h>
+
+#include "btBulletDynamicsCommon.h"
+#include "BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h"
+
+#include "CcdParallelWorld.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "PIL_time.h"
+}
+
+/* Rubble of a destruction scene: stacks of boxes, every other layer a convex hull box. */
+#define GRID_SIZE 10
+#define STACK_HEIGHT 20
+#define NUM_STEPS 120
+#define TIME_STEP (1.0f / 60.0f)
+
+/* Same setup than CcdPhysicsEnvironment, with the stock or the parallel world. */
+class BoxStackWorld
+{
+public:
+	btSoftBodyRigidBodyCollisionConfiguration *m_config;
+	btCollisionDispatcher *m_dispatcher;
+	btDbvtBroadphase *m_broadphase;
+	btSequentialImpulseConstraintSolver *m_solver;
+	btSoftRigidDynamicsWorld *m_world;
+	btBoxShape *m_boxShape;
+	btBoxShape *m_groundShape;
+	btConvexHullShape *m_hullShape;
+	std::vector<btRigidBody *> m_bodies;
+	btDefaultMotionState *m_kinematicState;
+
+	BoxStackWorld(TaskScheduler *scheduler)
+	{
+		btDefaultCollisionConstructionInfo constructionInfo;
+		if (scheduler) {
+			constructionInfo.m_customCollisionAlgorithmMaxElementSize = sizeof(CcdConvexConvexAlgorithm);
+		}
+		m_config = new btSoftBodyRigidBodyCollisionConfiguration(constructionInfo);
+		m_broadphase = new btDbvtBroadphase();
+		m_solver = new btSequentialImpulseConstraintSolver();
+
+		if (scheduler) {
+			m_dispatcher = new CcdCollisionDispatcher(m_config, scheduler);
+			m_world = new CcdDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_config, scheduler);
+		}
+		else {
+			m_dispatcher = new btCollisionDispatcher(m_config);
+			m_world = new btSoftRigidDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_config);
+		}
+		m_world->setGravity(btVector3(0.0f, 0.0f, -9.81f));
+
+		m_boxShape = new btBoxShape(btVector3(0.5f, 0.5f, 0.5f));
+		m_groundShape = new btBoxShape(btVector3(GRID_SIZE * 2.0f, GRID_SIZE * 2.0f, 1.0f));
+		m_hullShape = new btConvexHullShape();
+		for (int i = 0; i < 8; i++) {
+			m_hullShape->addPoint(btVector3((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f));
+		}
+
+		AddBody(m_groundShape, 0.0f, btVector3(GRID_SIZE, GRID_SIZE, -1.0f));
+
+		for (int x = 0; x < GRID_SIZE; x++) {
+			for (int y = 0; y < GRID_SIZE; y++) {
+				for (int z = 0; z < STACK_HEIGHT; z++) {
+					/* Slightly shifted layers, the stacks slowly collapse. */
+					const btVector3 pos(x * 2.0f + 0.05f * (z % 3), y * 2.0f, 0.5f + z * 1.01f);
+					AddBody((z & 1) ? (btConvexShape *)m_hullShape : (btConvexShape *)m_boxShape, 1.0f, pos);
+				}
+			}
+		}
+
+		/* A kinematic box pushing the first stack, its island is solved serially. */
+		m_kinematicState = new btDefaultMotionState(btTransform(btQuaternion::getIdentity(), btVector3(-1.5f, 0.0f, 0.5f)));
+		btRigidBody *kinematic = new btRigidBody(0.0f, m_kinematicState, m_boxShape);
+		kinematic->setCollisionFlags(kinematic->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
+		kinematic->setActivationState(DISABLE_DEACTIVATION);
+		m_world->addRigidBody(kinematic);
+		m_bodies.push_back(kinematic);
+	}
+
+	~BoxStackWorld()
+	{
+		for (std::vector<btRigidBody *>::iterator it = m_bodies.begin(); it != m_bodies.end(); ++it) {
+			m_world->removeRigidBody(*it);
+			delete (*it)->getMotionState();
+			delete *it;
+		}
+
+		delete m_world;
+		delete m_solver;
+		delete m_broadphase;
+		delete m_dispatcher;
+		delete m_config;
+		delete m_boxShape;
+		delete m_groundShape;
+		delete m_hullShape;
+	}
+
+	void AddBody(btCollisionShape *shape, float mass, const btVector3& pos)
+	{
+		btVector3 inertia(0.0f, 0.0f, 0.0f);
+		if (mass != 0.0f) {
+			shape->calculateLocalInertia(mass, inertia);
+		}
+
+		btDefaultMotionState *state = new btDefaultMotionState(btTransform(btQuaternion::getIdentity(), pos));
+		btRigidBody *body = new btRigidBody(mass, state, shape, inertia);
+		m_world->addRigidBody(body);
+		m_bodies.push_back(body);
+	}
+
+	double Run()
+	{
+		const double time_start = PIL_check_seconds_timer();
+
+		for (int step = 0; step < NUM_STEPS; step++) {
+			btTransform trans;
+			m_kinematicState->getWorldTransform(trans);
+			trans.getOrigin() += btVector3(TIME_STEP, 0.0f, 0.0f);
+			m_kinematicState->setWorldTransform(trans);
+
+			m_world->stepSimulation(TIME_STEP, 1, TIME_STEP);
+		}
+
+		return PIL_check_seconds_timer() - time_start;
+	}
+
+	void GetTransforms(std::vector<btTransform>& transforms) const
+	{
+		transforms.clear();
+		for (std::vector<btRigidBody *>::const_iterator it = m_bodies.begin(); it != m_bodies.end(); ++it) {
+			transforms.push_back((*it)->getWorldTransform());
+		}
+	}
+};
+
+static int transforms_mismatch(const std::vector<btTransform>& a, const std::vector<btTransform>& b)
+{
+	int num_mismatch = 0;
+
+	for (unsigned int i = 0; i < a.size(); i++) {
+		if (memcmp(&a[i].getBasis(), &b[i].getBasis(), sizeof(btMatrix3x3)) != 0 ||
+		    memcmp(&a[i].getOrigin(), &b[i].getOrigin(), sizeof(btVector3)) != 0)
+		{
+			num_mismatch++;
+		}
+	}
+
+	return num_mismatch;
+}
+
+TEST(physics, BoxStacks)
+{
+	std::vector<btTransform> transforms_ref, transforms;
+	const int max_threads = MAX2(BLI_system_thread_count(), 4);
+
+	BLI_threadapi_init();
+
+	printf("\n========== STARTING physics %d boxes ==========\n", GRID_SIZE * GRID_SIZE * STACK_HEIGHT);
+
+	{
+		BoxStackWorld world(NULL);
+		const double time = world.Run();
+		printf("stock world: %.1f steps/s\n", NUM_STEPS / time);
+	}
+
+	for (int num_threads = 1; num_threads <= max_threads; num_threads++) {
+		TaskScheduler *scheduler = BLI_task_scheduler_create(num_threads);
+
+		{
+			BoxStackWorld world(scheduler);
+			const double time = world.Run();
+			printf("parallel world, %d threads: %.1f steps/s\n", num_threads, NUM_STEPS / time);
+
+			if (num_threads == 1) {
+				world.GetTransforms(transforms_ref);
+			}
+			else {
+				world.GetTransforms(transforms);
+				/* The simulation doesn't depend on the amount of threads. */
+				EXPECT_EQ(transforms_mismatch(transforms_ref, transforms), 0);
+			}
+		}
+
+		BLI_task_scheduler_free(scheduler);
+	}
+
+	printf("========== ENDED physics ==========\n\n");
+
+	BLI_threadapi_exit();
+}
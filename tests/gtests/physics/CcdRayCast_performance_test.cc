@@ -0,0 +1,213 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <vector>
+#include <algorithm>
+
+#include "btBulletDynamicsCommon.h"
+#include "BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h"
+
+#include "CcdParallelWorld.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "PIL_time.h"
+}
+
+/* A field of boxes and spheres shot by rays from above, e.g. the sensors of many AI agents. */
+#define GRID_SIZE 64
+#define NUM_RAYS 100000
+#define RAYS_PER_TASK 64
+
+class RayCastWorld
+{
+public:
+	btSoftBodyRigidBodyCollisionConfiguration *m_config;
+	btCollisionDispatcher *m_dispatcher;
+	btDbvtBroadphase *m_broadphase;
+	btSequentialImpulseConstraintSolver *m_solver;
+	btSoftRigidDynamicsWorld *m_world;
+	btBoxShape *m_boxShape;
+	btSphereShape *m_sphereShape;
+	std::vector<btRigidBody *> m_bodies;
+
+	RayCastWorld()
+	{
+		m_config = new btSoftBodyRigidBodyCollisionConfiguration();
+		m_dispatcher = new btCollisionDispatcher(m_config);
+		m_broadphase = new btDbvtBroadphase();
+		m_solver = new btSequentialImpulseConstraintSolver();
+		m_world = new btSoftRigidDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_config);
+
+		m_boxShape = new btBoxShape(btVector3(0.4f, 0.4f, 0.4f));
+		m_sphereShape = new btSphereShape(0.4f);
+
+		for (int x = 0; x < GRID_SIZE; x++) {
+			for (int y = 0; y < GRID_SIZE; y++) {
+				/* Half of the objects are static, half are dynamic, to fill both broadphase sets. */
+				const btVector3 pos(x, y, (x * 7 + y * 3) % 5);
+				AddBody(((x + y) & 1) ? (btCollisionShape *)m_sphereShape : (btCollisionShape *)m_boxShape,
+				        (x & 1) ? 1.0f : 0.0f, pos);
+			}
+		}
+
+		/* Let the dynamic objects be moved in the broadphase once. */
+		m_world->stepSimulation(1.0f / 60.0f, 1, 1.0f / 60.0f);
+	}
+
+	~RayCastWorld()
+	{
+		for (std::vector<btRigidBody *>::iterator it = m_bodies.begin(); it != m_bodies.end(); ++it) {
+			m_world->removeRigidBody(*it);
+			delete (*it)->getMotionState();
+			delete *it;
+		}
+
+		delete m_world;
+		delete m_solver;
+		delete m_broadphase;
+		delete m_dispatcher;
+		delete m_config;
+		delete m_boxShape;
+		delete m_sphereShape;
+	}
+
+	void AddBody(btCollisionShape *shape, float mass, const btVector3& pos)
+	{
+		btVector3 inertia(0.0f, 0.0f, 0.0f);
+		if (mass != 0.0f) {
+			shape->calculateLocalInertia(mass, inertia);
+		}
+
+		btDefaultMotionState *state = new btDefaultMotionState(btTransform(btQuaternion::getIdentity(), pos));
+		btRigidBody *body = new btRigidBody(mass, state, shape, inertia);
+		/* Keep the dynamic objects in place. */
+		body->setGravity(btVector3(0.0f, 0.0f, 0.0f));
+		m_world->addRigidBody(body);
+		m_bodies.push_back(body);
+	}
+};
+
+struct RayBatch
+{
+	btSoftRigidDynamicsWorld *m_world;
+	btDbvtBroadphase *m_broadphase;
+	std::vector<btVector3> m_from;
+	std::vector<btVector3> m_to;
+	std::vector<const btCollisionObject *> m_hitObjects;
+	std::vector<btVector3> m_hitPoints;
+};
+
+static void ray_batch_single(RayBatch *batch, unsigned int i, bool concurrent)
+{
+	btCollisionWorld::ClosestRayResultCallback callback(batch->m_from[i], batch->m_to[i]);
+	if (concurrent) {
+		CcdConcurrentRayTest(batch->m_broadphase, batch->m_from[i], batch->m_to[i], callback);
+	}
+	else {
+		batch->m_world->rayTest(batch->m_from[i], batch->m_to[i], callback);
+	}
+
+	batch->m_hitObjects[i] = callback.m_collisionObject;
+	batch->m_hitPoints[i] = callback.hasHit() ? callback.m_hitPointWorld : btVector3(0.0f, 0.0f, 0.0f);
+}
+
+static void ray_batch_task(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	RayBatch *batch = (RayBatch *)BLI_task_pool_userdata(pool);
+	const unsigned int start = GET_UINT_FROM_POINTER(taskdata) * RAYS_PER_TASK;
+	const unsigned int end = std::min(start + RAYS_PER_TASK, (unsigned int)batch->m_from.size());
+
+	for (unsigned int i = start; i < end; i++) {
+		ray_batch_single(batch, i, true);
+	}
+}
+
+static void ray_batch_init(RayBatch& batch, const RayCastWorld& world)
+{
+	batch.m_world = world.m_world;
+	batch.m_broadphase = world.m_broadphase;
+	batch.m_from.resize(NUM_RAYS);
+	batch.m_to.resize(NUM_RAYS);
+	batch.m_hitObjects.resize(NUM_RAYS);
+	batch.m_hitPoints.resize(NUM_RAYS);
+
+	/* Deterministic pseudo random rays, mostly going down through the field. */
+	unsigned int seed = 1;
+	for (unsigned int i = 0; i < NUM_RAYS; i++) {
+		float values[4];
+		for (int j = 0; j < 4; j++) {
+			seed = seed * 1103515245 + 12345;
+			values[j] = (float)((seed >> 8) & 0xffff) / 65535.0f * GRID_SIZE;
+		}
+		batch.m_from[i] = btVector3(values[0], values[1], 10.0f);
+		batch.m_to[i] = btVector3(values[2], values[3], -10.0f);
+	}
+}
+
+TEST(physics, RayCastBatch)
+{
+	const int max_threads = MAX2(BLI_system_thread_count(), 4);
+
+	BLI_threadapi_init();
+
+	printf("\n========== STARTING physics %d rays ==========\n", NUM_RAYS);
+
+	RayCastWorld world;
+	RayBatch batch_ref, batch;
+	ray_batch_init(batch_ref, world);
+	ray_batch_init(batch, world);
+
+	{
+		const double time_start = PIL_check_seconds_timer();
+		for (unsigned int i = 0; i < NUM_RAYS; i++) {
+			ray_batch_single(&batch_ref, i, false);
+		}
+		const double time = PIL_check_seconds_timer() - time_start;
+		printf("rayTest loop: %.0f rays/ms\n", NUM_RAYS / time / 1000.0);
+	}
+
+	int num_hits = 0;
+	for (unsigned int i = 0; i < NUM_RAYS; i++) {
+		if (batch_ref.m_hitObjects[i]) {
+			num_hits++;
+		}
+	}
+	/* The rays hit something most of the time, the test isn't only measuring the broadphase. */
+	EXPECT_GT(num_hits, NUM_RAYS / 2);
+
+	for (int num_threads = 1; num_threads <= max_threads; num_threads++) {
+		TaskScheduler *scheduler = BLI_task_scheduler_create(num_threads);
+		TaskPool *pool = BLI_task_pool_create(scheduler, &batch);
+
+		const double time_start = PIL_check_seconds_timer();
+		const unsigned int num_tasks = (NUM_RAYS + RAYS_PER_TASK - 1) / RAYS_PER_TASK;
+		for (unsigned int i = 0; i < num_tasks; i++) {
+			BLI_task_pool_push(pool, ray_batch_task, SET_UINT_IN_POINTER(i), false, TASK_PRIORITY_HIGH);
+		}
+		BLI_task_pool_work_and_wait(pool);
+		const double time = PIL_check_seconds_timer() - time_start;
+		printf("concurrent batch, %d threads: %.0f rays/ms\n", num_threads, NUM_RAYS / time / 1000.0);
+
+		BLI_task_pool_free(pool);
+		BLI_task_scheduler_free(scheduler);
+
+		/* The batch gives the same hits than the stock ray test. */
+		int num_mismatch = 0;
+		for (unsigned int i = 0; i < NUM_RAYS; i++) {
+			if (batch.m_hitObjects[i] != batch_ref.m_hitObjects[i] ||
+			    (batch.m_hitPoints[i] - batch_ref.m_hitPoints[i]).length2() > 1e-8f)
+			{
+				num_mismatch++;
+			}
+		}
+		EXPECT_EQ(num_mismatch, 0);
+	}
+
+	printf("========== ENDED physics ==========\n\n");
+
+	BLI_threadapi_exit();
+}
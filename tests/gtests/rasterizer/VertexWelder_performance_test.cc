@@ -0,0 +1,199 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <vector>
+
+#include "RAS_VertexWelder.h"
+#include "RAS_TexVert.h"
+#include "MT_Vector2.h"
+#include "MT_Vector3.h"
+#include "MT_Vector4.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "PIL_time.h"
+}
+
+/* A smooth terrain of 2 * GRID_SIZE^2 triangles, its two halves use two materials. */
+#define GRID_SIZE 1000
+/* Smaller terrains welded in parallel, like the meshes of a scene. */
+#define NUM_MESHES 8
+#define MESH_GRID_SIZE 250
+
+/* The previous layout, a vector of the shared vertices of each original vertex. */
+class VectorWelder
+{
+private:
+	struct SharedVertex
+	{
+		unsigned int m_array;
+		unsigned int m_offset;
+	};
+
+	std::vector<std::vector<SharedVertex> > m_sharedVertices;
+	std::vector<std::vector<RAS_TexVert> > m_arrays;
+
+public:
+	VectorWelder(unsigned int numOrigVertices)
+		:m_sharedVertices(numOrigVertices),
+		m_arrays(2)
+	{
+	}
+
+	unsigned int AddVertex(unsigned int array, const RAS_TexVert& vertex)
+	{
+		std::vector<SharedVertex>& sharedmap = m_sharedVertices[vertex.getOrigIndex()];
+		for (std::vector<SharedVertex>::iterator it = sharedmap.begin(); it != sharedmap.end(); ++it) {
+			if (it->m_array == array && m_arrays[array][it->m_offset].closeTo(&vertex)) {
+				return it->m_offset;
+			}
+		}
+
+		SharedVertex shared = {array, (unsigned int)m_arrays[array].size()};
+		m_arrays[array].push_back(vertex);
+		sharedmap.push_back(shared);
+		return shared.m_offset;
+	}
+
+	std::vector<RAS_TexVert>& GetVertices(unsigned int array)
+	{
+		return m_arrays[array];
+	}
+};
+
+static RAS_TexVert grid_vertex(int size, int x, int y)
+{
+	const float height = sinf(x * 0.1f) * cosf(y * 0.13f) * 3.0f;
+	float normal[3] = {-cosf(x * 0.1f) * cosf(y * 0.13f) * 0.3f, sinf(x * 0.1f) * sinf(y * 0.13f) * 0.39f, 1.0f};
+	normalize_v3(normal);
+
+	MT_Vector2 uvs[RAS_TexVert::MAX_UNIT];
+	uvs[0] = MT_Vector2((float)x / size, (float)y / size);
+	for (int i = 1; i < RAS_TexVert::MAX_UNIT; i++) {
+		uvs[i] = MT_Vector2(0.0f, 0.0f);
+	}
+
+	return RAS_TexVert(MT_Vector3(x, y, height), uvs, MT_Vector4(1.0f, 0.0f, 0.0f, 1.0f), 0xFFFFFFFF,
+	                   MT_Vector3(normal), false, y * (size + 1) + x);
+}
+
+/* Add the vertices of the triangles in the order of a converted mesh, return the indices. */
+template <class Welder>
+static void grid_weld(Welder& welder, int size, std::vector<unsigned int>& r_indices)
+{
+	r_indices.clear();
+	r_indices.reserve(size * size * 6);
+
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			const unsigned int array = (x < size / 2) ? 0 : 1;
+			const int corners[6][2] = {{x, y}, {x + 1, y}, {x + 1, y + 1}, {x, y}, {x + 1, y + 1}, {x, y + 1}};
+			for (int i = 0; i < 6; i++) {
+				r_indices.push_back(welder.AddVertex(array, grid_vertex(size, corners[i][0], corners[i][1])));
+			}
+		}
+	}
+}
+
+struct MeshTask
+{
+	int m_size;
+	RAS_VertexWelder *m_welder;
+	std::vector<unsigned int> m_indices;
+};
+
+static void mesh_weld_task(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	MeshTask *task = (MeshTask *)taskdata;
+	task->m_welder = new RAS_VertexWelder((task->m_size + 1) * (task->m_size + 1));
+	task->m_welder->AddArray();
+	task->m_welder->AddArray();
+	grid_weld(*task->m_welder, task->m_size, task->m_indices);
+}
+
+TEST(rasterizer, VertexWelder)
+{
+	printf("\n========== STARTING rasterizer vertex welding %d triangles ==========\n", GRID_SIZE * GRID_SIZE * 2);
+
+	const unsigned int numorigverts = (GRID_SIZE + 1) * (GRID_SIZE + 1);
+	std::vector<unsigned int> indices_ref, indices;
+	unsigned int numverts_ref[2];
+
+	{
+		const double time_start = PIL_check_seconds_timer();
+		VectorWelder welder(numorigverts);
+		grid_weld(welder, GRID_SIZE, indices_ref);
+		printf("vector per original vertex: %.2f ms\n", (PIL_check_seconds_timer() - time_start) * 1000.0);
+
+		for (unsigned int i = 0; i < 2; i++) {
+			numverts_ref[i] = welder.GetVertices(i).size();
+		}
+	}
+
+	{
+		const double time_start = PIL_check_seconds_timer();
+		RAS_VertexWelder welder(numorigverts);
+		welder.AddArray();
+		welder.AddArray();
+		grid_weld(welder, GRID_SIZE, indices);
+		printf("chained vertices: %.2f ms\n", (PIL_check_seconds_timer() - time_start) * 1000.0);
+
+		/* The vertices of the column between the two materials are split. */
+		EXPECT_EQ(welder.GetVertices(0).size() + welder.GetVertices(1).size(), numorigverts + GRID_SIZE + 1);
+		for (unsigned int i = 0; i < 2; i++) {
+			EXPECT_EQ(welder.GetVertices(i).size(), numverts_ref[i]);
+		}
+		EXPECT_TRUE(indices == indices_ref);
+
+		/* Every shared vertex is reachable from its original vertex. */
+		const std::vector<int>& first = welder.GetFirstSharedVertices();
+		const std::vector<RAS_VertexWelder::SharedVertex>& shared = welder.GetSharedVertices();
+		unsigned int numshared = 0;
+		for (unsigned int i = 0; i < numorigverts; i++) {
+			for (int index = first[i]; index != -1; index = shared[index].m_next) {
+				EXPECT_EQ(welder.GetVertices(shared[index].m_array)[shared[index].m_offset].getOrigIndex(), i);
+				numshared++;
+			}
+		}
+		EXPECT_EQ(numshared, shared.size());
+	}
+
+	/* Meshes welded in parallel give the same vertices. */
+	BLI_threadapi_init();
+
+	const int max_threads = MAX2(BLI_system_thread_count(), 4);
+	std::vector<unsigned int> mesh_indices_ref;
+
+	for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+		TaskScheduler *scheduler = BLI_task_scheduler_create(num_threads);
+		MeshTask tasks[NUM_MESHES];
+
+		const double time_start = PIL_check_seconds_timer();
+		TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+		for (int i = 0; i < NUM_MESHES; i++) {
+			tasks[i].m_size = MESH_GRID_SIZE;
+			BLI_task_pool_push(pool, mesh_weld_task, &tasks[i], false, TASK_PRIORITY_LOW);
+		}
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+		printf("%d meshes, %d threads: %.2f ms\n", NUM_MESHES, num_threads, (PIL_check_seconds_timer() - time_start) * 1000.0);
+
+		if (num_threads == 1) {
+			mesh_indices_ref = tasks[0].m_indices;
+		}
+		for (int i = 0; i < NUM_MESHES; i++) {
+			EXPECT_TRUE(tasks[i].m_indices == mesh_indices_ref);
+			delete tasks[i].m_welder;
+		}
+
+		BLI_task_scheduler_free(scheduler);
+	}
+
+	BLI_threadapi_exit();
+
+	printf("========== ENDED rasterizer vertex welding ==========\n\n");
+}